@@ -0,0 +1,244 @@
+/*!
+ * @file event-benchmark.cc
+ * @brief Time the filling of Events hit by hit and loops over their Hits,
+ *        with the contiguous Hit storage and the former nested storage.
+ * @author agent
+ * @date 16 Oct 2026
+ * @version $Id$
+ */
+
+#include <hawcnest/CommandLineConfigurator.h>
+
+#include <data-structures/event/Event.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+using namespace evt;
+using namespace std;
+
+namespace {
+
+  // The storage of the Event before the contiguous Hits: vectors of tanks,
+  // each with a vector of Channels, each with a vector of Hits
+  class NestedEvent {
+    public:
+      struct Channel {
+        int channelId;
+        vector<Hit> hits;
+      };
+      struct Tank {
+        int tankId;
+        vector<Channel> channels;
+      };
+
+      NestedEvent() { tanks_.reserve(350); }
+
+      void AddHit(const Hit& hit) {
+        vector<Tank>::iterator t = tanks_.begin();
+        while (t != tanks_.end() && t->tankId != hit.tankId_)
+          ++t;
+        if (t == tanks_.end()) {
+          tanks_.push_back(Tank());
+          t = tanks_.end() - 1;
+          t->tankId = hit.tankId_;
+        }
+        vector<Channel>::iterator c = t->channels.begin();
+        while (c != t->channels.end() && c->channelId != hit.channelId_)
+          ++c;
+        if (c == t->channels.end()) {
+          t->channels.push_back(Channel());
+          c = t->channels.end() - 1;
+          c->channelId = hit.channelId_;
+        }
+        c->hits.insert(lower_bound(c->hits.begin(), c->hits.end(), hit), hit);
+      }
+
+      double SumCharge() const {
+        double sum = 0.;
+        for (vector<Tank>::const_iterator t = tanks_.begin();
+             t != tanks_.end(); ++t)
+          for (vector<Channel>::const_iterator c = t->channels.begin();
+               c != t->channels.end(); ++c)
+            for (vector<Hit>::const_iterator h = c->hits.begin();
+                 h != c->hits.end(); ++h)
+              sum += h->calibData_.PEs_;
+        return sum;
+      }
+
+    private:
+      vector<Tank> tanks_;
+  };
+
+  double Now()
+  {
+    static const boost::posix_time::ptime epoch =
+      boost::posix_time::microsec_clock::universal_time();
+    return (boost::posix_time::microsec_clock::universal_time() - epoch).
+           total_microseconds() * 1e-6;
+  }
+
+  // nHits random Hits in 300 tanks with 4 Channels each
+  vector<Hit> MakeHits(const int nHits, unsigned& state)
+  {
+    vector<Hit> hits(nHits);
+    for (int i = 0; i < nHits; ++i) {
+      state = state * 1103515245u + 12345u;
+      const unsigned r = state >> 4;
+      Hit& hit = hits[i];
+      hit.tankId_ = 1 + r % 300;
+      hit.tankChannelId_ = 1 + (r / 300) % 4;
+      hit.channelId_ = 4 * (hit.tankId_ - 1) + hit.tankChannelId_;
+      hit.triggerData_.time_ = (r / 1200) % 4000;
+      hit.calibData_.time_ = hit.triggerData_.time_ * 0.1;
+      hit.calibData_.PEs_ = 1. + (r / 1200) % 50;
+    }
+    return hits;
+  }
+
+  // Ways to loop over the Hits of an Event
+  double SumCharge(const Event& event)
+  {
+    double sum = 0.;
+    for (Event::ConstHitIterator h = event.HitsBegin();
+         h != event.HitsEnd(); ++h)
+      sum += h->calibData_.PEs_;
+    return sum;
+  }
+
+  double SumChargeNested(const Event& event)
+  {
+    double sum = 0.;
+    for (Event::ConstTankIterator t = event.TanksBegin();
+         t != event.TanksEnd(); ++t)
+      for (TankEvent::ConstChannelIterator c = t->ChannelsBegin();
+           c != t->ChannelsEnd(); ++c)
+        for (ChannelEvent::ConstHitIterator h = c->HitsBegin();
+             h != c->HitsEnd(); ++h)
+          sum += h->calibData_.PEs_;
+    return sum;
+  }
+
+  double SumChargeColumn(const Event& event)
+  {
+    const vector<double>& charges = event.GetHitCharges();
+    double sum = 0.;
+    for (size_t i = 0; i < charges.size(); ++i)
+      sum += charges[i];
+    return sum;
+  }
+
+  struct Timing {
+    double fill;        ///< time per event [s]
+    double loop;        ///< time per loop over the Hits [s]
+    double checksum;
+  };
+
+  Timing RunNested(const vector<vector<Hit> >& events, const int nLoops)
+  {
+    Timing t;
+    t.fill = t.loop = t.checksum = 0.;
+    for (size_t e = 0; e < events.size(); ++e) {
+      double start = Now();
+      NestedEvent event;
+      for (size_t i = 0; i < events[e].size(); ++i)
+        event.AddHit(events[e][i]);
+      const double filled = Now();
+      for (int l = 0; l < nLoops; ++l)
+        t.checksum += event.SumCharge();
+      t.loop += Now() - filled;
+      t.fill += filled - start;
+    }
+    t.fill /= events.size();
+    t.loop /= events.size() * nLoops;
+    return t;
+  }
+
+  typedef double (*Loop)(const Event&);
+
+  // Fills a new Event per event, or reuses one Event if reuse is set.  The
+  // fill time includes the grouping of the Hits by the first read
+  Timing RunEvent(const vector<vector<Hit> >& events, const int nLoops,
+                  const bool reuse, const Loop loop)
+  {
+    Timing t;
+    t.fill = t.loop = t.checksum = 0.;
+    Event reused;
+    for (size_t e = 0; e < events.size(); ++e) {
+      double start = Now();
+      Event fresh;
+      Event& event = reuse ? reused : fresh;
+      event.Clear();
+      for (size_t i = 0; i < events[e].size(); ++i)
+        event.AddHit(events[e][i]);
+      event.GetNHits();
+      const double filled = Now();
+      for (int l = 0; l < nLoops; ++l)
+        t.checksum += loop(event);
+      t.loop += Now() - filled;
+      t.fill += filled - start;
+    }
+    t.fill /= events.size();
+    t.loop /= events.size() * nLoops;
+    return t;
+  }
+
+  void Print(const char* label, const Timing& t, const Timing& reference)
+  {
+    printf("%-28s %10.2f %8.2f %10.3f %8.2f\n", label,
+           t.fill * 1e6, reference.fill / t.fill,
+           t.loop * 1e6, reference.loop / t.loop);
+  }
+
+}
+
+int main(int argc, char* argv[])
+{
+  CommandLineConfigurator cl(
+    "Fill and loop times of Events with the contiguous Hit storage and with "
+    "the former nested vectors of tanks, Channels and Hits.");
+  cl.AddOption<int>("events,n", 2000, "Number of events");
+  cl.AddOption<int>("hits,H", 500, "Hits per event");
+  cl.AddOption<int>("loops,l", 10, "Loops over the Hits of each event");
+
+  if (!cl.ParseCommandLine(argc, argv))
+    return 1;
+
+  const int nEvents = cl.GetArgument<int>("events");
+  const int nHits = cl.GetArgument<int>("hits");
+  const int nLoops = cl.GetArgument<int>("loops");
+  if (nEvents <= 0 || nLoops <= 0) {
+    fprintf(stderr, "need at least one event and one loop\n");
+    return 1;
+  }
+
+  unsigned state = 1;
+  vector<vector<Hit> > events;
+  for (int e = 0; e < nEvents; ++e)
+    events.push_back(MakeHits(nHits, state));
+
+  const Timing nested = RunNested(events, nLoops);
+  const Timing fresh = RunEvent(events, nLoops, false, SumCharge);
+  const Timing reused = RunEvent(events, nLoops, true, SumCharge);
+  const Timing views = RunEvent(events, nLoops, true, SumChargeNested);
+  const Timing columns = RunEvent(events, nLoops, true, SumChargeColumn);
+
+  printf("%-28s %10s %8s %10s %8s\n",
+         "storage", "fill [us]", "speedup", "loop [us]", "speedup");
+  Print("nested vectors (former)", nested, nested);
+  Print("Event, new per event", fresh, nested);
+  Print("Event, reused with Clear()", reused, nested);
+  Print("  loop over tanks, Channels", views, nested);
+  Print("  loop over charge column", columns, nested);
+
+  const bool ok = nested.checksum == fresh.checksum &&
+                  nested.checksum == reused.checksum &&
+                  nested.checksum == views.checksum &&
+                  nested.checksum == columns.checksum;
+  if (!ok)
+    printf("checksums differ!\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+/*!
+ * @file bayes-benchmark.cc
+ * @brief Time the filling and optimization of BayesianBuffers as a function
+ *        of the buffer size.
+ * @author agent
+ * @date 16 Oct 2026
+ * @version $Id$
+ */
+
+#include <hawcnest/CommandLineConfigurator.h>
+#include <hawcnest/HAWCNest.h>
+
+#include <rng-service/StdRNGService.h>
+
+#include <data-structures/math/BayesianBuffer.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+  double Now()
+  {
+    static const boost::posix_time::ptime epoch =
+      boost::posix_time::microsec_clock::universal_time();
+    return (boost::posix_time::microsec_clock::universal_time() - epoch).
+           total_microseconds() * 1e-6;
+  }
+
+  struct Timing {
+    double fill;        ///< time per added point [s]
+    double optimize;    ///< time of one Optimize() of the full buffer [s]
+  };
+
+  // Adds nPoints to the buffer, then finds the change points once
+  Timing Run(BayesianBuffer::BayesianBuffer& bb, const RNGService& rng,
+             const int nPoints, const int nBins, const double alpha)
+  {
+    Timing t;
+    vector<pair<double, double> > N(nBins);
+    vector<double> alphas(nBins, alpha);
+    double start = Now();
+    for (int i = 0; i < nPoints; ++i) {
+      for (int bin = 0; bin < nBins; ++bin) {
+        N[bin].second = rng.Poisson(200.);
+        N[bin].first = rng.Poisson(alpha * 200.);
+      }
+      bb.AddPoint(N, alphas, 56000. + i);
+    }
+    t.fill = (Now() - start) / nPoints;
+    vector<vector<unsigned int> > changes;
+    start = Now();
+    bb.Optimize(changes);
+    t.optimize = Now() - start;
+    return t;
+  }
+
+  void Print(const Timing& t)
+  { printf(" %10.2f %10.2f", t.fill * 1e6, t.optimize * 1e3); }
+
+}
+
+int main(int argc, char* argv[])
+{
+  CommandLineConfigurator cl(
+    "Time per added point and per optimization of BayesianBuffers versus "
+    "the buffer size.  Adding a point scales with the buffer size, the "
+    "optimization with its square.");
+  cl.AddOption<int>("bins,b", 3, "Number of bins per point");
+  cl.AddOption<int>("points,n", 2, "Points added, in units of the buffer size");
+  cl.AddOption<int>("seed", 0, "Random number seed");
+
+  if (!cl.ParseCommandLine(argc, argv))
+    return 1;
+
+  const int nBins = cl.GetArgument<int>("bins");
+  const int nBuffers = cl.GetArgument<int>("points");
+
+  HAWCNest nest;
+  nest.Service<StdRNGService>("rng")
+    ("seed", cl.GetArgument<int>("seed"));
+  nest.Configure();
+  const RNGService& rng = GetService<RNGService>("rng");
+
+  const double alpha = 0.1;
+  vector<double> alphas(nBins, alpha);
+  vector<double> gammas(1, 1e-3);
+
+  printf("%8s %21s %21s %21s\n%8s", "buffer", "default", "ratio", "excess",
+         "");
+  for (int i = 0; i < 3; ++i)
+    printf(" %10s %10s", "fill [us]", "opt [ms]");
+  printf("\n");
+  for (unsigned size = 50; size <= 1600; size *= 2) {
+    BayesianBuffer::BayesianBuffer bb(1., size, 1, true, -1., &gammas, 0.,
+                                      true);
+    BayesianBuffer::RatioBB ratio(1., size, 1, alphas, true, -1., &gammas, 0.,
+                                  true);
+    BayesianBuffer::ExcessRatioBB excess(1., size, 1, alphas, true, -1.,
+                                         &gammas, 0., true);
+    const int nPoints = nBuffers * size;
+    printf("%8u", size);
+    Print(Run(bb, rng, nPoints, nBins, alpha));
+    Print(Run(ratio, rng, nPoints, nBins, alpha));
+    Print(Run(excess, rng, nPoints, nBins, alpha));
+    printf("\n");
+  }
+
+  nest.Finish();
+  return 0;
+}
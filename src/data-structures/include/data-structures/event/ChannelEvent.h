@@ -14,11 +14,15 @@
 #include <data-structures/iterator/FlatIterator.h>
 
 #include <hawcnest/processing/Bag.h>
+#include <hawcnest/Logging.h>
 
 #include <algorithm>
+#include <vector>
 
 namespace evt {
 
+  class Event;
+
   /*!
    * @class ChannelEvent
    * @author Segev BenZvi, Jim Braun
@@ -26,6 +30,11 @@ namespace evt {
    * @date 6 Apr 2010
    * @brief Event data from a single Channel; provides access to trigger
    *        and calibration data from the event
+   *
+   * A ChannelEvent built by the user owns its Hits.  The ChannelEvents
+   * returned by an Event are views of a range of the Hits stored
+   * contiguously in the Event; Hits cannot be added to them.  Copying a view
+   * copies its Hits, so the copy owns them and does not depend on the Event.
    */
   class ChannelEvent : public Baggable {
 
@@ -35,14 +44,40 @@ namespace evt {
                        tankId_(0),
                        tankChannelId_(0),
                        hasL1Err_(false),
-                       hasFIFOErr_(false) { }
+                       hasFIFOErr_(false),
+                       view_(false) { SetOwnedRange(); }
 
       ChannelEvent(int channelId, int tankId, int tankChannelId) :
                        channelId_(channelId),
                        tankId_(tankId),
                        tankChannelId_(tankChannelId),
                        hasL1Err_(false),
-                       hasFIFOErr_(false) { }
+                       hasFIFOErr_(false),
+                       view_(false) { SetOwnedRange(); }
+
+      ChannelEvent(const ChannelEvent& ch) :
+                       Baggable(ch),
+                       channelId_(ch.channelId_),
+                       tankId_(ch.tankId_),
+                       tankChannelId_(ch.tankChannelId_),
+                       hasL1Err_(ch.hasL1Err_),
+                       hasFIFOErr_(ch.hasFIFOErr_),
+                       hits_(ch.HitsBegin(), ch.HitsEnd()),
+                       view_(false) { SetOwnedRange(); }
+
+      ChannelEvent& operator=(const ChannelEvent& ch) {
+        if (this != &ch) {
+          channelId_ = ch.channelId_;
+          tankId_ = ch.tankId_;
+          tankChannelId_ = ch.tankChannelId_;
+          hasL1Err_ = ch.hasL1Err_;
+          hasFIFOErr_ = ch.hasFIFOErr_;
+          hits_.assign(ch.HitsBegin(), ch.HitsEnd());
+          view_ = false;
+          SetOwnedRange();
+        }
+        return *this;
+      }
 
       int GetChannelId() const { return channelId_; }
       int GetTankId() const { return tankId_; }
@@ -60,22 +95,29 @@ namespace evt {
       typedef HitList::iterator HitIterator;
       typedef HitList::const_iterator ConstHitIterator;
 
-      HitIterator HitsBegin() { return hits_.begin(); }
-      HitIterator HitsEnd()   { return hits_.end(); }
+      HitIterator HitsBegin() { return begin_; }
+      HitIterator HitsEnd()   { return end_; }
 
-      ConstHitIterator HitsBegin() const { return hits_.begin(); }
-      ConstHitIterator HitsEnd() const   { return hits_.end(); }
+      ConstHitIterator HitsBegin() const { return begin_; }
+      ConstHitIterator HitsEnd() const   { return end_; }
+
+      /// Number of Hits
+      size_t GetNHits() const { return end_ - begin_; }
 
       /// Does the channel have a hit matching Selection
       template <typename Selection>
       bool HasHit(const Selection& sel) const {
-        return std::find_if(hits_.begin(), hits_.end(), sel) != hits_.end();
+        return std::find_if(HitsBegin(), HitsEnd(), sel) != HitsEnd();
       }
 
       void AddHit(const Hit& hit)
       {
+        if (view_)
+          log_fatal("Cannot add a hit to channel " << channelId_
+                    << " of an Event; use Event::AddHit.");
         HitIterator i = std::lower_bound(hits_.begin(), hits_.end(), hit);
         hits_.insert(i, hit);
+        SetOwnedRange();
       }
 
       /// Access policy to Edges via Hit objects
@@ -108,7 +150,19 @@ namespace evt {
       bool hasL1Err_;      ///< TDC L1 error flag set for this channel's group
       bool hasFIFOErr_;    ///< TDC FIFO err flag set for this channel's group
 
-      HitList hits_;
+      HitList hits_;       ///< Hits owned by a channel outside an Event
+
+      bool view_;          ///< True if the Hits are in an Event, not in hits_
+      HitIterator begin_;  ///< Range of the Hits, in hits_ or in an Event
+      HitIterator end_;
+
+      void SetOwnedRange() { begin_ = hits_.begin(); end_ = hits_.end(); }
+
+      /// Make this a view of a range of the Hits of an Event
+      void SetHitRange(HitIterator begin, HitIterator end)
+      { hits_.clear(); view_ = true; begin_ = begin; end_ = end; }
+
+      friend class Event;
 
   };
 
@@ -17,6 +17,8 @@
 
 #include <hawcnest/processing/Bag.h>
 
+#include <vector>
+
 #include <stdint.h>
 
 namespace evt {
@@ -31,8 +33,20 @@ namespace evt {
    * The Event class contains a nested hierarchy of TankEvent, ChannelEvent,
    * and Hit data.  Event --> TankEvent --> ChannelEvent --> Hit
    * Iterators are provided to make a "triple loop" over tanks, Channels, and
-   * Hits.  Alternatively, a flat_iterator can be used to loop directly over
-   * Hits from the top level.
+   * Hits.  Alternatively, the Hits can be looped over directly from the top
+   * level.
+   *
+   * All Hits are stored in one contiguous array, grouped by tank and by
+   * Channel, with the tanks and Channels in the order in which they were
+   * added.  The TankEvents and ChannelEvents are views of ranges of this
+   * array described by offset tables.  Hits added to the Event are grouped
+   * on the next read access, so fill the Event before looping over it; the
+   * views and iterators are invalidated by the next Add call.  For fast
+   * loops the channel IDs, times and charges of the Hits are also available
+   * as contiguous columns.
+   *
+   * Clear() empties the Event but keeps its memory, so an Event can be
+   * reused without reallocating its arrays.
    */
   class Event : public Baggable {
 
@@ -47,7 +61,18 @@ namespace evt {
                 laserTStart_(LASER_DATA_UNSET),
                 laserTStop_(LASER_DATA_UNSET),
                 laserLightToTanksStart_(LASER_DATA_UNSET),
-                laserLightToTanksStop_(LASER_DATA_UNSET) {tanks_.reserve(350);}
+                laserLightToTanksStop_(LASER_DATA_UNSET),
+                dirty_(false),
+                columnsStale_(false)
+      {
+        tanks_.reserve(350);
+        channelHitOffsets_.assign(1, 0);
+        tankChannelOffsets_.assign(1, 0);
+      }
+
+      Event(const Event& e);
+
+      Event& operator=(const Event& e);
 
       typedef std::vector<TankEvent> TankList;
       typedef TankList::iterator TankIterator;
@@ -55,99 +80,92 @@ namespace evt {
 
       /// Read-write access to the start of the triggered tank list
       TankIterator TanksBegin()
-      { return tanks_.begin(); }
+      { Group(); columnsStale_ = true; return tanks_.begin(); }
 
       /// Read-write access to the end of the triggered Tank list
       TankIterator TanksEnd()
-      { return tanks_.end(); }
+      { Group(); columnsStale_ = true; return tanks_.end(); }
 
       /// Read-only access to the start of the triggered tank list
       ConstTankIterator TanksBegin() const
-      { return tanks_.begin(); }
+      { Group(); return tanks_.begin(); }
 
       /// Read-only access to the end of the triggered Tank list
       ConstTankIterator TanksEnd() const
-      { return tanks_.end(); }
+      { Group(); return tanks_.end(); }
 
       /// Number of Tanks participating in the Event
       size_t GetNTanks() const
-      { return tanks_.size(); }
+      { Group(); return tanks_.size(); }
 
-      /// Access policy to Channels via Tank objects
-      class ChannelAccessPolicy {
-        public:
-          static TankEvent::ChannelIterator begin(TankEvent& t)
-          { return t.ChannelsBegin(); }
-          static TankEvent::ChannelIterator end(TankEvent& t)
-          { return t.ChannelsEnd(); }
-      };
-
-      typedef flat_iterator<TankIterator,
-                            TankEvent::ChannelIterator,
-                            ChannelAccessPolicy> ChannelIterator;
+      typedef TankEvent::ChannelEventList ChannelList;
+      typedef ChannelList::iterator ChannelIterator;
+      typedef ChannelList::const_iterator ConstChannelIterator;
 
       /// Read-write access to the start of the triggered Channel list
       ChannelIterator ChannelsBegin()
-      { return ChannelIterator(TanksBegin(), TanksEnd()); }
+      { Group(); columnsStale_ = true; return channels_.begin(); }
 
       /// Read-write access to the end of the triggered Channel list
       ChannelIterator ChannelsEnd()
-      { return ChannelIterator(TanksEnd(), TanksEnd()); }
-
-      /// Number of ChannelEvents
-      size_t GetNChannels() const
-      { return distance(ChannelsBegin(), ChannelsEnd()); }
-
-      /// Access policy to constant Channels, via Tank objects
-      class ConstChannelAccessPolicy {
-        public:
-          static TankEvent::ConstChannelIterator begin(const TankEvent& t)
-          { return t.ChannelsBegin(); }
-          static TankEvent::ConstChannelIterator end(const TankEvent& t)
-          { return t.ChannelsEnd(); }
-      };
-
-      typedef flat_iterator<ConstTankIterator,
-                            TankEvent::ConstChannelIterator,
-                            ConstChannelAccessPolicy> ConstChannelIterator;
+      { Group(); columnsStale_ = true; return channels_.end(); }
 
       /// Read-only access to the start of the triggered Channel list
       ConstChannelIterator ChannelsBegin() const
-      { return ConstChannelIterator(TanksBegin(), TanksEnd()); }
+      { Group(); return channels_.begin(); }
 
       /// Read-only access to the end of the triggered Channel list
       ConstChannelIterator ChannelsEnd() const
-      { return ConstChannelIterator(TanksEnd(), TanksEnd()); }
+      { Group(); return channels_.end(); }
 
+      /// Number of ChannelEvents
+      size_t GetNChannels() const
+      { Group(); return channels_.size(); }
 
-      // Hit-level access using nested flat_iterators
-      typedef flat_iterator<ChannelIterator,
-                            ChannelEvent::HitIterator,
-                            TankEvent::HitAccessPolicy> HitIterator;
+      typedef ChannelEvent::HitIterator HitIterator;
+      typedef ChannelEvent::ConstHitIterator ConstHitIterator;
 
-      /// Read-write access to the start of the triggered Channel list
+      /// Read-write access to the start of the Hit list
       HitIterator HitsBegin()
-      { return HitIterator(ChannelsBegin(), ChannelsEnd()); }
+      { Group(); columnsStale_ = true; return hits_.begin(); }
 
-      /// Read-write access to the end of the triggered Channel list
+      /// Read-write access to the end of the Hit list
       HitIterator HitsEnd()
-      { return HitIterator(ChannelsEnd(), ChannelsEnd()); }
-
-      typedef flat_iterator<ConstChannelIterator,
-                            ChannelEvent::ConstHitIterator,
-                            TankEvent::ConstHitAccessPolicy> ConstHitIterator;
+      { Group(); columnsStale_ = true; return hits_.end(); }
 
       /// Read-only access to the start of the Hit list
       ConstHitIterator HitsBegin() const
-      { return ConstHitIterator(ChannelsBegin(), ChannelsEnd()); }
+      { Group(); return hits_.begin(); }
 
       /// Read-only access to the end of the Hit list
       ConstHitIterator HitsEnd() const
-      { return ConstHitIterator(ChannelsEnd(), ChannelsEnd()); }
+      { Group(); return hits_.end(); }
 
       /// Number of Hits
       size_t GetNHits() const
-      { return distance(HitsBegin(), HitsEnd()); }
+      { Group(); return hits_.size(); }
+
+      /// Global channel IDs of the Hits, in the order of HitsBegin()
+      const std::vector<int>& GetHitChannelIds() const
+      { GatherColumns(); return hitChannelIds_; }
+
+      /// Calibrated times of the Hits, in the order of HitsBegin()
+      const std::vector<double>& GetHitTimes() const
+      { GatherColumns(); return hitTimes_; }
+
+      /// Calibrated charges [PE] of the Hits, in the order of HitsBegin()
+      const std::vector<double>& GetHitCharges() const
+      { GatherColumns(); return hitCharges_; }
+
+      /// Offsets of the Channels in the Hit list: the Hits of the i-th
+      /// Channel are [offsets[i], offsets[i+1])
+      const std::vector<size_t>& GetChannelHitOffsets() const
+      { Group(); return channelHitOffsets_; }
+
+      /// Offsets of the tanks in the Channel list: the Channels of the i-th
+      /// tank are [offsets[i], offsets[i+1])
+      const std::vector<size_t>& GetTankChannelOffsets() const
+      { Group(); return tankChannelOffsets_; }
 
       /// Add a Hit to the event (inserts into the proper Tank & Channel)
       void AddHit(const Hit& hit);
@@ -156,7 +174,11 @@ namespace evt {
       void AddChannel(const ChannelEvent& channel);
 
       /// Add a tank to the list of tanks
-      void AddTank(const TankEvent& tank) { tanks_.push_back(tank); }
+      void AddTank(const TankEvent& tank);
+
+      /// Remove all tanks, Channels and Hits and reset the event header,
+      /// keeping the allocated memory for the next event
+      void Clear();
 
       /// Check for the presence of a tank in the tank list by ID
       bool HasTank(const int tankId) const;
@@ -276,8 +298,6 @@ namespace evt {
 
     private:
 
-      TankList tanks_;
-
       TimeStamp time_;
       int eventID_;
       int runID_;
@@ -291,7 +311,63 @@ namespace evt {
       int32_t laserLightToTanksStart_;
       int32_t laserLightToTanksStop_;
 
+      // Fill records, in the order of the Add calls
+      std::vector<int> tankIds_;          ///< Tank IDs
+      mutable ChannelList channelRecords_; ///< IDs and flags, no Hits
+      std::vector<int> channelTanks_;     ///< Tank record of each Channel
+      std::vector<int> tankById_;         ///< First tank record of an ID
+      std::vector<int> channelById_;      ///< Channel record of an ID in
+                                          ///< the first tank
+
+      // Hits added since the last grouping, with their Channel records
+      mutable std::vector<Hit> pendingHits_;
+      mutable std::vector<int> pendingRecords_;
+      mutable std::vector<bool> pendingInserted_; ///< From AddHit
+      mutable bool dirty_;
+
+      // Grouped storage: tanks in record order, Channels grouped by tank
+      mutable std::vector<Hit> hits_;
+      mutable ChannelList channels_;
+      mutable TankList tanks_;
+      mutable std::vector<size_t> channelHitOffsets_;
+      mutable std::vector<size_t> tankChannelOffsets_;
+      mutable std::vector<int> channelOrder_;   ///< Record of each Channel
+
+      // Scratch space of Regroup
+      mutable std::vector<Hit> groupHits_;
+      mutable std::vector<size_t> groupRanges_;
+      mutable std::vector<size_t> groupPending_;
+
+      // Columns parallel to hits_
+      mutable std::vector<int> hitChannelIds_;
+      mutable std::vector<double> hitTimes_;
+      mutable std::vector<double> hitCharges_;
+      mutable bool columnsStale_;
+
       static const int32_t LASER_DATA_UNSET = -100000;
+
+      /// Largest tank or channel ID kept in the lookup tables
+      static const int MAX_LOOKUP_ID = 65535;
+
+      int FindTank(const int tankId) const;
+      int FindChannel(const int tankRecord, const int channelId) const;
+      /// Record of the first grouped Channel with the ID, -1 if none
+      int FindChannelRecord(const int channelId) const;
+      int NewTank(const int tankId);
+      int NewChannel(const int tankRecord, const ChannelEvent& ch);
+
+      /// Add a Channel record and queue its Hits as a block
+      void AddChannelBlock(const int tankRecord, const ChannelEvent& ch);
+
+      /// Sort pending Hits into the grouped storage
+      void Group() const { if (dirty_) Regroup(); }
+      void Regroup() const;
+
+      /// Point the tank and Channel views at the grouped storage
+      void LinkViews() const;
+
+      void GatherColumns() const;
+      void CopyFrom(const Event& e);
   };
 
   SHARED_POINTER_TYPEDEFS(Event);
@@ -14,8 +14,6 @@
 
 #include <hawcnest/processing/Bag.h>
 
-#include <vector>
-
 namespace evt {
 
   /*!
@@ -23,15 +21,19 @@ namespace evt {
    * @author Jim Braun
    * @ingroup event_data
    * @brief Event data from a pulse on a given Channel.
+   *
+   * The Edges are decoded from the trigger data on first access and kept in
+   * the Hit itself, so copying and storing Hits does not allocate memory.
    */
   class Hit : public Baggable {
 
     public:
 
-      typedef std::vector<Edge> EdgeList;
-      typedef EdgeList::const_iterator ConstEdgeIterator;
+      enum { MaxEdges = 4 };
+
+      typedef const Edge* ConstEdgeIterator;
 
-      Hit() { }
+      Hit() : nEdges_(0) { }
 
       HitTrigData triggerData_;
       HitCalData calibData_;
@@ -56,23 +58,25 @@ namespace evt {
 
       ConstEdgeIterator EdgesBegin() const {
         SetEdges();
-        return edges_.begin();
+        return edges_;
       }
 
       ConstEdgeIterator EdgesEnd() const {
         SetEdges();
-        return edges_.end();
+        return edges_ + nEdges_;
       }
 
     private:
 
-      mutable EdgeList edges_;
+      mutable Edge edges_[MaxEdges];
+      mutable int nEdges_;
 
       void SetEdges() const {
-        if (edges_.empty()) {
+        if (nEdges_ == 0) {
           int idMax = triggerData_.IsFourEdge() ? 4 : 2;
           for (int i = 0; i < idMax; ++i)
-            edges_.push_back(Edge(triggerData_, i));
+            edges_[i] = Edge(triggerData_, i);
+          nEdges_ = idMax;
         }
       }
 
@@ -18,6 +18,8 @@
 
 namespace evt {
 
+  class Event;
+
 /**
  * @class TankEvent
  * @author Segev BenZvi, Jim Braun
@@ -25,14 +27,36 @@ namespace evt {
  * @brief Container for Channels participating in an event
  * @todo This class may eventually contain summary data for all Channels in the
  *       tank to aid in tank-level triggers and reconstructions
+ *
+ * Like ChannelEvent, a TankEvent built by the user owns its Channels, while
+ * the TankEvents returned by an Event are views of a range of its Channels.
+ * Copying a view copies the Channels and their Hits.
  */
 
   class TankEvent : public Baggable {
 
     public:
 
-      TankEvent() : tankId_(0) { }
-      TankEvent(int tankId) : tankId_(tankId) { }
+      TankEvent() : tankId_(0), view_(false), nHits_(0) { SetOwnedRange(); }
+      TankEvent(int tankId) : tankId_(tankId), view_(false), nHits_(0)
+      { SetOwnedRange(); }
+
+      TankEvent(const TankEvent& t) :
+        Baggable(t),
+        tankId_(t.tankId_),
+        channels_(t.ChannelsBegin(), t.ChannelsEnd()),
+        view_(false),
+        nHits_(0) { SetOwnedRange(); }
+
+      TankEvent& operator=(const TankEvent& t) {
+        if (this != &t) {
+          tankId_ = t.tankId_;
+          channels_.assign(t.ChannelsBegin(), t.ChannelsEnd());
+          view_ = false;
+          SetOwnedRange();
+        }
+        return *this;
+      }
 
       int GetTankId() const {return tankId_;}
 
@@ -41,16 +65,16 @@ namespace evt {
       typedef ChannelEventList::const_iterator ConstChannelIterator;
 
       ChannelIterator ChannelsBegin()
-      { return channels_.begin(); }
+      { return begin_; }
 
       ChannelIterator ChannelsEnd()
-      { return channels_.end(); }
+      { return end_; }
 
       ConstChannelIterator ChannelsBegin() const
-      { return channels_.begin(); }
+      { return begin_; }
 
       ConstChannelIterator ChannelsEnd() const
-      { return channels_.end(); }
+      { return end_; }
 
       /// Access policy to Hits via Channel objects
       class HitAccessPolicy {
@@ -78,11 +102,11 @@ namespace evt {
 
       /// Number of ChannelEvents
       size_t GetNChannels() const
-      { return channels_.size(); }
+      { return end_ - begin_; }
 
       /// Number of Hits
       size_t GetNHits() const
-      { return distance(HitsBegin(), HitsEnd()); }
+      { return view_ ? nHits_ : distance(HitsBegin(), HitsEnd()); }
 
       /// Access policy to constant Channels, via Tank objects
       class ConstHitAccessPolicy {
@@ -105,15 +129,35 @@ namespace evt {
       ConstHitIterator HitsEnd() const
       { return ConstHitIterator(ChannelsEnd(), ChannelsEnd()); }
 
-      void AddChannel(const ChannelEvent& channel)
-      { channels_.push_back(channel); }
+      void AddChannel(const ChannelEvent& channel);
 
       void AddHit(const Hit& hit);
 
     private:
 
       int tankId_;
-      ChannelEventList channels_;
+      ChannelEventList channels_;   ///< Channels owned by a tank outside an Event
+
+      bool view_;                   ///< True if the Channels are in an Event
+      ChannelIterator begin_;       ///< Range of the Channels, in channels_
+      ChannelIterator end_;         ///< or in an Event
+      size_t nHits_;                ///< Number of Hits of a view
+
+      void SetOwnedRange()
+      { begin_ = channels_.begin(); end_ = channels_.end(); }
+
+      /// Make this a view of a range of the Channels of an Event
+      void SetChannelRange(ChannelIterator begin, ChannelIterator end,
+                           const size_t nHits)
+      {
+        channels_.clear();
+        view_ = true;
+        begin_ = begin;
+        end_ = end;
+        nHits_ = nHits;
+      }
+
+      friend class Event;
   };
 
   SHARED_POINTER_TYPEDEFS(TankEvent);
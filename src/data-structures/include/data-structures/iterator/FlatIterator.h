@@ -30,7 +30,7 @@
  * end of the inner container type from an outer container object.
  *
  * @tparam OIter Iterator type for outer container
- * @tparam IIter Iterator type for inner container
+ * @tparam IIter Iterator type for inner container (may be a plain pointer)
  * @tparam AccessPolicy Tells flat_iterator how to access the start and end of
  *         the inner container (defined per inner iterator)
  */
@@ -40,8 +40,8 @@ class flat_iterator :
 {
   public:
 
-    typedef typename IIter::reference reference;
-    typedef typename IIter::pointer pointer;
+    typedef typename std::iterator_traits<IIter>::reference reference;
+    typedef typename std::iterator_traits<IIter>::pointer pointer;
 
     flat_iterator() { }
 
@@ -198,6 +198,11 @@ namespace BayesianBuffer {
    *
    * Added 24 March 2015 by TRW:
    *   Modify for use with multiple bins
+   *
+   * Cumulative sums of the per-point terms of the fitness are kept for
+   * each bin, so Fitness() of a block costs O(bins) instead of
+   * O(bins * block length), and adding a point updates the cached block
+   * fitnesses in O(buffer size * bins).
    */
 
   class BayesianBuffer {
@@ -291,12 +296,32 @@ namespace BayesianBuffer {
       void AddDataPoint(double, double, double, double, double = 0.0);
       void AddDataPoint(std::vector<std::pair<double,double> >&, std::vector<double>&, double, double = 0.0);
 
+      // sums over the non-zero points of a block in one bin
+      struct BinSums {
+        BinSums() : n(0.0), non(0.0), noff(0.0), alphaInverse(0.0),
+                    noffLogAlpha(0.0), factorial(0.0), logTerm(0.0),
+                    subLogTerm(0.0) { }
+        double n;              // number of non-zero points
+        double non;
+        double noff;
+        double alphaInverse;
+        double noffLogAlpha;   // sum of Noff*log(alpha)
+        double factorial;      // sum of log(Non!) + log(Noff!)
+        double logTerm;
+        double subLogTerm;
+      };
+
+      // sums over the points idx1 up to but not including idx2 in bin
+      BinSums GetBinSums(unsigned int,unsigned int,size_t) const;
+      inline size_t GetSumBins() const { return sumBins_; }
+
       std::vector<double> startCountsOn_;
       std::vector<double> startCountsOff_;
 
     private:
 
       double GetFitness(unsigned int, unsigned int) const;
+      void UpdateBinSums(bool);
       void ResetCache();
       void AddToCache(double,double,double,double,double = 0.0);
       void AddToCache(std::vector<std::pair<double,double> >&,std::vector<double>&,double,double = 0.0);
@@ -308,6 +333,9 @@ namespace BayesianBuffer {
     private:
 
       std::deque<std::deque<double> > blockFitness_;
+      // cumulativeSums_[i][bin] holds the sums over the first i points
+      std::deque<std::vector<BinSums> > cumulativeSums_;
+      size_t sumBins_;
       double gamma_;
       double prior_;
       bool multipriors_;
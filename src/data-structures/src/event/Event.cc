@@ -11,76 +11,407 @@
 #include <data-structures/event/ChannelEvent.h>
 #include <data-structures/event/Hit.h>
 
+#include <algorithm>
+
 using namespace evt;
+using namespace std;
 
-class TankIdMatch : public std::binary_function<TankEvent, int, bool> {
-  public:
-    bool operator()(const TankEvent& t, const int id) const {
-      return t.GetTankId() == id;
-    }
-};
+namespace {
 
-class ChannelIdMatch : public std::binary_function<ChannelEvent, int, bool> {
-  public:
-    bool operator()(const ChannelEvent& p, const int id) const {
-      return p.GetChannelId() == id;
-    }
-};
+  // Error flags can only be set, so copying the set ones is enough
+  void CopyFlags(const ChannelEvent& from, ChannelEvent& to) {
+    if (from.HasL1Error())
+      to.SetL1Error();
+    if (from.HasFIFOError())
+      to.SetFIFOError();
+  }
+
+  // Entry of a lookup table for an ID, growing the table if needed
+  int& LookupEntry(vector<int>& table, const int id) {
+    if (id >= int(table.size()))
+      table.resize(id + 1, -1);
+    return table[id];
+  }
+
+}
+
+Event::Event(const Event& e) :
+  Baggable(e)
+{
+  CopyFrom(e);
+}
+
+Event&
+Event::operator=(const Event& e)
+{
+  if (this != &e) {
+    Baggable::operator=(e);
+    CopyFrom(e);
+  }
+  return *this;
+}
+
+void
+Event::CopyFrom(const Event& e)
+{
+  e.Group();
+
+  time_ = e.time_;
+  eventID_ = e.eventID_;
+  runID_ = e.runID_;
+  timeSliceID_ = e.timeSliceID_;
+  triggerFlags_ = e.triggerFlags_;
+  eventFlags_ = e.eventFlags_;
+  gtcFlags_ = e.gtcFlags_;
+  laserTStart_ = e.laserTStart_;
+  laserTStop_ = e.laserTStop_;
+  laserLightToTanksStart_ = e.laserLightToTanksStart_;
+  laserLightToTanksStop_ = e.laserLightToTanksStop_;
+
+  tankIds_ = e.tankIds_;
+  channelRecords_ = e.channelRecords_;
+  for (size_t i = 0; i < e.channels_.size(); ++i)
+    CopyFlags(e.channels_[i], channelRecords_[e.channelOrder_[i]]);
+  channelTanks_ = e.channelTanks_;
+  tankById_ = e.tankById_;
+  channelById_ = e.channelById_;
+
+  pendingHits_.clear();
+  pendingRecords_.clear();
+  pendingInserted_.clear();
+  dirty_ = false;
+
+  hits_ = e.hits_;
+  channelHitOffsets_ = e.channelHitOffsets_;
+  tankChannelOffsets_ = e.tankChannelOffsets_;
+  channelOrder_ = e.channelOrder_;
+  LinkViews();
+  columnsStale_ = true;
+}
 
 bool Event::HasTank(const int tankId) const {
-  return find_if(TanksBegin(), TanksEnd(), bind2nd(TankIdMatch(), tankId))
-    != TanksEnd();
+  return FindTank(tankId) >= 0;
 }
 
 const TankEvent&
 Event::GetTank(const int tkId)
   const
 {
-  ConstTankIterator iTk =
-    find_if(TanksBegin(), TanksEnd(), bind2nd(TankIdMatch(), tkId));
-  if (iTk == TanksEnd())
+  const int t = FindTank(tkId);
+  if (t < 0)
     log_fatal("Tank " << tkId << " not found in event.");
-  return *iTk;
+  Group();
+  return tanks_[t];
 }
 
 bool Event::HasChannel(const int channelId) const {
-  return find_if(ChannelsBegin(), ChannelsEnd(), bind2nd(ChannelIdMatch(), channelId))
-    != ChannelsEnd();
+  return FindChannelRecord(channelId) >= 0;
 }
 
 const ChannelEvent&
 Event::GetChannel(const int chId)
   const
 {
-  ConstChannelIterator iCh =
-    find_if(ChannelsBegin(), ChannelsEnd(), bind2nd(ChannelIdMatch(), chId));
-  if (iCh == ChannelsEnd())
+  const int r = FindChannelRecord(chId);
+  if (r < 0)
     log_fatal("Channel " << chId << " not found in event.");
-  return *iCh;
+  Group();
+  // Position of the record among the Channels of its tank
+  size_t i = tankChannelOffsets_[channelTanks_[r]];
+  while (channelOrder_[i] != r)
+    ++i;
+  return channels_[i];
 }
 
 void Event::AddChannel(const ChannelEvent& ch) {
 
-  TankIterator iTank;
-  if ((iTank = find_if(TanksBegin(), TanksEnd(),
-                 bind2nd(TankIdMatch(), ch.GetTankId()))) != TanksEnd()) {
-    iTank->AddChannel(ch);
+  int t = FindTank(ch.GetTankId());
+  if (t < 0)
+    t = NewTank(ch.GetTankId());
+  AddChannelBlock(t, ch);
+}
+
+void Event::AddTank(const TankEvent& tank) {
+
+  const int t = NewTank(tank.GetTankId());
+  for (TankEvent::ConstChannelIterator iCh = tank.ChannelsBegin();
+       iCh != tank.ChannelsEnd(); ++iCh)
+    AddChannelBlock(t, *iCh);
+}
+
+void Event::AddHit(const Hit& hit) {
+
+  int t = FindTank(hit.tankId_);
+  if (t < 0)
+    t = NewTank(hit.tankId_);
+  int r = FindChannel(t, hit.channelId_);
+  if (r < 0)
+    r = NewChannel(t, ChannelEvent(hit.channelId_,
+                                   hit.tankId_,
+                                   hit.tankChannelId_));
+  pendingHits_.push_back(hit);
+  pendingRecords_.push_back(r);
+  pendingInserted_.push_back(true);
+  dirty_ = true;
+}
+
+void
+Event::Clear()
+{
+  for (vector<int>::const_iterator id = tankIds_.begin();
+       id != tankIds_.end(); ++id)
+    if (*id >= 0 && *id < int(tankById_.size()))
+      tankById_[*id] = -1;
+  for (ConstChannelIterator iCh = channelRecords_.begin();
+       iCh != channelRecords_.end(); ++iCh) {
+    const int id = iCh->GetChannelId();
+    if (id >= 0 && id < int(channelById_.size()))
+      channelById_[id] = -1;
   }
-  else {
-    tanks_.push_back(TankEvent(ch.GetTankId()));
-    tanks_.back().AddChannel(ch);
+  tankIds_.clear();
+  channelRecords_.clear();
+  channelTanks_.clear();
+
+  pendingHits_.clear();
+  pendingRecords_.clear();
+  pendingInserted_.clear();
+  dirty_ = false;
+
+  tanks_.clear();
+  channels_.clear();
+  hits_.clear();
+  channelHitOffsets_.assign(1, 0);
+  tankChannelOffsets_.assign(1, 0);
+  channelOrder_.clear();
+
+  hitChannelIds_.clear();
+  hitTimes_.clear();
+  hitCharges_.clear();
+  columnsStale_ = false;
+
+  time_ = TimeStamp();
+  eventID_ = 0;
+  runID_ = 0;
+  timeSliceID_ = 0;
+  triggerFlags_ = 0x0;
+  eventFlags_ = 0x0;
+  gtcFlags_ = 0x0;
+  laserTStart_ = LASER_DATA_UNSET;
+  laserTStop_ = LASER_DATA_UNSET;
+  laserLightToTanksStart_ = LASER_DATA_UNSET;
+  laserLightToTanksStop_ = LASER_DATA_UNSET;
+}
+
+int
+Event::FindTank(const int tankId)
+  const
+{
+  if (tankId >= 0 && tankId <= MAX_LOOKUP_ID)
+    return tankId < int(tankById_.size()) ? tankById_[tankId] : -1;
+  vector<int>::const_iterator id =
+    find(tankIds_.begin(), tankIds_.end(), tankId);
+  return id != tankIds_.end() ? id - tankIds_.begin() : -1;
+}
+
+int
+Event::FindChannel(const int tankRecord, const int channelId)
+  const
+{
+  // The table holds the record of a channel ID in the first tank; search
+  // the records if that one belongs to another tank
+  if (channelId >= 0 && channelId <= MAX_LOOKUP_ID) {
+    if (channelId >= int(channelById_.size()))
+      return -1;
+    const int r = channelById_[channelId];
+    if (r < 0 || channelTanks_[r] == tankRecord)
+      return r;
   }
+  for (size_t r = 0; r < channelRecords_.size(); ++r)
+    if (channelTanks_[r] == tankRecord &&
+        channelRecords_[r].GetChannelId() == channelId)
+      return r;
+  return -1;
 }
 
-void Event::AddHit(const Hit& hit) {
+int
+Event::FindChannelRecord(const int channelId)
+  const
+{
+  if (channelId >= 0 && channelId <= MAX_LOOKUP_ID)
+    return channelId < int(channelById_.size()) ? channelById_[channelId] : -1;
+  int found = -1;
+  for (size_t r = 0; r < channelRecords_.size(); ++r)
+    if (channelRecords_[r].GetChannelId() == channelId &&
+        (found < 0 || channelTanks_[r] < channelTanks_[found]))
+      found = r;
+  return found;
+}
 
-  TankIterator iTank;
-  if ((iTank = find_if(TanksBegin(), TanksEnd(),
-                bind2nd(TankIdMatch(), hit.tankId_))) != TanksEnd()) {
-    iTank->AddHit(hit);
+int
+Event::NewTank(const int tankId)
+{
+  const int t = tankIds_.size();
+  tankIds_.push_back(tankId);
+  if (tankId >= 0 && tankId <= MAX_LOOKUP_ID) {
+    int& entry = LookupEntry(tankById_, tankId);
+    if (entry < 0)
+      entry = t;
+  }
+  dirty_ = true;
+  return t;
+}
+
+int
+Event::NewChannel(const int tankRecord, const ChannelEvent& ch)
+{
+  const int r = channelRecords_.size();
+  channelRecords_.push_back(ChannelEvent(ch.GetChannelId(),
+                                         ch.GetTankId(),
+                                         ch.GetTankChannelId()));
+  CopyFlags(ch, channelRecords_.back());
+  channelTanks_.push_back(tankRecord);
+  const int id = ch.GetChannelId();
+  if (id >= 0 && id <= MAX_LOOKUP_ID) {
+    // Keep the record that comes first in the grouped Channels
+    int& entry = LookupEntry(channelById_, id);
+    if (entry < 0 || tankRecord < channelTanks_[entry])
+      entry = r;
   }
-  else {
-    tanks_.push_back(TankEvent(hit.tankId_));
-    tanks_.back().AddHit(hit);
+  dirty_ = true;
+  return r;
+}
+
+void
+Event::AddChannelBlock(const int tankRecord, const ChannelEvent& ch)
+{
+  const int r = NewChannel(tankRecord, ch);
+  for (ChannelEvent::ConstHitIterator iHit = ch.HitsBegin();
+       iHit != ch.HitsEnd(); ++iHit) {
+    pendingHits_.push_back(*iHit);
+    pendingRecords_.push_back(r);
+    pendingInserted_.push_back(false);
+  }
+}
+
+void
+Event::Regroup()
+  const
+{
+  const size_t nTanks = tankIds_.size();
+  const size_t nRecords = channelRecords_.size();
+  const size_t nPending = pendingHits_.size();
+
+  // Keep the flags set through the Channel views
+  for (size_t i = 0; i < channels_.size(); ++i)
+    CopyFlags(channels_[i], channelRecords_[channelOrder_[i]]);
+
+  // Hit ranges of the records in the current grouping
+  groupRanges_.assign(2 * nRecords, 0);
+  for (size_t i = 0; i < channelOrder_.size(); ++i) {
+    groupRanges_[2 * channelOrder_[i]] = channelHitOffsets_[i];
+    groupRanges_[2 * channelOrder_[i] + 1] = channelHitOffsets_[i + 1];
+  }
+
+  // Counting sorts of the Channel records by tank and of the pending Hits
+  // by record.  Counts go two places up so that, after the prefix sum,
+  // offsets[k + 1] is the insertion cursor of k and ends as the start of
+  // k + 1
+  tankChannelOffsets_.assign(nTanks + 2, 0);
+  for (size_t r = 0; r < nRecords; ++r)
+    ++tankChannelOffsets_[channelTanks_[r] + 2];
+  for (size_t t = 2; t < nTanks + 2; ++t)
+    tankChannelOffsets_[t] += tankChannelOffsets_[t - 1];
+  channelOrder_.resize(nRecords);
+  for (size_t r = 0; r < nRecords; ++r)
+    channelOrder_[tankChannelOffsets_[channelTanks_[r] + 1]++] = r;
+  tankChannelOffsets_.resize(nTanks + 1);
+
+  groupPending_.assign(nRecords + 2 + nPending, 0);
+  vector<size_t>::iterator pendingOffsets = groupPending_.begin();
+  vector<size_t>::iterator pendingOrder = pendingOffsets + nRecords + 2;
+  for (size_t i = 0; i < nPending; ++i)
+    ++pendingOffsets[pendingRecords_[i] + 2];
+  for (size_t r = 2; r < nRecords + 2; ++r)
+    pendingOffsets[r] += pendingOffsets[r - 1];
+  for (size_t i = 0; i < nPending; ++i)
+    pendingOrder[pendingOffsets[pendingRecords_[i] + 1]++] = i;
+
+  // Existing Hits of each Channel, then its pending Hits in the order they
+  // were added.  AddHit inserts in time order like ChannelEvent::AddHit
+  groupHits_.clear();
+  groupHits_.reserve(hits_.size() + nPending);
+  channelHitOffsets_.resize(nRecords + 1);
+  channelHitOffsets_[0] = 0;
+  for (size_t i = 0; i < nRecords; ++i) {
+    const size_t r = channelOrder_[i];
+    const size_t begin = groupHits_.size();
+    groupHits_.insert(groupHits_.end(),
+                      hits_.begin() + groupRanges_[2 * r],
+                      hits_.begin() + groupRanges_[2 * r + 1]);
+    for (size_t k = pendingOffsets[r]; k < pendingOffsets[r + 1]; ++k) {
+      const size_t j = pendingOrder[k];
+      if (pendingInserted_[j])
+        groupHits_.insert(lower_bound(groupHits_.begin() + begin,
+                                      groupHits_.end(), pendingHits_[j]),
+                          pendingHits_[j]);
+      else
+        groupHits_.push_back(pendingHits_[j]);
+    }
+    channelHitOffsets_[i + 1] = groupHits_.size();
+  }
+  hits_.swap(groupHits_);
+
+  pendingHits_.clear();
+  pendingRecords_.clear();
+  pendingInserted_.clear();
+  dirty_ = false;
+
+  LinkViews();
+  columnsStale_ = true;
+}
+
+void
+Event::LinkViews()
+  const
+{
+  // Drop the old views first so that resizing never copies a view
+  tanks_.clear();
+  channels_.clear();
+
+  channels_.resize(channelOrder_.size());
+  for (size_t i = 0; i < channels_.size(); ++i) {
+    channels_[i] = channelRecords_[channelOrder_[i]];
+    channels_[i].SetHitRange(hits_.begin() + channelHitOffsets_[i],
+                             hits_.begin() + channelHitOffsets_[i + 1]);
+  }
+
+  tanks_.resize(tankIds_.size());
+  for (size_t t = 0; t < tanks_.size(); ++t) {
+    const size_t first = tankChannelOffsets_[t];
+    const size_t last = tankChannelOffsets_[t + 1];
+    tanks_[t].tankId_ = tankIds_[t];
+    tanks_[t].SetChannelRange(channels_.begin() + first,
+                              channels_.begin() + last,
+                              channelHitOffsets_[last] -
+                              channelHitOffsets_[first]);
+  }
+}
+
+void
+Event::GatherColumns()
+  const
+{
+  Group();
+  if (!columnsStale_)
+    return;
+  const size_t n = hits_.size();
+  hitChannelIds_.resize(n);
+  hitTimes_.resize(n);
+  hitCharges_.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    hitChannelIds_[i] = hits_[i].channelId_;
+    hitTimes_[i] = hits_[i].calibData_.time_;
+    hitCharges_[i] = hits_[i].calibData_.PEs_;
   }
+  columnsStale_ = false;
 }
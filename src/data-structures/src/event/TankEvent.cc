@@ -24,8 +24,20 @@ bool TankEvent::HasChannel(const int channelId) const {
     != ChannelsEnd();
 }
 
+void TankEvent::AddChannel(const ChannelEvent& channel) {
+  if (view_)
+    log_fatal("Cannot add a channel to tank " << tankId_
+              << " of an Event; use Event::AddChannel.");
+  channels_.push_back(channel);
+  SetOwnedRange();
+}
+
 void TankEvent::AddHit(const Hit& hit) {
 
+  if (view_)
+    log_fatal("Cannot add a hit to tank " << tankId_
+              << " of an Event; use Event::AddHit.");
+
   ChannelIterator iCh;
   if ((iCh = find_if(ChannelsBegin(), ChannelsEnd(),
                 bind2nd(ChannelIdMatch(), hit.channelId_))) != ChannelsEnd()) {
@@ -36,5 +48,6 @@ void TankEvent::AddHit(const Hit& hit) {
                                      hit.tankId_,
                                      hit.tankChannelId_));
     channels_.back().AddHit(hit);
+    SetOwnedRange();
   }
 }
@@ -377,6 +377,7 @@ namespace BayesianBuffer {
       multipriors_ = false;
     }
     bufferSize_ = bufferSize_in;
+    sumBins_ = 0;
     shifts_ = 0;
     rebinning_ = rebinning_in;
     binctr_ = 0;
@@ -404,6 +405,8 @@ namespace BayesianBuffer {
     }
     points_.clear();
     blockFitness_.clear();
+    cumulativeSums_.clear();
+    sumBins_ = 0;
     if(!IsBuffered()) bufferSize_ = 0;
   }
 
@@ -562,43 +565,80 @@ namespace BayesianBuffer {
   BayesianBuffer::Fitness(unsigned int idx1,unsigned int idx2)
     const
   {
-    size_t maxbin = 0;
-    for(unsigned int i = idx1; i < idx2; ++i) {
-      size_t testbins = points_[i]->GetBins();
-      if(testbins > maxbin) maxbin = testbins;
-    }
+    // bins beyond those of the points in the block have no non-zero points
+    // and contribute nothing
     double H = 0.0;
-    for(size_t bin = 0; bin < maxbin; ++bin) {
-      double N = 0.0;
-      double Noff = 0.0;
-      double Non = 0.0;
-      double inv_alpha = 0.0;
-      for (unsigned int i = idx1; i < idx2; ++i) {
-        if (!points_[i]->IsZero(bin)) {
-          Non += points_[i]->GetNon(bin);
-          Noff += points_[i]->GetNoff(bin);
-          inv_alpha += points_[i]->GetAlphaInverse(bin);
-          N += 1.0;
-        }
-      }
-      if(N != 0.0) {
-        double t1 = (Non == 0.0 ? 0.0 : log(Non/N));
-        double t2 = (Noff/inv_alpha);
+    for(size_t bin = 0; bin < GetSumBins(); ++bin) {
+      BinSums sums = GetBinSums(idx1,idx2,bin);
+      if(sums.n != 0.0) {
+        double t1 = (sums.non == 0.0 ? 0.0 : log(sums.non/sums.n));
+        double t2 = (sums.noff/sums.alphaInverse);
         double t3 = log(t2);
-        for (unsigned int i = idx1; i < idx2; ++i) {
-          if (!points_[i]->IsZero(bin)) {
-            H -= points_[i]->GetNon(bin)*t1;
-            H += points_[i]->GetNoff(bin)*(points_[i]->GetLogAlpha(bin)-t3);
-            H += points_[i]->GetAlphaInverse(bin)*t2;
-            H += points_[i]->GetFactorialTerm(bin);
-          }
-        }
+        H -= sums.non*t1;
+        H += sums.noffLogAlpha-sums.noff*t3;
+        H += sums.alphaInverse*t2;
+        H += sums.factorial;
       }
-      H += Non;
+      H += sums.non;
     }
     return -H;
   }
 
+  // sums over the non-zero points idx1 up to but not including idx2 in bin,
+  // taken from the difference of the cumulative sums
+  BayesianBuffer::BinSums
+  BayesianBuffer::GetBinSums(unsigned int idx1,unsigned int idx2,size_t bin)
+    const
+  {
+    BinSums sums;
+    if(bin >= sumBins_ || idx2 >= cumulativeSums_.size() || idx1 >= idx2)
+      return sums;
+    const BinSums& s1 = cumulativeSums_[idx1][bin];
+    const BinSums& s2 = cumulativeSums_[idx2][bin];
+    sums.n = s2.n-s1.n;
+    sums.non = s2.non-s1.non;
+    sums.noff = s2.noff-s1.noff;
+    sums.alphaInverse = s2.alphaInverse-s1.alphaInverse;
+    sums.noffLogAlpha = s2.noffLogAlpha-s1.noffLogAlpha;
+    sums.factorial = s2.factorial-s1.factorial;
+    sums.logTerm = s2.logTerm-s1.logTerm;
+    sums.subLogTerm = s2.subLogTerm-s1.subLogTerm;
+    return sums;
+  }
+
+  // extend the cumulative sums by the last point in the buffer; if the
+  // first point was dropped, recompute them all so that rounding errors do
+  // not build up over the shifts
+  void BayesianBuffer::UpdateBinSums(bool dropped) {
+    size_t first = points_.size()-1;
+    if(dropped || cumulativeSums_.size() != points_.size()) {
+      cumulativeSums_.assign(1,std::vector<BinSums>(sumBins_));
+      first = 0;
+    }
+    if(points_.back()->GetBins() > sumBins_) {
+      sumBins_ = points_.back()->GetBins();
+      // the earlier points have no counts in the new bins
+      for(size_t i = 0; i < cumulativeSums_.size(); ++i)
+        cumulativeSums_[i].resize(sumBins_);
+    }
+    for(size_t i = first; i < points_.size(); ++i) {
+      cumulativeSums_.push_back(cumulativeSums_.back());
+      std::vector<BinSums>& sums = cumulativeSums_.back();
+      const DataPoint& point = *points_[i];
+      for(size_t bin = 0; bin < point.GetBins(); ++bin) {
+        if(point.IsZero(bin)) continue;
+        sums[bin].n += 1.0;
+        sums[bin].non += point.GetNon(bin);
+        sums[bin].noff += point.GetNoff(bin);
+        sums[bin].alphaInverse += point.GetAlphaInverse(bin);
+        sums[bin].noffLogAlpha += point.GetNoff(bin)*point.GetLogAlpha(bin);
+        sums[bin].factorial += point.GetFactorialTerm(bin);
+        sums[bin].logTerm += point.GetLogTerm(bin);
+        sums[bin].subLogTerm += point.GetSubLogTerm(bin);
+      }
+    }
+  }
+
   // get the total signal (Non) over some range
   double BayesianBuffer::GetSignalSum(unsigned int idx1,unsigned int idx2) const {
     if(idx2 > points_.size()) idx2 = points_.size();
@@ -734,15 +774,20 @@ std::cout << "Proceeding in AddDataPoint!" << std::endl;*/
         points_.push_back(new DataPoint(cache_, cacheAlpha_, cacheMJD_, (cacheCount_ > 0 ? cacheAverageMJD_/((double)cacheCount_) : cacheMJD_), (cacheCount_ > 0 ? cacheAverageZenith_/((double)cacheCount_) : 0.0)));
         if(!IsBuffered()) bufferSize_ = points_.size();
         if(UseBlockFitness()) blockFitness_.push_back(std::deque<double>());
+        bool dropped = false;
         if(points_.size() > bufferSize_) {
           if(points_[0]) delete points_[0];
           points_.pop_front();
           if(UseBlockFitness()) blockFitness_.pop_front();
           shifts_++;
+          dropped = true;
         }
         if(IsSingleSearch()) {
         } else {
+          UpdateBinSums(dropped);
           if(UseBlockFitness()) {
+            // only the blocks ending at the new point are new; each costs
+            // O(bins) with the cumulative sums
             for (unsigned int i = 0; i < points_.size(); ++i) blockFitness_[i].push_back(GetFitness(i,points_.size()));
           }
         }
@@ -1001,33 +1046,17 @@ std::cout << "Proceeding in AddDataPoint!" << std::endl;*/
   }
 
   double ExcessRatioBB::Fitness(unsigned int idx1, unsigned int idx2) const {
-    size_t maxbin = 0;
-    for(unsigned int i = idx1; i < idx2; ++i) {
-      size_t testbins = points_[i]->GetBins();
-      if(testbins > maxbin) maxbin = testbins;
-    }
     double H = 0.0;
-    for(size_t bin = 0; bin < maxbin; ++bin) {
-      double N = 0.0;
-      double Noff = 0.0;
-      double Non = 0.0;
-      for(unsigned int i = idx1; i < idx2; ++i) {
-        if(!points_[i]->IsZero(bin)) {
-          Non += points_[i]->GetNon(bin);
-          Noff += points_[i]->GetNoff(bin);
-          N += 1.0;
-        }
-      }
-      if(N > 0.0 && Noff > 0.0) {
+    for(size_t bin = 0; bin < GetSumBins(); ++bin) {
+      BinSums sums = GetBinSums(idx1,idx2,bin);
+      double Non = sums.non;
+      double Noff = sums.noff;
+      if(sums.n > 0.0 && Noff > 0.0) {
         double F = Non / (alpha_[bin] * Noff) - 1.0;
         double t1 = 1.0/(1.0 + alpha_[bin] + alpha_[bin] * F);
-        for(unsigned int i = idx1; i < idx2; ++i) {
-          if(!points_[i]->IsZero(bin)) {
-            double sum = points_[i]->GetNon(bin) + points_[i]->GetNoff(bin);
-            H -= sum * log(sum * t1);
-            H += points_[i]->GetFactorialTerm(bin);
-          }
-        }
+        // sum of (Non+Noff)*log((Non+Noff)*t1) over the points
+        H -= sums.logTerm + (Non + Noff) * log(t1);
+        H += sums.factorial;
         H += Non + Noff;
         H -= log(alpha_[bin] + alpha_[bin] * F) * Non;
       }
@@ -1048,30 +1077,18 @@ std::cout << "Proceeding in AddDataPoint!" << std::endl;*/
   }
 
   double RatioBB::Fitness(unsigned int idx1,unsigned int idx2) const {
-    size_t maxbin = 0;
-    for(unsigned int i = idx1; i < idx2; ++i) {
-      size_t testbins = points_[i]->GetBins();
-      if(testbins > maxbin) maxbin = testbins;
-    }
+    bool offset = (GetKeyword() == "offset");
     double sum = 0.0;
-    for(size_t bin = 0; bin < maxbin; ++bin) {
-      double N = 0.0;
-      double M = 0.0;
-      for(unsigned int i = idx1; i < idx2; ++i) {
-        if(!points_[i]->IsZero(bin)) {
-          N += points_[i]->GetNon(bin);
-          M += points_[i]->GetNoff(bin);
-          if(GetKeyword() == "offset") {
-            sum += points_[i]->GetSubLogTerm(bin)-points_[i]->GetLogTerm(bin);
-          } else {
-            sum += points_[i]->GetLogTerm(bin)-points_[i]->GetFactorialTerm(bin);
-          }
-        }
-      }
-      if(GetKeyword() == "offset") {
+    for(size_t bin = 0; bin < GetSumBins(); ++bin) {
+      BinSums sums = GetBinSums(idx1,idx2,bin);
+      double N = sums.non;
+      double M = sums.noff;
+      if(offset) {
+        sum += sums.subLogTerm-sums.logTerm;
         if(N > 0.0) sum += N * (1.0 + log(1.0 + M / N) );
         if(M > 0.0) sum += M * (1.0 + log(1.0 + N / M) );
       } else {
+        sum += sums.logTerm-sums.factorial;
         if(N > 0.0) sum -= N * (1.0 + log(1.0 + M / N) );
         if(M > 0.0) sum -= M * (1.0 + log(1.0 + N / M) );
       }
@@ -1145,6 +1162,17 @@ std::cout << "Proceeding in AddDataPoint!" << std::endl;*/
         alphas[bin] = (points_.size() > 0 ? alphas[bin]/((double)points_.size()) : 0.0);
       }
       //get_significance(obs0,alphas,p0,t0,s0);
+      // running sums over the points up to and including C
+      std::vector<double> N1;
+      std::vector<double> M1;
+      N1.resize(maxbin,0.0);
+      M1.resize(maxbin,0.0);
+      for(size_t bin=0; bin<maxbin; ++bin) {
+        for(size_t i=0; i<(minC < maxC ? minC : 0); ++i) {
+          N1[bin] += points_[i]->GetNon(bin);
+          M1[bin] += points_[i]->GetNoff(bin);
+        }
+      }
       for(size_t C=minC; C<maxC; ++C) {
         double p1 = 0.0;
         double t1 = 0.0;
@@ -1157,16 +1185,12 @@ std::cout << "Proceeding in AddDataPoint!" << std::endl;*/
           obs1[bin].second = 0.0;
           obs2[bin].first = 0.0;
           obs2[bin].second = 0.0;
-          double N1 = 0.0;
-          double M1 = 0.0;
-          for(size_t i=0; i<=C; ++i) {
-            N1 += points_[i]->GetNon(bin);
-            M1 += points_[i]->GetNoff(bin);
-          }
-          obs1[bin].first = N1;
-          obs1[bin].second = M1;
-          obs2[bin].first = N[bin]-N1;
-          obs2[bin].second = M[bin]-M1;
+          N1[bin] += points_[C]->GetNon(bin);
+          M1[bin] += points_[C]->GetNoff(bin);
+          obs1[bin].first = N1[bin];
+          obs1[bin].second = M1[bin];
+          obs2[bin].first = N[bin]-N1[bin];
+          obs2[bin].second = M[bin]-M1[bin];
         }
 //log_info("Point " << C);
 //for(size_t bin=0; bin<maxbin; ++bin) log_info("  Bin " << bin << " obs2: (" << obs2[bin].first << "," << obs2[bin].second << ")  obs1: (" << obs1[bin].first << "," << obs1[bin].second << ")  alpha: " << alphas[bin]);
@@ -1208,13 +1232,12 @@ std::cout << "Proceeding in AddDataPoint!" << std::endl;*/
         bool sit1 = false;
         if(N < alphas[bin]*M) sit1 = true;
         double term = (sit1 ? 0.0 : (N > 0.0 ? N*log(1.0+M/N) : 0.0)+(M > 0.0 ? M*log(1.0+N/M) : 0.0));
+        // running sums over the points up to and including C
+        double N0 = baseN0;
+        double M0 = baseM0;
         for(size_t C=minC; C<maxC; ++C) {
-          double N0 = baseN0;
-          double M0 = baseM0;
-          for(size_t i=(minC < points_.size() ? minC : points_.size()); i<=C; ++i) {
-            N0 += points_[i]->GetNon(bin);
-            M0 += points_[i]->GetNoff(bin);
-          }
+          N0 += points_[C]->GetNon(bin);
+          M0 += points_[C]->GetNoff(bin);
           double N1 = N-N0;
           double M1 = M-M0;
           bool add = true;
@@ -1288,12 +1311,17 @@ std::cout << "Proceeding in AddDataPoint!" << std::endl;*/
         //  M += points_[i]->GetNoff(bin);
         //}
         //double term = (N > 0.0 ? N*log(1.0+M/N) : 0.0)+(M > 0.0 ? M*log(1.0+N/M) : 0.0);
+        // running sums over the points after C
+        double N1 = 0.0;
+        double M1 = 0.0;
+        for(size_t i=(minC+1); i<points_.size(); ++i) {
+          N1 += points_[i]->GetNon(bin);
+          M1 += points_[i]->GetNoff(bin);
+        }
         for(size_t C=minC; C<maxC; ++C) {
-          double N1 = 0.0;
-          double M1 = 0.0;
-          for(size_t i=(C+1); i<points_.size(); ++i) {
-            N1 += points_[i]->GetNon(bin);
-            M1 += points_[i]->GetNoff(bin);
+          if(C > minC) {
+            N1 -= points_[C]->GetNon(bin);
+            M1 -= points_[C]->GetNoff(bin);
           }
           //double N0 = baseN0;
           //double M0 = baseM0;
@@ -1354,13 +1382,12 @@ std::cout << "Proceeding in AddDataPoint!" << std::endl;*/
 //std::cout << "Bin " << bin << " sums: " << N << " and " << M << std::endl;
         double term = (N > 0.0 ? N*log(1.0+M/N) : 0.0)+(M > 0.0 ? M*log(1.0+N/M) : 0.0);
 //std::cout << "  term: " << term << std::endl;
+        // running sums over the points up to and including C
+        double N0 = baseN0;
+        double M0 = baseM0;
         for(size_t C=minC; C<maxC; ++C) {
-          double N0 = baseN0;
-          double M0 = baseM0;
-          for(size_t i=(minC < points_.size() ? minC : points_.size()); i<=C; ++i) {
-            N0 += points_[i]->GetNon(bin);
-            M0 += points_[i]->GetNoff(bin);
-          }
+          N0 += points_[C]->GetNon(bin);
+          M0 += points_[C]->GetNoff(bin);
           double N1 = N-N0;
           double M1 = M-M0;
 //std::cout << "  C = " << C << " sums: " << N0 << "," << M0 << " and " << N1 << "," << M1 << std::endl;
@@ -0,0 +1,313 @@
+/*!
+ * @file BayesianBuffer.cc
+ * @brief Unit tests of the block fitness of the buffered Bayesian blocks.
+ * @author agent
+ * @date 16 Oct 2026
+ * @ingroup unit_test
+ * @version $Id$
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <hawcnest/test/OutputConfig.h>
+
+#include <data-structures/math/BayesianBuffer.h>
+
+#include <cmath>
+
+using namespace std;
+using BayesianBuffer::ExcessRatioBB;
+using BayesianBuffer::RatioBB;
+using BayesianBuffer::SingleRatioBB;
+
+namespace {
+
+  typedef BayesianBuffer::BayesianBuffer Buffer;
+
+  // Reproducible Poisson counts: a 64-bit LCG and Knuth's algorithm
+  class CountGenerator {
+    public:
+      CountGenerator() : state_(12345) { }
+      double Poisson(const double mu) {
+        const double limit = exp(-mu);
+        double p = 1.;
+        int k = 0;
+        do {
+          ++k;
+          p *= Uniform();
+        } while (p > limit);
+        return k - 1;
+      }
+    private:
+      double Uniform() {
+        state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+        return ((state_ >> 11) + 0.5) / 9007199254740992.;
+      }
+      unsigned long long state_;
+  };
+
+  // Feeds nPoints of three-bin data with a flare in the 40 points before the
+  // last 20 to each buffer.  Every 37th point is empty and every 50th point
+  // lacks the last bin
+  void Fill(vector<Buffer*>& buffers, const int nPoints)
+  {
+    CountGenerator gen;
+    for (int i = 0; i < nPoints; ++i) {
+      vector<pair<double, double> > N;
+      vector<double> alphas;
+      const bool flare = i > nPoints - 60 && i < nPoints - 20;
+      for (int bin = 0; bin < 3; ++bin) {
+        double off = gen.Poisson(200.);
+        double on = gen.Poisson(20. * (1 + bin) + (flare ? 15. : 0.));
+        if (i % 37 == 5)
+          on = off = 0.;
+        N.push_back(make_pair(on, off));
+        alphas.push_back(0.1 * (1 + bin) + 0.001 * (i % 5));
+      }
+      if (i % 50 == 7) {
+        N.pop_back();
+        alphas.pop_back();
+      }
+      for (unsigned b = 0; b < buffers.size(); ++b)
+        buffers[b]->AddPoint(N, alphas, 56000. + i);
+    }
+  }
+
+  // The fitness functions as they were before the cumulative sums: every
+  // call walks over all points of the block
+  class ReferenceBB : public Buffer {
+    public:
+      ReferenceBB(vector<double>& gammas, const unsigned size) :
+        Buffer(1., size, 1, true, -1., &gammas, 0., true) { }
+
+      double Fitness(unsigned int idx1, unsigned int idx2) const {
+        size_t maxbin = 0;
+        for (unsigned int i = idx1; i < idx2; ++i)
+          maxbin = max(maxbin, points_[i]->GetBins());
+        double H = 0.;
+        for (size_t bin = 0; bin < maxbin; ++bin) {
+          double N = 0.;
+          double Noff = 0.;
+          double Non = 0.;
+          double invAlpha = 0.;
+          for (unsigned int i = idx1; i < idx2; ++i) {
+            if (!points_[i]->IsZero(bin)) {
+              Non += points_[i]->GetNon(bin);
+              Noff += points_[i]->GetNoff(bin);
+              invAlpha += points_[i]->GetAlphaInverse(bin);
+              N += 1.;
+            }
+          }
+          if (N != 0.) {
+            const double t1 = (Non == 0. ? 0. : log(Non / N));
+            const double t2 = Noff / invAlpha;
+            const double t3 = log(t2);
+            for (unsigned int i = idx1; i < idx2; ++i) {
+              if (!points_[i]->IsZero(bin)) {
+                H -= points_[i]->GetNon(bin) * t1;
+                H += points_[i]->GetNoff(bin) *
+                     (points_[i]->GetLogAlpha(bin) - t3);
+                H += points_[i]->GetAlphaInverse(bin) * t2;
+                H += points_[i]->GetFactorialTerm(bin);
+              }
+            }
+          }
+          H += Non;
+        }
+        return -H;
+      }
+  };
+
+  class ReferenceRatioBB : public RatioBB {
+    public:
+      ReferenceRatioBB(vector<double>& gammas, vector<double>& alpha,
+                       const unsigned size) :
+        RatioBB(1., size, 1, alpha, true, -1., &gammas, 0., true) { }
+
+      double Fitness(unsigned int idx1, unsigned int idx2) const {
+        size_t maxbin = 0;
+        for (unsigned int i = idx1; i < idx2; ++i)
+          maxbin = max(maxbin, points_[i]->GetBins());
+        const bool offset = GetKeyword() == "offset";
+        double sum = 0.;
+        for (size_t bin = 0; bin < maxbin; ++bin) {
+          double N = 0.;
+          double M = 0.;
+          for (unsigned int i = idx1; i < idx2; ++i) {
+            if (!points_[i]->IsZero(bin)) {
+              N += points_[i]->GetNon(bin);
+              M += points_[i]->GetNoff(bin);
+              if (offset)
+                sum += points_[i]->GetSubLogTerm(bin) -
+                       points_[i]->GetLogTerm(bin);
+              else
+                sum += points_[i]->GetLogTerm(bin) -
+                       points_[i]->GetFactorialTerm(bin);
+            }
+          }
+          const double sign = offset ? 1. : -1.;
+          if (N > 0.)
+            sum += sign * N * (1. + log(1. + M / N));
+          if (M > 0.)
+            sum += sign * M * (1. + log(1. + N / M));
+        }
+        return sum;
+      }
+  };
+
+  class ReferenceExcessRatioBB : public ExcessRatioBB {
+    public:
+      ReferenceExcessRatioBB(vector<double>& gammas, vector<double>& alpha,
+                             const unsigned size) :
+        ExcessRatioBB(1., size, 1, alpha, true, -1., &gammas, 0., true),
+        alpha_(alpha) { }
+
+      double Fitness(unsigned int idx1, unsigned int idx2) const {
+        size_t maxbin = 0;
+        for (unsigned int i = idx1; i < idx2; ++i)
+          maxbin = max(maxbin, points_[i]->GetBins());
+        double H = 0.;
+        for (size_t bin = 0; bin < maxbin; ++bin) {
+          double N = 0.;
+          double Noff = 0.;
+          double Non = 0.;
+          for (unsigned int i = idx1; i < idx2; ++i) {
+            if (!points_[i]->IsZero(bin)) {
+              Non += points_[i]->GetNon(bin);
+              Noff += points_[i]->GetNoff(bin);
+              N += 1.;
+            }
+          }
+          if (N > 0. && Noff > 0.) {
+            const double F = Non / (alpha_[bin] * Noff) - 1.;
+            const double t1 = 1. / (1. + alpha_[bin] + alpha_[bin] * F);
+            for (unsigned int i = idx1; i < idx2; ++i) {
+              if (!points_[i]->IsZero(bin)) {
+                const double sum = points_[i]->GetNon(bin) +
+                                   points_[i]->GetNoff(bin);
+                H -= sum * log(sum * t1);
+                H += points_[i]->GetFactorialTerm(bin);
+              }
+            }
+            H += Non + Noff;
+            H -= log(alpha_[bin] + alpha_[bin] * F) * Non;
+          }
+        }
+        return -H;
+      }
+
+    private:
+      vector<double> alpha_;
+  };
+
+  // Both buffers give the same change points and optimum fitness
+  void CheckSameOptimum(Buffer& bb, Buffer& reference)
+  {
+    vector<vector<unsigned int> > changes;
+    vector<vector<unsigned int> > referenceChanges;
+    const double fitness = bb.Optimize(changes);
+    const double referenceFitness = reference.Optimize(referenceChanges);
+    BOOST_REQUIRE_EQUAL(changes.size(), referenceChanges.size());
+    for (unsigned i = 0; i < changes.size(); ++i)
+      BOOST_CHECK_EQUAL_COLLECTIONS(
+        changes[i].begin(), changes[i].end(),
+        referenceChanges[i].begin(), referenceChanges[i].end());
+    BOOST_CHECK_CLOSE(fitness, referenceFitness, 1e-6);
+  }
+
+}
+
+BOOST_AUTO_TEST_SUITE(BayesianBufferTest)
+
+  // ___________________________________________________________________________
+  // The cached block fitnesses agree with a direct sum over the points, with
+  // and without points dropped from the front of the buffer
+  BOOST_AUTO_TEST_CASE(BlockFitness)
+  {
+    vector<double> gammas(1, 1e-3);
+    for (int nPoints = 150; nPoints <= 300; nPoints += 150) {
+      Buffer bb(1., 200, 1, true, -1., &gammas, 0., true);
+      ReferenceBB reference(gammas, 200);
+      vector<Buffer*> buffers;
+      buffers.push_back(&bb);
+      buffers.push_back(&reference);
+      Fill(buffers, nPoints);
+
+      BOOST_CHECK_EQUAL(bb.GetFilledSize(), reference.GetFilledSize());
+      for (unsigned i = 0; i < bb.GetFilledSize(); i += 7)
+        for (unsigned j = i + 1; j <= bb.GetFilledSize(); j += 5)
+          BOOST_CHECK_CLOSE(bb.GetBlockFitness(i, j),
+                            reference.GetBlockFitness(i, j), 1e-8);
+      CheckSameOptimum(bb, reference);
+
+      // refilled after clearing
+      bb.ClearData();
+      reference.ClearData();
+      Fill(buffers, 120);
+      CheckSameOptimum(bb, reference);
+    }
+  }
+
+  // ___________________________________________________________________________
+  // Same for the ratio fitness, with and without the offset keyword
+  BOOST_AUTO_TEST_CASE(RatioFitness)
+  {
+    vector<double> gammas(1, 1e-3);
+    vector<double> alpha(3, 0.1);
+    const char* keywords[] = { "", "offset" };
+    for (int k = 0; k < 2; ++k) {
+      RatioBB bb(1., 200, 1, alpha, true, -1., &gammas, 0., true);
+      ReferenceRatioBB reference(gammas, alpha, 200);
+      bb.SetKeyword(keywords[k]);
+      reference.SetKeyword(keywords[k]);
+      vector<Buffer*> buffers;
+      buffers.push_back(&bb);
+      buffers.push_back(&reference);
+      Fill(buffers, 300);
+      CheckSameOptimum(bb, reference);
+    }
+  }
+
+  // ___________________________________________________________________________
+  // Same for the excess fitness
+  BOOST_AUTO_TEST_CASE(ExcessRatioFitness)
+  {
+    vector<double> gammas(1, 1e-3);
+    vector<double> alpha(3, 0.1);
+    ExcessRatioBB bb(1., 200, 1, alpha, true, -1., &gammas, 0., true);
+    ReferenceExcessRatioBB reference(gammas, alpha, 200);
+    vector<Buffer*> buffers;
+    buffers.push_back(&bb);
+    buffers.push_back(&reference);
+    Fill(buffers, 300);
+    CheckSameOptimum(bb, reference);
+  }
+
+  // ___________________________________________________________________________
+  // The single change point search finds the start of the flare at the same
+  // point as before the running sums, for all fitness keywords
+  BOOST_AUTO_TEST_CASE(SingleChangePoint)
+  {
+    vector<double> gammas(1, 1e-3);
+    vector<double> alpha(3, 0.1);
+    const char* keywords[] = { "", "limited", "source-free" };
+    const double fitnesses[] = { 138.7305105, 131.1701119, 159.8645904 };
+    for (int k = 0; k < 3; ++k) {
+      SingleRatioBB bb(1., 200, 1, alpha, true, -1., &gammas, k == 0, 1, 0,
+                       0., true);
+      bb.SetKeyword(keywords[k]);
+      vector<Buffer*> buffers(1, &bb);
+      Fill(buffers, 300);
+
+      vector<vector<unsigned int> > changes(1);
+      vector<double> fitness;
+      bb.OptimizeSingle(changes, &fitness);
+      BOOST_REQUIRE_EQUAL(changes[0].size(), 1u);
+      BOOST_CHECK_EQUAL(changes[0][0], 142u);
+      BOOST_CHECK_CLOSE(fitness.back(), fitnesses[k], 1e-6);
+    }
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
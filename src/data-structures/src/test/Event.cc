@@ -0,0 +1,331 @@
+/*!
+ * @file Event.cc
+ * @brief Unit tests of the contiguous Hit storage of the Event.
+ * @author agent
+ * @date 16 Oct 2026
+ * @ingroup unit_test
+ * @version $Id$
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <hawcnest/test/OutputConfig.h>
+
+#include <data-structures/event/Event.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+using namespace evt;
+using namespace std;
+
+namespace {
+
+  // Channel ch of tank tk is global channel 4 * tk + ch
+  Hit MakeHit(const int tankId, const int tankChannelId, const int time,
+              const int tag = 0)
+  {
+    Hit hit;
+    hit.tankId_ = tankId;
+    hit.tankChannelId_ = tankChannelId;
+    hit.channelId_ = 4 * tankId + tankChannelId;
+    hit.triggerData_.time_ = time;
+    hit.triggerData_.loTOT_ = tag;
+    hit.calibData_.time_ = 0.5 * time;
+    hit.calibData_.PEs_ = tag + 0.25;
+    return hit;
+  }
+
+  // Tank-level fill as done by Event before the contiguous storage: a list
+  // of TankEvents that own their Channels
+  class ReferenceEvent {
+    public:
+      void AddHit(const Hit& hit) { Tank(hit.tankId_).AddHit(hit); }
+      void AddChannel(const ChannelEvent& ch)
+      { Tank(ch.GetTankId()).AddChannel(ch); }
+      void AddTank(const TankEvent& tank) { tanks_.push_back(tank); }
+      Event::TankList tanks_;
+    private:
+      TankEvent& Tank(const int tankId) {
+        for (Event::TankIterator t = tanks_.begin(); t != tanks_.end(); ++t)
+          if (t->GetTankId() == tankId)
+            return *t;
+        tanks_.push_back(TankEvent(tankId));
+        return tanks_.back();
+      }
+  };
+
+  // Same tanks, Channels and Hits in the same order
+  void CheckSameHits(const Event& event, const ReferenceEvent& reference)
+  {
+    vector<int> ids;
+    vector<int> refIds;
+    size_t nChannels = 0;
+    size_t nHits = 0;
+    for (Event::ConstTankIterator t = reference.tanks_.begin();
+         t != reference.tanks_.end(); ++t) {
+      refIds.push_back(-t->GetTankId());
+      nChannels += t->GetNChannels();
+      nHits += t->GetNHits();
+      for (TankEvent::ConstChannelIterator ch = t->ChannelsBegin();
+           ch != t->ChannelsEnd(); ++ch) {
+        refIds.push_back(ch->GetChannelId());
+        for (ChannelEvent::ConstHitIterator h = ch->HitsBegin();
+             h != ch->HitsEnd(); ++h)
+          refIds.push_back(1000 * h->triggerData_.time_ +
+                           h->triggerData_.loTOT_);
+      }
+    }
+    for (Event::ConstTankIterator t = event.TanksBegin();
+         t != event.TanksEnd(); ++t) {
+      ids.push_back(-t->GetTankId());
+      for (TankEvent::ConstChannelIterator ch = t->ChannelsBegin();
+           ch != t->ChannelsEnd(); ++ch) {
+        ids.push_back(ch->GetChannelId());
+        for (ChannelEvent::ConstHitIterator h = ch->HitsBegin();
+             h != ch->HitsEnd(); ++h)
+          ids.push_back(1000 * h->triggerData_.time_ +
+                        h->triggerData_.loTOT_);
+      }
+    }
+    BOOST_CHECK_EQUAL_COLLECTIONS(ids.begin(), ids.end(),
+                                  refIds.begin(), refIds.end());
+    BOOST_CHECK_EQUAL(event.GetNTanks(), reference.tanks_.size());
+    BOOST_CHECK_EQUAL(event.GetNChannels(), nChannels);
+    BOOST_CHECK_EQUAL(event.GetNHits(), nHits);
+  }
+
+}
+
+BOOST_AUTO_TEST_SUITE(EventTest)
+
+  // ___________________________________________________________________________
+  // Hits, Channels and tanks come out in the order of the nested storage,
+  // with reads between the Add calls
+  BOOST_AUTO_TEST_CASE(FillOrder)
+  {
+    Event event;
+    ReferenceEvent reference;
+    unsigned state = 1;
+    for (int i = 0; i < 400; ++i) {
+      state = state * 1103515245u + 12345u;
+      const int r = (state >> 8) % 1000;
+      const int tank = 1 + r % 17;
+      const int time = (r / 17) % 8;
+      if (r % 23 == 0) {
+        // a Channel with unsorted hits, possibly already in the event
+        ChannelEvent ch(4 * tank + 1, tank, 1);
+        ch.AddHit(MakeHit(tank, 1, 5, i));
+        ch.AddHit(MakeHit(tank, 1, 2, i));
+        ch.AddHit(MakeHit(tank, 1, 1, i + 1));
+        event.AddChannel(ch);
+        reference.AddChannel(ch);
+      }
+      else if (r % 29 == 0) {
+        TankEvent tk(tank);
+        tk.AddHit(MakeHit(tank, 2, time, i));
+        tk.AddHit(MakeHit(tank, 3, time + 1, i));
+        event.AddTank(tk);
+        reference.AddTank(tk);
+      }
+      else {
+        const Hit hit = MakeHit(tank, r % 3, time, i);
+        event.AddHit(hit);
+        reference.AddHit(hit);
+      }
+      if (i % 50 == 0)
+        CheckSameHits(event, reference);
+    }
+    CheckSameHits(event, reference);
+  }
+
+  // ___________________________________________________________________________
+  // The columns and offset tables describe the same Hits as the views
+  BOOST_AUTO_TEST_CASE(Columns)
+  {
+    Event event;
+    for (int i = 0; i < 60; ++i)
+      event.AddHit(MakeHit(1 + i % 7, i % 3, 100 - i, i));
+
+    const vector<int>& ids = event.GetHitChannelIds();
+    const vector<double>& times = event.GetHitTimes();
+    const vector<double>& charges = event.GetHitCharges();
+    const vector<size_t>& hitOffsets = event.GetChannelHitOffsets();
+    const vector<size_t>& channelOffsets = event.GetTankChannelOffsets();
+    BOOST_REQUIRE_EQUAL(ids.size(), event.GetNHits());
+    BOOST_REQUIRE_EQUAL(hitOffsets.size(), event.GetNChannels() + 1);
+    BOOST_REQUIRE_EQUAL(channelOffsets.size(), event.GetNTanks() + 1);
+
+    size_t i = 0;
+    for (Event::ConstHitIterator h = event.HitsBegin();
+         h != event.HitsEnd(); ++h, ++i) {
+      BOOST_CHECK_EQUAL(ids[i], h->channelId_);
+      BOOST_CHECK_EQUAL(times[i], h->calibData_.time_);
+      BOOST_CHECK_EQUAL(charges[i], h->calibData_.PEs_);
+    }
+
+    size_t c = 0;
+    size_t t = 0;
+    for (Event::ConstTankIterator tk = event.TanksBegin();
+         tk != event.TanksEnd(); ++tk, ++t) {
+      BOOST_CHECK_EQUAL(channelOffsets[t + 1] - channelOffsets[t],
+                        tk->GetNChannels());
+      BOOST_CHECK_EQUAL(hitOffsets[channelOffsets[t + 1]] -
+                        hitOffsets[channelOffsets[t]], tk->GetNHits());
+      for (TankEvent::ConstChannelIterator ch = tk->ChannelsBegin();
+           ch != tk->ChannelsEnd(); ++ch, ++c) {
+        BOOST_CHECK_EQUAL(hitOffsets[c + 1] - hitOffsets[c], ch->GetNHits());
+        for (size_t k = hitOffsets[c]; k < hitOffsets[c + 1]; ++k)
+          BOOST_CHECK_EQUAL(ids[k], ch->GetChannelId());
+      }
+    }
+
+    // Hits changed through the iterators show up in the columns
+    event.HitsBegin()->calibData_.PEs_ = 42.;
+    BOOST_CHECK_EQUAL(event.GetHitCharges()[0], 42.);
+  }
+
+  // ___________________________________________________________________________
+  // Lookup of tanks and Channels by ID, including IDs outside the tables
+  BOOST_AUTO_TEST_CASE(Lookup)
+  {
+    Event event;
+    event.AddHit(MakeHit(3, 1, 10));
+    event.AddHit(MakeHit(-2, 0, 20));
+    event.AddHit(MakeHit(70000, 2, 30));
+    event.AddHit(MakeHit(3, 2, 40));
+    event.AddHit(MakeHit(70000, 2, 50));
+
+    BOOST_CHECK(event.HasTank(3));
+    BOOST_CHECK(event.HasTank(-2));
+    BOOST_CHECK(event.HasTank(70000));
+    BOOST_CHECK(!event.HasTank(4));
+    BOOST_CHECK_EQUAL(event.GetTank(3).GetNHits(), 2u);
+    BOOST_CHECK_EQUAL(event.GetTank(70000).GetNHits(), 2u);
+    BOOST_CHECK_EQUAL(event.GetTank(70000).GetNChannels(), 1u);
+    BOOST_CHECK_THROW(event.GetTank(4), std::exception);
+
+    BOOST_CHECK(event.HasChannel(14));
+    BOOST_CHECK(event.HasChannel(-8));
+    BOOST_CHECK(!event.HasChannel(15));
+    BOOST_CHECK_EQUAL(event.GetChannel(4 * 70000 + 2).GetNHits(), 2u);
+    BOOST_CHECK_THROW(event.GetChannel(15), std::exception);
+
+    // a Channel ID in two tanks is found in the first tank
+    event.AddChannel(ChannelEvent(100, 70000, 0));
+    event.AddChannel(ChannelEvent(100, 3, 3));
+    event.AddChannel(ChannelEvent(-9, 70000, 1));
+    event.AddChannel(ChannelEvent(-9, 3, 0));
+    BOOST_CHECK(event.HasChannel(100));
+    BOOST_CHECK_EQUAL(event.GetChannel(100).GetTankId(), 3);
+    BOOST_CHECK_EQUAL(event.GetChannel(-9).GetTankId(), 3);
+    BOOST_CHECK_EQUAL(event.GetChannel(14).GetNHits(), 1u);
+  }
+
+  // ___________________________________________________________________________
+  // Flags set through the views survive regrouping and copies; Hits can only
+  // be added through the Event
+  BOOST_AUTO_TEST_CASE(Views)
+  {
+    Event event;
+    event.AddHit(MakeHit(1, 0, 10));
+    event.AddHit(MakeHit(2, 0, 20));
+    event.ChannelsBegin()->SetL1Error();
+    event.AddHit(MakeHit(1, 0, 5));
+    BOOST_CHECK(event.GetChannel(4).HasL1Error());
+    BOOST_CHECK(!event.GetChannel(8).HasL1Error());
+    BOOST_CHECK_EQUAL(event.GetChannel(4).HitsBegin()->triggerData_.time_, 5);
+
+    BOOST_CHECK_THROW(event.ChannelsBegin()->AddHit(MakeHit(1, 0, 1)),
+                      std::exception);
+    BOOST_CHECK_THROW(event.TanksBegin()->AddHit(MakeHit(1, 0, 1)),
+                      std::exception);
+
+    // copies of views own their Hits
+    ChannelEvent ch = event.GetChannel(4);
+    BOOST_CHECK(ch.HasL1Error());
+    ch.AddHit(MakeHit(1, 0, 7));
+    BOOST_CHECK_EQUAL(ch.GetNHits(), 3u);
+    BOOST_CHECK_EQUAL(event.GetChannel(4).GetNHits(), 2u);
+    TankEvent tk = event.GetTank(2);
+    tk.AddHit(MakeHit(2, 1, 7));
+    BOOST_CHECK_EQUAL(tk.GetNHits(), 2u);
+    BOOST_CHECK_EQUAL(event.GetTank(2).GetNHits(), 1u);
+  }
+
+  // ___________________________________________________________________________
+  // Copies are independent of the original, and a cleared Event refills
+  // like a new one
+  BOOST_AUTO_TEST_CASE(CopyAndClear)
+  {
+    Event event;
+    event.SetEventID(7);
+    for (int i = 0; i < 20; ++i)
+      event.AddHit(MakeHit(1 + i % 4, i % 2, i));
+    event.TanksBegin()->ChannelsBegin()->SetFIFOError();
+
+    Event copy(event);
+    BOOST_CHECK_EQUAL(copy.GetEventID(), 7);
+    BOOST_CHECK_EQUAL(copy.GetNHits(), 20u);
+    BOOST_CHECK(copy.ChannelsBegin()->HasFIFOError());
+    copy.HitsBegin()->triggerData_.time_ = 1000;
+    copy.AddHit(MakeHit(9, 0, 1));
+    BOOST_CHECK_EQUAL(event.HitsBegin()->triggerData_.time_, 0);
+    BOOST_CHECK_EQUAL(event.GetNTanks(), 4u);
+    BOOST_CHECK_EQUAL(copy.GetNTanks(), 5u);
+
+    Event assigned;
+    assigned.AddHit(MakeHit(5, 0, 1));
+    assigned = copy;
+    BOOST_CHECK(!assigned.HasTank(5));
+    BOOST_CHECK_EQUAL(assigned.GetNHits(), 21u);
+    BOOST_CHECK_EQUAL(assigned.GetTank(9).ChannelsBegin()->GetNHits(), 1u);
+
+    event.Clear();
+    BOOST_CHECK_EQUAL(event.GetEventID(), 0);
+    BOOST_CHECK_EQUAL(event.GetNTanks(), 0u);
+    BOOST_CHECK_EQUAL(event.GetNChannels(), 0u);
+    BOOST_CHECK_EQUAL(event.GetNHits(), 0u);
+    BOOST_CHECK_EQUAL(event.GetChannelHitOffsets().size(), 1u);
+    BOOST_CHECK(!event.HasTank(1));
+    BOOST_CHECK(!event.HasChannel(4));
+
+    ReferenceEvent reference;
+    for (int i = 0; i < 20; ++i) {
+      const Hit hit = MakeHit(4 - i % 4, i % 3, 20 - i);
+      event.AddHit(hit);
+      reference.AddHit(hit);
+    }
+    CheckSameHits(event, reference);
+    BOOST_CHECK(!event.ChannelsBegin()->HasFIFOError());
+  }
+
+  // ___________________________________________________________________________
+  // Hits decode two or four Edges
+  BOOST_AUTO_TEST_CASE(HitEdges)
+  {
+    Hit hit = MakeHit(1, 0, 100);
+    hit.triggerData_.time01_ = 30;
+    hit.triggerData_.loTOT_ = 50;
+    BOOST_CHECK_EQUAL(hit.EdgesEnd() - hit.EdgesBegin(), 2);
+
+    Hit fourEdge = MakeHit(1, 0, 100);
+    fourEdge.triggerData_.time01_ = 10;
+    fourEdge.triggerData_.loTOT_ = 50;
+    fourEdge.triggerData_.hiTOT_ = 30;
+    BOOST_CHECK_EQUAL(fourEdge.EdgesEnd() - fourEdge.EdgesBegin(), 4);
+
+    // decoded Edges are copied with the Hit
+    Event event;
+    event.AddHit(fourEdge);
+    const Hit& stored = *event.HitsBegin();
+    BOOST_CHECK_EQUAL(stored.EdgesEnd() - stored.EdgesBegin(), 4);
+    Hit::ConstEdgeIterator e1 = fourEdge.EdgesBegin();
+    for (Hit::ConstEdgeIterator e2 = stored.EdgesBegin();
+         e2 != stored.EdgesEnd(); ++e1, ++e2)
+      BOOST_CHECK_EQUAL(e1->GetTime(), e2->GetTime());
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,164 @@
+/*!
+ * @file bag-benchmark.cc
+ * @brief Measure the Put/Get throughput of the Bag with string names and
+ *        with interned BagKeys.
+ * @author agent
+ * @date 16 Oct 2026
+ * @version $Id$
+ */
+
+#include <hawcnest/CommandLineConfigurator.h>
+#include <hawcnest/processing/Bag.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <cstdio>
+#include <map>
+#include <sstream>
+
+using namespace std;
+
+// A product of some module
+struct BenchmarkProduct : public Baggable {
+  BenchmarkProduct(const int v) : value(v) { }
+  int value;
+};
+
+SHARED_POINTER_TYPEDEFS(BenchmarkProduct);
+
+namespace {
+
+  // The storage of the Bag before interned keys: a std::map keyed by name
+  // with the demangled type name recorded on every Put
+  class MapBag {
+    public:
+      void Put(const string& name, BaggableConstPtr b) {
+        if (bag_.find(name) != bag_.end())
+          throw bag_exception();
+        bag_[name] = b;
+        bagTypes_[name] = name_of<BenchmarkProduct>();
+      }
+      const BenchmarkProduct& Get(const string& name) const {
+        map<string, BaggableConstPtr>::const_iterator found = bag_.find(name);
+        if (found == bag_.end())
+          throw bag_exception();
+        BenchmarkProductConstPtr p =
+          boost::dynamic_pointer_cast<const BenchmarkProduct>(found->second);
+        if (!p)
+          throw bag_exception();
+        return *p;
+      }
+    private:
+      map<string, BaggableConstPtr> bag_;
+      map<string, string> bagTypes_;
+  };
+
+  double Now()
+  {
+    static const boost::posix_time::ptime epoch =
+      boost::posix_time::microsec_clock::universal_time();
+    return (boost::posix_time::microsec_clock::universal_time() - epoch).
+           total_microseconds() * 1e-6;
+  }
+
+  const BenchmarkProduct& Get(const MapBag& bag, const string& name)
+  { return bag.Get(name); }
+
+  template <class K>
+  const BenchmarkProduct& Get(const Bag& bag, const K& key)
+  { return bag.Get<BenchmarkProduct>(key); }
+
+  struct BenchmarkResult {
+    double seconds;
+    long checksum;
+  };
+
+  // Fills a bag with nProducts per event and reads nGets products back,
+  // cycling through the products like a chain of modules would
+  template <class B, class K>
+  BenchmarkResult Run(const vector<K>& keys,
+                      const vector<BenchmarkProductPtr>& products,
+                      const int nEvents, const int nGets)
+  {
+    BenchmarkResult result;
+    result.checksum = 0;
+    const double start = Now();
+    for (int e = 0; e < nEvents; ++e) {
+      B bag;
+      for (unsigned p = 0; p < keys.size(); ++p)
+        bag.Put(keys[p], products[p]);
+      for (int g = 0; g < nGets; ++g)
+        result.checksum +=
+          Get(bag, keys[(g * 7 + e) % keys.size()]).value;
+    }
+    result.seconds = Now() - start;
+    return result;
+  }
+
+  void Print(const char* label, const BenchmarkResult& r,
+             const int nEvents, const int nProducts, const int nGets,
+             const double reference)
+  {
+    const double perEvent = r.seconds / nEvents * 1e9;
+    printf("%-24s %10.3f %12.1f %10.1f %10.1f %8.2f\n",
+           label, r.seconds, perEvent, perEvent / nProducts,
+           perEvent / nGets, reference / r.seconds);
+  }
+
+}
+
+int main(int argc, char* argv[])
+{
+  CommandLineConfigurator cl(
+    "Put/Get throughput of the Bag with string names, with interned BagKeys, "
+    "and with the former std::map storage.");
+  cl.AddOption<int>("events,n", 200000, "Number of events");
+  cl.AddOption<int>("products,p", 30, "Products put into each bag");
+  cl.AddOption<int>("gets,g", 150, "Gets per event");
+
+  if (!cl.ParseCommandLine(argc, argv))
+    return 1;
+
+  const int nEvents = cl.GetArgument<int>("events");
+  const int nProducts = cl.GetArgument<int>("products");
+  const int nGets = cl.GetArgument<int>("gets");
+  if (nProducts <= 0 || nGets <= 0) {
+    cerr << "need at least one product and one get" << endl;
+    return 1;
+  }
+
+  // product names of realistic length, e.g. "reco::Module12Result"
+  vector<string> names;
+  vector<BagKey> keys;
+  vector<BenchmarkProductPtr> products;
+  for (int p = 0; p < nProducts; ++p) {
+    ostringstream name;
+    name << "reco::Module" << p << "Result";
+    names.push_back(name.str());
+    keys.push_back(BagKey(name.str()));
+    products.push_back(boost::make_shared<BenchmarkProduct>(p));
+  }
+
+  const BenchmarkResult mapResult =
+    Run<MapBag>(names, products, nEvents, nGets);
+  const BenchmarkResult stringResult =
+    Run<Bag>(names, products, nEvents, nGets);
+  const BenchmarkResult keyResult =
+    Run<Bag>(keys, products, nEvents, nGets);
+
+  printf("%-24s %10s %12s %10s %10s %8s\n",
+         "storage", "time [s]", "ns/event", "ns/put*", "ns/get*", "speedup");
+  Print("std::map (former)", mapResult, nEvents, nProducts, nGets,
+        mapResult.seconds);
+  Print("Bag, string names", stringResult, nEvents, nProducts, nGets,
+        mapResult.seconds);
+  Print("Bag, BagKeys", keyResult, nEvents, nProducts, nGets,
+        mapResult.seconds);
+  printf("* time per event divided by the number of puts or gets\n");
+
+  const bool ok = mapResult.checksum == stringResult.checksum &&
+                  mapResult.checksum == keyResult.checksum;
+  if (!ok)
+    printf("checksums differ!\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,364 @@
+/*!
+ * @file pipelined-loop-benchmark.cc
+ * @brief Compare the event rates of the SequentialMainLoop and the
+ *        PipelinedMainLoop on a synthetic module chain.
+ * @author agent
+ * @date 16 Oct 2026
+ * @version $Id$
+ */
+
+#include <hawcnest/HAWCNest.h>
+#include <hawcnest/CommandLineConfigurator.h>
+#include <hawcnest/Logging.h>
+#include <hawcnest/RegisterService.h>
+#include <hawcnest/processing/MainLoop.h>
+#include <hawcnest/processing/Module.h>
+#include <hawcnest/processing/PipelinedMainLoop.h>
+#include <hawcnest/processing/SequentialMainLoop.h>
+#include <hawcnest/processing/Source.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+using namespace std;
+
+// Raw data of a synthetic event
+struct SyntheticHits : public Baggable {
+  long id;
+  vector<double> charges;
+};
+
+SHARED_POINTER_TYPEDEFS(SyntheticHits);
+
+// Calibrated charges
+struct SyntheticCalibratedHits : public Baggable {
+  vector<double> charges;
+};
+
+SHARED_POINTER_TYPEDEFS(SyntheticCalibratedHits);
+
+// Result of the reconstruction
+struct SyntheticFit : public Baggable {
+  double value;
+};
+
+SHARED_POINTER_TYPEDEFS(SyntheticFit);
+
+namespace {
+
+  // Busy work standing in for the calibration/fit of one hit
+  double Crunch(double x, const int work)
+  {
+    for (int i = 0; i < work; ++i)
+      x = sqrt(x + 1.) + sin(x) * 1e-3;
+    return x;
+  }
+
+}
+
+// Source of events with pseudo-random charges
+class SyntheticSource : public Source {
+
+  public:
+
+    typedef Source Interface;
+
+    SyntheticSource() : nBags_(0), nHits_(0), count_(0) { }
+
+    Configuration DefaultConfiguration()
+    {
+      Configuration config;
+      config.Parameter<int>("nBags", 10000);
+      config.Parameter<int>("nHits", 100);
+      return config;
+    }
+
+    void Initialize(const Configuration& config)
+    {
+      config.GetParameter("nBags", nBags_);
+      config.GetParameter("nHits", nHits_);
+    }
+
+    BagPtr Next()
+    {
+      if (count_ >= nBags_)
+        return BagPtr();
+
+      SyntheticHitsPtr hits = boost::make_shared<SyntheticHits>();
+      hits->id = count_;
+      hits->charges.resize(nHits_);
+      for (int i = 0; i < nHits_; ++i)
+        hits->charges[i] = ((count_ * 7919 + i * 104729) % 1000) * 0.1;
+      ++count_;
+
+      BagPtr bag = boost::make_shared<Bag>();
+      bag->Put("hits", hits);
+      return bag;
+    }
+
+  private:
+
+    int nBags_;
+    int nHits_;
+    long count_;
+
+};
+
+REGISTER_SERVICE(SyntheticSource);
+
+// Per-hit calibration; re-entrant
+class SyntheticCalibration : public Module {
+
+  public:
+
+    typedef Module Interface;
+
+    Configuration DefaultConfiguration()
+    {
+      Configuration config;
+      config.Parameter<int>("work", 100);
+      return config;
+    }
+
+    void Initialize(const Configuration& config)
+    { config.GetParameter("work", work_); }
+
+    bool IsReentrant() const { return true; }
+
+    Module::Result Process(BagPtr bag)
+    {
+      const SyntheticHits& hits = bag->Get<SyntheticHits>("hits");
+      SyntheticCalibratedHitsPtr calibrated =
+        boost::make_shared<SyntheticCalibratedHits>();
+      calibrated->charges.resize(hits.charges.size());
+      for (unsigned i = 0; i < hits.charges.size(); ++i)
+        calibrated->charges[i] = Crunch(hits.charges[i], work_);
+      bag->Put("calibrated", calibrated);
+      return Module::Continue;
+    }
+
+  private:
+
+    int work_;
+
+};
+
+REGISTER_SERVICE(SyntheticCalibration);
+
+// Drops every tenth event; re-entrant
+class SyntheticFilter : public Module {
+
+  public:
+
+    typedef Module Interface;
+
+    bool IsReentrant() const { return true; }
+
+    Module::Result Process(BagPtr bag)
+    {
+      const SyntheticHits& hits = bag->Get<SyntheticHits>("hits");
+      return (hits.id % 10 == 9) ? Module::Filter : Module::Continue;
+    }
+
+};
+
+REGISTER_SERVICE(SyntheticFilter);
+
+// Event fit; re-entrant
+class SyntheticReconstruction : public Module {
+
+  public:
+
+    typedef Module Interface;
+
+    Configuration DefaultConfiguration()
+    {
+      Configuration config;
+      config.Parameter<int>("work", 100);
+      return config;
+    }
+
+    void Initialize(const Configuration& config)
+    { config.GetParameter("work", work_); }
+
+    bool IsReentrant() const { return true; }
+
+    Module::Result Process(BagPtr bag)
+    {
+      const SyntheticCalibratedHits& hits =
+        bag->Get<SyntheticCalibratedHits>("calibrated");
+      double sum = 0.;
+      for (unsigned i = 0; i < hits.charges.size(); ++i)
+        sum += Crunch(hits.charges[i], work_);
+      SyntheticFitPtr fit = boost::make_shared<SyntheticFit>();
+      fit->value = sum / hits.charges.size();
+      bag->Put("fit", fit);
+      return Module::Continue;
+    }
+
+  private:
+
+    int work_;
+
+};
+
+REGISTER_SERVICE(SyntheticReconstruction);
+
+// Output stand-in: serial, checks the order and sums up the results
+class SyntheticSink : public Module {
+
+  public:
+
+    typedef Module Interface;
+
+    SyntheticSink() : lastId_(-1), nBags_(0), checksum_(0.), ordered_(true) { }
+
+    Module::Result Process(BagPtr bag)
+    {
+      const long id = bag->Get<SyntheticHits>("hits").id;
+      if (id <= lastId_)
+        ordered_ = false;
+      lastId_ = id;
+      ++nBags_;
+      checksum_ += (id % 100 + 1) * bag->Get<SyntheticFit>("fit").value;
+      return Module::Continue;
+    }
+
+    long GetNumberOfBags() const { return nBags_; }
+    double GetChecksum() const { return checksum_; }
+    bool IsOrdered() const { return ordered_; }
+
+  private:
+
+    long lastId_;
+    long nBags_;
+    double checksum_;
+    bool ordered_;
+
+};
+
+REGISTER_SERVICE(SyntheticSink);
+
+namespace {
+
+  struct LoopResult {
+    double seconds;
+    long nBags;
+    double checksum;
+    bool ordered;
+  };
+
+  // Runs the chain source -> calibration -> filter -> reconstruction -> sink
+  LoopResult RunLoop(const string& loop, const int nThreads, const int nBags,
+                     const int nHits, const int work)
+  {
+    HAWCNest nest;
+
+    nest.Service<SyntheticSource>("source")
+      ("nBags", nBags)
+      ("nHits", nHits);
+    nest.Service<SyntheticCalibration>("calibration")
+      ("work", work);
+    nest.Service<SyntheticFilter>("filter");
+    nest.Service<SyntheticReconstruction>("reconstruction")
+      ("work", work);
+    nest.Service<SyntheticSink>("sink");
+
+    vector<string> chain;
+    chain.push_back("calibration");
+    chain.push_back("filter");
+    chain.push_back("reconstruction");
+    chain.push_back("sink");
+
+    if (loop == "SequentialMainLoop") {
+      nest.Service<SequentialMainLoop>("mainloop")
+        ("source", "source")
+        ("modulechain", chain)
+        ("updateFrequency", nBags + 1);
+    }
+    else {
+      nest.Service<PipelinedMainLoop>("mainloop")
+        ("source", "source")
+        ("modulechain", chain)
+        ("updateFrequency", nBags + 1)
+        ("nThreads", nThreads);
+    }
+
+    nest.Configure();
+
+    const boost::posix_time::ptime start =
+      boost::posix_time::microsec_clock::universal_time();
+    GetService<MainLoop>("mainloop").Execute();
+    const boost::posix_time::ptime stop =
+      boost::posix_time::microsec_clock::universal_time();
+
+    boost::shared_ptr<SyntheticSink> sink =
+      boost::dynamic_pointer_cast<SyntheticSink>(GetService<ModulePtr>("sink"));
+    LoopResult result;
+    result.seconds = (stop - start).total_microseconds() * 1e-6;
+    result.nBags = sink->GetNumberOfBags();
+    result.checksum = sink->GetChecksum();
+    result.ordered = sink->IsOrdered();
+
+    nest.Finish();
+    return result;
+  }
+
+}
+
+int main(int argc, char* argv[])
+{
+  CommandLineConfigurator cl(
+    "Compare events/s of the SequentialMainLoop and the PipelinedMainLoop on "
+    "a synthetic chain of calibration, filter, reconstruction (re-entrant) "
+    "and sink (serial) modules.");
+  cl.AddOption<int>("bags,n", 20000, "Number of events");
+  cl.AddOption<int>("hits", 100, "Hits per event");
+  cl.AddOption<int>("work,w", 50, "Iterations per hit and module");
+  cl.AddOption<int>("threads,t", 0, "Maximum number of threads (0: one per core)");
+
+  if (!cl.ParseCommandLine(argc, argv))
+    return 1;
+
+  const int nBags = cl.GetArgument<int>("bags");
+  const int nHits = cl.GetArgument<int>("hits");
+  const int work = cl.GetArgument<int>("work");
+  int maxThreads = cl.GetArgument<int>("threads");
+  if (maxThreads <= 0)
+    maxThreads = max(1u, boost::thread::hardware_concurrency());
+
+  Logger::GetInstance().SetDefaultLogLevel(Logger::WARN);
+
+  const LoopResult reference =
+    RunLoop("SequentialMainLoop", 1, nBags, nHits, work);
+  const double referenceRate = reference.nBags / reference.seconds;
+
+  printf("%-20s %8s %10s %12s %8s %6s %9s\n",
+         "loop", "threads", "time [s]", "events/s", "speedup", "order",
+         "checksum");
+  printf("%-20s %8d %10.3f %12.1f %8.2f %6s %9s\n",
+         "SequentialMainLoop", 1, reference.seconds, referenceRate, 1.,
+         reference.ordered ? "ok" : "WRONG", "ok");
+
+  bool ok = reference.ordered;
+  for (int nThreads = 1; nThreads <= maxThreads;
+       nThreads = (nThreads < maxThreads && 2*nThreads > maxThreads) ?
+                  maxThreads : 2*nThreads) {
+    const LoopResult result =
+      RunLoop("PipelinedMainLoop", nThreads, nBags, nHits, work);
+    const double rate = result.nBags / result.seconds;
+    const bool same = (result.nBags == reference.nBags) &&
+                      (result.checksum == reference.checksum);
+    printf("%-20s %8d %10.3f %12.1f %8.2f %6s %9s\n",
+           "PipelinedMainLoop", nThreads, result.seconds, rate,
+           rate / referenceRate, result.ordered ? "ok" : "WRONG",
+           same ? "ok" : "WRONG");
+    ok = ok && result.ordered && same;
+  }
+
+  return ok ? 0 : 1;
+}
@@ -9,26 +9,39 @@
 #ifndef HAWCNEST_BAG_INL_H_INCLUDED
 #define HAWCNEST_BAG_INL_H_INCLUDED
 
+#include <algorithm>
+
 template <class T>
 void
-Bag::Put(const std::string& name, T baggable) 
+Bag::Put(const BagKey& key, T baggable)
 {
   if (!baggable) {
     log_error("cannot put empty objects in the bag. Called with type '" 
-              <<name_of<T>() <<"' and name '" << name << "'");
+              <<name_of<T>() <<"' and name '" << key.GetName() << "'");
+    throw bag_exception();
+  }
+  if (!key.IsValid()) {
+    log_error("cannot put type '" << name_of<T>() << "' in the bag with an "
+              "invalid key.");
     throw bag_exception();
   }
-  if (bag_.find(name) == bag_.end()) {
-    bag_[name] = baggable;
+  const int id = key.GetId();
+  if (id >= int(slots_.size()))
+    slots_.resize(std::max(id + 1, 2*int(slots_.size())));
+  Slot& slot = slots_[id];
+  if (!slot.object) {
+    slot.object = baggable;
 #if BOOST_VERSION < 105300
-    bagTypes_[name] = name_of<typename T::value_type>();
+    slot.type = &typeid(typename T::value_type);
 #else
-    bagTypes_[name] = name_of<typename T::element_type>();
+    slot.type = &typeid(typename T::element_type);
 #endif
+    keys_.push_back(key);
+    viewStale_ = true;
   }
   else {
-    log_error("bag member '" << name << "' already exists. Cannot put type '"
-              << name_of<T>() << "' with that key.");
+    log_error("bag member '" << key.GetName() << "' already exists. Cannot "
+              "put type '" << name_of<T>() << "' with that key.");
     throw bag_exception();
   }
 }
@@ -36,7 +49,7 @@ Bag::Put(const std::string& name, T baggable)
 // version of Get if T is a const shared_ptr
 template <class T>
 T
-Bag::Get(const std::string& name,
+Bag::Get(const BagKey& key,
   typename boost::enable_if<is_shared_ptr<T> >::type*,
 #if BOOST_VERSION < 105300
   typename boost::enable_if<boost::is_const<typename T::value_type> >::type*
@@ -46,29 +59,37 @@ Bag::Get(const std::string& name,
   )
 const
 {
-  typename BagType::const_iterator found = bag_.find(name);
-  if(found == bag_.end()){
+  const Slot* found = Find(key);
+  if (!found) {
     return T();
   }
-  BaggableConstPtr toreturn = found->second;
 #if BOOST_VERSION < 105300
-  return boost::dynamic_pointer_cast<typename T::value_type>(toreturn);
+  return boost::dynamic_pointer_cast<typename T::value_type>(found->object);
 #else
-  return boost::dynamic_pointer_cast<typename T::element_type>(toreturn);
+  return boost::dynamic_pointer_cast<typename T::element_type>(found->object);
 #endif
 }
 
 // version of Get if T is a reference
 template <class T>
 const T&
-Bag::Get(const std::string& name,
+Bag::Get(const BagKey& key,
   typename boost::disable_if<is_shared_ptr<T> >::type*)
 const
 {
-  boost::shared_ptr<const T> returnme =
-    Get<boost::shared_ptr<const T> >(name);
+  return GetObject<T>(key, key.GetName());
+}
+
+template <class T>
+const T&
+Bag::GetObject(const BagKey& key, const std::string& name)
+const
+{
+  // cast the stored pointer: no reference counting on the hot path
+  const Slot* found = Find(key);
+  const T* returnme = found ? dynamic_cast<const T*>(found->object.get()) : 0;
   if (!returnme) {
-    if (bag_.count(name) > 0) {
+    if (found) {
       log_error("Found bag member " << name
                 << " but it isn't the requested type of " << name_of<T>());
       throw bag_exception();
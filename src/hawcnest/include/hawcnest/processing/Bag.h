@@ -11,6 +11,7 @@
 
 #include <hawcnest/impl/is_shared_ptr.h>
 #include <hawcnest/impl/name_of.h>
+#include <hawcnest/processing/BagKey.h>
 #include <hawcnest/PointerTypedefs.h>
 #include <hawcnest/Logging.h>
 
@@ -22,6 +23,8 @@
 #include <iostream>
 #include <string>
 #include <map>
+#include <typeinfo>
+#include <vector>
 
 /*!
  * @author John Pretz
@@ -58,18 +61,34 @@ class bag_exception : public std::exception{
  * a bag_exception is thrown.  The second form returns a const 
  * boost::shared_ptr.  In this case, no exception is thrown and the shared_ptr
  * is null if there is no such item in the bag.
+ *
+ * Objects are stored in a flat array indexed by the BagKey of their name.
+ * Every method taking a name also takes a BagKey; modules which look up the
+ * same names on every event should intern them once at configuration time
+ * and use the BagKey versions, which skip the string lookup.
  */
 class Bag {
 
   public:
 
+    Bag() : viewStale_(false) { }
+
     /*!
      * @brief Adds an item to the bag with the specified name
      * @tparam An object which inherits from Baggable
      */
     template<class T>
     void
-    Put(const std::string& name, T baggable);
+    Put(const std::string& name, T baggable)
+    { Put(BagKey(name), baggable); }
+
+    /*!
+     * @brief Adds an item to the bag with the specified key
+     * @tparam An object which inherits from Baggable
+     */
+    template<class T>
+    void
+    Put(const BagKey& key, T baggable);
   
     /*!
      * @brief Retrieves an item from the bag with the given name.  A null
@@ -84,6 +103,23 @@ class Bag {
         typename boost::enable_if<boost::is_const<typename T::value_type> >::type* = 0
 #else
         typename boost::enable_if<boost::is_const<typename T::element_type> >::type* = 0
+#endif
+        ) const
+    { return Get<T>(BagKey::Find(name)); }
+
+    /*!
+     * @brief Retrieves an item from the bag with the given key.  A null
+     *        pointer is returned if the keyed object doesn't exist
+     * @tparam A shared pointer to a const object
+     */
+    template<class T>
+    T
+    Get(const BagKey& key,
+        typename boost::enable_if<is_shared_ptr<T> >::type* = 0,
+#if BOOST_VERSION < 105300
+        typename boost::enable_if<boost::is_const<typename T::value_type> >::type* = 0
+#else
+        typename boost::enable_if<boost::is_const<typename T::element_type> >::type* = 0
 #endif
         ) const;
 
@@ -95,22 +131,35 @@ class Bag {
     template<class T>
     const T&
     Get(const std::string& name,
+        typename boost::disable_if<is_shared_ptr<T> >::type* = 0) const
+    { return GetObject<T>(BagKey::Find(name), name); }
+
+    /*!
+     * @brief Retrieves an item from the bag with the given key.  An exception
+     *        is raised if the keyed object doesn't exist
+     * @tparam A non-const Baggable type
+     */
+    template<class T>
+    const T&
+    Get(const BagKey& key,
         typename boost::disable_if<is_shared_ptr<T> >::type* = 0) const;
 
     /*!
      * @brief Delete an object in the bag using its name key
      */
     void
-    Delete(const std::string& name);
+    Delete(const std::string& name)
+    { Delete(BagKey::Find(name)); }
+
+    /// Delete an object in the bag using its interned key
+    void
+    Delete(const BagKey& key);
 
     /*!
      * @brief Clear the bag/key contents
      */
     void
-    Clear() {
-      bag_.clear();
-      bagTypes_.clear();
-    }
+    Clear();
 
     /*!
      * @brief Return 'true' if an object with the given name exists, regardless
@@ -118,7 +167,12 @@ class Bag {
      */
     bool
     Exists(const std::string& name) const
-    { return bag_.find(name) != bag_.end(); }
+    { return Exists(BagKey::Find(name)); }
+
+    /// Return 'true' if an object with the given key exists, regardless of type
+    bool
+    Exists(const BagKey& key) const
+    { return Find(key) != 0; }
 
     /*!
      * @brief Returns 'true' if an object with the given name (and type)
@@ -132,38 +186,79 @@ class Bag {
       return bool(Get<boost::shared_ptr<const T> >(name));
     }
 
+    /// Returns 'true' if an object with the given key (and type) exists
+    template <class T>
+    bool
+    Exists(const BagKey& key,
+           typename boost::disable_if<is_shared_ptr<T> >::type* = 0) const {
+      return bool(Get<boost::shared_ptr<const T> >(key));
+    }
+
     /*!
      * @brief For pretty printing
      */
     void dump(std::ostream& o) const;
 
+    // The name-sorted maps below are built from the flat storage on the
+    // first call after a change, so they are meant for printing and python
+    // access.  Put, Delete and Clear invalidate their iterators.
+
     typedef std::map<std::string, BaggableConstPtr> BagType;
     typedef BagType::const_iterator ConstBagIterator;
 
     /// Read-only iterator to the start of the Bag instance key/object container
-    ConstBagIterator BagBegin() const { return bag_.begin(); }
+    ConstBagIterator BagBegin() const { return GetView().begin(); }
 
     /// Read-only iterator to the end of the Bag instance key/object container
-    ConstBagIterator BagEnd() const { return bag_.end(); }
+    ConstBagIterator BagEnd() const { return GetView().end(); }
 
     typedef std::map<std::string, std::string> KeyType;
     typedef KeyType::const_iterator ConstTypeIterator;
 
     /// Read-only iterator to the start of the Bag instance key/type dictionary
-    ConstTypeIterator TypesBegin() const { return bagTypes_.begin(); }
+    ConstTypeIterator TypesBegin() const { return GetTypes().begin(); }
 
     /// Read-only iterator to the end of the Bag instance key/type dictionary
-    ConstTypeIterator TypesEnd() const { return bagTypes_.end(); }
+    ConstTypeIterator TypesEnd() const { return GetTypes().end(); }
 
     typedef BagType::size_type size_type;
 
     /// Output the size of the Bag
-    size_type GetSize() const { return bag_.size(); }
+    size_type GetSize() const { return keys_.size(); }
 
   private:
 
-    BagType bag_;       ///< List of key-Baggable pointer pairs (the Bag)
-    KeyType bagTypes_;  ///< Dictionary of key-Baggable type pairs
+    /// Stored object and its type, indexed by BagKey::GetId
+    struct Slot {
+      Slot() : type(0) { }
+      BaggableConstPtr object;
+      const std::type_info* type;
+    };
+
+    /// Object of type T stored with key; throws with name in the message
+    /// if there is none
+    template<class T>
+    const T&
+    GetObject(const BagKey& key, const std::string& name) const;
+
+    /// Slot of key if it holds an object, 0 otherwise
+    const Slot* Find(const BagKey& key) const {
+      const int id = key.GetId();
+      if (id < 0 || id >= int(slots_.size()) || !slots_[id].object)
+        return 0;
+      return &slots_[id];
+    }
+
+    /// Fills the name-sorted maps if the storage changed
+    const BagType& GetView() const;
+    const KeyType& GetTypes() const;
+
+    std::vector<Slot> slots_;   ///< Objects indexed by key id (the Bag)
+    std::vector<BagKey> keys_;  ///< Keys of the occupied slots
+
+    mutable BagType view_;      ///< Name-sorted copy of the Bag
+    mutable KeyType viewTypes_; ///< Dictionary of key-Baggable type pairs
+    mutable bool viewStale_;
 
 };
 
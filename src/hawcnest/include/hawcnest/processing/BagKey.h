@@ -0,0 +1,70 @@
+/*!
+ * @file BagKey.h
+ * @brief Interned names of the objects in the Bag.
+ * @author agent
+ * @date 16 Oct 2026
+ * @version $Id$
+ */
+
+#ifndef HAWCNEST_BAGKEY_H_INCLUDED
+#define HAWCNEST_BAGKEY_H_INCLUDED
+
+#include <string>
+
+/*!
+ * @class BagKey
+ * @author agent
+ * @ingroup hawcnest_api
+ * @brief Name of a Bag object, interned into a small integer.
+ *
+ * All names used in the Bag are registered once in a process-wide table.
+ * The Bag stores objects in a flat array indexed by the key id, so a Get
+ * or Put with a BagKey is a direct index instead of a string lookup.
+ * Modules should construct their keys once, e.g. in Module::Initialize:
+ *
+ * \code
+ *   hitsKey_ = BagKey("hits");                   // in Initialize
+ *   const HitList& hits = bag->Get<HitList>(hitsKey_);  // in Process
+ * \endcode
+ *
+ * Interning is thread-safe, and finding a known name only takes a shared
+ * lock.  Keys are never removed from the table, so only Bag::Put registers
+ * new names; lookups by name use Find.
+ */
+class BagKey {
+
+  public:
+
+    /// An invalid key, which is found in no Bag
+    BagKey() : id_(-1), name_(0) { }
+
+    /// Interns name, registering it if it is new
+    explicit BagKey(const std::string& name);
+
+    /// The key of name if it was ever interned, an invalid key otherwise
+    static BagKey Find(const std::string& name);
+
+    /// Number of names interned so far
+    static int GetNumberOfKeys();
+
+    bool IsValid() const { return id_ >= 0; }
+
+    /// Index of the key in the Bag storage
+    int GetId() const { return id_; }
+
+    /// Interned name; empty for an invalid key
+    const std::string& GetName() const;
+
+    bool operator==(const BagKey& k) const { return id_ == k.id_; }
+    bool operator!=(const BagKey& k) const { return id_ != k.id_; }
+
+  private:
+
+    BagKey(const int id, const std::string* name) : id_(id), name_(name) { }
+
+    int id_;
+    const std::string* name_;   ///< name in the registry (never freed)
+
+};
+
+#endif // HAWCNEST_BAGKEY_H_INCLUDED
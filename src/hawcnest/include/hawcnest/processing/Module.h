@@ -31,6 +31,11 @@ class Module {
 
     virtual Result Process(BagPtr b) = 0;
 
+    /// True if Process can be called for different Bags at the same time,
+    /// e.g. by the PipelinedMainLoop. Other modules see one Bag at a time,
+    /// in the order of the Source.
+    virtual bool IsReentrant() const { return false; }
+
 };
 
 SHARED_POINTER_TYPEDEFS(Module);
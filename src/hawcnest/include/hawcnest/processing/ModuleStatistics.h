@@ -0,0 +1,125 @@
+/*!
+ * @file ModuleStatistics.h
+ * @brief Per-module timing and counters of the main loops.
+ * @author agent
+ * @date 16 Oct 2026
+ * @version $Id$
+ */
+
+#ifndef HAWCNEST_MODULESTATISTICS_H_INCLUDED
+#define HAWCNEST_MODULESTATISTICS_H_INCLUDED
+
+#include <hawcnest/processing/Bag.h>
+#include <hawcnest/processing/Module.h>
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <time.h>
+
+/*!
+ * @class ModuleStatistics
+ * @author agent
+ * @ingroup hawcnest_api
+ * @brief Call counts, wall-time histograms and Bag sizes of the Source and
+ *        the modules run by a MainLoop.
+ *
+ * The loop adds one entry per position in its module chain, then calls
+ * Record after each call with the time at which the call started.  Record
+ * returns the current time, which can be used as the start of the next
+ * call, so each call costs one monotonic clock read and a few additions.
+ *
+ * Times are histogrammed in powers of two: bin k counts the calls which
+ * took between 2^k and 2^(k+1) ns.
+ */
+class ModuleStatistics {
+
+  public:
+
+    enum { NBins = 40 };   ///< histogram bins, up to 2^40 ns ~ 18 minutes
+
+    ModuleStatistics() : start_(0), stop_(0) { }
+
+    /// Adds an entry labeled name; returns its index
+    unsigned AddEntry(const std::string& name);
+
+    /// Resets all counters and marks the start of the loop
+    void Start();
+
+    /// Marks the end of the loop
+    void Stop() { stop_ = GetTime(); }
+
+    /// Monotonic time in ns
+    static uint64_t GetTime() {
+      timespec t;
+      clock_gettime(CLOCK_MONOTONIC, &t);
+      return uint64_t(t.tv_sec) * 1000000000ull + t.tv_nsec;
+    }
+
+    /// Records a call of entry i started at time start with the given
+    /// result; bag is the Bag after the call (null if there is none).
+    /// Returns the time at the end of the call
+    uint64_t Record(const unsigned i, const uint64_t start, const Bag* bag,
+                    const Module::Result result = Module::Continue) {
+      const uint64_t stop = GetTime();
+      Entry& e = entries_[i];
+      const uint64_t dt = stop - start;
+      ++e.calls;
+      e.totalTime += dt;
+      if (dt > e.maxTime)
+        e.maxTime = dt;
+      ++e.histogram[TimeBin(dt)];
+      if (result == Module::Filter)
+        ++e.filtered;
+      else if (result == Module::Terminate)
+        ++e.terminated;
+      if (bag) {
+        const uint64_t size = bag->GetSize();
+        e.bagSizeTotal += size;
+        if (size > e.bagSizeMax)
+          e.bagSizeMax = size;
+      }
+      return stop;
+    }
+
+    /// Prints a summary table, one line per entry
+    void Print(std::ostream& os) const;
+
+    /// Writes all counters and histograms to a JSON file
+    void Write(const std::string& filename) const;
+
+  private:
+
+    struct Entry {
+      Entry() { Clear(); }
+      void Clear();
+      std::string name;
+      uint64_t calls;
+      uint64_t filtered;
+      uint64_t terminated;
+      uint64_t totalTime;       ///< [ns]
+      uint64_t maxTime;         ///< [ns]
+      uint64_t bagSizeTotal;    ///< Bag size summed over calls
+      uint64_t bagSizeMax;
+      uint64_t histogram[NBins];
+    };
+
+    static unsigned TimeBin(uint64_t dt) {
+      unsigned bin = 0;
+      while (dt >>= 1)
+        ++bin;
+      return bin < NBins ? bin : NBins - 1;
+    }
+
+    /// Upper edge [ns] of the bin below which a fraction q of the calls lie
+    static double Quantile(const Entry& e, double q);
+
+    std::vector<Entry> entries_;
+    uint64_t start_;
+    uint64_t stop_;
+
+};
+
+#endif // HAWCNEST_MODULESTATISTICS_H_INCLUDED
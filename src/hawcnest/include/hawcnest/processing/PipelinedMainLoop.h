@@ -0,0 +1,118 @@
+/*!
+ * @file PipelinedMainLoop.h
+ * @brief A processing loop which keeps several Bags in flight on a pool of
+ *        threads.
+ * @author agent
+ * @date 16 Oct 2026
+ * @version $Id$
+ */
+
+#ifndef HAWCNEST_PIPELINEDMAINLOOP_H_INCLUDED
+#define HAWCNEST_PIPELINEDMAINLOOP_H_INCLUDED
+
+#include <hawcnest/processing/MainLoop.h>
+#include <hawcnest/processing/Source.h>
+#include <hawcnest/processing/Module.h>
+#include <hawcnest/Configuration.h>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <set>
+
+/*!
+ * @class PipelinedMainLoop
+ * @author agent
+ * @ingroup hawcnest_api
+ * @brief A MainLoop with the configuration of the SequentialMainLoop which
+ * processes several Bags at once, one per thread.
+ *
+ * Each thread takes the next Bag from the Source and carries it through the
+ * module chain. Modules which return true from Module::IsReentrant are
+ * called concurrently for different Bags. All other modules are serial:
+ * they process one Bag at a time, in the order in which the Source
+ * delivered them, so sinks write the same output as with the
+ * SequentialMainLoop. A Bag filtered before a serial module just gives up
+ * its turn there.
+ *
+ * If a module returns Module::Terminate, no further Bags are read and the
+ * Bags read after the terminating one are dropped at their next serial
+ * module. Serial modules before the terminating one may thus see up to
+ * one Bag per thread more than in the SequentialMainLoop. SIGINT stops the
+ * loop like in the SequentialMainLoop: Bags in flight are finished.
+ *
+ * Sources and modules written in python can only be run by the
+ * SequentialMainLoop.
+ */
+class PipelinedMainLoop : public MainLoop {
+
+  public:
+    typedef MainLoop Interface;
+
+    typedef std::vector<std::string> ModuleChain;
+
+    PipelinedMainLoop();
+
+    virtual void Execute(const Direction dir=FORWARD);
+
+    Configuration DefaultConfiguration();
+
+    void Initialize(const Configuration& config);
+
+  private:
+
+    /// Turns of the Bags at a serial module
+    struct SerialStage {
+      SerialStage() : next(0), aborted(false) { }
+      /// Moves next past the skipped Bags; call with the mutex locked
+      void SkipAhead();
+      boost::mutex mutex;
+      boost::condition_variable turn;
+      long next;                ///< sequence number of the next Bag
+      std::set<long> skipped;   ///< later Bags which gave up their turn
+      bool aborted;
+    };
+    typedef boost::shared_ptr<SerialStage> SerialStagePtr;
+
+    /// Thread function: processes Bags until the Source is done
+    void Work();
+
+    /// Gets the next Bag from the Source; false if the loop should stop
+    bool NextBag(BagPtr& bag, long& seq);
+
+    /// Waits for the turn of Bag seq at a serial stage; false on abort
+    bool WaitForTurn(SerialStage& stage, long seq);
+
+    /// Ends the turn of Bag seq at a serial stage
+    void EndTurn(SerialStage& stage, long seq);
+
+    /// Gives up the turn of Bag seq at a serial stage without waiting
+    void SkipTurn(SerialStage& stage, long seq);
+
+    /// True if a module terminated the loop at a Bag before seq
+    bool IsDropped(long seq);
+
+    /// Wakes up all threads waiting for their turn and stops the loop
+    void Abort(const std::string& error);
+
+    std::string sourceName_;
+    ModuleChain moduleNames_;
+    SourcePtr source_;
+    std::vector<ModulePtr> modules_;
+    std::vector<SerialStagePtr> stages_; ///< null for re-entrant modules
+
+    int updateFrequency_;
+    int nBags_;
+    int terminationLimit_;
+    int nThreads_;
+
+    boost::mutex sourceMutex_;
+    long nextSeq_;
+    bool sourceDone_;
+
+    boost::mutex stateMutex_;
+    long terminateSeq_;       ///< Bag which returned Module::Terminate
+    std::string error_;
+};
+
+#endif // HAWCNEST_PIPELINEDMAINLOOP_H_INCLUDED
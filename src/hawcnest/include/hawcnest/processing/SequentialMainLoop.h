@@ -10,6 +10,7 @@
 #define HAWCNEST_SEQUENTIALMAINLOOP_H_INCLUDED
 
 #include <hawcnest/processing/MainLoop.h>
+#include <hawcnest/processing/ModuleStatistics.h>
 #include <hawcnest/processing/Source.h>
 #include <hawcnest/processing/Module.h>
 #include <hawcnest/Configuration.h>
@@ -21,6 +22,11 @@
  * @brief A class which is the main execution loop. Retrieves a list
  * of Module services and one Source service and executes them in 
  * order.
+ *
+ * Unless moduleStatistics is set to false, the loop records the call counts,
+ * times and Bag sizes of the Source and the modules (see ModuleStatistics),
+ * logs a summary table at the end and writes all counters to statisticsFile
+ * if one is given.
  */
 class SequentialMainLoop : public MainLoop{
 
@@ -47,6 +53,10 @@ class SequentialMainLoop : public MainLoop{
     int updateFrequency_;
     int nBags_;
     int terminationLimit_;
+
+    bool collectStatistics_;
+    std::string statisticsFile_;
+    ModuleStatistics statistics_;   ///< entry 0: source, i+1: module i
 };
 
 #endif // HAWCNEST_SEQUENTIALMAINLOOP_H_INCLUDED
@@ -10,6 +10,7 @@
 #define HAWCNEST_TWOFORKMAINLOOP_H_INCLUDED
 
 #include <hawcnest/processing/MainLoop.h>
+#include <hawcnest/processing/ModuleStatistics.h>
 #include <hawcnest/processing/Source.h>
 #include <hawcnest/processing/Module.h>
 #include <hawcnest/processing/SignpostModule.h>
@@ -21,6 +22,9 @@
  * @ingroup hawcnest_api
  * @brief A MainLoop implementation in which the events traverse one of 
  * two forks, alternate reconstruction paths, for instance
+ *
+ * Module statistics are recorded and reported as in the SequentialMainLoop;
+ * the modules of the forks are labeled fork1:name and fork2:name.
  */
 class TwoForkMainLoop : public MainLoop{
 
@@ -57,6 +61,20 @@ class TwoForkMainLoop : public MainLoop{
     int updateFrequency_;
     int nBags_;
     int terminationLimit_;
+
+    /// Runs a module chain on event until a module filters it
+    void ProcessChain(const ModuleChain& names,
+                      const std::vector<ModulePtr>& modules,
+                      unsigned firstEntry, BagPtr event, uint64_t& start);
+
+    bool collectStatistics_;
+    std::string statisticsFile_;
+    ModuleStatistics statistics_;   ///< entry 0: source, then the chains
+    unsigned preforkEntry_;         ///< entry of the first pre-fork module
+    unsigned signpostEntry_;
+    unsigned fork1Entry_;
+    unsigned fork2Entry_;
+    unsigned postforkEntry_;
 };
 
 #endif // HAWCNEST_SEQUENTIALMAINLOOP_H_INCLUDED
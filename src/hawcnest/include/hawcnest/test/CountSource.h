@@ -0,0 +1,79 @@
+/*!
+ * @file CountSource.h
+ * @brief Counting source shared by the main loop unit tests.
+ * @author agent
+ * @date 16 Oct 2026
+ * @version $Id$
+ */
+
+#ifndef HAWCNEST_HAWCNEST_TEST_COUNTSOURCE_H_INCLUDED
+#define HAWCNEST_HAWCNEST_TEST_COUNTSOURCE_H_INCLUDED
+
+#include <hawcnest/PointerTypedefs.h>
+#include <hawcnest/RegisterService.h>
+#include <hawcnest/processing/Bag.h>
+#include <hawcnest/processing/Source.h>
+
+/*!
+ * @class TestCount
+ * @author agent
+ * @date 16 Oct 2026
+ * @ingroup aerie_test
+ * @brief Event number in a bag, put as "count" by TestCountSource
+ */
+class TestCount : public Baggable {
+  public:
+    int n;
+};
+
+SHARED_POINTER_TYPEDEFS(TestCount);
+
+/*!
+ * @class TestCountSource
+ * @author agent
+ * @date 16 Oct 2026
+ * @ingroup aerie_test
+ * @brief Source of bags numbered 0 to maxCount - 1
+ *
+ * The service is registered by including this header; registering it from
+ * several test files just repeats the same registry entry.
+ */
+class TestCountSource : public Source {
+
+  public:
+
+    typedef Source Interface;
+
+    TestCountSource() : count_(0), maxCount_(0) { }
+
+    Configuration DefaultConfiguration()
+    {
+      Configuration config;
+      config.Parameter<int>("maxCount");
+      return config;
+    }
+
+    void Initialize(const Configuration& config)
+    { config.GetParameter("maxCount", maxCount_); }
+
+    BagPtr Next()
+    {
+      if (count_ >= maxCount_)
+        return BagPtr();
+      TestCountPtr c = boost::make_shared<TestCount>();
+      c->n = count_++;
+      BagPtr bag = boost::make_shared<Bag>();
+      bag->Put("count", c);
+      return bag;
+    }
+
+  private:
+
+    int count_;
+    int maxCount_;
+
+};
+
+REGISTER_SERVICE(TestCountSource);
+
+#endif // HAWCNEST_HAWCNEST_TEST_COUNTSOURCE_H_INCLUDED
@@ -8,29 +8,68 @@
 
 #include <hawcnest/processing/Bag.h>
 
+#include <algorithm>
+
 using namespace std;
 
 void
-Bag::Delete(const string& name)
+Bag::Delete(const BagKey& key)
 {
-  BagType::iterator iObj = bag_.find(name);
-  if (iObj != bag_.end())
-    bag_.erase(iObj);
+  const int id = key.GetId();
+  if (id < 0 || id >= int(slots_.size()) || !slots_[id].object)
+    return;
 
-  KeyType::iterator iKey = bagTypes_.find(name);
-  if (iKey != bagTypes_.end())
-    bagTypes_.erase(iKey);
+  slots_[id] = Slot();
+  keys_.erase(find(keys_.begin(), keys_.end(), key));
+  viewStale_ = true;
+}
+
+void
+Bag::Clear()
+{
+  // reset only the occupied slots, keeping the storage for reuse
+  for (vector<BagKey>::const_iterator iK = keys_.begin(); iK != keys_.end();
+       ++iK)
+    slots_[iK->GetId()] = Slot();
+  keys_.clear();
+  viewStale_ = true;
+}
+
+const Bag::BagType&
+Bag::GetView()
+  const
+{
+  if (viewStale_) {
+    view_.clear();
+    viewTypes_.clear();
+    for (vector<BagKey>::const_iterator iK = keys_.begin(); iK != keys_.end();
+         ++iK) {
+      const Slot& slot = slots_[iK->GetId()];
+      view_[iK->GetName()] = slot.object;
+      viewTypes_[iK->GetName()] = name_of(*slot.type);
+    }
+    viewStale_ = false;
+  }
+  return view_;
+}
+
+const Bag::KeyType&
+Bag::GetTypes()
+  const
+{
+  GetView();
+  return viewTypes_;
 }
 
 void
 Bag::dump(ostream& os)
   const
 {
+  const KeyType& bagTypes = GetTypes();
   os << "bag members:\n";
-  for (ConstTypeIterator iT = bagTypes_.begin(); iT != bagTypes_.end(); ++iT) {
+  for (ConstTypeIterator iT = bagTypes.begin(); iT != bagTypes.end(); ++iT) {
     os << "  \"" << iT->first << "\" => <" << iT->second << ">";
-    if (distance(iT, bagTypes_.end()) > 1)
+    if (distance(iT, bagTypes.end()) > 1)
       os << '\n';
   }
 }
-
@@ -0,0 +1,81 @@
+/*!
+ * @file BagKey.cc
+ * @brief Implementation of the interned Bag object names.
+ * @author agent
+ * @date 16 Oct 2026
+ * @version $Id$
+ */
+
+#include <hawcnest/processing/BagKey.h>
+
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/unordered_map.hpp>
+
+using namespace std;
+
+namespace {
+
+  // Process-wide name -> id table.  Rehashing does not move the elements,
+  // so keys can point to the names stored here
+  typedef boost::unordered_map<string, int> KeyRegistry;
+
+  KeyRegistry&
+  GetRegistry()
+  {
+    static KeyRegistry registry;
+    return registry;
+  }
+
+  // Lookups of known names only take a shared lock, so threads processing
+  // events in parallel do not serialize on the registry
+  boost::shared_mutex&
+  GetRegistryMutex()
+  {
+    static boost::shared_mutex mutex;
+    return mutex;
+  }
+
+  // Force construction before main() starts any threads
+  const bool registryReady = (GetRegistry(), GetRegistryMutex(), true);
+
+}
+
+BagKey::BagKey(const string& name)
+{
+  *this = Find(name);
+  if (IsValid())
+    return;
+
+  boost::unique_lock<boost::shared_mutex> lock(GetRegistryMutex());
+  KeyRegistry& registry = GetRegistry();
+  KeyRegistry::iterator it =
+    registry.insert(make_pair(name, int(registry.size()))).first;
+  id_ = it->second;
+  name_ = &it->first;
+}
+
+BagKey
+BagKey::Find(const string& name)
+{
+  boost::shared_lock<boost::shared_mutex> lock(GetRegistryMutex());
+  KeyRegistry::const_iterator it = GetRegistry().find(name);
+  if (it == GetRegistry().end())
+    return BagKey();
+  return BagKey(it->second, &it->first);
+}
+
+int
+BagKey::GetNumberOfKeys()
+{
+  boost::shared_lock<boost::shared_mutex> lock(GetRegistryMutex());
+  return GetRegistry().size();
+}
+
+const string&
+BagKey::GetName()
+  const
+{
+  static const string invalid;
+  return name_ ? *name_ : invalid;
+}
@@ -0,0 +1,143 @@
+/*!
+ * @file ModuleStatistics.cc
+ * @brief Implementation of the per-module timing and counters.
+ * @author agent
+ * @date 16 Oct 2026
+ * @version $Id$
+ */
+
+#include <hawcnest/processing/ModuleStatistics.h>
+#include <hawcnest/Logging.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+namespace {
+
+  // Module names are plain identifiers, but escape them anyway
+  string JsonString(const string& s)
+  {
+    string out = "\"";
+    for (string::const_iterator c = s.begin(); c != s.end(); ++c) {
+      if (*c == '"' || *c == '\\')
+        out += '\\';
+      out += *c;
+    }
+    return out + '"';
+  }
+
+}
+
+void
+ModuleStatistics::Entry::Clear()
+{
+  calls = filtered = terminated = 0;
+  totalTime = maxTime = 0;
+  bagSizeTotal = bagSizeMax = 0;
+  fill(histogram, histogram + NBins, 0);
+}
+
+unsigned
+ModuleStatistics::AddEntry(const string& name)
+{
+  entries_.push_back(Entry());
+  entries_.back().name = name;
+  return entries_.size() - 1;
+}
+
+void
+ModuleStatistics::Start()
+{
+  for (vector<Entry>::iterator e = entries_.begin(); e != entries_.end(); ++e)
+    e->Clear();
+  start_ = stop_ = GetTime();
+}
+
+double
+ModuleStatistics::Quantile(const Entry& e, const double q)
+{
+  uint64_t n = 0;
+  for (unsigned k = 0; k < NBins; ++k) {
+    n += e.histogram[k];
+    if (n >= q * e.calls)
+      return double(uint64_t(2) << k);
+  }
+  return double(uint64_t(1) << NBins);
+}
+
+void
+ModuleStatistics::Print(ostream& os)
+  const
+{
+  const double wallTime = (stop_ - start_) * 1e-9;
+  uint64_t moduleTime = 0;
+  for (vector<Entry>::const_iterator e = entries_.begin();
+       e != entries_.end(); ++e)
+    moduleTime += e->totalTime;
+
+  os << "module statistics after " << fixed << setprecision(3) << wallTime
+     << " s (p50/p99: upper edges of the 2^k ns time bins)\n"
+     << "  " << left << setw(24) << "module" << right
+     << setw(11) << "calls" << setw(11) << "filtered"
+     << setw(11) << "total [s]" << setw(9) << "[%]"
+     << setw(11) << "mean [us]" << setw(11) << "p50 [us]"
+     << setw(11) << "p99 [us]" << setw(11) << "max [us]"
+     << setw(10) << "bag size";
+
+  for (vector<Entry>::const_iterator e = entries_.begin();
+       e != entries_.end(); ++e) {
+    const double total = e->totalTime * 1e-9;
+    const double n = e->calls > 0 ? double(e->calls) : 1.;
+    os << "\n  " << left << setw(24) << e->name << right
+       << setw(11) << e->calls << setw(11) << e->filtered
+       << setw(11) << setprecision(3) << total
+       << setw(9) << setprecision(1)
+       << (wallTime > 0 ? 100. * total / wallTime : 0.)
+       << setw(11) << setprecision(2) << e->totalTime * 1e-3 / n
+       << setw(11) << (e->calls ? Quantile(*e, 0.5) * 1e-3 : 0.)
+       << setw(11) << (e->calls ? Quantile(*e, 0.99) * 1e-3 : 0.)
+       << setw(11) << e->maxTime * 1e-3
+       << setw(10) << setprecision(1) << e->bagSizeTotal / n;
+  }
+
+  const double other = wallTime - moduleTime * 1e-9;
+  os << "\n  " << left << setw(24) << "(loop)" << right
+     << setw(11) << "" << setw(11) << ""
+     << setw(11) << setprecision(3) << other
+     << setw(9) << setprecision(1)
+     << (wallTime > 0 ? 100. * other / wallTime : 0.);
+}
+
+void
+ModuleStatistics::Write(const string& filename)
+  const
+{
+  ofstream out(filename.c_str());
+  if (!out)
+    log_fatal("cannot write module statistics to " << filename);
+
+  out << "{\n  \"wallTimeNs\": " << stop_ - start_ << ",\n"
+      << "  \"modules\": [";
+  for (vector<Entry>::const_iterator e = entries_.begin();
+       e != entries_.end(); ++e) {
+    out << (e == entries_.begin() ? "\n" : ",\n")
+        << "    {\"name\": " << JsonString(e->name)
+        << ", \"calls\": " << e->calls
+        << ", \"filtered\": " << e->filtered
+        << ", \"terminated\": " << e->terminated
+        << ", \"totalTimeNs\": " << e->totalTime
+        << ", \"maxTimeNs\": " << e->maxTime
+        << ", \"bagSizeTotal\": " << e->bagSizeTotal
+        << ", \"bagSizeMax\": " << e->bagSizeMax
+        << ",\n     \"histogramLog2Ns\": [";
+    for (unsigned k = 0; k < NBins; ++k)
+      out << (k ? ", " : "") << e->histogram[k];
+    out << "]}";
+  }
+  out << "\n  ]\n}\n";
+  log_info("wrote module statistics to " << filename);
+}
@@ -0,0 +1,292 @@
+/*!
+ * @file PipelinedMainLoop.cc
+ * @brief Implementation of the multi-threaded data processing loop class.
+ * @author agent
+ * @date 16 Oct 2026
+ * @version $Id$
+ */
+
+#include <hawcnest/processing/PipelinedMainLoop.h>
+#include <hawcnest/processing/PythonModule.h>
+#include <hawcnest/processing/PythonSource.h>
+#include <hawcnest/RegisterService.h>
+#include <hawcnest/Logging.h>
+#include <stdexcept>
+#include <hawcnest/Service.h>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <signal.h>
+
+using namespace std;
+
+REGISTER_SERVICE(PipelinedMainLoop);
+
+PipelinedMainLoop::PipelinedMainLoop() : updateFrequency_(10000),
+                                         nBags_(0),
+                                         terminationLimit_(-1),
+                                         nThreads_(0),
+                                         nextSeq_(0),
+                                         sourceDone_(false),
+                                         terminateSeq_(-1) {
+}
+
+Configuration PipelinedMainLoop::DefaultConfiguration(){
+  // same parameters as the SequentialMainLoop, plus the number of threads
+
+  Configuration config;
+  config.Parameter<vector<string> >("modulechain");
+  config.Parameter<string>("source");
+  config.Parameter<int>("updateFrequency",updateFrequency_);
+  config.Parameter<int>("terminationLimit",terminationLimit_);
+  config.Parameter<int>("nThreads",nThreads_);  // 0: one per core
+  return config;
+}
+
+void PipelinedMainLoop::Initialize(const Configuration& config){
+
+  config.GetParameter("source",sourceName_);
+  config.GetParameter("modulechain",moduleNames_);
+  config.GetParameter("updateFrequency",updateFrequency_);
+  config.GetParameter("terminationLimit",terminationLimit_);
+  config.GetParameter("nThreads",nThreads_);
+
+  source_ = GetService<SourcePtr>(sourceName_);
+  if (!source_)
+    log_fatal("no source specified.  aborting");
+  // python code can not be called from the worker threads
+  if (boost::dynamic_pointer_cast<PythonSource>(source_))
+    log_fatal("python source " << sourceName_ << " can not be used in the "
+              "PipelinedMainLoop, use the SequentialMainLoop");
+  for (unsigned i = 0 ; i < moduleNames_.size() ; i++) {
+    ModulePtr module = GetService<ModulePtr>(moduleNames_[i]);
+    if (!module)
+      log_fatal("couldn't find module with name " << moduleNames_[i]);
+    if (boost::dynamic_pointer_cast<PythonModule>(module))
+      log_fatal("python module " << moduleNames_[i] << " can not be used in "
+                "the PipelinedMainLoop, use the SequentialMainLoop");
+    modules_.push_back(module);
+  }
+}
+
+// global bool for flagging when a signal to terminate the loop is caught,
+// as in the SequentialMainLoop
+bool& PipelinedMainLoop_termination_flag(){
+  static bool terminate = false;
+  return terminate;
+}
+
+// the signal function. passed to the unix signal(...) to stop reading bags
+// when the user sends SIGINT (Ctl-C); the bags in flight are finished
+void PipelinedMainLoop_terminate(int signal){
+  log_info("Terminating main loop early because we received a signal " << signal);
+  PipelinedMainLoop_termination_flag() = true;
+}
+
+void
+PipelinedMainLoop::Execute(const MainLoop::Direction dir)
+{
+  // set up termination signal
+  signal(SIGINT,PipelinedMainLoop_terminate);
+  PipelinedMainLoop_termination_flag() = false;
+
+  if (!source_)
+    log_fatal("no source specified.  aborting");
+  if (modules_.size() == 0)
+    log_fatal("no modules specified.  ");
+
+  nextSeq_ = 0;
+  sourceDone_ = false;
+  terminateSeq_ = -1;
+  error_.clear();
+  stages_.assign(modules_.size(), SerialStagePtr());
+  for (unsigned i = 0 ; i < modules_.size() ; i++) {
+    if (!modules_[i]->IsReentrant())
+      stages_[i].reset(new SerialStage);
+  }
+
+  unsigned nThreads = nThreads_ > 0 ? nThreads_ :
+                                      boost::thread::hardware_concurrency();
+  if (nThreads == 0)
+    nThreads = 1;
+  log_info("processing bags with " << nThreads << " thread(s)");
+
+  // the calling thread is one of the workers
+  boost::thread_group threads;
+  for (unsigned t = 1 ; t < nThreads ; t++)
+    threads.create_thread(boost::bind(&PipelinedMainLoop::Work, this));
+  Work();
+  threads.join_all();
+
+  if (!error_.empty())
+    log_fatal("error processing bags: " << error_);
+  lastResult_ = terminateSeq_ >= 0 ? Module::Terminate : Module::Continue;
+}
+
+void
+PipelinedMainLoop::Work()
+{
+  try {
+    BagPtr bag;
+    long seq;
+    while (NextBag(bag, seq)) {
+      bool filtered = false;
+      for (unsigned i = 0 ; i < modules_.size() ; i++) {
+        SerialStage* stage = stages_[i].get();
+        if (stage) {
+          if (filtered) {
+            SkipTurn(*stage, seq);
+            continue;
+          }
+          if (!WaitForTurn(*stage, seq))
+            return;
+          if (IsDropped(seq)) {
+            log_trace("dropping bag read after the loop was terminated");
+            filtered = true;
+            EndTurn(*stage, seq);
+            continue;
+          }
+        }
+        else if (filtered)
+          continue;
+
+        log_trace("processing module named '"<<moduleNames_[i]<<"'");
+        const Module::Result result = modules_[i]->Process(bag);
+        if (stage)
+          EndTurn(*stage, seq);
+
+        if (result == Module::Continue){
+          log_trace("continuing to the next module");
+        }
+        else if (result == Module::Filter) {
+          log_trace("filtering event");
+          filtered = true;
+        }
+        else if (result == Module::Terminate) {
+          log_trace("Terminating event early");
+          boost::mutex::scoped_lock lock(stateMutex_);
+          if (terminateSeq_ < 0 || seq < terminateSeq_)
+            terminateSeq_ = seq;
+        }
+        else {
+          log_warn("problem with module return result.  filtering event");
+          filtered = true;
+        }
+      }
+      bag.reset();
+      log_trace("done processing this event");
+    }
+  } catch (const exception& e) {
+    Abort(e.what());
+  } catch (...) {
+    Abort("unknown exception");
+  }
+}
+
+bool
+PipelinedMainLoop::NextBag(BagPtr& bag, long& seq)
+{
+  boost::mutex::scoped_lock lock(sourceMutex_);
+  if (sourceDone_)
+    return false;
+
+  if(nBags_ >= terminationLimit_ && terminationLimit_ > 0){
+    log_info("terminating loop because we reached the "
+             "termination limit of "<<terminationLimit_);
+    sourceDone_ = true;
+    return false;
+  }
+
+  if(nBags_ % updateFrequency_ == 0){
+    log_info("processing bag number "<<nBags_);
+  }
+
+  if(PipelinedMainLoop_termination_flag()){
+    log_info("terminating loop early because it was interrupted by the user");
+    sourceDone_ = true;
+    return false;
+  }
+
+  {
+    boost::mutex::scoped_lock state(stateMutex_);
+    if (terminateSeq_ >= 0 || !error_.empty()) {
+      log_trace("terminating loop early as requested by a module");
+      sourceDone_ = true;
+      return false;
+    }
+  }
+
+  log_trace("getting event from source named '"<<sourceName_<<"'");
+  bag = source_->Next();
+  nBags_ = nBags_ + 1;
+  if (!bag) {
+    log_trace("Done processing events");
+    sourceDone_ = true;
+    return false;
+  }
+  seq = nextSeq_++;
+  return true;
+}
+
+void
+PipelinedMainLoop::SerialStage::SkipAhead()
+{
+  while (!skipped.empty() && *skipped.begin() == next) {
+    skipped.erase(skipped.begin());
+    ++next;
+  }
+}
+
+bool
+PipelinedMainLoop::WaitForTurn(SerialStage& stage, const long seq)
+{
+  boost::mutex::scoped_lock lock(stage.mutex);
+  while (stage.next != seq && !stage.aborted)
+    stage.turn.wait(lock);
+  return !stage.aborted;
+}
+
+void
+PipelinedMainLoop::EndTurn(SerialStage& stage, const long seq)
+{
+  boost::mutex::scoped_lock lock(stage.mutex);
+  stage.next = seq + 1;
+  stage.SkipAhead();
+  stage.turn.notify_all();
+}
+
+void
+PipelinedMainLoop::SkipTurn(SerialStage& stage, const long seq)
+{
+  boost::mutex::scoped_lock lock(stage.mutex);
+  stage.skipped.insert(seq);
+  if (stage.next == seq) {
+    stage.SkipAhead();
+    stage.turn.notify_all();
+  }
+}
+
+bool
+PipelinedMainLoop::IsDropped(const long seq)
+{
+  boost::mutex::scoped_lock lock(stateMutex_);
+  return terminateSeq_ >= 0 && seq > terminateSeq_;
+}
+
+void
+PipelinedMainLoop::Abort(const string& error)
+{
+  {
+    boost::mutex::scoped_lock lock(stateMutex_);
+    if (error_.empty())
+      error_ = error;
+  }
+  for (unsigned i = 0 ; i < stages_.size() ; i++) {
+    if (stages_[i]) {
+      boost::mutex::scoped_lock lock(stages_[i]->mutex);
+      stages_[i]->aborted = true;
+      stages_[i]->turn.notify_all();
+    }
+  }
+}
@@ -14,6 +14,7 @@
 #include <hawcnest/processing/Module.h>
 #include <hawcnest/processing/Source.h>
 #include <signal.h>
+#include <sstream>
 
 using namespace std;
 
@@ -21,7 +22,8 @@ REGISTER_SERVICE(SequentialMainLoop);
 
 SequentialMainLoop::SequentialMainLoop() : updateFrequency_(10000),
                                            nBags_(0),
-                                           terminationLimit_(-1){
+                                           terminationLimit_(-1),
+                                           collectStatistics_(true){
 }
 
 Configuration SequentialMainLoop::DefaultConfiguration(){
@@ -33,6 +35,8 @@ Configuration SequentialMainLoop::DefaultConfiguration(){
   config.Parameter<string>("source");
   config.Parameter<int>("updateFrequency",updateFrequency_);
   config.Parameter<int>("terminationLimit",terminationLimit_);
+  config.Parameter<bool>("moduleStatistics",collectStatistics_);
+  config.Parameter<string>("statisticsFile","");
   return config;
 }
 
@@ -44,15 +48,19 @@ void SequentialMainLoop::Initialize(const Configuration& config){
   config.GetParameter("modulechain",moduleNames_);
   config.GetParameter("updateFrequency",updateFrequency_);
   config.GetParameter("terminationLimit",terminationLimit_);
+  config.GetParameter("moduleStatistics",collectStatistics_);
+  config.GetParameter("statisticsFile",statisticsFile_);
 
   source_ = GetService<SourcePtr>(sourceName_);
   if (!source_)
     log_fatal("no source specified.  aborting");
+  statistics_.AddEntry(sourceName_);
   for (unsigned i = 0 ; i < moduleNames_.size() ; i++) {
     ModulePtr module = GetService<ModulePtr>(moduleNames_[i]);
     if (!module)
       log_fatal("couldn't find module with name " << moduleNames_[i]);
     modules_.push_back(module);
+    statistics_.AddEntry(moduleNames_[i]);
   }
 }
 
@@ -99,6 +107,9 @@ SequentialMainLoop::Execute(const MainLoop::Direction dir)
   if (modules_.size() == 0)
     log_fatal("no modules specified.  ");
 
+  if (collectStatistics_)
+    statistics_.Start();
+
   // Use the source to retrieve an event, then execute modules 
   // in order until the module gives 'filter' or the source
   // doesn't have any more events
@@ -130,7 +141,10 @@ SequentialMainLoop::Execute(const MainLoop::Direction dir)
     }
 
     // otherwise check for a new event
+    uint64_t start = collectStatistics_ ? ModuleStatistics::GetTime() : 0;
     BagPtr event = source_->Next();
+    if (collectStatistics_)
+      start = statistics_.Record(0, start, event.get());
     nBags_ = nBags_ + 1;
     if (!event) {
       log_trace("Done processing events");
@@ -139,6 +153,8 @@ SequentialMainLoop::Execute(const MainLoop::Direction dir)
     for (unsigned i = 0 ; i < modules_.size() ; i++) {
       log_trace("processing module named '"<<moduleNames_[i]<<"'");
       lastResult_ = modules_[i]->Process(event);
+      if (collectStatistics_)
+        start = statistics_.Record(i + 1, start, event.get(), lastResult_);
       if (lastResult_ == Module::Continue){
         log_trace("continuing to the next module");
       }
@@ -157,4 +173,13 @@ SequentialMainLoop::Execute(const MainLoop::Direction dir)
     }
     log_trace("done processing this event");
   }
+
+  if (collectStatistics_) {
+    statistics_.Stop();
+    ostringstream summary;
+    statistics_.Print(summary);
+    log_info(summary.str());
+    if (!statisticsFile_.empty())
+      statistics_.Write(statisticsFile_);
+  }
 }
@@ -14,6 +14,7 @@
 #include <hawcnest/processing/Module.h>
 #include <hawcnest/processing/Source.h>
 #include <signal.h>
+#include <sstream>
 
 using namespace std;
 
@@ -21,7 +22,13 @@ REGISTER_SERVICE(TwoForkMainLoop);
 
 TwoForkMainLoop::TwoForkMainLoop() : updateFrequency_(10000),
                                            nBags_(0),
-                                           terminationLimit_(-1){
+                                           terminationLimit_(-1),
+                                           collectStatistics_(true),
+                                           preforkEntry_(0),
+                                           signpostEntry_(0),
+                                           fork1Entry_(0),
+                                           fork2Entry_(0),
+                                           postforkEntry_(0){
 }
 
 Configuration TwoForkMainLoop::DefaultConfiguration(){
@@ -37,6 +44,8 @@ Configuration TwoForkMainLoop::DefaultConfiguration(){
   config.Parameter<string>("source");
   config.Parameter<int>("updateFrequency",updateFrequency_);
   config.Parameter<int>("terminationLimit",terminationLimit_);
+  config.Parameter<bool>("moduleStatistics",collectStatistics_);
+  config.Parameter<string>("statisticsFile","");
   return config;
 }
 
@@ -53,6 +62,8 @@ void TwoForkMainLoop::Initialize(const Configuration& config){
 
   config.GetParameter("updateFrequency",updateFrequency_);
   config.GetParameter("terminationLimit",terminationLimit_);
+  config.GetParameter("moduleStatistics",collectStatistics_);
+  config.GetParameter("statisticsFile",statisticsFile_);
 
   source_ = GetService<SourcePtr>(sourceName_);
   if (!source_)
@@ -94,6 +105,21 @@ void TwoForkMainLoop::Initialize(const Configuration& config){
     fork2Modules_.push_back(module);
   }
 
+  // Statistics entries in the order of processing
+  statistics_.AddEntry(sourceName_);
+  preforkEntry_ = 1;
+  for (unsigned i = 0 ; i < preforkModuleNames_.size() ; i++)
+    statistics_.AddEntry(preforkModuleNames_[i]);
+  signpostEntry_ = statistics_.AddEntry(signpostModuleName_);
+  fork1Entry_ = signpostEntry_ + 1;
+  for (unsigned i = 0 ; i < fork1ModuleNames_.size() ; i++)
+    statistics_.AddEntry("fork1:" + fork1ModuleNames_[i]);
+  fork2Entry_ = fork1Entry_ + fork1ModuleNames_.size();
+  for (unsigned i = 0 ; i < fork2ModuleNames_.size() ; i++)
+    statistics_.AddEntry("fork2:" + fork2ModuleNames_[i]);
+  postforkEntry_ = fork2Entry_ + fork2ModuleNames_.size();
+  for (unsigned i = 0 ; i < postforkModuleNames_.size() ; i++)
+    statistics_.AddEntry(postforkModuleNames_[i]);
 }
 
 
@@ -126,6 +152,35 @@ void TwoForkMainLoop_terminate(int signal){
    TwoForkMainLoop_termination_flag() = true;
 }
 
+void
+TwoForkMainLoop::ProcessChain(const ModuleChain& names,
+                              const vector<ModulePtr>& modules,
+                              const unsigned firstEntry, BagPtr event,
+                              uint64_t& start)
+{
+  for (unsigned i = 0 ; i < modules.size() ; i++) {
+    log_trace("processing module named '"<<names[i]<<"'");
+    Module::Result result = modules[i]->Process(event);
+    if (collectStatistics_)
+      start = statistics_.Record(firstEntry + i, start, event.get(), result);
+    if (result == Module::Continue){
+      log_trace("continuing to the next module");
+    }
+    else if (result == Module::Filter) {
+      log_trace("filtering event");
+      break;
+    }
+    else if (result == Module::Terminate) {
+        log_trace("Terminating event early");
+        TwoForkMainLoop_early_termination_flag() = true;
+    }
+    else {
+      log_warn("problem with module return result.  filtering event");
+      break;
+    }
+  }
+}
+
 void
 TwoForkMainLoop::Execute(const MainLoop::Direction dir)
 {
@@ -140,7 +195,8 @@ TwoForkMainLoop::Execute(const MainLoop::Direction dir)
   if (!source_)
     log_fatal("no source specified.  aborting");
 
-
+  if (collectStatistics_)
+    statistics_.Start();
 
   // Use the source to retrieve an event, then execute modules 
   // in order until the module gives 'filter' or the source
@@ -173,7 +229,10 @@ TwoForkMainLoop::Execute(const MainLoop::Direction dir)
     }
 
     // otherwise check for a new event
+    uint64_t start = collectStatistics_ ? ModuleStatistics::GetTime() : 0;
     BagPtr event = source_->Next();
+    if (collectStatistics_)
+      start = statistics_.Record(0, start, event.get());
     nBags_ = nBags_ + 1;
     if (!event) {
       log_trace("Done processing events");
@@ -182,38 +241,17 @@ TwoForkMainLoop::Execute(const MainLoop::Direction dir)
 
     // The pre-fork modules
     log_trace("processing pre-fork modules");
-    for (unsigned i = 0 ; i < preforkModules_.size() ; i++) {
-      log_trace("processing module named '"<<preforkModuleNames_[i]<<"'");
-      Module::Result result = preforkModules_[i]->Process(event);
-      if (result == Module::Continue){
-        log_trace("continuing to the next module");
-      }
-      else if (result == Module::Filter) {
-        log_trace("filtering event");
-        break;
-      }
-      else if (result == Module::Terminate) {
-          log_trace("Terminating event early");
-          TwoForkMainLoop_early_termination_flag() = true;
-      }
-      else {
-        log_warn("problem with module return result.  filtering event");
-        break;
-      }
-    }
+    ProcessChain(preforkModuleNames_, preforkModules_, preforkEntry_,
+                 event, start);
 
     // The decision
     int forkNum = signpostModule_->Direction(event);
-    ModuleChain* chosenForkNames = NULL;
-    vector<ModulePtr>* chosenFork = NULL;
+    if (collectStatistics_)
+      start = statistics_.Record(signpostEntry_, start, event.get());
     if(forkNum == 1){
-      chosenForkNames = &fork1ModuleNames_;
-      chosenFork = &fork1Modules_;
       log_trace("Event goes down fork 1");
     }
     else if(forkNum == 2){
-      chosenForkNames = &fork2ModuleNames_;
-      chosenFork = &fork2Modules_;
       log_trace("Event goes down fork 2");
     }
     else{
@@ -225,49 +263,25 @@ TwoForkMainLoop::Execute(const MainLoop::Direction dir)
 
     // The fork modules
     log_trace("processing fork "<<forkNum<<" modules");
-    for (unsigned i = 0 ; i < chosenFork->size() ; i++) {
-      log_trace("processing module named '"<<(*chosenForkNames)[i]<<"'");
-      Module::Result result = (*chosenFork)[i]->Process(event);
-      if (result == Module::Continue){
-        log_trace("continuing to the next module");
-      }
-      else if (result == Module::Filter) {
-        log_trace("filtering event");
-        break;
-      }
-      else if (result == Module::Terminate) {
-          log_trace("Terminating event early");
-          TwoForkMainLoop_early_termination_flag() = true;
-      }
-      else {
-        log_warn("problem with module return result.  filtering event");
-        break;
-      }
-    }
+    if (forkNum == 1)
+      ProcessChain(fork1ModuleNames_, fork1Modules_, fork1Entry_, event, start);
+    else
+      ProcessChain(fork2ModuleNames_, fork2Modules_, fork2Entry_, event, start);
 
     // The post-fork modules
     log_trace("processing post-fork modules");
-    for (unsigned i = 0 ; i < postforkModules_.size() ; i++) {
-      log_trace("processing module named '"<<postforkModuleNames_[i]<<"'");
-      Module::Result result = postforkModules_[i]->Process(event);
-      if (result == Module::Continue){
-        log_trace("continuing to the next module");
-      }
-      else if (result == Module::Filter) {
-        log_trace("filtering event");
-        break;
-      }
-      else if (result == Module::Terminate) {
-          log_trace("Terminating event early");
-          TwoForkMainLoop_early_termination_flag() = true;
-      }
-      else {
-        log_warn("problem with module return result.  filtering event");
-        break;
-      }
-    }
+    ProcessChain(postforkModuleNames_, postforkModules_, postforkEntry_,
+                 event, start);
 
     log_trace("done processing this event");
   }
 
+  if (collectStatistics_) {
+    statistics_.Stop();
+    ostringstream summary;
+    statistics_.Print(summary);
+    log_info(summary.str());
+    if (!statisticsFile_.empty())
+      statistics_.Write(statisticsFile_);
+  }
 }
@@ -83,6 +83,68 @@ BOOST_AUTO_TEST_SUITE(BagTest)
                       bag_exception);
   }
 
+  // ___________________________________________________________________________
+  // Check that names are interned once and keys access the same objects
+  BOOST_AUTO_TEST_CASE(InternedKeys)
+  {
+    BOOST_CHECK(!BagKey().IsValid());
+    BOOST_CHECK(!BagKey::Find("BagTest::neverUsed").IsValid());
+
+    BagKey key("BagTest::keyed");
+    BOOST_CHECK(key.IsValid());
+    BOOST_CHECK_EQUAL(key.GetName(), "BagTest::keyed");
+    BOOST_CHECK(BagKey("BagTest::keyed") == key);
+    BOOST_CHECK(BagKey::Find("BagTest::keyed") == key);
+    BOOST_CHECK(BagKey("BagTest::other") != key);
+
+    TestDataPtr testData = boost::make_shared<TestData>();
+    Bag b;
+    b.Put(key, testData);
+    BOOST_CHECK(&b.Get<TestData>("BagTest::keyed") == testData.get());
+    BOOST_CHECK(b.Get<TestDataConstPtr>(key) == testData);
+    BOOST_CHECK(b.Exists<TestData>(key));
+    BOOST_CHECK(!b.Exists(BagKey("BagTest::other")));
+    BOOST_CHECK_THROW(b.Get<TestData>(BagKey("BagTest::other")),
+                      bag_exception);
+    BOOST_CHECK_THROW(b.Put("BagTest::keyed", testData), bag_exception);
+    BOOST_CHECK_THROW(b.Put(BagKey(), testData), bag_exception);
+
+    // lookups of unknown names do not register them
+    const int nKeys = BagKey::GetNumberOfKeys();
+    BOOST_CHECK_THROW(b.Get<TestData>("BagTest::missing"), bag_exception);
+    BOOST_CHECK(!b.Get<TestDataConstPtr>("BagTest::missing"));
+    BOOST_CHECK(!b.Exists("BagTest::missing"));
+    BOOST_CHECK(!b.Exists<TestData>("BagTest::missing"));
+    b.Delete("BagTest::missing");
+    BOOST_CHECK_EQUAL(BagKey::GetNumberOfKeys(), nKeys);
+    BOOST_CHECK(!BagKey::Find("BagTest::missing").IsValid());
+  }
+
+  // ___________________________________________________________________________
+  // Check that deleted and cleared objects are gone and slots can be reused
+  BOOST_AUTO_TEST_CASE(DeleteAndClear)
+  {
+    Bag b;
+    TestDataPtr testData = boost::make_shared<TestData>();
+    b.Put("test_a", testData);
+    b.Put("test_b", testData);
+    BOOST_CHECK_EQUAL(b.GetSize(), 2u);
+
+    b.Delete("test_a");
+    BOOST_CHECK(!b.Exists("test_a"));
+    BOOST_CHECK(b.Exists("test_b"));
+    BOOST_CHECK_EQUAL(b.GetSize(), 1u);
+    BOOST_CHECK_EQUAL(b.BagBegin()->first, "test_b");
+
+    b.Clear();
+    BOOST_CHECK(!b.Exists("test_b"));
+    BOOST_CHECK_EQUAL(b.GetSize(), 0u);
+    BOOST_CHECK(b.BagBegin() == b.BagEnd());
+
+    BOOST_CHECK_NO_THROW(b.Put("test_b", testData));
+    BOOST_CHECK(b.Exists<TestData>("test_b"));
+  }
+
   // ___________________________________________________________________________
   // Check that contents in the Bag can be printed
   BOOST_AUTO_TEST_CASE(PrintBag)
@@ -0,0 +1,165 @@
+/*!
+ * @file ModuleStatisticsTest.cc
+ * @brief Unit test of the module statistics of the main loops.
+ * @author agent
+ * @date 16 Oct 2026
+ * @ingroup unit_test
+ * @version $Id$
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <hawcnest/HAWCNest.h>
+#include <hawcnest/RegisterService.h>
+#include <hawcnest/processing/MainLoop.h>
+#include <hawcnest/processing/Module.h>
+#include <hawcnest/processing/ModuleStatistics.h>
+#include <hawcnest/processing/SequentialMainLoop.h>
+#include <hawcnest/processing/Source.h>
+#include <hawcnest/test/CountSource.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+// Filters odd bags and puts a copy of the count into the others
+class StatsFilterModule : public Module {
+
+  public:
+
+    typedef Module Interface;
+
+    Module::Result Process(BagPtr bag)
+    {
+      const int n = bag->Get<TestCount>("count").n;
+      if (n % 2)
+        return Module::Filter;
+      bag->Put("copy", boost::make_shared<TestCount>());
+      return Module::Continue;
+    }
+
+};
+
+REGISTER_SERVICE(StatsFilterModule);
+
+// Does nothing
+class StatsSinkModule : public Module {
+
+  public:
+
+    typedef Module Interface;
+
+    Module::Result Process(BagPtr bag)
+    { return Module::Continue; }
+
+};
+
+REGISTER_SERVICE(StatsSinkModule);
+
+namespace {
+
+  // Value of "key": in the first line containing name
+  string JsonValue(const string& json, const string& name, const string& key)
+  {
+    istringstream in(json);
+    string line;
+    while (getline(in, line)) {
+      if (line.find("\"" + name + "\"") == string::npos)
+        continue;
+      const string tag = "\"" + key + "\": ";
+      const size_t pos = line.find(tag);
+      if (pos == string::npos)
+        return "";
+      const size_t start = pos + tag.size();
+      return line.substr(start, line.find_first_of(",}", start) - start);
+    }
+    return "";
+  }
+
+}
+
+BOOST_AUTO_TEST_SUITE(ModuleStatisticsTest)
+
+  // ___________________________________________________________________________
+  // Calls, results and bag sizes are counted per entry
+  BOOST_AUTO_TEST_CASE(Record)
+  {
+    ModuleStatistics stats;
+    BOOST_CHECK_EQUAL(stats.AddEntry("source"), 0u);
+    BOOST_CHECK_EQUAL(stats.AddEntry("module"), 1u);
+    stats.Start();
+
+    Bag bag;
+    bag.Put("count", boost::make_shared<TestCount>());
+    uint64_t t = ModuleStatistics::GetTime();
+    t = stats.Record(0, t, &bag);
+    t = stats.Record(1, t, &bag, Module::Filter);
+    const uint64_t t2 = stats.Record(1, t, 0, Module::Terminate);
+    BOOST_CHECK(t2 >= t);
+    stats.Stop();
+
+    const string file = (boost::filesystem::temp_directory_path() /
+                         boost::filesystem::unique_path()).string();
+    stats.Write(file);
+    ifstream in(file.c_str());
+    const string json((istreambuf_iterator<char>(in)),
+                      istreambuf_iterator<char>());
+    remove(file.c_str());
+
+    BOOST_CHECK_EQUAL(JsonValue(json, "source", "calls"), "1");
+    BOOST_CHECK_EQUAL(JsonValue(json, "source", "bagSizeTotal"), "1");
+    BOOST_CHECK_EQUAL(JsonValue(json, "module", "calls"), "2");
+    BOOST_CHECK_EQUAL(JsonValue(json, "module", "filtered"), "1");
+    BOOST_CHECK_EQUAL(JsonValue(json, "module", "terminated"), "1");
+    BOOST_CHECK_EQUAL(JsonValue(json, "module", "bagSizeMax"), "1");
+
+    ostringstream table;
+    stats.Print(table);
+    BOOST_CHECK(table.str().find("module") != string::npos);
+  }
+
+  // ___________________________________________________________________________
+  // The SequentialMainLoop counts the calls of the source and the modules
+  BOOST_AUTO_TEST_CASE(SequentialMainLoopStatistics)
+  {
+    const string file = (boost::filesystem::temp_directory_path() /
+                         boost::filesystem::unique_path()).string();
+    {
+      HAWCNest nest;
+      nest.Service<TestCountSource>("statsSource")
+        ("maxCount", 100);
+      nest.Service<StatsFilterModule>("statsFilter");
+      nest.Service<StatsSinkModule>("statsSink");
+
+      vector<string> chain;
+      chain.push_back("statsFilter");
+      chain.push_back("statsSink");
+      nest.Service<SequentialMainLoop>("mainloop")
+        ("source", "statsSource")
+        ("modulechain", chain)
+        ("statisticsFile", file);
+      nest.Configure();
+      GetService<MainLoop>("mainloop").Execute();
+      nest.Finish();
+    }
+
+    ifstream in(file.c_str());
+    const string json((istreambuf_iterator<char>(in)),
+                      istreambuf_iterator<char>());
+    remove(file.c_str());
+
+    // the last call of the source returns no bag
+    BOOST_CHECK_EQUAL(JsonValue(json, "statsSource", "calls"), "101");
+    BOOST_CHECK_EQUAL(JsonValue(json, "statsFilter", "calls"), "100");
+    BOOST_CHECK_EQUAL(JsonValue(json, "statsFilter", "filtered"), "50");
+    BOOST_CHECK_EQUAL(JsonValue(json, "statsFilter", "bagSizeTotal"), "150");
+    BOOST_CHECK_EQUAL(JsonValue(json, "statsSink", "calls"), "50");
+    BOOST_CHECK_EQUAL(JsonValue(json, "statsSink", "bagSizeMax"), "2");
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,163 @@
+/*!
+ * @file PipelinedMainLoopTest.cc
+ * @brief Unit test of the PipelinedMainLoop class.
+ * @author agent
+ * @date 16 Oct 2026
+ * @ingroup unit_test
+ * @version $Id$
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <hawcnest/HAWCNest.h>
+#include <hawcnest/RegisterService.h>
+#include <hawcnest/processing/MainLoop.h>
+#include <hawcnest/processing/Module.h>
+#include <hawcnest/processing/PipelinedMainLoop.h>
+#include <hawcnest/processing/Source.h>
+#include <hawcnest/test/CountSource.h>
+
+#include <stdexcept>
+
+using namespace std;
+
+// Re-entrant module filtering multiples of "filter", terminating at
+// "terminate" and throwing at "fail" (-1: never)
+class TestReentrantModule : public Module {
+
+  public:
+
+    typedef Module Interface;
+
+    Configuration DefaultConfiguration()
+    {
+      Configuration config;
+      config.Parameter<int>("filter", -1);
+      config.Parameter<int>("terminate", -1);
+      config.Parameter<int>("fail", -1);
+      return config;
+    }
+
+    void Initialize(const Configuration& config)
+    {
+      config.GetParameter("filter", filter_);
+      config.GetParameter("terminate", terminate_);
+      config.GetParameter("fail", fail_);
+    }
+
+    bool IsReentrant() const { return true; }
+
+    Module::Result Process(BagPtr bag)
+    {
+      const int n = bag->Get<TestCount>("count").n;
+      if (n == fail_)
+        throw runtime_error("test failure");
+      if (n == terminate_)
+        return Module::Terminate;
+      if (filter_ > 0 && n % filter_ == 0)
+        return Module::Filter;
+      return Module::Continue;
+    }
+
+  private:
+
+    int filter_;
+    int terminate_;
+    int fail_;
+
+};
+
+REGISTER_SERVICE(TestReentrantModule);
+
+// Serial module recording the bags it sees
+class TestSinkModule : public Module {
+
+  public:
+
+    typedef Module Interface;
+
+    Module::Result Process(BagPtr bag)
+    {
+      seen_.push_back(bag->Get<TestCount>("count").n);
+      return Module::Continue;
+    }
+
+    const vector<int>& GetSeen() const { return seen_; }
+
+  private:
+
+    vector<int> seen_;
+
+};
+
+REGISTER_SERVICE(TestSinkModule);
+
+namespace {
+
+  // Runs count source -> reentrant -> sink with nThreads and returns the
+  // bags seen by the sink
+  vector<int> RunChain(const int nThreads, const int maxCount,
+                       const int filter, const int terminate, const int fail)
+  {
+    HAWCNest nest;
+    nest.Service<TestCountSource>("source")
+      ("maxCount", maxCount);
+    nest.Service<TestReentrantModule>("reentrant")
+      ("filter", filter)
+      ("terminate", terminate)
+      ("fail", fail);
+    nest.Service<TestSinkModule>("sink");
+
+    vector<string> chain;
+    chain.push_back("reentrant");
+    chain.push_back("sink");
+    nest.Service<PipelinedMainLoop>("mainloop")
+      ("source", "source")
+      ("modulechain", chain)
+      ("nThreads", nThreads);
+    nest.Configure();
+
+    GetService<MainLoop>("mainloop").Execute();
+    vector<int> seen = boost::dynamic_pointer_cast<TestSinkModule>(
+      GetService<ModulePtr>("sink"))->GetSeen();
+    nest.Finish();
+    return seen;
+  }
+
+}
+
+BOOST_AUTO_TEST_SUITE(PipelinedMainLoopTest)
+
+  // ___________________________________________________________________________
+  // The serial sink sees all unfiltered bags in the order of the source
+  BOOST_AUTO_TEST_CASE(OrderAndFilter)
+  {
+    for (int nThreads = 1; nThreads <= 8; nThreads *= 2) {
+      const vector<int> seen = RunChain(nThreads, 1000, 3, -1, -1);
+      BOOST_REQUIRE_EQUAL(seen.size(), 666u);
+      for (unsigned i = 0; i < seen.size(); ++i)
+        BOOST_CHECK_EQUAL(seen[i], int(3*(i/2) + 1 + i%2));
+    }
+  }
+
+  // ___________________________________________________________________________
+  // No bag after the terminating one reaches the sink
+  BOOST_AUTO_TEST_CASE(Terminate)
+  {
+    for (int nThreads = 1; nThreads <= 8; nThreads *= 2) {
+      const vector<int> seen = RunChain(nThreads, 1000, -1, 500, -1);
+      BOOST_REQUIRE_EQUAL(seen.size(), 501u);
+      for (unsigned i = 0; i < seen.size(); ++i)
+        BOOST_CHECK_EQUAL(seen[i], int(i));
+    }
+  }
+
+  // ___________________________________________________________________________
+  // Exceptions in the worker threads are passed on by Execute
+  BOOST_AUTO_TEST_CASE(Exception)
+  {
+    BOOST_CHECK_THROW(RunChain(4, 1000, -1, -1, 100), runtime_error);
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,52 @@
+/*!
+ * @file ConvertMapTree.cc
+ * @author agent
+ * @date 16 Oct 2026
+ * @brief Convert between MapTree ROOT files and map column files.
+ * @version $Id$
+ */
+
+#include <liff/BinList.h>
+#include <liff/SkyMapCollection.h>
+#include <liff/skymaps/MapColumnFile.h>
+
+#include <hawcnest/CommandLineConfigurator.h>
+#include <hawcnest/Logging.h>
+
+using namespace std;
+
+int main(int argc, char **argv) {
+  CommandLineConfigurator cl(
+      "Converts a MapTree file (nHitXX/data, nHitXX/bkg and BinInfo trees) "
+      "into a map column file for fast partial-sky loading, or a map column "
+      "file back into a MapTree file. The direction is chosen from the "
+      "input file.");
+  cl.AddOption<string>("input,i", "", "Input MapTree or map column file");
+  cl.AddOption<string>("output,o", "", "Output file name");
+  cl.AddFlag("float", "Store map values as 32-bit floats (map column output)");
+  AddBinOptions(cl);
+
+  if (!cl.ParseCommandLine(argc, argv))
+    return 1;
+
+  const string input = cl.GetArgument<string>("input");
+  const string output = cl.GetArgument<string>("output");
+  if (input.empty() || output.empty()) {
+    log_fatal("Please provide --input and --output file names.");
+  }
+
+  const BinListConstPtr binList = ParseBinOptions(cl, input);
+
+  // Default sky region of SkyMapCollection is the full sky
+  SkyMapCollection maps;
+  maps.LoadMaps(input, *binList);
+
+  if (MapColumnFile::IsMapColumnFile(input)) {
+    maps.WriteMapTree(output);
+  }
+  else {
+    maps.WriteMapColumns(output, cl.HasFlag("float"));
+  }
+
+  return 0;
+}
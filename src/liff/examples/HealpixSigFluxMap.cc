@@ -390,44 +390,45 @@ int main(int argc, char **argv) {
 
 
   //Likelihood:
+  LikeHAWC *likeHAWC = 0;
   if (!useMPS and !useExtended) {
     log_info("Using TF1PointSource version");
-    gLikeHAWC = new LikeHAWC(&data, detectorResponseFileName, pointSource, sourceRA, sourceDec, roiRadius,
-                             true, *binList);
+    likeHAWC = new LikeHAWC(&data, detectorResponseFileName, pointSource, sourceRA, sourceDec, roiRadius,
+                            true, *binList);
     //turn CommonNorm fit on/off:
-    gLikeHAWC->ClearFreeParameterList();
+    likeHAWC->ClearFreeParameterList();
     if (cl.HasFlag("indexfree")) {
-      gLikeHAWC->AddFreeParameter(sourceSpectrum, 1); //The index will be free
+      likeHAWC->AddFreeParameter(sourceSpectrum, 1); //The index will be free
       log_info(" - Index is free.");
     }
-    gLikeHAWC->SetCommonNormFree(true);
+    likeHAWC->SetCommonNormFree(true);
   } else if (useMPS) {
     log_info("Using MultiSource version");
-    gLikeHAWC = new LikeHAWC(&data, detectorResponseFileName, usedMultiSource, sourceRA, sourceDec,
-                             roiRadius, true, *binList);
-    //gLikeHAWC->ResetSources(usedMultiPointSource);
+    likeHAWC = new LikeHAWC(&data, detectorResponseFileName, usedMultiSource, sourceRA, sourceDec,
+                            roiRadius, true, *binList);
+    //likeHAWC->ResetSources(usedMultiPointSource);
     //turn CommonNorm fit on/off:
-    gLikeHAWC->ClearFreeParameterList();
-    gLikeHAWC->SetCommonNormFree(false);
+    likeHAWC->ClearFreeParameterList();
+    likeHAWC->SetCommonNormFree(false);
     log_info("Source 0:");
-    gLikeHAWC->AddFreeParameter(spectr, 0); //The norm will be free
+    likeHAWC->AddFreeParameter(spectr, 0); //The norm will be free
     log_info(" - Normalization is free.");
     if (cl.HasFlag("indexfree")) {
-      gLikeHAWC->AddFreeParameter(spectr, 1); //The index will be free
+      likeHAWC->AddFreeParameter(spectr, 1); //The index will be free
       log_info(" - Index is free.");
     }
   } else if (useExtended) {
     log_info("Using TF1ExtendedSource version");
-    gLikeHAWC = new LikeHAWC(&data, detectorResponseFileName, extendedSource,
-                             sourceRA, sourceDec, roiRadius, true,
-                             *binList);
+    likeHAWC = new LikeHAWC(&data, detectorResponseFileName, extendedSource,
+                            sourceRA, sourceDec, roiRadius, true,
+                            *binList);
     log_info("LikeHAWC is set.");
-    gLikeHAWC->SetROI(gLikeHAWC->MatchROI(padding));
+    likeHAWC->SetROI(likeHAWC->MatchROI(padding));
     log_info("ROI is set.");
-    gLikeHAWC->ClearFreeParameterList();
-    gLikeHAWC->SetCommonNormFree(true);
+    likeHAWC->ClearFreeParameterList();
+    likeHAWC->SetCommonNormFree(true);
     if (cl.HasFlag("indexfree")) {
-      gLikeHAWC->AddFreeParameter(sourceSpectrum, 1); //The index will be free
+      likeHAWC->AddFreeParameter(sourceSpectrum, 1); //The index will be free
       log_info(" - Index is free.");
     }
   } else {
@@ -439,12 +440,12 @@ int main(int argc, char **argv) {
   //Here we create a reference to CommonNorm in theLikeHAWC, so that it always
   //reflects the current value used in the likelihood and that changes to
   //CommonNorm are propagated to the likelihood:
-  double &refCommonNorm = gLikeHAWC->CommonNorm();
-  double &refCommonNormError = gLikeHAWC->CommonNormError();
+  double &refCommonNorm = likeHAWC->CommonNorm();
+  double &refCommonNormError = likeHAWC->CommonNormError();
 
   //turn BackgroundNorm fit on/off:
   if (cl.HasFlag("backgroundNormFit")) {
-    gLikeHAWC->SetBackgroundNormFree(true);
+    likeHAWC->SetBackgroundNormFree(true);
     cout << "Fitting background norm in all bins." << endl;
   }
 
@@ -502,8 +503,8 @@ int main(int argc, char **argv) {
 
     //change test source position:
     if (!useMPS && !useExtended) {
-      gLikeHAWC->GetPointSourceDetectorResponse(0)->SetSkyPos(position);
-      gLikeHAWC->SetROI(gLikeHAWC->MatchROI(max(roiRadius, ceil(maxSourceRadius))));
+      likeHAWC->GetPointSourceDetectorResponse(0)->SetSkyPos(position);
+      likeHAWC->SetROI(likeHAWC->MatchROI(max(roiRadius, ceil(maxSourceRadius))));
     } else if (useMPS) {
       switch(multiSource.getTotalSourceType(0)) {
         case MultiSource::POINT: {
@@ -534,11 +535,11 @@ int main(int argc, char **argv) {
 
       switch(multiSource.getTotalSourceType(0)) {
         case MultiSource::POINT: {
-          gLikeHAWC->UpdateSources();
+          likeHAWC->UpdateSources();
           break;
         }
         case MultiSource::EXTENDED: {
-          gLikeHAWC->ResetSources(extendedSource, padding);
+          likeHAWC->ResetSources(extendedSource, padding);
           break;
         }
         default: {
@@ -547,7 +548,7 @@ int main(int argc, char **argv) {
       }
       log_info("Setting fixed ROI with RA " << position.RA()
                    << " Dec " << position.Dec() << " r " << roiRadius);
-      gLikeHAWC->SetROI(position.RA(), position.Dec(), roiRadius, true);
+      likeHAWC->SetROI(position.RA(), position.Dec(), roiRadius, true);
     } else if (useExtended) { // Extended, but no multi sources!
 
       extendedSource.setSourcePosition(position.RA(), position.Dec());
@@ -555,13 +556,13 @@ int main(int argc, char **argv) {
       //extendedSource = TF1ExtendedSourcePtr(
       //new TF1ExtendedSource("TestSource", position.RA(), position.Dec(), sourceSpectrum, extendedRadius));
 
-      ////gLikeHAWC->UpdateSources(); //// Colas, 2016-06-16: This used to work, but not anymore for an unknown reason. So calling the slow alternative...
-      gLikeHAWC->ResetSources(extendedSource, padding);
+      ////likeHAWC->UpdateSources(); //// Colas, 2016-06-16: This used to work, but not anymore for an unknown reason. So calling the slow alternative...
+      likeHAWC->ResetSources(extendedSource, padding);
 
       log_info("Setting fixed ROI with RA " << position.RA()
                    << " Dec " << position.Dec() << " r " << roiRadius);
-      gLikeHAWC->SetROI(position.RA(), position.Dec(), roiRadius, true);
-      //gLikeHAWC->SetupCalcBins(analysisBinStart, analysisBinStop);
+      likeHAWC->SetROI(position.RA(), position.Dec(), roiRadius, true);
+      //likeHAWC->SetupCalcBins(analysisBinStart, analysisBinStop);
     } else {
       log_fatal("Logic error, I should never get here. Fix me.")
     }
@@ -575,10 +576,10 @@ int main(int argc, char **argv) {
 
         //Find Initial Guesses (using a gaussian approx.)
         if (doTopHat) {
-          gLikeHAWC->EstimateTopHatNormAndSigma(refCommonNorm, sigma, position, apertures);
+          likeHAWC->EstimateTopHatNormAndSigma(refCommonNorm, sigma, position, apertures);
         }
         else {
-          gLikeHAWC->EstimateNormAndSigma(refCommonNorm, sigma);
+          likeHAWC->EstimateNormAndSigma(refCommonNorm, sigma);
         }
         //minimizer tends to be unstable for negative initial common norm
         if (refCommonNorm < 0) refCommonNorm = 0;
@@ -611,19 +612,19 @@ int main(int argc, char **argv) {
 
     double testStatistics = 0;
     if (doTopHat) {
-      testStatistics = gLikeHAWC->CalcTopHatTestStatistic(position, apertures);
+      testStatistics = likeHAWC->CalcTopHatTestStatistic(position, apertures);
     }
     else {
       // Regular test statistics
-      testStatistics = gLikeHAWC->CalcTestStatistic();
+      testStatistics = likeHAWC->CalcTestStatistic();
       if (useMPS && cl.GetArgument<string>("model") != "") {
         // I want the fixed sources in the null hypothesis, don't optimize
         // The optimization already happened in the call of
-        // gLikeHAWC->CalcTestStatistic() above
-        double llhSignalHypothesis = gLikeHAWC->CalcLogLikelihoodUpdateSources(false);
+        // likeHAWC->CalcTestStatistic() above
+        double llhSignalHypothesis = likeHAWC->CalcLogLikelihoodUpdateSources(false);
         double savedAmplitude = spectr->GetParameter(0);
         spectr->SetParameter(0, 0.); // Turn off the test source
-        double llhNullHypothesis = gLikeHAWC->CalcLogLikelihoodUpdateSources(false);
+        double llhNullHypothesis = likeHAWC->CalcLogLikelihoodUpdateSources(false);
         testStatistics = 2 * (llhSignalHypothesis - llhNullHypothesis);
         log_debug(testStatistics << " " << llhSignalHypothesis << " " << llhNullHypothesis);
         // Put back the correct amplitude
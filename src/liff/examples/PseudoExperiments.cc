@@ -0,0 +1,115 @@
+/*!
+ * @file PseudoExperiments.cc
+ * @author agent
+ * @date 16 Oct 2026
+ * @brief TS distribution of a point source from Poisson pseudo-experiments.
+ * @version $Id$
+ */
+
+#include <liff/BinList.h>
+#include <liff/LikeHAWC.h>
+#include <liff/PseudoExperiments.h>
+#include <liff/SkyMapCollection.h>
+#include <liff/TF1PointSource.h>
+#include <liff/Util.h>
+
+#include <hawcnest/CommandLineConfigurator.h>
+#include <hawcnest/HAWCUnits.h>
+#include <hawcnest/Logging.h>
+
+#include <limits>
+
+using namespace std;
+using namespace threeML;
+using namespace HAWCUnits;
+
+int main(int argc, char **argv) {
+  CommandLineConfigurator cl(
+      "Calibrates the TS distribution of a point source fit: the event maps "
+      "are replaced by Poisson realizations of the background (plus the "
+      "source with --inject) and refitted in memory. Realizations only "
+      "depend on --seed and their trial number, so runs with different "
+      "--first can be merged.");
+  cl.AddOption<string>("mapfile,m", "", "Map Tree file name");
+  cl.AddOption<string>("detfile,e", "", "Detector response file name");
+  cl.AddOption<double>("ntransits,n", -1, "Number of transits (optional, "
+                       "leave at -1 to load duration from maptree)");
+  cl.AddOption<double>("RA,r", 83.63, "Right Ascension in degree");
+  cl.AddOption<double>("Dec,d", 22.01, "Declination in degree");
+  cl.AddOption<double>("roiRadius", 3., "ROI radius in degree");
+  cl.AddOption<string>("spectrum,s", "SimplePowerLaw,3.5e-11,2.63",
+                       "Source spectral type and input spectrum - norm index "
+                       "[cutoff], e.g. 'SimplePowerLaw,3.5e-11,2.63'");
+  cl.AddOption<double>("pivot", 1., "Pivot energy [TeV]");
+  cl.AddFlag("inject", "Draw the realizations from background + source "
+             "instead of background only");
+  cl.AddFlag("backgroundNormFit,b", "Fit background norm");
+  cl.AddOption<unsigned>("trials,t", 1000, "Number of pseudo-experiments");
+  cl.AddOption<unsigned>("first", 0, "Number of the first pseudo-experiment");
+  cl.AddOption<unsigned>("seed", 1, "Seed of the pseudo-experiments");
+  cl.AddOption<unsigned>("threads", 1, "Number of threads for the "
+                         "likelihood and the map generation, 0 = all cores");
+  cl.AddOption<string>("output,o", "", "Output text file with trial and TS");
+  AddBinOptions(cl);
+
+  if (!cl.ParseCommandLine(argc, argv))
+    return 1;
+
+  const string mapFileName = cl.GetArgument<string>("mapfile");
+  const string detectorResponseFileName = cl.GetArgument<string>("detfile");
+  const string output = cl.GetArgument<string>("output");
+  if (mapFileName.empty() || detectorResponseFileName.empty() ||
+      output.empty()) {
+    log_fatal("Please provide --mapfile, --detfile and --output.");
+  }
+
+  const BinListConstPtr binList = ParseBinOptions(cl, mapFileName);
+
+  const double sourceRA = cl.GetArgument<double>("RA");
+  const double sourceDec = cl.GetArgument<double>("Dec");
+  const double roiRadius = cl.GetArgument<double>("roiRadius");
+
+  SkyMapCollection data;
+  data.SetDisc(SkyPos(sourceRA, sourceDec), (roiRadius + 1.) * degree);
+  data.LoadMaps(mapFileName, *binList);
+  const double nTransits = cl.GetArgument<double>("ntransits");
+  if (nTransits >= 0) {
+    data.SetTransits(nTransits);
+  }
+
+  Func1Ptr sourceSpectrum =
+      MakeSpectrum("sourceSpectrum", cl.GetArgument<string>("spectrum"),
+                   numeric_limits<double>::quiet_NaN(),
+                   numeric_limits<double>::quiet_NaN(),
+                   cl.GetArgument<double>("pivot"));
+  TF1PointSource pointSource("TestSource", sourceRA, sourceDec,
+                             sourceSpectrum);
+
+  LikeHAWC likeHAWC(&data, detectorResponseFileName, pointSource,
+                    sourceRA, sourceDec, roiRadius, true, *binList);
+  likeHAWC.ClearFreeParameterList();
+  likeHAWC.SetCommonNormFree(true);
+  if (cl.HasFlag("backgroundNormFit")) {
+    likeHAWC.SetBackgroundNormFree(true);
+  }
+  const unsigned nThreads = cl.GetArgument<unsigned>("threads");
+  likeHAWC.SetNumberOfThreads(nThreads);
+
+  PseudoExperiments experiments(likeHAWC, cl.GetArgument<unsigned>("seed"),
+                                nThreads);
+  if (cl.HasFlag("inject")) {
+    experiments.SetExpectation(true);
+  }
+
+  const unsigned first = cl.GetArgument<unsigned>("first");
+  const unsigned trials = cl.GetArgument<unsigned>("trials");
+  log_info("Running " << trials << " pseudo-experiments starting at trial "
+           << first);
+  const vector<double> ts =
+      experiments.CalcTestStatistics(first, trials);
+  PseudoExperiments::WriteTestStatistics(output, first, ts);
+  log_info("Wrote TS of " << ts.size() << " pseudo-experiments to "
+           << output);
+
+  return 0;
+}
@@ -0,0 +1,154 @@
+/*!
+ * @file TSMapScan.cc
+ * @author agent
+ * @date 16 Oct 2026
+ * @brief Multi-threaded point source significance map in HEALPix.
+ * @version $Id$
+ */
+
+#include <liff/BinList.h>
+#include <liff/TSMapScan.h>
+#include <liff/Util.h>
+
+#include <hawcnest/CommandLineConfigurator.h>
+#include <hawcnest/HAWCUnits.h>
+#include <hawcnest/Logging.h>
+
+#include <healpix_map_fitsio.h>
+
+using namespace std;
+using namespace HAWCUnits;
+
+int main(int argc, char **argv) {
+  CommandLineConfigurator cl(
+      "Point source significance, flux and index maps as made by "
+      "HealpixSigFluxMap, with the maps loaded once and the pixels fitted "
+      "by several threads. With --checkpoint, results are appended to a "
+      "text file while scanning, and a rerun skips the pixels found there.");
+  cl.AddOption<string>("maptype,a", "box",
+                       "Pixels to scan: 'allsky' (dec -30 to +70), "
+                       "'InnerGalaxy', 'box' (see --RA, --Dec, --edgeRA, "
+                       "--edgeDec) or a fits file with a mask map (non-zero "
+                       "pixels of the first column)");
+  cl.AddOption<double>("RA,r", 83.63, "Right Ascension of the box center in "
+                       "degree");
+  cl.AddOption<double>("Dec,d", 22.01, "Declination of the box center in "
+                       "degree");
+  cl.AddOption<double>("edgeRA,g", 2., "Length of side in RA of the box");
+  cl.AddOption<double>("edgeDec,l", 2., "Length of side in Dec of the box");
+  cl.AddOption<int>("nside,p", 512, "nside of Healpix map");
+  cl.AddOption<string>("mapfile,m", "", "Map Tree file name");
+  cl.AddOption<double>("ntransits,n", -1, "Number of transits (optional, "
+                       "leave at -1 to load duration from maptree)");
+  cl.AddOption<string>("detfile,e", "", "Detector response file name");
+  cl.AddOption<double>("roiRadius", 3., "ROI radius in degree");
+  cl.AddOption<string>("spectrum,s", "SimplePowerLaw,3.5e-11,2.63",
+                       "Source spectral type and input spectrum - norm index "
+                       "[cutoff], e.g. 'SimplePowerLaw,3.5e-11,2.63'");
+  cl.AddOption<double>("pivot", 1., "Pivot energy [TeV]");
+  cl.AddFlag("indexfree", "Set index free in the fit.");
+  cl.AddFlag("backgroundNormFit,b", "Fit background norm");
+  cl.AddOption<unsigned>("threads", 0, "Number of threads, 0 = all cores");
+  cl.AddOption<string>("checkpoint", "", "Text file for intermediate "
+                       "results (optional)");
+  cl.AddOption<unsigned>("block", 1024, "Pixels between checkpoints");
+  cl.AddOption<string>("output,o", "", "Output fits file name");
+  AddBinOptions(cl);
+
+  if (!cl.ParseCommandLine(argc, argv))
+    return 1;
+
+  const string mapFileName = cl.GetArgument<string>("mapfile");
+  const string detectorResponseFileName = cl.GetArgument<string>("detfile");
+  const string output = cl.GetArgument<string>("output");
+  if (mapFileName.empty() || detectorResponseFileName.empty() ||
+      output.empty()) {
+    log_fatal("Please provide --mapfile, --detfile and --output.");
+  }
+
+  const BinListConstPtr binList = ParseBinOptions(cl, mapFileName);
+
+  //****Define the pixels we want to look at
+  const int nside = cl.GetArgument<int>("nside");
+  Healpix_Map<double> hMap(nside, RING, SET_NSIDE);
+  rangeset<int> pixset;
+  const string mapType = cl.GetArgument<string>("maptype");
+  if (mapType == "allsky") {
+    hMap.query_strip(20 * degree, 120 * degree, false, pixset);
+  }
+  else if (mapType == "InnerGalaxy" || mapType == "box") {
+    vector<pointing> polygon;
+    if (mapType == "InnerGalaxy") {
+      polygon.push_back(SkyPos(270, -15).GetPointing());
+      polygon.push_back(SkyPos(270, -25).GetPointing());
+      polygon.push_back(SkyPos(276, -25).GetPointing());
+      polygon.push_back(SkyPos(294, 11).GetPointing());
+      polygon.push_back(SkyPos(294, 21).GetPointing());
+      polygon.push_back(SkyPos(288, 21).GetPointing());
+    }
+    else {
+      const double ra = cl.GetArgument<double>("RA");
+      const double dec = cl.GetArgument<double>("Dec");
+      const double edgeRA = cl.GetArgument<double>("edgeRA");
+      const double edgeDec = cl.GetArgument<double>("edgeDec");
+      polygon.push_back(SkyPos(ra - edgeRA / 2., dec - edgeDec / 2.).GetPointing());
+      polygon.push_back(SkyPos(ra - edgeRA / 2., dec + edgeDec / 2.).GetPointing());
+      polygon.push_back(SkyPos(ra + edgeRA / 2., dec + edgeDec / 2.).GetPointing());
+      polygon.push_back(SkyPos(ra + edgeRA / 2., dec - edgeDec / 2.).GetPointing());
+    }
+    hMap.query_polygon(polygon, pixset);
+  }
+  else {
+    Healpix_Map<double> maskImport;
+    read_Healpix_map_from_fits(mapType, maskImport);
+    Healpix_Map<double> mask = hMap;
+    mask.Import(maskImport); //Adjust NSIDE and SCHEME is neccesary
+    for (int i = 0; i < mask.Npix(); i++) {
+      if (mask[i] != 0) {
+        pixset.add(i);
+      }
+    }
+  }
+  vector<int> pixels;
+  pixset.toVector(pixels);
+  if (pixels.empty()) {
+    log_fatal("No pixels to scan for --maptype " << mapType);
+  }
+
+  //****Scan
+  TSMapScan scan(mapFileName, cl.GetArgument<double>("ntransits"),
+                 detectorResponseFileName, *binList,
+                 cl.GetArgument<string>("spectrum"),
+                 cl.GetArgument<double>("pivot"),
+                 cl.GetArgument<double>("roiRadius"),
+                 nside, pixels, cl.GetArgument<unsigned>("threads"));
+  if (cl.HasFlag("indexfree")) {
+    scan.SetIndexFree(true);
+  }
+  if (cl.HasFlag("backgroundNormFit")) {
+    scan.SetBackgroundNormFree(true);
+  }
+  if (!cl.GetArgument<string>("checkpoint").empty()) {
+    scan.SetCheckpointFile(cl.GetArgument<string>("checkpoint"),
+                           cl.GetArgument<unsigned>("block"));
+  }
+  scan.Scan(nside, pixels);
+
+  const vector<TSMapScan::Result> results = scan.GetResults();
+  double maxSigma = -10.;
+  int maxPixel = -1;
+  for (unsigned i = 0; i < results.size(); ++i) {
+    if (results[i].significance > maxSigma) {
+      maxSigma = results[i].significance;
+      maxPixel = results[i].pixel;
+    }
+  }
+  if (maxPixel >= 0) {
+    const SkyPos maxPos(hMap.pix2ang(maxPixel));
+    log_info("Maximum significance: " << maxSigma << " at (" << maxPos.RA()
+             << "," << maxPos.Dec() << ")");
+  }
+
+  scan.WriteFits(output);
+  return 0;
+}
@@ -0,0 +1,73 @@
+/*!
+ * @file BatchModelInterface.h
+ * @author agent
+ * @date 16 Oct 2026
+ * @brief Vectorized extension of the ModelInterface for extended sources.
+ * @version $Id$
+ */
+
+#ifndef BATCH_MODEL_INTERFACE_H_INCLUDED
+#define BATCH_MODEL_INTERFACE_H_INCLUDED
+
+#include <vector>
+
+#include <liff/ModelInterface.h>
+
+namespace threeML {
+
+/*!
+ * @class BatchModelInterface
+ * @author agent
+ * @date 16 Oct 2026
+ * @ingroup
+ * @brief ModelInterface that answers extended-source queries for many sky
+ *        positions at once.
+ *
+ * ModelInterface.h is kept in sync with 3ML and must not change, so the
+ * batched queries are an optional extension: models deriving from this
+ * class can override them, e.g. to answer a whole convolution grid with one
+ * NumPy call instead of one Python call per position. The default
+ * implementations loop over the scalar methods.
+ *
+ * LiFF code calls the static GetExtendedSourceFluxes() and
+ * IsInsideAnyExtendedSource(), which use the batched methods if the model
+ * is a BatchModelInterface and the scalar loop otherwise.
+ */
+
+class BatchModelInterface: public ModelInterface {
+
+  public:
+
+    virtual ~BatchModelInterface() {};
+
+    //Fluxes at positions (ra[i], dec[i]) are returned in fluxes[i * nE + e]
+    //for energies[e], nE = energies.size(), in MeV^-1 cm^-2 s^-1 sr^-1
+    virtual void getExtendedSourceFluxesBatch(int srcid,
+                                              const std::vector<double> &j2000_ra,
+                                              const std::vector<double> &j2000_dec,
+                                              const std::vector<double> &energies,
+                                              std::vector<double> &fluxes) const;
+
+    //inside[i] is nonzero if (ra[i], dec[i]) is inside any extended source
+    virtual void isInsideAnyExtendedSourceBatch(const std::vector<double> &j2000_ra,
+                                                const std::vector<double> &j2000_dec,
+                                                std::vector<char> &inside) const;
+
+    /// Batched flux query for any model, see getExtendedSourceFluxesBatch
+    static void GetExtendedSourceFluxes(const ModelInterface &mi, int srcid,
+                                        const std::vector<double> &ra,
+                                        const std::vector<double> &dec,
+                                        const std::vector<double> &energies,
+                                        std::vector<double> &fluxes);
+
+    /// Batched inside test for any model, see isInsideAnyExtendedSourceBatch
+    static void IsInsideAnyExtendedSource(const ModelInterface &mi,
+                                          const std::vector<double> &ra,
+                                          const std::vector<double> &dec,
+                                          std::vector<char> &inside);
+
+};
+
+}
+
+#endif // BATCH_MODEL_INTERFACE_H_INCLUDED
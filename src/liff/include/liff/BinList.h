@@ -37,7 +37,7 @@ class BinList {
     /// Constructor taking list of names.
     inline BinList(const std::vector<BinName>& name) : name_(name) {}
     
-    /// Constructor taking map-tree file.
+    /// Constructor taking map-tree or map column file.
     BinList(const std::string& mapFileName);
     
     /// Number of bins.
@@ -84,6 +84,37 @@ class CalcBin {
   ///Returns Log Likelihood for BG-only
   double CalcBackgroundLogLikelihood();
 
+  ///Builds all lazily filled caches needed by the (BG-only if !signal) LL,
+  ///returns the number of pixel chunks of at most chunkSize pixels. After
+  ///this, CalcLogLikelihoodChunk can be called concurrently, also for
+  ///different CalcBins sharing the same source responses.
+  unsigned PrepareLogLikelihood(bool signal, unsigned chunkSize);
+
+  ///Returns the LL contribution of one chunk, see PrepareLogLikelihood
+  double CalcLogLikelihoodChunk(bool signal, unsigned chunk);
+
+  ///Appends the ON counts, the expected excess at CommonNorm = 1 and the BG
+  ///of the pixels contributing to the LL, for the fit of CommonNorm alone.
+  ///Returns false if the LL of this bin cannot be written in these terms.
+  bool GetCommonNormFitTerms(std::vector<double> &counts,
+                             std::vector<double> &excess,
+                             std::vector<double> &background);
+
+  ///True if CalcLogLikelihoodGradient is available
+  bool HasLogLikelihoodGradient() const;
+
+  ///Returns the Log Likelihood (as CalcLogLikelihood, up to rounding) and
+  ///its derivatives with respect to CommonNorm and BackgroundNorm. Has to
+  ///follow PrepareLogLikelihood(true, ...), and can then be called
+  ///concurrently for different CalcBins.
+  double CalcLogLikelihoodGradient(double &dCommonNorm,
+                                   double &dBackgroundNorm);
+
+  ///Returns the BG-only Log Likelihood (as CalcBackgroundLogLikelihood, up
+  ///to rounding) and its derivative with respect to BackgroundNorm, after
+  ///PrepareLogLikelihood(false, ...), see CalcLogLikelihoodGradient
+  double CalcBackgroundLogLikelihoodGradient(double &dBackgroundNorm);
+
   ///These numbers are used for Gaussian Approximations
   void CalcWeights(double &sumExpWeighted, double &sumSignalWeighted,
                    double &sumBGWeighted);
@@ -116,6 +147,8 @@ class CalcBin {
   double numTransits_;
   PointSourceDetectorResponseVector &pointSources_;
   ExtendedSourceDetectorResponseVector &extendedSources_;
+  SkyMapCollection *skyMaps_;
+  InternalModelPtr internal_;
   InternalModelBin imb_;
   rangeset<int> roiPix_;
   rangeset<int> skyMapPixels_;
@@ -134,6 +167,123 @@ class CalcBin {
 
   std::map<int, SkyPos> pixelCenterHash_;
 
+  //Compiled ROI: flat per-pixel arrays in the iteration order of roiPix_,
+  //so that the likelihood loops do not touch rangesets or std::maps.
+  bool roiCompiled_;
+  unsigned roiDataRevision_;
+  unsigned roiBGRevision_;
+  std::vector<int> roiPixIds_;
+  std::vector<SkyPos> roiPixCenters_;
+  std::vector<double> roiCounts_;       //ON counts, clamped to >= 0
+  std::vector<double> roiLogFactorial_; //lgamma(ON + 1)
+  std::vector<double> roiBackground_;   //BG without BackgroundNorm
+
+  //Hoisted data terms for the vectorized LL kernel: only pixels with
+  //BG != 0 contribute, BG < 0 pixels add a constant -1e30 each.
+  std::vector<unsigned> roiFitPix_;     //index into the arrays above
+  std::vector<double> roiFitCounts_;
+  std::vector<double> roiFitBackground_;
+  std::vector<double> roiFitExcess_;    //work buffer, filled per call
+  double roiFitLogFactorialSum_;
+  unsigned roiNegativeBG_;
+  unsigned chunkSize_; //set by PrepareLogLikelihood, 0 = whole bin
+  unsigned roiRevision_; //incremented whenever the ROI arrays are rebuilt
+
+  //PSF footprint of a point source at the center of a RING pixel: the
+  //non-zero pixelated-PSF densities per HEALPix ring, by index in the
+  //ring. Rotating the source along its ring by k pixels rotates ring j
+  //by k*n_j/n_source pixels, so the footprint serves every pixel of the
+  //source ring (as long as these shifts are whole pixels, i.e. always in
+  //the equatorial belt) with the same PSF.
+  struct PsfFootprint {
+    PsfFootprint() : source(0), pixelatedPsfRevision(0), ring(-1),
+                     ringIndex(0), ringPixels(0) { }
+    const PointSourceDetectorResponse *source;
+    unsigned pixelatedPsfRevision;
+    int ring;                             //ring of the source pixel
+    int ringIndex;                        //source pixel index in the ring
+    int ringPixels;                       //number of pixels in the ring
+    std::vector<int> rings;               //per footprint ring:
+    std::vector<int> ringStart;           //  first pixel of the ring
+    std::vector<int> ringSize;            //  number of pixels in the ring
+    std::vector<unsigned> ringFirst;      //  first entry, plus end entry
+    std::vector<int> index;               //pixel index in its ring
+    std::vector<double> density;
+  };
+
+  //Sparse PSF template of one point source in this bin: the ROI pixels
+  //within PSF_LIM and their pixelated-PSF densities. It only depends on
+  //the source position and PSF, so spectral changes just rescale it.
+  struct PsfTemplate {
+    PsfTemplate() : source(0), psfRevision(0), roiRevision(0) { }
+    const PointSourceDetectorResponse *source;
+    unsigned psfRevision;
+    unsigned roiRevision;
+    std::vector<unsigned> pix;            //index into the ROI arrays
+    std::vector<double> density;
+    PsfFootprint footprint;               //of the last source ring
+  };
+  std::vector<PsfTemplate> psfTemplates_;
+  std::vector<double> roiExcess_;       //work buffer, per ROI pixel
+
+  //Change tracking of the source contributions: static sources are summed
+  //once into roiStaticCounts_, only the others are re-added in every LL call.
+  struct SourceState {
+    SourceState()
+        : source(0), modelRevision(0), isStatic(false), unchangedCalls(0) { }
+    ///Records the source and revision of this call, returns true if the
+    ///static sum has to be rebuilt
+    bool Update(const void *src, unsigned revision);
+    const void *source;
+    unsigned modelRevision;
+    bool isStatic;
+    unsigned unchangedCalls; //since the last change, while not static
+  };
+  std::vector<SourceState> pointSourceStates_;
+  std::vector<SourceState> extendedSourceStates_;
+  std::vector<std::vector<double> > roiExtendedCounts_; //per ext. source
+  std::vector<double> roiStaticCounts_; //without CommonNorm, numTransits
+  unsigned staticRoiRevision_;
+
+  ///(Re-)builds the PSF templates of moved or new point sources
+  void UpdatePsfTemplates();
+
+  ///Fills tmpl from its (possibly rebuilt) ring footprint if the source
+  ///sits at a pixel center of a RING map; false if it can not be used
+  bool TranslatePsfFootprint(PointSourceDetectorResponse &ps,
+                             PsfTemplate &tmpl);
+
+  ///Pixelated-PSF densities around a source at the center of pixel hp
+  void BuildPsfFootprint(PointSourceDetectorResponse &ps, int hp,
+                         PsfFootprint &fp);
+
+  ///Updates the PSF templates, the cached extended-source contributions
+  ///and the sum of the unchanged sources; called before CalcExpectedExcess
+  void UpdateModelCounts();
+
+  ///Fills roiExcess_ for the ROI pixels in [begin, end) with CommonNorm
+  ///norm; same values as GetPerPixelExpectedExcess up to the summation
+  ///order of the sources. Disjoint ranges can be filled concurrently.
+  void CalcExpectedExcess(unsigned begin, unsigned end, double norm);
+
+  ///(Re-)builds the flat ROI arrays if the ROI, data or BG cache changed
+  void CompileROI();
+
+  ///Per-pixel LL loops, reference implementation for the kernel
+  double CalcLogLikelihoodScalar();
+  double CalcBackgroundLogLikelihoodScalar();
+
+  ///LL via the vectorized kernel for the fit pixels in [begin, end);
+  ///the constant terms are added to the chunk starting at 0
+  double CalcLogLikelihoodVectorized(bool signal, unsigned begin,
+                                     unsigned end);
+
+  ///Evaluates the LL with the kernel selected in the InternalModel
+  double EvaluateLogLikelihood(bool signal);
+
+  ///Expected excess for a pixel whose center is already known
+  double GetPerPixelExpectedExcess(int hp, const SkyPos &pixelCenter);
+
   //double GetPointSourceConvolutedSignal(int sID, double distance);
 
   //double GetExtendedSourceConvolutedSignal(int sID, int hp);
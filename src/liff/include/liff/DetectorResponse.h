@@ -28,6 +28,12 @@
 
 SHARED_POINTER_TYPEDEFS(TFile);
 
+/// Returns a new value of a process-wide counter, never 0. Source
+/// responses take their revision numbers from it, so a cache keyed on a
+/// source pointer and its revision cannot match a new source that was
+/// allocated at the address of a deleted one.
+unsigned NextSourceRevision();
+
 /*!
  * @class DetectorResponse
  * @author Robert Lauer
@@ -40,6 +46,9 @@ SHARED_POINTER_TYPEDEFS(TFile);
 typedef std::pair<int, BinName> BinPair;
 typedef std::map<BinPair, ResponseBinPtr> ResponseBinMap;
 
+class DetectorResponse;
+SHARED_POINTER_TYPEDEFS(DetectorResponse);
+
 class DetectorResponse {
 
  public:
@@ -74,6 +83,18 @@ class DetectorResponse {
     }
   }
 
+  /// Return a response for the file that shares the simulated histograms
+  /// and functions with all other responses opened from the same file
+  /// (same path and modification time) in this process. Only the small
+  /// reweighted state of the ResponseBins is owned by the returned copy.
+  /// The file is read again once all responses sharing it are destroyed.
+  static DetectorResponse Open(const std::string &filename);
+
+  /// Replace the histograms and functions shared through Open by private
+  /// copies. ROOT objects are not safe to evaluate from several threads
+  /// at once, so a response used in its own thread has to call this first
+  void Unshare();
+
   /// Read  in response histograms
   void Read(const std::string filename);
 
@@ -178,6 +199,10 @@ class DetectorResponse {
 
   TDirectory *currentDir_;
 
+  //response read from file that this one shares its simulated
+  //histograms with, if created with Open()
+  DetectorResponseConstPtr shared_;
+
   //Added by GV
   double getValueFromSpectrum(double logE);
   std::map<double, double> spModelHash_;
@@ -78,8 +78,11 @@ class ExtendedSourceDetectorResponse {
         fftwIn_(0),
         fftwOut_(0),
         gridRA_(0),
-        gridDec_(0) {
-    dr_ = DetectorResponse(dr);
+        gridDec_(0),
+        modelRevision_(NextSourceRevision()),
+        spectralOnlyChanges_(0),
+        useComponents_(false) {
+    dr_ = DetectorResponse::Open(dr);
     SetModel(mi);
   }
 
@@ -92,6 +95,16 @@ class ExtendedSourceDetectorResponse {
 
   void SetModel(threeML::ModelInterface &mi, bool reconvolute = false);
 
+  ///Compares the boundaries and the fluxes on the convolution grid with
+  ///the last call and returns true if they changed. If only the spectrum
+  ///changed in more calls in a row than there are energy bins, the
+  ///convolution is split into per-energy-bin components that are
+  ///re-weighted from then on; otherwise calls SetModel(mi, true).
+  bool UpdateModel(threeML::ModelInterface &mi);
+
+  ///Changes whenever the convoluted signal may have changed
+  unsigned GetModelRevision() const { return modelRevision_; }
+
   int GetSourceID() const { return sourceId_; }
 
   int GetNumRegions() const { return numRegions_; }
@@ -119,6 +132,11 @@ class ExtendedSourceDetectorResponse {
                                            const int nside,
                                            rangeset<int> &roiPix, const int hp);
 
+  ///Runs the PSF convolution for this bin if it is not cached yet, so that
+  ///GetExtendedSourceConvolutedSignal can be called concurrently afterwards
+  void PrepareConvolutedSignal(const BinName& nhbin, const int nside,
+                               rangeset<int> &roiPix);
+
   double GetExpectedSignal(const BinName& nhbin,
                            const double ra, const double dec);
 
@@ -150,6 +168,31 @@ class ExtendedSourceDetectorResponse {
   DetectorResponse dr_;
   threeML::ModelInterface &mi_;
   void checkRegionId(int regionId) const;
+  //Energies [MeV] at which the fluxes are queried
+  std::vector<double> GetModelEnergies();
+  //Fluxes at all positions_ sampled by ConvolutePSF, energy index fastest;
+  //queries the model once for all positions (see BatchModelInterface)
+  void SampleModelFluxes(threeML::ModelInterface &mi, double minra,
+                         double maxra, double mindec, double maxdec,
+                         std::vector<double> &fluxes,
+                         std::vector<char> &sampled);
+  //True if fluxes = scales[e] * reference for every energy e
+  static bool GetSpectralScales(const std::vector<double> &fluxes,
+                                const std::vector<double> &reference,
+                                unsigned nEnergies,
+                                std::vector<double> &scales);
+  //Expected signal for model fluxes [MeV^-1 cm^-2 s^-1 sr^-1] at dec;
+  //fluxes are converted in place
+  double GetExpectedSignal(const BinName& nhbin, double dec,
+                           std::vector<double> &fluxes);
+  //Dec bins and weights used to interpolate the response at dec
+  bool GetDecInterpolation(double dec, int &decb1, int &decb2,
+                           double &w1, double &w2);
+  //PSF convolution of the input in fftwIn_ or tempMap, result in tempMap
+  void ConvoluteInput(const BinName& nhbin, Healpix_Map<double> &tempMap,
+                      rangeset<int> &roiPix);
+  //Convoluted signal as weighted sum of per-energy-bin components
+  void ConvoluteComponents(const BinName& nhbin, rangeset<int> &roiPix);
   int nside_;
   MapMap convolutedExpectedSignalMap_; //nhbin
   std::map<BinName, std::pair<SkyPos, double> > prevCount_;
@@ -162,6 +205,17 @@ class ExtendedSourceDetectorResponse {
   std::map<BinPair, std::pair<TH1D, TH1D> > pixelatedFTPsf_;
   std::vector<std::pair<double, double> > positions_;
   rangeset<int> healpixIds_;
+  unsigned modelRevision_;
+  //fluxes at positions_ at the last UpdateModel or ConvolutePSF, see
+  //SampleModelFluxes; cleared when positions_ change
+  std::vector<double> modelFluxes_;
+  std::vector<char> modelSampled_;
+  //consecutive spectral-only changes handled by full convolutions
+  unsigned spectralOnlyChanges_;
+  bool useComponents_;
+  std::vector<double> componentFluxes_; //reference fluxes of components
+  std::vector<double> componentScales_; //current/reference, per energy
+  std::map<BinName, std::vector<SkyMap<double> > > convolutedComponents_;
 };
 
 SHARED_POINTER_TYPEDEFS(ExtendedSourceDetectorResponse);
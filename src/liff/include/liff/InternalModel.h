@@ -6,6 +6,7 @@
 #include <TF2.h>
 
 #include <liff/Util.h>
+#include <liff/PoissonLikelihood.h>
 
 SHARED_POINTER_TYPEDEFS(TF1);
 SHARED_POINTER_TYPEDEFS(TF2);
@@ -113,6 +114,32 @@ class InternalModel {
     ///Returns MINUIT verbosity levl
     int GetInternalFitVerbosity() const { return verbosity_; };
 
+    ///Selects the Poisson LL kernel; tolerance (relative) for LL_KERNEL_VERIFY
+    void SetLikelihoodKernel(LikelihoodKernel k, double tolerance = 1e-9) {
+      llKernel_ = k;
+      llTolerance_ = tolerance;
+    };
+
+    ///Returns the Poisson LL kernel used by the CalcBins
+    LikelihoodKernel GetLikelihoodKernel() const { return llKernel_; };
+
+    ///Returns the relative tolerance used by LL_KERNEL_VERIFY
+    double GetLikelihoodKernelTolerance() const { return llTolerance_; };
+
+    ///Fits CommonNorm with Newton's method instead of MINUIT if it is the
+    ///only free parameter (default)
+    void SetAnalyticCommonNormFit(bool a = true) { analyticCNFit_ = a; };
+
+    ///Returns if CommonNorm-only fits use Newton's method
+    bool IsAnalyticCommonNormFit() const { return analyticCNFit_; };
+
+    ///Passes the analytic LL gradient to MINUIT if only CommonNorm and
+    ///BackgroundNorms are free (default)
+    void SetAnalyticGradient(bool a = true) { analyticGradient_ = a; };
+
+    ///Returns if the analytic LL gradient is used when possible
+    bool IsAnalyticGradient() const { return analyticGradient_; };
+
   private:
 
     double commonNorm_;
@@ -133,6 +160,12 @@ class InternalModel {
 
     int verbosity_;
 
+    LikelihoodKernel llKernel_;
+    double llTolerance_;
+
+    bool analyticCNFit_;
+    bool analyticGradient_;
+
 };
 
 SHARED_POINTER_TYPEDEFS(InternalModel);
@@ -35,7 +35,13 @@ class InternalModelBin {
     void SetBackgroundFromMap(SkyMap<double> *BGMap);
 
     ///Returns BG value for a given healpix pixel ID
-    double BG(int hp);
+    double BG(int hp) { return UnscaledBG(hp) * BackgroundNorm(); };
+
+    ///Returns BG value for a given healpix pixel ID without BackgroundNorm
+    double UnscaledBG(int hp);
+
+    ///Incremented whenever cached (unscaled) BG values are invalidated
+    unsigned BackgroundRevision() const { return bgRevision_; };
 
     ///Returns free parameter list
     FreeParameterList &GetFreeBackgroundParameterList() { return freeBGParList_; };
@@ -63,6 +69,7 @@ class InternalModelBin {
 
     TF2Ptr bgModelBin_;
     std::map<int, double> bgHash_;
+    unsigned bgRevision_;
 
     double backgroundNorm_;
     double backgroundNormError_;
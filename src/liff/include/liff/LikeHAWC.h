@@ -12,6 +12,7 @@
 #include <liff/BinList.h>
 #include <liff/CalcBin.h>
 #include <liff/ROI.h>
+#include <liff/ThreadPool.h>
 
 #include <TMinuit.h>
 
@@ -21,6 +22,9 @@
  * @date 25 Jul 2014
  * @ingroup 
  * @brief Wraps several CalcBin objects together for a likelihood analysis
+ *
+ * The internal fits are bound to the instance, so different LikeHAWC
+ * objects can be fitted independently, also in different threads.
  */
 
 class LikeHAWC {
@@ -159,6 +163,17 @@ class LikeHAWC {
   ///Sets new model, calculates and returns LL(Model)
   double CalcLogLikelihood(threeML::ModelInterface &model, bool doIntFit = true);
 
+  ///Returns LL(Model) without fit and its derivatives with respect to
+  ///CommonNorm and the BackgroundNorm of each CalcBin (see
+  ///CalcBin::CalcLogLikelihoodGradient), evaluated in the thread pool
+  double CalcLogLikelihoodGradient(double &dCommonNorm,
+                                   std::vector<double> &dBackgroundNorms);
+
+  ///Returns LL(BG) without fit and its derivatives with respect to the
+  ///BackgroundNorm of each CalcBin
+  double CalcBackgroundLogLikelihoodGradient(
+      std::vector<double> &dBackgroundNorms);
+
   ///Calculates and returns LL(Model) - LL(BG)
   double CalcTestStatistic(bool doIntFit = true);
 
@@ -290,6 +305,36 @@ class LikeHAWC {
   ///Returns MINUIT verbosity levl
   int GetInternalFitVerbosity() { return internal_->GetInternalFitVerbosity(); };
 
+  ///Selects the Poisson LL kernel; tolerance (relative) for LL_KERNEL_VERIFY
+  void SetLikelihoodKernel(LikelihoodKernel k, double tolerance = 1e-9) {
+    internal_->SetLikelihoodKernel(k, tolerance);
+  };
+
+  ///Fits CommonNorm with Newton's method instead of MINUIT if it is the
+  ///only free parameter (default)
+  void SetAnalyticCommonNormFit(bool a = true) {
+    internal_->SetAnalyticCommonNormFit(a);
+  };
+
+  ///Passes the analytic LL gradient to MINUIT if only CommonNorm and
+  ///BackgroundNorms are free (default); the BackgroundNorms are then
+  ///limited to [1e-3, 1e3]
+  void SetAnalyticGradient(bool a = true) {
+    internal_->SetAnalyticGradient(a);
+  };
+
+  ///Pixel chunk size of the vectorized kernel, see SetNumberOfThreads
+  static const unsigned DefaultPixelChunkSize = 16384;
+
+  ///Evaluates the CalcBins (and pixel chunks of pixelChunkSize pixels for
+  ///the vectorized kernel) in nThreads threads; 0 = one per core, 1 = serial.
+  ///The LL only depends on pixelChunkSize, not on nThreads
+  void SetNumberOfThreads(unsigned nThreads,
+                          unsigned pixelChunkSize = DefaultPixelChunkSize);
+
+  ///Number of threads used for the likelihood evaluation
+  unsigned GetNumberOfThreads() const;
+
   ///Get the TopHat excess for all bins as expected from the current model
   std::vector<double> GetTopHatExpectedExcesses(double ra, double dec, double countradius);
 
@@ -338,6 +383,32 @@ class LikeHAWC {
 
   CalcBinVector calcBins_;
 
+  ThreadPoolPtr threadPool_;
+  unsigned pixelChunkSize_;
+
+  ///Sum of the (BG-only if !signal) LL of all CalcBins
+  double SumLogLikelihood(bool signal);
+
+  ///Thread pool task t of SumLogLikelihood
+  void EvaluateLogLikelihoodTask(bool signal,
+                                 const std::vector<unsigned> &taskBin,
+                                 const std::vector<unsigned> &taskChunk,
+                                 std::vector<double> &taskLL,
+                                 unsigned t);
+
+  ///LL of all CalcBins as SumLogLikelihood, with the derivatives of each
+  ///CalcBin in dCommonNorms and dBackgroundNorms
+  double SumLogLikelihoodGradient(bool signal,
+                                  std::vector<double> &dCommonNorms,
+                                  std::vector<double> &dBackgroundNorms);
+
+  ///Thread pool task of SumLogLikelihoodGradient for CalcBin k
+  void EvaluateLogLikelihoodGradientTask(bool signal,
+                                         std::vector<double> &binLL,
+                                         std::vector<double> &dCommonNorms,
+                                         std::vector<double> &dBackgroundNorms,
+                                         unsigned k);
+
   ///Minimizes -LL via free parameters in InternalModel
   //int InternalMinimize(int Verbosity=-1);
 
@@ -345,6 +416,4 @@ class LikeHAWC {
 
 };
 
-extern LikeHAWC *gLikeHAWC;  //declaration of a global variable
-
 #endif
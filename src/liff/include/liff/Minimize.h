@@ -9,58 +9,93 @@
 #ifndef MINIMIZE_H
 #define MINIMIZE_H
 
+class LikeHAWC;
+
+/// Fit function evaluating -LL of a LikeHAWC instance for MINUIT parameters
+typedef void (*InternalFitFunction)(LikeHAWC &like,
+                                    int &npar, double *gin, double &LL,
+                                    double *par, int iflag);
+
 /*****************************************************/
 
 /// Minimize InternalModel
-int InternalMinimize();
+int InternalMinimize(LikeHAWC &like);
+
+/*****************************************************/
+
+/// Fit of CommonNorm alone by Newton's method; returns 0 on success and
+/// 1 if the LL has no suitable form or maximum (then use MINUIT)
+int InternalCommonNormMinimize(LikeHAWC &like);
 
 /*****************************************************/
 
 /// Internal Model fit function
-void InternalFitFunc(int &npar, double *gin, double &LL,
+void InternalFitFunc(LikeHAWC &like,
+                     int &npar, double *gin, double &LL,
                      double *par, int iflag);
 
 /*****************************************************/
 
 /// Internal Model fit function, reset sources in each iteration
-void InternalFitFuncUpdateSources(int &npar, double *gin, double &LL,
+void InternalFitFuncUpdateSources(LikeHAWC &like,
+                                  int &npar, double *gin, double &LL,
                                   double *par, int iflag);
 
 /*****************************************************/
 
+/// Internal Model fit function with analytic gradient, for fits of
+/// CommonNorm and BackgroundNorms only
+void InternalFitFuncGradient(LikeHAWC &like,
+                             int &npar, double *gin, double &LL,
+                             double *par, int iflag);
+
+/*****************************************************/
+
 /// Minimize -LL for internal BG-Model (inside InternallModel) only
-int InternalBGMinimize();
+int InternalBGMinimize(LikeHAWC &like);
 
 /*****************************************************/
 
 /// Background-only internal fit function
-void InternalBGFitFunc(int &npar, double *gin, double &LL,
+void InternalBGFitFunc(LikeHAWC &like,
+                       int &npar, double *gin, double &LL,
                        double *par, int iflag);
 
 /*****************************************************/
 
+/// Background-only internal fit function with analytic gradient, for fits
+/// of BackgroundNorms only
+void InternalBGFitFuncGradient(LikeHAWC &like,
+                               int &npar, double *gin, double &LL,
+                               double *par, int iflag);
+
+/*****************************************************/
+
 /// Minimize InternalModel for top hat 
-int InternalTopHatMinimize();
+int InternalTopHatMinimize(LikeHAWC &like);
 
 /*****************************************************/
 
 /// Internal Model fit function for top hat
-void InternalTopHatFitFunc(int &npar, double *gin, double &LL,
+void InternalTopHatFitFunc(LikeHAWC &like,
+                           int &npar, double *gin, double &LL,
                            double *par, int iflag);
 
 /*****************************************************/
 /// Internal Model top hat fit function, update sources in each iteration
-void InternalTopHatFitFuncUpdateSources(int &npar, double *gin, double &LL,
+void InternalTopHatFitFuncUpdateSources(LikeHAWC &like,
+                                        int &npar, double *gin, double &LL,
                                         double *par, int iflag);
 
 /*****************************************************/
 
 /// Minimize Background-only for top hat 
-int InternalTopHatBGMinimize();
+int InternalTopHatBGMinimize(LikeHAWC &like);
 
 /*****************************************************/
 /// Background-only  fit function for top hat
-void InternalTopHatBGFitFunc(int &npar, double *gin, double &LL,
+void InternalTopHatBGFitFunc(LikeHAWC &like,
+                             int &npar, double *gin, double &LL,
                              double *par, int iflag);
 
 
@@ -53,12 +53,16 @@ class PointSourceDetectorResponse {
           decBinId2_(-1),
           ra_(-1000),
           dec_(-1000),
-          mi_(mi) {
-      dr_ = DetectorResponse(dr);
+          mi_(mi),
+          psfRevision_(NextSourceRevision()),
+          pixelatedPsfRevision_(NextSourceRevision()),
+          modelRevision_(NextSourceRevision()) {
+      dr_ = DetectorResponse::Open(dr);
       SetModel(mi);
     }
 
-    //returns 1 if the position has changed, zero otherwise
+    //returns 1 if the position has changed, zero otherwise;
+    //only reweights energies if the position or the fluxes changed
     int SetModel(threeML::ModelInterface &mi, bool detResFree = false);
 
     void SetSkyPos(SkyPos pos);
@@ -89,8 +93,33 @@ class PointSourceDetectorResponse {
     double GetSmearedSignal(double distance, double pixelArea,
                             const BinName& nhbin);
 
+    ///Fraction of the signal in a pixel at the given distance, i.e.
+    ///GetSmearedSignal without the GetExpectedSignal factor
+    double GetPixelatedPsfDensity(double distance, double pixelArea,
+                                  const BinName& nhbin);
+
+    ///Changes whenever GetPixelatedPsfDensity may change for a given
+    ///pixel, i.e. if the source moved or the PSF cache was cleared
+    unsigned GetPsfRevision() const { return psfRevision_; }
+
+    ///Changes whenever the cached pixelated PSFs are cleared, i.e. not if
+    ///the source only moved; GetPixelatedPsfDensity as function of the
+    ///distance is the same for all positions in one dec bin
+    unsigned GetPixelatedPsfRevision() const { return pixelatedPsfRevision_; }
+
+    ///Distance [degree] below which GetPixelatedPsfDensity can be non-zero
+    double GetPixelatedPsfRadius(double pixelArea, const BinName& nhbin);
+
+    ///Changes whenever GetExpectedSignal or the PSF may have changed, i.e.
+    ///if the source moved or its spectrum changed in the ModelInterface
+    unsigned GetModelRevision() const { return modelRevision_; }
+
     TH1D CalculatePixelatedPsf(double pixelArea, const BinName& nhbin);
 
+    ///Builds the cached pixelated PSF for this bin (and current dec bin),
+    ///so that GetSmearedSignal can be called concurrently afterwards
+    void PreparePixelatedPsf(double pixelArea, const BinName& nhbin);
+
     bool IsPSFDeltaFunction(double pixelArea, const BinName& nhbin);
 
     bool IsPSFDoubleGaussian(const BinName& nhbin);
@@ -109,6 +138,11 @@ class PointSourceDetectorResponse {
   private:
   
     typedef std::pair<BinName, int> BinPair;
+
+    //Fluxes [TeV^-1 cm^-2 s^-1] at the log-energy bins of the response
+    std::vector<double> QueryFluxes();
+
+    void ReweightEnergies(const std::vector<double> &fluxes);
   
     //Computes the "Disc Spread Function", to be wrapped by a TF1. Parameters are the same as for the double gaussian plus [4] = disc radius
     double ComputeDSF(double *radius, double *parameters);
@@ -127,6 +161,10 @@ class PointSourceDetectorResponse {
     std::map<BinPair, TH1D> pixelatedPsf_;
     std::map<BinName, bool> deltaFunctionPSF_;
     SkyPos skypos_;
+    unsigned psfRevision_;
+    unsigned pixelatedPsfRevision_;
+    unsigned modelRevision_;
+    std::vector<double> fluxes_; //fluxes of the last reweighting
 };
 
 // The following creates the typedef PointSourceDetectorResponsePtr (and PointSourceDetectorResponsePtrConst)
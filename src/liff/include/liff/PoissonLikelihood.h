@@ -0,0 +1,59 @@
+/*!
+ * @file PoissonLikelihood.h
+ * @author agent
+ * @date 16 Oct 2026
+ * @brief Vectorized kernel for the model-dependent part of the binned
+ *        Poisson log-likelihood.
+ * @version $Id$
+ */
+
+#ifndef LIFF_POISSON_LIKELIHOOD_H
+#define LIFF_POISSON_LIKELIHOOD_H
+
+/// Selects how CalcBin evaluates the Poisson log-likelihood of its ROI
+enum LikelihoodKernel {
+  LL_KERNEL_SCALAR,     // per-pixel loop with branches, std::log and lgamma
+  LL_KERNEL_VECTORIZED, // hoisted data terms + SIMD kernel with fast log
+  LL_KERNEL_VERIFY      // both; warn if they differ, return scalar result
+};
+
+/// Returns sum_i [ n_i * log(mu_i) - mu_i ] over n pixels, where
+/// mu_i = max(excess_i + bgNorm * bg_i, minMu). excess may be NULL (no
+/// signal). minMu must be a positive normal number. Uses AVX-512 or AVX2
+/// if the CPU supports it, a plain loop with std::log otherwise.
+double PoissonLogLikelihoodSum(const double *counts,
+                               const double *excess,
+                               const double *bg,
+                               double bgNorm,
+                               double minMu,
+                               unsigned n);
+
+/// Same as PoissonLogLikelihoodSum, but never uses SIMD instructions
+double PoissonLogLikelihoodSumScalar(const double *counts,
+                                     const double *excess,
+                                     const double *bg,
+                                     double bgNorm,
+                                     double minMu,
+                                     unsigned n);
+
+/// Maximizes sum_i [ n_i * log(mu_i) - mu_i ] with mu_i = norm * excess_i +
+/// bg_i over norm (Newton's method, safeguarded by bisection), starting from
+/// the given norm. All bg_i must be positive. Returns false if there is no
+/// maximum with all mu_i > 0, e.g. without ON counts in signal pixels;
+/// otherwise sets norm to the maximum and error to 1/sqrt(-d2/dnorm2), the
+/// 1 sigma error of a likelihood fit.
+bool PoissonMaximizeNorm(const double *counts,
+                         const double *excess,
+                         const double *bg,
+                         unsigned n,
+                         double &norm,
+                         double &error);
+
+/// Natural logarithm for positive normal doubles, same algorithm as the
+/// SIMD kernels (relative error of a few 1e-16)
+double PoissonFastLog(double x);
+
+/// Name of the instruction set used by PoissonLogLikelihoodSum
+const char *GetPoissonKernelInstructionSet();
+
+#endif
@@ -0,0 +1,99 @@
+/*!
+ * @file PseudoExperiments.h
+ * @author agent
+ * @date 16 Oct 2026
+ * @brief Reproducible Poisson pseudo-experiments for a LikeHAWC setup.
+ * @version $Id$
+ */
+
+#ifndef LIFF_PSEUDO_EXPERIMENTS_H
+#define LIFF_PSEUDO_EXPERIMENTS_H
+
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include <liff/LikeHAWC.h>
+#include <liff/ThreadPool.h>
+
+/*!
+ * @class PseudoExperiments
+ * @author agent
+ * @date 16 Oct 2026
+ * @ingroup
+ * @brief Replaces the event maps of a LikeHAWC by Poisson realizations of
+ *        background (+ model) and refits them, e.g. to calibrate TS
+ *        distributions.
+ *
+ * The realizations are generated in memory and reuse the ROI, the source
+ * responses and the PSF templates of the LikeHAWC; nothing is written to
+ * disk. The map of bin b in trial t is drawn from RNGStream(seed, s), where
+ * s is a hash of the name of b and of t, so a trial only depends on the seed
+ * and its number: trials can be split over processes (see first in
+ * CalcTestStatistics) and the maps are fluctuated by several threads, with
+ * identical results. The fit starts from the same parameter values in
+ * every trial. The original event maps are restored by Restore() and on
+ * destruction.
+ */
+
+class PseudoExperiments {
+
+  public:
+
+    ///Uses the data and fit setup of like; nThreads fluctuate the maps of
+    ///different bins concurrently (0 = one per core)
+    PseudoExperiments(LikeHAWC &like, boost::uint64_t seed,
+                      unsigned nThreads = 1);
+
+    ~PseudoExperiments();
+
+    ///Sets the expectation the realizations are drawn from: the background
+    ///maps, plus the current model (as in LikeHAWC::MakeModelMap) if
+    ///withModel. Background only by default.
+    void SetExpectation(bool withModel = false);
+
+    ///Replaces the event maps of all CalcBins by realization trial
+    void Generate(boost::uint64_t trial);
+
+    ///Returns the TS of the current model (see LikeHAWC::CalcTestStatistic)
+    ///for the realizations first, ..., first + n - 1
+    std::vector<double> CalcTestStatistics(boost::uint64_t first, unsigned n,
+                                           bool doIntFit = true);
+
+    ///Writes "trial TS" lines of CalcTestStatistics to a text file
+    static void WriteTestStatistics(const std::string &filename,
+                                    boost::uint64_t first,
+                                    const std::vector<double> &ts);
+
+    ///Puts the original event maps back
+    void Restore();
+
+  private:
+
+    PseudoExperiments(const PseudoExperiments &);
+    PseudoExperiments &operator=(const PseudoExperiments &);
+
+    ///Sets the fit parameters to the values at construction
+    void ResetFitParameters();
+
+    void GenerateBin(boost::uint64_t trial, unsigned k);
+
+    LikeHAWC &like_;
+    boost::uint64_t seed_;
+    ThreadPool pool_;
+    bool generated_;
+
+    //per CalcBin
+    std::vector<boost::uint64_t> binKeys_; //hash of the bin name
+    std::vector<SkyMap<double> > expectation_;
+    std::vector<SkyMap<double> > original_;
+
+    //fit parameters at construction
+    double commonNorm_;
+    std::vector<double> backgroundNorms_;
+    std::vector<double> freeParameters_;
+
+};
+
+#endif
@@ -43,36 +43,71 @@ class ResponseBin {
       return logEnBins_;
     }
 
-    ///Reweight energy histograms according to vector with diff flux values
-    void ReweightEnergies(const std::vector<double> fluxes) {
+    ///Reweight energy histograms according to vector with diff flux values;
+    ///the reweighted EnSig histogram is only built when requested
+    void ReweightEnergies(const std::vector<double> &fluxes) {
+      sigExp_ = GetExpectedSignal(fluxes);
+      enSigFluxes_ = fluxes;
+    }
+
+    ///Expected signal after reweighting to fluxes, without changing the bin
+    double GetExpectedSignal(const std::vector<double> &fluxes) {
       if (fluxes.size() != simFluxes_.size()) {
         log_fatal("Size of vector<double> fluxes is not number of logEn "
                       << "histogram bins.");
       }
-      const TH1DPtr enSig = GetEnSigHist(true); //'true' means reset
-      for (int b = 0; b < enSig->GetNbinsX(); ++b) {
-        double scale = fluxes[b] / simFluxes_[b];
-        enSig->SetBinContent(b, enSig->GetBinContent(b) * scale);
+      if (simSignal_.empty()) UpdateSimSignal();
+      return ReweightedSignal(&simSignal_[0], &fluxes[0], &simFluxes_[0],
+                              simSignal_.size() - 2);
+    }
+
+    ///Integral over histogram bins 1..n of counts[b] * fluxes[b]/simFluxes[b]
+    ///for b < n, i.e. of the n-bin EnSig histogram with bin contents counts
+    ///after ReweightEnergies: the bins 0..n-1 are scaled, so the last bin
+    ///always enters with its simulated value
+    static double ReweightedSignal(const double *counts, const double *fluxes,
+                                   const double *simFluxes, const unsigned n) {
+      double sum = 0.;
+      for (unsigned b = 1; b < n; ++b) {
+        sum += counts[b] * (fluxes[b] / simFluxes[b]);
+      }
+      return n > 0 ? sum + counts[n] : sum;
+    }
+
+    ///Linear form of ReweightEnergies: after ReweightEnergies(fluxes),
+    ///GetExpectedSignal() = sum_b weights[b] * fluxes[b] + constant
+    void GetSignalWeights(std::vector<double> &weights, double &constant) {
+      if (simSignal_.empty()) UpdateSimSignal();
+      const unsigned nBins = simSignal_.size() - 2;
+      weights.assign(simFluxes_.size(), 0.);
+      for (unsigned b = 1; b < nBins; ++b) {
+        weights[b] = simSignal_[b] / simFluxes_[b];
       }
-      sigExp_ = enSig->Integral();
+      constant = simSignal_[nBins];
     }
 
     /// Return Point Spread Function histogram
     TH1DPtr GetPsfHist(const bool reset = false) {
       if (reset || !psfHist_) {
-        const std::string name = "PSF" + suffix_;
-        psfHist_ = TH1DPtr(simPsfHist_);
-        psfHist_->SetNameTitle(name.c_str(), name.c_str());
+        psfHist_ = simPsfHist_; //shared, named by NameSimObjects
       }
       return psfHist_;
     }
 
     /// Return Energy Distribution histogram for Signal
     TH1DPtr GetEnSigHist(const bool reset = false) {
-      if (reset || !enSigHist_) {
+      if (reset || !enSigHist_ || !enSigFluxes_.empty()) {
         const std::string name = "EnSig" + suffix_;
         enSigHist_ = TH1DPtr(new TH1D(*simEnSigHist_));
         enSigHist_->SetNameTitle(name.c_str(), name.c_str());
+        if (!reset) {
+          //apply pending reweighting
+          for (int b = 0; b < enSigHist_->GetNbinsX(); ++b) {
+            double scale = enSigFluxes_[b] / simFluxes_[b];
+            enSigHist_->SetBinContent(b, enSigHist_->GetBinContent(b) * scale);
+          }
+        }
+        enSigFluxes_.clear();
       }
       return enSigHist_;
     }
@@ -80,9 +115,7 @@ class ResponseBin {
     /// Return Energy Distribution histogram for Background
     TH1DPtr GetEnBgHist(const bool reset = false) {
       if (reset || !enBgHist_) {
-        const std::string name = "EnBg" + suffix_;
-        enBgHist_ = TH1DPtr(simEnBgHist_);
-        enBgHist_->SetNameTitle(name.c_str(), name.c_str());
+        enBgHist_ = simEnBgHist_; //shared, named by NameSimObjects
       }
       return enBgHist_;
     }
@@ -90,9 +123,7 @@ class ResponseBin {
     /// Return PSF distribution function
     TF1Ptr GetPsfFunction(const bool reset = false) {
       if (reset || !psfFunc_) {
-        const std::string name = "PSF" + suffix_ + "_fit";
-        psfFunc_ = TF1Ptr(simPsfFunc_);
-        psfFunc_->SetNameTitle(name.c_str(), name.c_str());
+        psfFunc_ = simPsfFunc_; //shared, named by NameSimObjects
       }
       return psfFunc_;
     }
@@ -100,9 +131,7 @@ class ResponseBin {
     /// Return energy distribution function for signal
     TF1Ptr GetEnSigFunction(const bool reset = false) {
       if (reset || !enSigFunc_) {
-        const std::string name = "EnSig" + suffix_ + "_fit";
-        enSigFunc_ = TF1Ptr(simEnSigFunc_);
-        enSigFunc_->SetNameTitle(name.c_str(), name.c_str());
+        enSigFunc_ = simEnSigFunc_; //shared, named by NameSimObjects
       }
       return enSigFunc_;
     }
@@ -110,9 +139,7 @@ class ResponseBin {
     /// Return energy distribution function for background
     TF1Ptr GetEnBgFunction(const bool reset = false) {
       if (reset || !enBgFunc_) {
-        const std::string name = "EnBg" + suffix_ + "_fit";
-        enBgFunc_ = TF1Ptr(simEnBgFunc_);
-        enBgFunc_->SetNameTitle(name.c_str(), name.c_str());
+        enBgFunc_ = simEnBgFunc_; //shared, named by NameSimObjects
       }
       return enBgFunc_;
     }
@@ -131,7 +158,8 @@ class ResponseBin {
     /// Set PSF TF1 and fit corresponding histogram
     void FitPsfWithTF1(TF1Ptr func) {
       SetPsfFunction(func, false);
-      GetPsfHist()->Fit(psfFunc_.get(), "Q");
+      psfHist_ = TH1DPtr(new TH1D(*GetPsfHist())); //Fit changes the hist
+      psfHist_->Fit(psfFunc_.get(), "Q");
     }
 
     /// Set EnSig function, keep old range if setRange=false (default)
@@ -163,7 +191,8 @@ class ResponseBin {
     /// Set EnBg TF1 and fit corresponding histogram
     void FitEnBgWithTF1(TF1Ptr func) {
       SetEnBgFunction(func, false);
-      GetEnBgHist()->Fit(enBgFunc_.get(), "Q");
+      enBgHist_ = TH1DPtr(new TH1D(*GetEnBgHist())); //Fit changes the hist
+      enBgHist_->Fit(enBgFunc_.get(), "Q");
     }
 
     /// Return expected number of gamma-ray events in this bin
@@ -183,15 +212,19 @@ class ResponseBin {
       //rescale current (possibly reweighted) energy hist:
       double oldexp = GetEnSigHist()->Integral();
       if (oldexp > 0) GetEnSigHist()->Scale(sigExp_ / oldexp);
-      //rescale base reference energy hist used for future reweightings:
+      //rescale base reference energy hist used for future reweightings,
+      //on a private copy since it may be shared with other responses:
+      simEnSigHist_ = TH1DPtr(new TH1D(*simEnSigHist_));
       oldexp = simEnSigHist_->Integral();
       if (oldexp > 0) simEnSigHist_->Scale(sigExp_ / oldexp);
+      UpdateSimSignal();
     }
 
     /// Set expected number of background events in this bin
     void SetExpectedBackground(double nbg) {
       /// WARNING: EnBg-Function is not rescaled
       bgExp_ = nbg;
+      simEnBgHist_ = TH1DPtr(new TH1D(*simEnBgHist_)); //may be shared
       double oldexp = simEnBgHist_->Integral();
       simEnBgHist_->Scale(bgExp_ / oldexp);
       GetEnBgHist(true);
@@ -200,6 +233,55 @@ class ResponseBin {
 
   private:
 
+    ///Give the simulated histograms and functions the names under which
+    ///the accessors return them. Called once after they are built: they
+    ///may be shared with other responses later and must not change then
+    void NameSimObjects() {
+      std::string name = "PSF" + suffix_;
+      simPsfHist_->SetNameTitle(name.c_str(), name.c_str());
+      name = "EnBg" + suffix_;
+      simEnBgHist_->SetNameTitle(name.c_str(), name.c_str());
+      name = "PSF" + suffix_ + "_fit";
+      simPsfFunc_->SetNameTitle(name.c_str(), name.c_str());
+      name = "EnSig" + suffix_ + "_fit";
+      simEnSigFunc_->SetNameTitle(name.c_str(), name.c_str());
+      name = "EnBg" + suffix_ + "_fit";
+      simEnBgFunc_->SetNameTitle(name.c_str(), name.c_str());
+    }
+
+    ///Replace the simulated histograms and functions by private copies;
+    ///accessors that returned the shared ones return the copies from then on
+    void CloneSimObjects() {
+      const TH1DPtr psfHist = simPsfHist_;
+      const TH1DPtr enBgHist = simEnBgHist_;
+      const TF1Ptr psfFunc = simPsfFunc_;
+      const TF1Ptr enSigFunc = simEnSigFunc_;
+      const TF1Ptr enBgFunc = simEnBgFunc_;
+      simPsfHist_ = TH1DPtr(new TH1D(*psfHist));
+      simEnSigHist_ = TH1DPtr(new TH1D(*simEnSigHist_));
+      simEnBgHist_ = TH1DPtr(new TH1D(*enBgHist));
+      simPsfFunc_ = TF1Ptr(new TF1(*psfFunc));
+      simEnSigFunc_ = TF1Ptr(new TF1(*enSigFunc));
+      simEnBgFunc_ = TF1Ptr(new TF1(*enBgFunc));
+      if (psfHist_ == psfHist) psfHist_ = simPsfHist_;
+      if (enBgHist_ == enBgHist) enBgHist_ = simEnBgHist_;
+      if (psfFunc_ == psfFunc) psfFunc_ = simPsfFunc_;
+      if (enSigFunc_ == enSigFunc) enSigFunc_ = simEnSigFunc_;
+      if (enBgFunc_ == enBgFunc) enBgFunc_ = simEnBgFunc_;
+    }
+
+    ///Copy contents of simEnSigHist_ (incl. under-/overflow) to simSignal_
+    void UpdateSimSignal() {
+      const int nBins = simEnSigHist_->GetNbinsX();
+      simSignal_.resize(nBins + 2);
+      for (int b = 0; b <= nBins + 1; ++b) {
+        simSignal_[b] = simEnSigHist_->GetBinContent(b);
+      }
+      if (simFluxes_.size() < (unsigned) nBins) {
+        log_fatal("Less simulated fluxes than logEn histogram bins.");
+      }
+    }
+
     // const int decbin_;
     // const BinName nhitbin_;
     //
@@ -226,6 +308,11 @@ class ResponseBin {
 
     std::vector<double> simFluxes_;
     std::vector<double> logEnBins_;
+
+    //contents of simEnSigHist_ by histogram bin index
+    std::vector<double> simSignal_;
+    //fluxes of the last reweighting, not applied to enSigHist_ yet
+    std::vector<double> enSigFluxes_;
 };
 SHARED_POINTER_TYPEDEFS(ResponseBin);
 
@@ -41,7 +41,8 @@ class SkyMapCollection {
           center_(defaultCenter_),
           radius_(defaultRadius_),
           minDec_(defaultMinDec_),
-          maxDec_(defaultMaxDec_) { }
+          maxDec_(defaultMaxDec_),
+          revision_(0) { }
 
     /// Constructor taking bin list.
     SkyMapCollection(const std::string& dir, const BinList& binList)
@@ -50,7 +51,8 @@ class SkyMapCollection {
           center_(defaultCenter_),
           radius_(defaultRadius_),
           minDec_(defaultMinDec_),
-          maxDec_(defaultMaxDec_) {
+          maxDec_(defaultMaxDec_),
+          revision_(0) {
       SetBins(binList);
     }
     
@@ -90,14 +92,17 @@ class SkyMapCollection {
     /// Deletes stored maps and loads maps for a given UTC range
     /// must set sky region and map directory first
     std::vector<std::string> LoadSiderealDayMaps(UTCDate start, UTCDate stop,
-                                                 std::string prefix="maptree");
+                                                 std::string prefix="maptree",
+                                                 unsigned nThreads = 1);
 
     /// Deletes stored maps and loads list of maps
     /// must set sky region and map directory first
-    void LoadMapList(std::vector<std::string> maptrees);
+    /// With nThreads > 1 (0 = one per core), the files are read and stacked
+    /// by several threads; the result only depends on the number of threads
+    void LoadMapList(std::vector<std::string> maptrees, unsigned nThreads = 1);
 
-    /// Deletes stored maps and loads maps from a MapTree file in a given
-    /// analysis-bin range. Optionally set transit signal fraction.
+    /// Deletes stored maps and loads maps from a MapTree or MapColumnFile in
+    /// a given analysis-bin range. Optionally set transit signal fraction.
     void LoadMaps(const std::string& file, const BinList& binList,
                   double transits = dontSetTransits_);
 
@@ -131,6 +136,11 @@ class SkyMapCollection {
                       WriteType writeType = WRITE_STANDARD,
                       bool poisson = false);
 
+    /// Stores event and background maps and BinInfo as MapColumnFile, which
+    /// LoadMaps reads pixel ranges from without going through ROOT
+    void WriteMapColumns(const std::string& filename,
+                         bool singlePrecision = false);
+
     /// Stores model maps to disk as MapTree
     void WriteModelMapTree(const std::string& filename, bool poisson = false) {
       WriteMapTree(filename, WRITE_MODEL, poisson);
@@ -158,6 +168,13 @@ class SkyMapCollection {
     /// Returns pointer to background-SkyMap for chosen bin
     SkyMap<double> *GetBackgroundMap(const BinName& nhbin);
 
+    /// Incremented whenever event or background maps are replaced in memory
+    unsigned GetRevision() const { return revision_; }
+
+    /// Call after changing event or background maps in place via the map
+    /// pointers, so that the cached data of the CalcBins are rebuilt
+    void MapsChanged() { ++revision_; }
+
     /// Returns nHit and g/h binning as map-typedef, see BinDefinitions.h
     AnalysisBinMap &GetBins() { return analysisBins_; }
 
@@ -218,12 +235,23 @@ class SkyMapCollection {
 
   private:
 
+    /// Loads maps and BinInfo of all bins from a MapTree file
+    void LoadMapTreeFile(const std::string& file);
+
+    /// Loads maps and BinInfo of all bins from a MapColumnFile
+    void LoadMapColumnFile(const std::string& file);
+
+    /// Returns the pixels of the sky region for the given nside/scheme
+    rangeset<int> QueryRegion(const Healpix_Base& base) const;
+
     /// Map setters
     void SetEventMap(const BinName& binName, const SkyMap<double> map) {
       eventMaps_[binName] = map;
+      ++revision_;
     }
     void SetBackgroundMap(const BinName& binName, const SkyMap<double> map) {
       backgroundMaps_[binName] = map;
+      ++revision_;
     }
     void SetModelMap(const BinName& binName, const SkyMap<double> map) {
       modelMaps_[binName] = map;
@@ -306,6 +334,22 @@ class SkyMapCollection {
     MapMap backgroundMaps_;
     AnalysisBinMap analysisBins_; // contains the cuts
     BinInfoMap binInfoMap_; // contains the durations
+    unsigned revision_; // see GetRevision()
+
+    /// Loads BinInfo of a MapTree or MapColumnFile into binInfoMap
+    void LoadBinInfo(const std::string& mtFile, bool reset,
+                     BinInfoMap& binInfoMap) const;
+
+    /// Reader thread of LoadMapList: adds the maps of files[i] for
+    /// i = worker, worker + nWorkers, ... to eventSums[worker] and
+    /// backgroundSums[worker] and keeps the BinInfo of each file
+    void StackMapFiles(const std::vector<std::string>& files,
+                       unsigned nWorkers,
+                       const std::vector<MapMap*>& eventSums,
+                       const std::vector<MapMap*>& backgroundSums,
+                       std::vector<BinInfoMap>& fileBinInfo,
+                       std::vector<int>& fileLoaded,
+                       unsigned worker) const;
 
 };
 #endif
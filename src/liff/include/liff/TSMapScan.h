@@ -0,0 +1,179 @@
+/*!
+ * @file TSMapScan.h
+ * @author agent
+ * @date 16 Oct 2026
+ * @brief Multi-threaded point source TS scan over a set of HEALPix pixels.
+ * @version $Id$
+ */
+
+#ifndef LIFF_TS_MAP_SCAN_H
+#define LIFF_TS_MAP_SCAN_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <liff/BinList.h>
+#include <liff/LikeHAWC.h>
+#include <liff/SkyMapCollection.h>
+#include <liff/TF1PointSource.h>
+#include <liff/ThreadPool.h>
+#include <liff/Util.h>
+
+/*!
+ * @class TSMapScan
+ * @author agent
+ * @date 16 Oct 2026
+ * @ingroup
+ * @brief Fits a point source at the centers of HEALPix pixels and collects
+ *        significance, flux and index maps (as HealpixSigFluxMap).
+ *
+ * The maps are loaded once and shared read-only by all threads. Every
+ * thread fits with its own workspace (spectrum, source, LikeHAWC, and
+ * copies of the response histograms and functions, which ROOT cannot
+ * evaluate from several threads at once). A workspace keeps its ROI and
+ * PSF caches from one position to the next. Positions are handed out in
+ * chunks of consecutive pixels, i.e. along HEALPix rings in RING ordering,
+ * so that a workspace mostly moves within a declination band of the
+ * response and along the ring of its PSF footprints (see CalcBin). The
+ * fit of a pixel starts from the same parameter values and errors (the
+ * MINUIT start steps) in every workspace, so the result does not depend on
+ * the number of threads.
+ *
+ * Results can be appended to a checkpoint file after every block of
+ * positions; a scan with an existing checkpoint file skips the pixels
+ * found in it, so an interrupted scan can be resumed.
+ */
+
+class TSMapScan {
+
+  public:
+
+    ///Fit result of one pixel
+    struct Result {
+      int pixel;
+      double ts;
+      double significance; ///<sqrt(TS), negative for a negative flux
+      double flux;         ///<Norm of the spectrum at the pivot
+      double fluxError;
+      double index;        ///<Spectral index, e.g. -2.63
+      double indexError;
+    };
+
+    ///Scans with the maps in data, which have to cover the scanned pixels
+    ///plus roiRadius (see SetDataRegion). The spectrum is given as for
+    ///MakeSpectrum, e.g. 'SimplePowerLaw,3.5e-11,2.63'; pivot in TeV,
+    ///roiRadius in degree, nThreads = 0 uses one thread per core.
+    TSMapScan(SkyMapCollection &data, const std::string &detRes,
+              const BinList &binList, const std::string &spectrum,
+              double pivot, double roiRadius, unsigned nThreads = 0);
+
+    ///Loads the part of the map tree needed to scan pixels of a RING map
+    ///with nside (nTransits < 0: duration from the map tree)
+    TSMapScan(const std::string &mapTreeFile, double nTransits,
+              const std::string &detRes, const BinList &binList,
+              const std::string &spectrum, double pivot, double roiRadius,
+              int nside, const std::vector<int> &pixels,
+              unsigned nThreads = 0);
+
+    ///Restricts data to the declination band of pixels (RING, nside), plus
+    ///radius [degree]
+    static void SetDataRegion(SkyMapCollection &data, int nside,
+                              const std::vector<int> &pixels, double radius);
+
+    ///Fit the background norms of all bins, too
+    void SetBackgroundNormFree(bool free = true);
+
+    ///Fit the spectral index, too
+    void SetIndexFree(bool free = true);
+
+    ///Appends the results to filename after every blockSize pixels, and
+    ///skips the pixels already in filename in the next Scan
+    void SetCheckpointFile(const std::string &filename,
+                           unsigned blockSize = 1024);
+
+    ///Fits the pixels of a RING map with nside; the results are added to
+    ///the ones of previous scans (with the same nside)
+    void Scan(int nside, const std::vector<int> &pixels);
+
+    ///Results of all scanned pixels, in order of the pixel number
+    std::vector<Result> GetResults() const;
+
+    ///Writes significance, flux, flux error, index and index error maps to
+    ///a FITS file in the format of HealpixSigFluxMap; pixels not scanned
+    ///are set to -5
+    void WriteFits(const std::string &filename) const;
+
+    SkyMapCollection &GetData() { return data_; };
+
+    unsigned GetNumberOfThreads() const { return pool_.GetNumberOfThreads(); };
+
+  private:
+
+    TSMapScan(const TSMapScan &);
+    TSMapScan &operator=(const TSMapScan &);
+
+    ///Fit setup of one thread
+    struct Workspace {
+      Func1Ptr spectrum;
+      boost::shared_ptr<threeML::TF1PointSource> source;
+      boost::shared_ptr<LikeHAWC> like;
+    };
+
+    ///Creates one workspace per thread, with the source at pixel
+    void CreateWorkspaces(int pixel);
+
+    ///Sets the free parameters of the fit
+    void SetupFit(Workspace &ws);
+
+    Workspace *CheckOut();
+
+    void CheckIn(Workspace *ws);
+
+    ///Task of Scan: fits pixels todo[first, ..., first+n-1]
+    void FitChunk(const std::vector<int> *todo, unsigned first, unsigned n,
+                  std::vector<Result> *results, unsigned chunk);
+
+    Result Fit(Workspace &ws, int pixel);
+
+    void ReadCheckpoint();
+
+    void WriteCheckpoint(const std::vector<Result> &results) const;
+
+    boost::shared_ptr<SkyMapCollection> ownedData_;
+    SkyMapCollection &data_;
+    std::string detRes_;
+    BinList binList_;
+    std::string spectrum_;
+    double pivot_;
+    double roiRadius_;
+    ThreadPool pool_;
+
+    bool backgroundNormFree_;
+    bool indexFree_;
+    std::string checkpointFile_;
+    unsigned blockSize_;
+
+    std::vector<Workspace> workspaces_;
+    std::vector<Workspace *> idle_;
+    boost::mutex idleMutex_;
+
+    //start values and errors of the fits
+    double startNorm_;
+    double startNormError_;
+    double startIndex_;
+    double startIndexError_;
+    std::vector<double> backgroundNorms_;
+    std::vector<double> backgroundNormErrors_;
+
+    int nside_;
+    std::map<int, Result> results_;
+
+};
+
+SHARED_POINTER_TYPEDEFS(TSMapScan);
+
+#endif
@@ -0,0 +1,80 @@
+/*!
+ * @file ThreadPool.h
+ * @author agent
+ * @date 16 Oct 2026
+ * @brief Minimal fixed-size pool of worker threads for indexed tasks.
+ * @version $Id$
+ */
+
+#ifndef LIFF_THREAD_POOL_H
+#define LIFF_THREAD_POOL_H
+
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <hawcnest/PointerTypedefs.h>
+
+/*!
+ * @class ThreadPool
+ * @author agent
+ * @date 16 Oct 2026
+ * @ingroup
+ * @brief Runs task(0) ... task(n-1) on a set of persistent worker threads.
+ *
+ * Run() blocks until all tasks are done; the calling thread works on tasks,
+ * too. Tasks are handed out in index order but may finish in any order, so
+ * callers that need reproducible results store one result per index and
+ * reduce them afterwards in index order. Run() must not be called from
+ * inside a task.
+ */
+
+class ThreadPool {
+
+  public:
+
+    typedef boost::function<void (unsigned)> Task;
+
+    ///Starts nThreads-1 workers (the caller is the n-th); 0 = one per core
+    explicit ThreadPool(unsigned nThreads = 0);
+
+    ~ThreadPool();
+
+    ///Number of threads working on tasks, including the caller of Run()
+    unsigned GetNumberOfThreads() const { return workers_.size() + 1; };
+
+    ///Calls task(i) for all i in [0, n) and waits for completion
+    void Run(unsigned n, const Task &task);
+
+  private:
+
+    ThreadPool(const ThreadPool &);
+    ThreadPool &operator=(const ThreadPool &);
+
+    void WorkerLoop();
+
+    void RunTasks();
+
+    std::vector<boost::thread *> workers_;
+
+    boost::mutex mutex_;
+    boost::condition_variable start_;
+    boost::condition_variable done_;
+
+    const Task *task_;
+    unsigned nTasks_;
+    unsigned next_;
+    unsigned pending_;
+    unsigned generation_;
+    bool stop_;
+    std::string error_;
+
+};
+
+SHARED_POINTER_TYPEDEFS(ThreadPool);
+
+#endif
@@ -0,0 +1,181 @@
+/*!
+ * @file MapColumnFile.h
+ * @author agent
+ * @date 16 Oct 2026
+ * @brief Columnar, memory-mapped storage of the data and background maps
+ *        of a set of analysis bins.
+ * @version $Id$
+ */
+
+#ifndef MAP_COLUMN_FILE_H
+#define MAP_COLUMN_FILE_H
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/cstdint.hpp>
+
+#include <healpix_base.h>
+
+/*!
+ * @class MapColumnFile
+ * @author agent
+ * @date 16 Oct 2026
+ * @ingroup
+ * @brief Read access to a map column file.
+ *
+ * A map column file holds, for each analysis bin, the stored pixel ranges of
+ * the data and background maps as contiguous float or double arrays, plus a
+ * directory with nside, scheme, the pixel-range index and the BinInfo
+ * entries. The file is memory-mapped, so reading part of the sky only
+ * touches the pages holding these pixels.
+ *
+ * Layout (native byte order, checked on reading):
+ *   header:    magic "LIFFMCOL", version, byte-order mark, value size,
+ *              number of bins, directory offset
+ *   arrays:    per bin, data values of all ranges, then background values
+ *   directory: per bin, name, nside, scheme, BinInfo, column offsets and
+ *              the sorted list of (begin, end, first value) pixel ranges
+ */
+
+class MapColumnFile {
+
+  public:
+
+    /// Map column inside an analysis bin
+    enum Column {
+      DATA = 0,
+      BACKGROUND = 1
+    };
+
+    /// Per-bin metadata, same entries as the BinInfo tree of MapTree files
+    struct BinInfo {
+      BinInfo()
+          : startMJD(0), stopMJD(0), nEvents(-1), totalDuration(24),
+            duration(2), maptype("unknown"), maxDur(-1), minDur(-1),
+            epoch("unknown") { }
+      double startMJD;
+      double stopMJD;
+      double nEvents;
+      double totalDuration;
+      double duration;
+      std::string maptype;
+      double maxDur;
+      double minDur;
+      std::string epoch;
+    };
+
+    /// Opens and memory-maps a map column file
+    explicit MapColumnFile(const std::string &filename);
+
+    /// Returns true if the file exists and starts with the format's magic
+    static bool IsMapColumnFile(const std::string &filename);
+
+    /// Returns the names of all bins, in the order they were written
+    const std::vector<std::string> &GetBinNames() const { return names_; }
+
+    /// Returns true if the bin is stored in the file
+    bool HasBin(const std::string &bin) const {
+      return bins_.find(bin) != bins_.end();
+    }
+
+    /// Returns nside of the maps of a bin
+    int Nside(const std::string &bin) const { return GetBin(bin).nside; }
+
+    /// Returns the ordering scheme of the maps of a bin
+    Healpix_Ordering_Scheme Scheme(const std::string &bin) const {
+      return (Healpix_Ordering_Scheme) GetBin(bin).scheme;
+    }
+
+    /// Returns the BinInfo entries of a bin
+    const BinInfo &GetBinInfo(const std::string &bin) const {
+      return GetBin(bin).info;
+    }
+
+    /// Returns the ranges of pixels stored for a bin
+    rangeset<int> GetStoredPixels(const std::string &bin) const;
+
+    /// Copies pixels [begin, end) of a column into out; pixels that are not
+    /// stored in the file are set to Healpix_undef
+    void ReadRange(const std::string &bin, Column column,
+                   int begin, int end, double *out) const;
+
+    /// Returns the file name
+    const std::string &GetFileName() const { return fname_; }
+
+  private:
+
+    struct PixelRange {
+      int begin;
+      int end;
+      boost::uint64_t first;
+    };
+
+    struct Bin {
+      int nside;
+      int scheme;
+      BinInfo info;
+      boost::uint64_t offset[2];
+      std::vector<PixelRange> ranges;
+    };
+
+    const Bin &GetBin(const std::string &bin) const;
+
+    std::string fname_;
+    boost::iostreams::mapped_file_source file_;
+    unsigned valueSize_;
+    std::vector<std::string> names_;
+    std::map<std::string, Bin> bins_;
+
+};
+
+/*!
+ * @class MapColumnWriter
+ * @author agent
+ * @date 16 Oct 2026
+ * @ingroup
+ * @brief Writes a map column file, one analysis bin at a time.
+ */
+
+class MapColumnWriter {
+
+  public:
+
+    /// Creates the file; values are stored as floats if singlePrecision
+    MapColumnWriter(const std::string &filename, bool singlePrecision = false);
+
+    /// Closes the file without writing the header if Close() was not
+    /// called, so that an incomplete file cannot be read
+    ~MapColumnWriter();
+
+    /// Adds a bin; data and bkg hold the values of all pixels in pixels,
+    /// in increasing pixel order
+    void AddBin(const std::string &bin, int nside,
+                Healpix_Ordering_Scheme scheme,
+                const rangeset<int> &pixels,
+                const std::vector<double> &data,
+                const std::vector<double> &bkg,
+                const MapColumnFile::BinInfo &info);
+
+    /// Writes the directory and closes the file
+    void Close();
+
+  private:
+
+    MapColumnWriter(const MapColumnWriter &);
+    MapColumnWriter &operator=(const MapColumnWriter &);
+
+    void WriteValues(const std::vector<double> &values);
+
+    std::string fname_;
+    std::ofstream out_;
+    unsigned valueSize_;
+    std::string directory_;
+    unsigned nBins_;
+
+};
+
+#endif
@@ -11,6 +11,9 @@
 
 #include <TFile.h>
 #include <TTree.h>
+#include <TBranch.h>
+#include <TBasket.h>
+#include <TBuffer.h>
 #include <TParameter.h>
 
 #include <healpix_map.h>
@@ -18,7 +21,9 @@
 #include <hawcnest/Logging.h>
 
 #include <sys/stat.h>
+#include <algorithm>
 #include <limits>
+#include <vector>
 
 /// A class to store Healpix_Map data in a root TTree
 class MapTree {
@@ -28,17 +33,26 @@ class MapTree {
   MapTree()
       : fname_(""),
         file_(0),
-        tree_(0) { }
+        tree_(0),
+        branch_(0),
+        loadedBasket_(-1),
+        cacheBegin_(-1) { }
 
   /// Constructs MapTree that by connecting to a Healpix_Map
   template<typename T>
   MapTree(Healpix_Map<T> &map)
       : fname_(""),
-        file_(0) { SetMap(map); }
+        file_(0),
+        branch_(0),
+        loadedBasket_(-1),
+        cacheBegin_(-1) { SetMap(map); }
 
   /// Constructs MapTree by opening a TTree in a TFile
   MapTree(std::string filename, std::string treename)
-      : file_(0) {
+      : file_(0),
+        branch_(0),
+        loadedBasket_(-1),
+        cacheBegin_(-1) {
     if (!OpenFile(filename)) {
       log_fatal("TFile " << filename << " does not exist.")
     }
@@ -51,6 +65,7 @@ class MapTree {
   void SetMap(Healpix_Map<double> &map) {
     map_ = map;
     tree_ = 0;
+    branch_ = 0;
   }
 
   /// Copy contents from Healpix_Map and convert to doubles
@@ -60,6 +75,7 @@ class MapTree {
       map_[p] = (double) map[p];
     }
     tree_ = 0;
+    branch_ = 0;
   }
 
   /// Copy contents from Healpix_Map and convert to doubles
@@ -69,6 +85,7 @@ class MapTree {
       map_[p] = (double) map[p];
     }
     tree_ = 0;
+    branch_ = 0;
   }
 
   /// Open TFile; return true if TFile exists, false if not
@@ -113,6 +130,9 @@ class MapTree {
       log_fatal("No TFile open, do OpenFile(name) first.");
     }
     tree_ = 0;
+    branch_ = 0;
+    loadedBasket_ = -1;
+    cacheBegin_ = -1;
     map_.Set(0, string2HealpixScheme("RING")); //clear map
     file_->GetObject(treename.c_str(), tree_);
     if (tree_) {
@@ -121,6 +141,7 @@ class MapTree {
       Healpix_Ordering_Scheme scheme = (Healpix_Ordering_Scheme) si->GetVal();
       map_.SetNside(nside->GetVal(), scheme);
       tree_->SetBranchAddress("count", &count_);
+      branch_ = tree_->GetBranch("count");
       return true;
     }
     log_warn("Cannot open MapTree " << treename << " in file " << file_->GetName())
@@ -155,13 +176,81 @@ class MapTree {
     return count_;
   }
 
+  /// Copies the values of pixels [begin, end) into out. Reads whole
+  /// baskets of the count branch through a TTreeCache instead of calling
+  /// GetEntry for every pixel. The last basket read is kept until a read
+  /// moves past it, so consecutive ranges in one basket, e.g. the rings of
+  /// a RING ROI, only decompress it once.
+  template<typename T>
+  void ReadRange(int begin, int end, T *out) {
+    if ((begin < 0) || (end > Npix()) || (begin > end)) {
+      log_fatal("Pixel range [" << begin << ", " << end << ") outside map"
+                    << " with " << Npix() << " pixels.");
+    }
+    if (!tree_) {
+      for (int p = begin; p < end; p++) {
+        out[p - begin] = (T) map_[p];
+      }
+      return;
+    }
+    if (begin == end) {
+      return;
+    }
+
+    if (tree_->GetCacheSize() < cacheSize_) {
+      tree_->SetCacheSize(cacheSize_);
+      tree_->AddBranchToCache(branch_, kTRUE);
+      cacheBegin_ = -1;
+    }
+    // ranges are usually read in increasing order: cache up to the end of
+    // the map and only restart the cache when a read goes backwards
+    if ((cacheBegin_ < 0) || (begin < cacheBegin_)) {
+      tree_->SetCacheEntryRange(begin, Npix());
+      cacheBegin_ = begin;
+    }
+
+    std::vector<double> buf;
+    Long64_t *basketEntry = branch_->GetBasketEntry();
+    int nBaskets = branch_->GetWriteBasket();
+    int b = std::upper_bound(basketEntry, basketEntry + nBaskets,
+                             (Long64_t) begin) - basketEntry - 1;
+    int p = begin;
+    for (; (p < end) && (b >= 0) && (b < nBaskets); b++) {
+      int first = basketEntry[b];
+      int last = std::min((Long64_t) end, basketEntry[b + 1]);
+      if (b != loadedBasket_) {
+        branch_->DropBaskets("all");
+        loadedBasket_ = b;
+      }
+      tree_->LoadTree(p);
+      TBasket *basket = branch_->GetBasket(b);
+      if (!basket || basket->GetEntryOffset() ||
+          (basket->GetNevBufSize() != (Int_t) sizeof(double))) {
+        // not a plain array of doubles, use the generic reader below
+        break;
+      }
+      // fixed-size entries are stored back-to-back after the key header
+      TBuffer *bufRef = basket->GetBufferRef();
+      bufRef->SetBufferOffset(basket->GetKeylen() +
+                              (p - first) * sizeof(double));
+      buf.resize(last - p);
+      bufRef->ReadFastArray(&buf[0], last - p);
+      for (int i = 0; i < last - p; i++) {
+        out[p - begin + i] = (T) buf[i];
+      }
+      p = last;
+    }
+    // remaining entries, e.g. in a basket that is still held by the TTree
+    for (; p < end; p++) {
+      out[p - begin] = (T) GetPixel(p);
+    }
+  }
+
   /// Returns full Healpix_map, cast required
   template<typename T>
   Healpix_Map<T> GetMap() {
     Healpix_Map<T> map(Nside(), Scheme(), SET_NSIDE);
-    for (int p = 0; p < Npix(); p++) {
-      map[p] = (T) GetPixel(p);
-    }
+    ReadRange(0, Npix(), &map[0]);
     return map;
   }
 
@@ -218,9 +307,14 @@ class MapTree {
 
  private:
 
+  static const Long64_t cacheSize_ = 64 * 1024 * 1024;
+
   std::string fname_;
   TFile *file_;
   TTree *tree_;
+  TBranch *branch_;
+  int loadedBasket_;     // basket of branch_ kept by ReadRange, -1 if none
+  Long64_t cacheBegin_;  // first entry of the TTreeCache range, -1 if none
   Healpix_Map<double> map_;
   double count_;
 
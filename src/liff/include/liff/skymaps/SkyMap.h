@@ -12,50 +12,80 @@
 #include <healpix_base.h>
 #include <healpix_map.h>
 
+#include <boost/cstdint.hpp>
+
 #include <liff/skymaps/MapTree.h>
+#include <liff/skymaps/MapColumnFile.h>
 
 const int outpix = -1;
 
 /// A (partial) sky map of a given datatype
+///
+/// The pixel values are kept in one contiguous buffer of "slots", in
+/// increasing pixel order. A pixel is mapped to its slot via a table of
+/// the first interval of the rangeset in each block of pixels, sized to a
+/// quarter of the number of pixels, so the lookup does not depend on the
+/// number of intervals of fragmented ranges (masks, strips, polygons).
+/// Loops over all pixels can walk the slots directly.
 template<typename T>
 class SkyMap: public Healpix_Base {
 
  public:
 
-  SkyMap() : outside_(outpix) { }
+  SkyMap()
+      : outside_(outpix), firstPix_(0), endPix_(0), indexShift_(0) { }
 
   /// Constructs an empty SkyMap for a rangeset of pixels
   SkyMap(rangeset<int> &pixset, int nside, Healpix_Ordering_Scheme scheme)
-      : outside_(outpix) { SetPixelRange(pixset, nside, scheme); }
+      : outside_(outpix), firstPix_(0), endPix_(0), indexShift_(0) {
+    SetPixelRange(pixset, nside, scheme);
+  }
 
   /// Constructs a partial map from a healpix map and a rangeset of pixels
   SkyMap(Healpix_Map<T> &map, rangeset<int> &pixset)
-      : outside_(outpix) { SetFromMap(map, pixset); }
+      : outside_(outpix), firstPix_(0), endPix_(0), indexShift_(0) {
+    SetFromMap(map, pixset);
+  }
 
   /// Constructs a map of a disc for given center/radius from a healpix map
   SkyMap(Healpix_Map<T> &map, pointing ptg, double radius)
-      : outside_(outpix) { DiscFromMap(map, ptg, radius); }
+      : outside_(outpix), firstPix_(0), endPix_(0), indexShift_(0) {
+    DiscFromMap(map, ptg, radius);
+  }
 
   /// Constructs a partial map from a MapTree and a rangeset of pixels
   SkyMap(MapTree &tree, rangeset<int> &pixset)
-      : outside_(outpix) { SetFromTree(tree, pixset); }
+      : outside_(outpix), firstPix_(0), endPix_(0), indexShift_(0) {
+    SetFromTree(tree, pixset);
+  }
 
   /// Constructs a map of a disc for given center/radius from a MapTree
   SkyMap(MapTree &tree, pointing ptg, double radius)
-      : outside_(outpix) { DiscFromTree(tree, ptg, radius); }
+      : outside_(outpix), firstPix_(0), endPix_(0), indexShift_(0) {
+    DiscFromTree(tree, ptg, radius);
+  }
+
+  /// Constructs a partial map from a column of a bin in a MapColumnFile
+  SkyMap(const MapColumnFile &file, const std::string &bin,
+         MapColumnFile::Column column, rangeset<int> &pixset)
+      : outside_(outpix), firstPix_(0), endPix_(0), indexShift_(0) {
+    SetFromColumn(file, bin, column, pixset);
+  }
 
   /// Deletes the old map and creates a new map with a given order/scheme.
   void Set(int order, Healpix_Ordering_Scheme scheme) {
     Healpix_Base::Set(order, scheme);
-    maps_.clear();
+    values_.clear();
     pixels_.clear();
+    BuildIndex();
   }
 
   /// Deletes the old map and creates a new map with a given nside/scheme
   void SetNside(int nside, Healpix_Ordering_Scheme scheme) {
     Healpix_Base::SetNside(nside, scheme);
-    maps_.clear();
+    values_.clear();
     pixels_.clear();
+    BuildIndex();
   }
 
   /// Deletes old map and creates an empty map with a given pixel range.
@@ -76,12 +106,16 @@ class SkyMap: public Healpix_Base {
   /// Keep the same rangeset, fill map with zeros
   void Empty();
 
-  /// Add values from another SkyMap, must have same rangeset
-  void Add(const SkyMap map);
+  /// Add values from another SkyMap times scale, must have same rangeset
+  void Add(const SkyMap &map, T scale = 1);
 
   /// Fluctuate the map using Poisson statistics
   void PoissonFluctuate();
 
+  /// Reproducible Poisson fluctuation: the pixels are drawn in increasing
+  /// order from RNGStream(seed, stream); pixels <= 0 are kept
+  void PoissonFluctuate(boost::uint64_t seed, boost::uint64_t stream);
+
   /// Adds Healpix_Map values for pixels in the SkyMap rangeset.
   void AddHealpixMap(Healpix_Map<T> &map, bool poisson=false);
 
@@ -99,6 +133,10 @@ class SkyMap: public Healpix_Base {
     SetFromTree(tree, disc);
   }
 
+  /// Deletes the old map and copies given pixel range from a MapColumnFile.
+  void SetFromColumn(const MapColumnFile &file, const std::string &bin,
+                     MapColumnFile::Column column, rangeset<int> &pixset);
+
   /// Adds MapTree values for pixels in the SkyMap rangeset.
   void AddMapTree(MapTree &tree);
 
@@ -134,6 +172,9 @@ class SkyMap: public Healpix_Base {
   /// Returns the number of defined pixels
   int GetPixelNumber() const { return pixels_.nval(); }
 
+  /// Returns the values of all defined pixels in increasing pixel order
+  std::vector<T> GetPixelValues() const;
+
   /// Writes SkyMap as a MapTree into a TFile and returns number of pixels
   const int WriteTreeFile
       (std::string filename, std::string treename) const;
@@ -144,10 +185,60 @@ class SkyMap: public Healpix_Base {
   /// Returns the sum of all pixels
   T GetSum() const;
 
+  /// Returns the number of slots, i.e. of defined pixels
+  int GetNumberOfSlots() const { return values_.size(); }
+
+  /// Returns the slot of the pixel indexed by its healpix number, or -1 if
+  /// the pixel is outside the SkyMap range
+  int GetSlot(int pix) const {
+    if (pix < firstPix_ || pix >= endPix_) return -1;
+    // binary search among the intervals overlapping the block of pix
+    const int b = (pix - firstPix_) >> indexShift_;
+    tsize i = index_[b];
+    tsize hi = index_[b + 1];
+    while (i < hi) {
+      const tsize mid = (i + hi) / 2;
+      if (pixels_.ivend(mid) <= pix) {
+        i = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    if (pix < pixels_.ivbegin(i)) return -1;
+    return offsets_[i] + (pix - pixels_.ivbegin(i));
+  }
+
+  /// Returns the healpix number of a slot
+  int GetSlotPixel(int slot) const;
+
+  /// Returns the value of a slot
+  const T &GetSlotValue(int slot) const { return values_[slot]; }
+
+  /// Changes the value of a slot
+  void SetSlotValue(int slot, T value) { values_[slot] = value; }
+
+  /// Adds the value to a slot
+  void AddToSlot(int slot, T value) { values_[slot] += value; }
+
  private:
-  std::vector<arr<T> > maps_;
+
+  /// Sets up the slot offsets and the pixel to slot table for pixels_
+  void BuildIndex();
+
+  /// Values of all defined pixels, in increasing pixel order
+  std::vector<T> values_;
   rangeset<int> pixels_;
   T outside_;
 
+  /// First slot of each interval of pixels_
+  std::vector<int> offsets_;
+  /// First interval ending after the first pixel of each block, plus the
+  /// last interval
+  std::vector<int> index_;
+  /// Pixels covered by the table and log2 of the block size
+  int firstPix_;
+  int endPix_;
+  int indexShift_;
+
 };
 #endif
@@ -0,0 +1,104 @@
+/*!
+ * @file BatchModelInterface.cc
+ * @author agent
+ * @date 16 Oct 2026
+ * @brief Vectorized extension of the ModelInterface for extended sources.
+ * @version $Id$
+ */
+
+#include <liff/BatchModelInterface.h>
+
+#include <hawcnest/Logging.h>
+
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+  void CheckPositions(const vector<double> &ra, const vector<double> &dec) {
+    if (ra.size() != dec.size()) {
+      log_fatal("Got " << ra.size() << " RA but " << dec.size()
+                << " Dec coordinates.");
+    }
+  }
+
+  void ScalarFluxes(const threeML::ModelInterface &mi, int srcid,
+                    const vector<double> &ra, const vector<double> &dec,
+                    const vector<double> &energies, vector<double> &fluxes) {
+    const unsigned nEnergies = energies.size();
+    fluxes.resize(ra.size() * nEnergies);
+    for (unsigned i = 0; i < ra.size(); ++i) {
+      const vector<double> f =
+          mi.getExtendedSourceFluxes(srcid, ra[i], dec[i], energies);
+      if (f.size() != nEnergies) {
+        log_fatal("ModelInterface returned " << f.size() << " fluxes for "
+                  << nEnergies << " energies.");
+      }
+      copy(f.begin(), f.end(), fluxes.begin() + i * nEnergies);
+    }
+  }
+
+  void ScalarInside(const threeML::ModelInterface &mi,
+                    const vector<double> &ra, const vector<double> &dec,
+                    vector<char> &inside) {
+    inside.resize(ra.size());
+    for (unsigned i = 0; i < ra.size(); ++i) {
+      inside[i] = mi.isInsideAnyExtendedSource(ra[i], dec[i]);
+    }
+  }
+
+}
+
+namespace threeML {
+
+  void BatchModelInterface::getExtendedSourceFluxesBatch(
+      int srcid, const vector<double> &j2000_ra,
+      const vector<double> &j2000_dec, const vector<double> &energies,
+      vector<double> &fluxes) const {
+    ScalarFluxes(*this, srcid, j2000_ra, j2000_dec, energies, fluxes);
+  }
+
+  void BatchModelInterface::isInsideAnyExtendedSourceBatch(
+      const vector<double> &j2000_ra, const vector<double> &j2000_dec,
+      vector<char> &inside) const {
+    ScalarInside(*this, j2000_ra, j2000_dec, inside);
+  }
+
+  void BatchModelInterface::GetExtendedSourceFluxes(
+      const ModelInterface &mi, int srcid, const vector<double> &ra,
+      const vector<double> &dec, const vector<double> &energies,
+      vector<double> &fluxes) {
+    CheckPositions(ra, dec);
+    const BatchModelInterface *batch =
+        dynamic_cast<const BatchModelInterface *>(&mi);
+    if (!batch) {
+      ScalarFluxes(mi, srcid, ra, dec, energies, fluxes);
+      return;
+    }
+    batch->getExtendedSourceFluxesBatch(srcid, ra, dec, energies, fluxes);
+    if (fluxes.size() != ra.size() * energies.size()) {
+      log_fatal("ModelInterface returned " << fluxes.size() << " fluxes for "
+                << ra.size() << " positions and " << energies.size()
+                << " energies.");
+    }
+  }
+
+  void BatchModelInterface::IsInsideAnyExtendedSource(
+      const ModelInterface &mi, const vector<double> &ra,
+      const vector<double> &dec, vector<char> &inside) {
+    CheckPositions(ra, dec);
+    const BatchModelInterface *batch =
+        dynamic_cast<const BatchModelInterface *>(&mi);
+    if (!batch) {
+      ScalarInside(mi, ra, dec, inside);
+      return;
+    }
+    batch->isInsideAnyExtendedSourceBatch(ra, dec, inside);
+    if (inside.size() != ra.size()) {
+      log_fatal("ModelInterface returned " << inside.size() << " inside "
+                << "flags for " << ra.size() << " positions.");
+    }
+  }
+
+}
@@ -14,6 +14,7 @@
 #include <hawcnest/CommandLineConfigurator.h>
 #include <hawcnest/Logging.h>
 #include <liff/BinList.h>
+#include <liff/skymaps/MapColumnFile.h>
 
 #include <boost/lexical_cast.hpp>
 #include <boost/make_shared.hpp>
@@ -46,6 +47,11 @@ BinList::BinList(const vector<BinIndex>& index) : name_(index.size()) {
 
 BinList::BinList(const string& mapFileName) {
 
+  if (MapColumnFile::IsMapColumnFile(mapFileName)) {
+    name_ = MapColumnFile(mapFileName).GetBinNames();
+    return;
+  }
+
   TFile mapFile(mapFileName.c_str());
   if (!mapFile.IsOpen())
     log_fatal("Could not open map-tree file " << mapFileName << ".")
@@ -11,6 +11,7 @@
 #include <liff/SkyMapCollection.h>
 
 #include <liff/ROI.h>
+#include <liff/PoissonLikelihood.h>
 
 #include <hawcnest/HAWCUnits.h>
 
@@ -19,6 +20,8 @@
 #include <data-structures/astronomy/GalPoint.h>
 #include <data-structures/astronomy/AstroCoords.h>
 
+#include <algorithm>
+
 using namespace std;
 using namespace HAWCUnits;
 
@@ -55,6 +58,26 @@ namespace {
 }
 
 bool notSequential(int a, int b) { return (a + 1) != b; }
+
+namespace {
+
+  // Number of consecutive calls of UpdateModelCounts without a change after
+  // which a dynamic source is summed into the static model counts again
+  const unsigned staticAfterUnchangedCalls = 50;
+
+  bool SameRanges(const rangeset<int> &a, const rangeset<int> &b) {
+    if (a.size() != b.size()) {
+      return false;
+    }
+    for (tsize k = 0; k < a.size(); ++k) {
+      if ((a.ivbegin(k) != b.ivbegin(k)) || (a.ivend(k) != b.ivend(k))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+}
 bool GPD_ = false; /// will be moved later...
 
 /*****************************************************/
@@ -65,7 +88,11 @@ CalcBin::CalcBin(const BinName& binID,
                  InternalModelPtr internalModel,
                  vector<SkyPos> roi
                  )
-    : binID_(binID), pointSources_(pointSources), extendedSources_(extendedSources) {
+    : binID_(binID), pointSources_(pointSources), extendedSources_(extendedSources),
+      skyMaps_(skyMaps), internal_(internalModel), roiCompiled_(false),
+      roiDataRevision_(0), roiBGRevision_(0), roiFitLogFactorialSum_(0),
+      roiNegativeBG_(0), chunkSize_(0), roiRevision_(0),
+      staticRoiRevision_(0) {
 
   //Set skyMaps
   eventMap_ = skyMaps->GetEventMap(binID_);
@@ -113,6 +140,9 @@ void CalcBin::SetROIPixels(vector<SkyPos> roi) {
   if (!eventMap_) {
     log_fatal("No data-map defined for CalcBin with ID " << binID_);
   }
+  //the compiled ROI (and everything derived from it) is kept if the
+  //pixels do not change, e.g. if the sources moved within the ROI
+  const rangeset<int> previousPix = roiPix_;
   roiPix_.clear();
   //galactic plane diffuse model
   if (GPD_) {
@@ -140,6 +170,9 @@ void CalcBin::SetROIPixels(vector<SkyPos> roi) {
   }
 
   log_debug("Number of ROI pixels: " << roiPix_.nval());
+  if (!SameRanges(previousPix, roiPix_)) {
+    roiCompiled_ = false;
+  }
   
   //check if SkyMapCollection region contains all of ROI:
   if (!skyMapPixels_.contains(roiPix_)) {
@@ -230,6 +263,7 @@ void CalcBin::SetROIPixels(string mask, double threshold) {
     log_fatal("No data-map defined for CalcBin with ID " << binID_);
   }
   roiPix_.clear();
+  roiCompiled_ = false;
 
   /*
   //with map-maker dependency, using RoIMask class:
@@ -349,11 +383,17 @@ double CalcBin::GetPerPixelExpectedExcess(int hp) {
 
   }
 
+  return GetPerPixelExpectedExcess(hp, *pixelCenter);
+}
+
+/*****************************************************/
+double CalcBin::GetPerPixelExpectedExcess(int hp, const SkyPos &pixelCenter) {
+
   double counts = 0.;
   log_trace("Source list sizes: "<<pointSources_.size()<<" and "<<extendedSources_.size());
   for (unsigned s = 0; s < pointSources_.size(); s++) {
     PointSourceDetectorResponsePtr ps = pointSources_[s];
-    double distance = pixelCenter->Angle(ps->GetSkyPos());
+    double distance = pixelCenter.Angle(ps->GetSkyPos());
     counts += ps->GetSmearedSignal(distance, pixelArea_, binID_);
   }
   for (unsigned s = 0; s < extendedSources_.size(); s++) {
@@ -364,8 +404,8 @@ double CalcBin::GetPerPixelExpectedExcess(int hp) {
     //const AstroService& astroX = GetService<AstroService>("astroX");
     EquPoint cel;
     GalPoint gal;
-    double RA = SkyPos(eventMap_->pix2ang(hp)).RA();
-    double dec = SkyPos(eventMap_->pix2ang(hp)).Dec();
+    double RA = pixelCenter.RA();
+    double dec = pixelCenter.Dec();
     cel.SetRADec(RA*HAWCUnits::degree, dec*HAWCUnits::degree);
     equ2gal(cel, gal);
     //astroX.Equ2Gal(cel, gal);
@@ -382,6 +422,320 @@ double CalcBin::GetPerPixelExpectedExcess(int hp) {
   }
 }
 
+/*****************************************************/
+// The point-source part of GetPerPixelExpectedExcess only depends on the
+// spectrum through GetExpectedSignal, so the per-pixel distances and PSF
+// lookups are done once per source position here and reused until the
+// source moves, its PSF cache is cleared, or the ROI changes.
+void CalcBin::UpdatePsfTemplates() {
+
+  CompileROI();
+
+  psfTemplates_.resize(pointSources_.size());
+  for (unsigned s = 0; s < pointSources_.size(); s++) {
+    PointSourceDetectorResponsePtr ps = pointSources_[s];
+    PsfTemplate &tmpl = psfTemplates_[s];
+    if ((tmpl.source == ps.get()) &&
+        (tmpl.psfRevision == ps->GetPsfRevision()) &&
+        (tmpl.roiRevision == roiRevision_)) {
+      continue;
+    }
+
+    tmpl.source = ps.get();
+    tmpl.psfRevision = ps->GetPsfRevision();
+    tmpl.roiRevision = roiRevision_;
+    if (TranslatePsfFootprint(*ps, tmpl)) {
+      log_debug("CalcBin " << binID_ << ": PSF template of point source "
+                << ps->GetSourceID() << " translated along ring "
+                << tmpl.footprint.ring << ".");
+      continue;
+    }
+
+    tmpl.pix.clear();
+    tmpl.density.clear();
+
+    const SkyPos sourcePos = ps->GetSkyPos();
+    for (unsigned i = 0; i < roiPixIds_.size(); ++i) {
+      double density = ps->GetPixelatedPsfDensity(
+          roiPixCenters_[i].Angle(sourcePos), pixelArea_, binID_);
+      if (density != 0.) {
+        tmpl.pix.push_back(i);
+        tmpl.density.push_back(density);
+      }
+    }
+    log_debug("CalcBin " << binID_ << ": PSF template of point source "
+              << ps->GetSourceID() << " covers " << tmpl.pix.size()
+              << " ROI pixels.");
+  }
+}
+
+/*****************************************************/
+// In a scan over pixel centers, the source moves along HEALPix rings. The
+// footprint of the first pixel of a ring is rotated to the others, which
+// replaces the distance and PSF lookup per ROI pixel by an index shift.
+// The densities only differ from the direct calculation by the rounding
+// of the distances.
+bool CalcBin::TranslatePsfFootprint(PointSourceDetectorResponse &ps,
+                                    PsfTemplate &tmpl) {
+
+  if (eventMap_->Scheme() != RING) {
+    return false;
+  }
+  const SkyPos sourcePos = ps.GetSkyPos();
+  const int hp = eventMap_->ang2pix(sourcePos.GetPointing());
+  if (sourcePos.Angle(SkyPos(eventMap_->pix2ang(hp))) > 1e-6) {
+    return false; //not at a pixel center, e.g. in a position fit
+  }
+
+  PsfFootprint &fp = tmpl.footprint;
+  if ((fp.source != &ps) ||
+      (fp.pixelatedPsfRevision != ps.GetPixelatedPsfRevision()) ||
+      (fp.ring != eventMap_->pix2ring(hp))) {
+    BuildPsfFootprint(ps, hp, fp);
+  }
+
+  //rotation in pixels of the source ring, and of each footprint ring
+  int start, nPix;
+  double theta;
+  bool shifted;
+  eventMap_->get_ring_info2(fp.ring, start, nPix, theta, shifted);
+  const long k = (hp - start) - fp.ringIndex;
+  vector<int> shifts(fp.rings.size());
+  for (unsigned r = 0; r < fp.rings.size(); ++r) {
+    const long n = fp.ringSize[r];
+    if ((k * n) % fp.ringPixels != 0) {
+      return false; //pixel grids do not match (polar caps)
+    }
+    shifts[r] = (int) ((((k * n) / fp.ringPixels) % n + n) % n);
+  }
+
+  //rings are in increasing pixel order; within a ring, the entries
+  //wrapping past the end of the ring come first
+  tmpl.pix.clear();
+  tmpl.density.clear();
+  vector<int>::const_iterator roi = roiPixIds_.begin();
+  const vector<int>::const_iterator roiEnd = roiPixIds_.end();
+  for (unsigned r = 0; r < fp.rings.size(); ++r) {
+    const int n = fp.ringSize[r];
+    const unsigned wrap =
+        lower_bound(fp.index.begin() + fp.ringFirst[r],
+                    fp.index.begin() + fp.ringFirst[r + 1], n - shifts[r])
+        - fp.index.begin();
+    for (unsigned pass = 0; pass < 2; ++pass) {
+      const unsigned first = (pass == 0) ? wrap : fp.ringFirst[r];
+      const unsigned last = (pass == 0) ? fp.ringFirst[r + 1] : wrap;
+      const int offset = fp.ringStart[r] + shifts[r] - ((pass == 0) ? n : 0);
+      for (unsigned e = first; e < last; ++e) {
+        const int pix = offset + fp.index[e];
+        if ((roi != roiEnd) && (*roi < pix)) {
+          roi = lower_bound(roi, roiEnd, pix);
+        }
+        if ((roi != roiEnd) && (*roi == pix)) {
+          tmpl.pix.push_back(roi - roiPixIds_.begin());
+          tmpl.density.push_back(fp.density[e]);
+          ++roi;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+/*****************************************************/
+
+void CalcBin::BuildPsfFootprint(PointSourceDetectorResponse &ps, int hp,
+                                PsfFootprint &fp) {
+
+  int start, nPix;
+  double theta;
+  bool shifted;
+  fp.source = &ps;
+  fp.pixelatedPsfRevision = ps.GetPixelatedPsfRevision();
+  fp.ring = eventMap_->pix2ring(hp);
+  eventMap_->get_ring_info2(fp.ring, start, nPix, theta, shifted);
+  fp.ringIndex = hp - start;
+  fp.ringPixels = nPix;
+  fp.rings.clear();
+  fp.ringStart.clear();
+  fp.ringSize.clear();
+  fp.ringFirst.clear();
+  fp.index.clear();
+  fp.density.clear();
+
+  //all pixels closer than the outer edge of the pixelated PSF
+  const SkyPos sourcePos = ps.GetSkyPos();
+  const double radius = ps.GetPixelatedPsfRadius(pixelArea_, binID_);
+  rangeset<int> disc;
+  eventMap_->query_disc(sourcePos.GetPointing(), radius * degree, disc);
+  for (tsize i = 0; i < disc.size(); ++i) {
+    for (int j = disc.ivbegin(i); j < disc.ivend(i); ++j) {
+      const double density = ps.GetPixelatedPsfDensity(
+          SkyPos(eventMap_->pix2ang(j)).Angle(sourcePos), pixelArea_, binID_);
+      if (density == 0.) {
+        continue;
+      }
+      if (fp.rings.empty() ||
+          (j >= fp.ringStart.back() + fp.ringSize.back())) {
+        const int ring = eventMap_->pix2ring(j);
+        eventMap_->get_ring_info2(ring, start, nPix, theta, shifted);
+        fp.rings.push_back(ring);
+        fp.ringStart.push_back(start);
+        fp.ringSize.push_back(nPix);
+        fp.ringFirst.push_back(fp.index.size());
+      }
+      fp.index.push_back(j - fp.ringStart.back());
+      fp.density.push_back(density);
+    }
+  }
+  fp.ringFirst.push_back(fp.index.size());
+  log_debug("CalcBin " << binID_ << ": PSF footprint of point source "
+            << ps.GetSourceID() << " on ring " << fp.ring << " covers "
+            << fp.index.size() << " pixels in " << fp.rings.size()
+            << " rings.");
+}
+
+/*****************************************************/
+bool CalcBin::SourceState::Update(const void *src, unsigned revision) {
+
+  const bool replaced = (src != source);
+  const bool wasStatic = isStatic;
+  if (replaced) {
+    isStatic = true;
+    unchangedCalls = 0;
+  }
+  else if (revision != modelRevision) {
+    isStatic = false;
+    unchangedCalls = 0;
+  }
+  else if (!isStatic && (++unchangedCalls >= staticAfterUnchangedCalls)) {
+    isStatic = true;
+  }
+  source = src;
+  modelRevision = revision;
+  return replaced || (isStatic != wasStatic);
+}
+
+/*****************************************************/
+// Called serially before the (possibly concurrent) CalcExpectedExcess calls.
+// Sources are split into a static set, summed once into roiStaticCounts_,
+// and a dynamic set that is re-added in every call. New sources start out
+// static; a source whose model revision changes moves to the dynamic set and
+// stays there until it was unchanged in staticAfterUnchangedCalls calls. The
+// sum is thus rebuilt only when a static source changes, a dynamic one
+// settles or the sources or the ROI are replaced, not whenever MINUIT steps
+// a different one of several free sources.
+void CalcBin::UpdateModelCounts() {
+
+  UpdatePsfTemplates();
+
+  const bool roiChanged = (staticRoiRevision_ != roiRevision_);
+  bool rebuild = roiChanged ||
+                 (pointSourceStates_.size() != pointSources_.size()) ||
+                 (extendedSourceStates_.size() != extendedSources_.size());
+  pointSourceStates_.resize(pointSources_.size());
+  extendedSourceStates_.resize(extendedSources_.size());
+  roiExtendedCounts_.resize(extendedSources_.size());
+
+  for (unsigned s = 0; s < pointSources_.size(); s++) {
+    rebuild |= pointSourceStates_[s].Update(
+        pointSources_[s].get(), pointSources_[s]->GetModelRevision());
+  }
+
+  for (unsigned s = 0; s < extendedSources_.size(); s++) {
+    SourceState &state = extendedSourceStates_[s];
+    const unsigned revision = state.modelRevision;
+    const void *source = state.source;
+    rebuild |= state.Update(extendedSources_[s].get(),
+                            extendedSources_[s]->GetModelRevision());
+    if ((source != state.source) || (revision != state.modelRevision) ||
+        roiChanged) {
+      extendedSources_[s]->PrepareConvolutedSignal(binID_, nside_, roiPix_);
+      vector<double> &counts = roiExtendedCounts_[s];
+      counts.resize(roiPixIds_.size());
+      for (unsigned i = 0; i < roiPixIds_.size(); ++i) {
+        counts[i] = extendedSources_[s]->GetExtendedSourceConvolutedSignal(
+            binID_, nside_, roiPix_, roiPixIds_[i]);
+      }
+    }
+  }
+
+  if (!rebuild) {
+    return;
+  }
+
+  roiStaticCounts_.assign(roiPixIds_.size(), 0.);
+  unsigned nStatic = 0;
+  for (unsigned s = 0; s < pointSources_.size(); s++) {
+    if (pointSourceStates_[s].isStatic) {
+      const PsfTemplate &tmpl = psfTemplates_[s];
+      const double signal = pointSources_[s]->GetExpectedSignal(binID_);
+      for (unsigned k = 0; k < tmpl.pix.size(); ++k) {
+        roiStaticCounts_[tmpl.pix[k]] += tmpl.density[k] * signal;
+      }
+      ++nStatic;
+    }
+  }
+  for (unsigned s = 0; s < extendedSources_.size(); s++) {
+    if (extendedSourceStates_[s].isStatic) {
+      const vector<double> &counts = roiExtendedCounts_[s];
+      for (unsigned i = 0; i < roiPixIds_.size(); ++i) {
+        roiStaticCounts_[i] += counts[i];
+      }
+      ++nStatic;
+    }
+  }
+  staticRoiRevision_ = roiRevision_;
+  log_debug("CalcBin " << binID_ << ": " << nStatic << " of "
+            << pointSources_.size() + extendedSources_.size()
+            << " source(s) in the static model counts.");
+}
+
+/*****************************************************/
+void CalcBin::CalcExpectedExcess(unsigned begin, unsigned end,
+                                 double norm) {
+
+  if (GPD_) {
+    for (unsigned i = begin; i < end; ++i) {
+      roiExcess_[i] = GetPerPixelExpectedExcess(roiPixIds_[i],
+                                                roiPixCenters_[i]);
+    }
+    return;
+  }
+
+  for (unsigned i = begin; i < end; ++i) {
+    roiExcess_[i] = roiStaticCounts_[i];
+  }
+
+  //scaled sparse accumulate of the changing point sources
+  for (unsigned s = 0; s < psfTemplates_.size(); s++) {
+    if (pointSourceStates_[s].isStatic) {
+      continue;
+    }
+    const PsfTemplate &tmpl = psfTemplates_[s];
+    const double signal = pointSources_[s]->GetExpectedSignal(binID_);
+    vector<unsigned>::const_iterator first =
+        lower_bound(tmpl.pix.begin(), tmpl.pix.end(), begin);
+    for (unsigned k = first - tmpl.pix.begin();
+         (k < tmpl.pix.size()) && (tmpl.pix[k] < end); ++k) {
+      roiExcess_[tmpl.pix[k]] += tmpl.density[k] * signal;
+    }
+  }
+
+  for (unsigned s = 0; s < roiExtendedCounts_.size(); s++) {
+    if (extendedSourceStates_[s].isStatic) {
+      continue;
+    }
+    const vector<double> &counts = roiExtendedCounts_[s];
+    for (unsigned i = begin; i < end; ++i) {
+      roiExcess_[i] += counts[i];
+    }
+  }
+
+  for (unsigned i = begin; i < end; ++i) {
+    roiExcess_[i] = norm * roiExcess_[i] * numTransits_;
+  }
+}
+
 /*****************************************************/
 // the expected BG correction in the DirectIntegration declination band
 // (the HEALPix ring) of a given HEALpix pixel ID, i.e. 
@@ -567,121 +921,414 @@ double CalcBin::GetTopHatArea(SkyPos center, double radius) {
   return pixelArea_ * nPixInROI;
 }
 
+/*****************************************************/
+// Flatten the ROI into per-pixel arrays. Everything stored here is
+// independent of the source model and of the fit parameters; the only
+// dependencies are the data maps (tracked via the SkyMapCollection revision)
+// and the cached BG values of the InternalModelBin (tracked via its revision).
+// The pixel list is only rebuilt if the ROI changed, so that new data (e.g.
+// pseudo-experiments) keep the PSF templates and cached source counts.
+void CalcBin::CompileROI() {
+
+  if (roiCompiled_ &&
+      (roiDataRevision_ == skyMaps_->GetRevision()) &&
+      (roiBGRevision_ == imb_.BackgroundRevision())) {
+    return;
+  }
+
+  if (!roiCompiled_) {
+    roiPixIds_.clear();
+    roiPixCenters_.clear();
+    roiPixIds_.reserve(roiPix_.nval());
+    roiPixCenters_.reserve(roiPix_.nval());
+    for (unsigned k = 0; k < roiPix_.size(); ++k) {
+      for (int j = roiPix_.ivbegin(k); j < roiPix_.ivend(k); ++j) {
+        roiPixIds_.push_back(j);
+        roiPixCenters_.push_back(SkyPos(eventMap_->pix2ang(j)));
+      }
+    }
+    roiExcess_.resize(roiPixIds_.size());
+    ++roiRevision_;
+  }
+
+  const unsigned nPix = roiPixIds_.size();
+  roiCounts_.resize(nPix);
+  roiLogFactorial_.resize(nPix);
+  roiBackground_.resize(nPix);
+
+  for (unsigned i = 0; i < nPix; ++i) {
+    const int j = roiPixIds_[i];
+
+    double evtVal = (*eventMap_)[j];
+
+    //Check on On Value:
+    //it might be the healpix default "empty" value
+    if (evtVal < -1.e30) {
+      log_trace("Healpix undefined pixel value, changed to 0.");
+      evtVal = 0;
+    }
+      //or it might be negativ in case of residual maps
+    else if (evtVal < 0) {
+      evtVal = 0;
+    }
+
+    roiCounts_[i] = evtVal;
+    //The following is the logarithm of the factorial of N:
+    // log(N!) = lgamma(N+1)
+    roiLogFactorial_[i] = lgamma(evtVal + 1);
+    roiBackground_[i] = imb_.UnscaledBG(j);
+  }
+
+  //Hoist the data-only terms for the vectorized kernel. The sign of the BG
+  //only depends on the unscaled value as long as BackgroundNorm > 0.
+  roiFitPix_.clear();
+  roiFitCounts_.clear();
+  roiFitBackground_.clear();
+  roiFitLogFactorialSum_ = 0.;
+  roiNegativeBG_ = 0;
+  for (unsigned i = 0; i < nPix; ++i) {
+    if (roiBackground_[i] == 0) {
+      continue;
+    }
+    else if (roiBackground_[i] < 0) {
+      ++roiNegativeBG_;
+      continue;
+    }
+    roiFitPix_.push_back(i);
+    roiFitCounts_.push_back(roiCounts_[i]);
+    roiFitBackground_.push_back(roiBackground_[i]);
+    roiFitLogFactorialSum_ += roiLogFactorial_[i];
+  }
+  roiFitExcess_.resize(roiFitPix_.size());
+
+  roiDataRevision_ = skyMaps_->GetRevision();
+  roiBGRevision_ = imb_.BackgroundRevision();
+  roiCompiled_ = true;
+  log_debug("CalcBin " << binID_ << ": compiled " << nPix
+            << " ROI pixels.");
+}
+
 /*****************************************************/
 
 double CalcBin::CalcLogLikelihood() {
 
-  double logLike = 0;
+  return EvaluateLogLikelihood(true);
+}
 
-  //Loop through ROI
-  for (unsigned k = 0; k < roiPix_.size(); ++k) {
-    for (int j = roiPix_.ivbegin(k); j < roiPix_.ivend(k); ++j) {
+/*****************************************************/
+double CalcBin::CalcBackgroundLogLikelihood() {
 
-      double evtVal = (*eventMap_)[j];
+  return EvaluateLogLikelihood(false);
+}
 
-      //Check on On Value:
-      //it might be the healpix default "empty" value
-      if (evtVal < -1.e30) {
-        log_trace("Healpix undefined pixel value, changed to 0.");
-        evtVal = 0;
-      }
-        //or it might be negativ in case of residual maps
-      else if (evtVal < 0) {
-        //log_warn("Negative on count " << evtVal << ", changed to 0.");
-        evtVal = 0;
-        // log_fatal("On Count is < 0.");
+/*****************************************************/
+double CalcBin::EvaluateLogLikelihood(bool signal) {
+
+  CompileROI();
+
+  LikelihoodKernel kernel = internal_->GetLikelihoodKernel();
+  //the hoisted BG terms are only valid for a positive BackgroundNorm
+  if ((kernel == LL_KERNEL_SCALAR) || !(imb_.BackgroundNorm() > 0)) {
+    return signal ? CalcLogLikelihoodScalar()
+                  : CalcBackgroundLogLikelihoodScalar();
+  }
+
+  if (signal) {
+    UpdateModelCounts();
+  }
+  double logLike = CalcLogLikelihoodVectorized(signal, 0, roiFitPix_.size());
+
+  if (kernel == LL_KERNEL_VERIFY) {
+    double reference = signal ? CalcLogLikelihoodScalar()
+                              : CalcBackgroundLogLikelihoodScalar();
+    double tolerance = internal_->GetLikelihoodKernelTolerance();
+    if (!(fabs(logLike - reference) <= tolerance * max(1., fabs(reference)))) {
+      log_warn("CalcBin " << binID_ << ": vectorized LL = " << logLike
+               << " differs from scalar LL = " << reference
+               << " by more than the relative tolerance " << tolerance);
+    }
+    return reference;
+  }
+
+  return logLike;
+}
+
+/*****************************************************/
+double CalcBin::CalcLogLikelihoodVectorized(bool signal, unsigned begin,
+                                            unsigned end) {
+
+  double logLike = 0.;
+
+  if (end > begin) {
+    const double *excess = 0;
+    if (signal) {
+      //fit pixels are sorted, so chunks map to disjoint ROI pixel ranges
+      CalcExpectedExcess(roiFitPix_[begin], roiFitPix_[end - 1] + 1,
+                         imb_.CommonNorm());
+      for (unsigned v = begin; v < end; ++v) {
+        unsigned i = roiFitPix_[v];
+        int j = roiPixIds_[i];
+        roiFitExcess_[v] = roiExcess_[i] -
+                           GetPerPixelExpectedBackgroundCorrection(j);
       }
+      excess = &roiFitExcess_[begin];
+    }
+    logLike = PoissonLogLikelihoodSum(&roiFitCounts_[begin], excess,
+                                      &roiFitBackground_[begin],
+                                      imb_.BackgroundNorm(),
+                                      minOnCount_, end - begin);
+  }
 
-      //correct BG based on expected signal contribution in DI dec ring
-      double bgVal = imb_.BG(j);
+  if (begin == 0) {
+    logLike -= roiFitLogFactorialSum_;
+    logLike += -1.e30 * roiNegativeBG_;
+  }
 
-      //CommonNorm() is used inside the following method:
+  log_trace("CalcBin " << binID_ << ": LL(" << (signal ? "Model+BG" : "BG")
+            << ", " << GetPoissonKernelInstructionSet() << ") = " << logLike);
+  return logLike;
+}
 
-      double expExcess = GetPerPixelExpectedExcess(j);
+/*****************************************************/
+// Everything that is filled lazily during the LL evaluation (compiled ROI,
+// BG cache, pixelated PSFs, convoluted extended sources) is built here, in
+// the calling thread. Chunks are only used with the vectorized kernel; the
+// chunk boundaries only depend on chunkSize, so a fixed-order sum over the
+// chunks does not depend on the number of threads.
+unsigned CalcBin::PrepareLogLikelihood(bool signal, unsigned chunkSize) {
+
+  CompileROI();
+
+  if (signal) {
+    for (unsigned s = 0; s < pointSources_.size(); s++) {
+      pointSources_[s]->PreparePixelatedPsf(pixelArea_, binID_);
+    }
+    for (unsigned s = 0; s < extendedSources_.size(); s++) {
+      extendedSources_[s]->PrepareConvolutedSignal(binID_, nside_, roiPix_);
+    }
+    UpdateModelCounts();
+  }
 
-      double corrBG = GetPerPixelExpectedBackgroundCorrection(j);
+  if ((internal_->GetLikelihoodKernel() != LL_KERNEL_VECTORIZED) ||
+      !(imb_.BackgroundNorm() > 0) || (chunkSize == 0)) {
+    chunkSize_ = 0;
+    return 1;
+  }
 
-      double expEvt = expExcess + bgVal - corrBG;
+  chunkSize_ = chunkSize;
+  unsigned nFit = roiFitPix_.size();
+  return (nFit == 0) ? 1 : (nFit + chunkSize - 1) / chunkSize;
+}
 
-      if (bgVal == 0) {
-        //ignore BG=0
-        log_trace("Bin " << binID_ << "; pixel " << j << " : OFF=" << bgVal
-                      << " , ignoring via LL+=0");
-      }
-      else if (bgVal < 0) {
-        log_trace("Bin " << binID_ << "; pixel " << j << " : OFF=" << bgVal
-                      << " is negative, set LL+=-1e30");
-        logLike += -1.e30;
-      }
-      else {
-        if (expEvt < minOnCount_) {
-          log_trace("Negative or zero expected On counts = " << expEvt
-                        << ", changed to minimum double value: " << minOnCount_);
-          expEvt = minOnCount_;
-        }
-        //The following is the logarithm of the factorial of N:
-        // log(N!) = lgamma(N+1)
-        double logCounts = lgamma(evtVal + 1);
-        logLike += evtVal * log(expEvt) - expEvt - logCounts;
-      }
+/*****************************************************/
+double CalcBin::CalcLogLikelihoodChunk(bool signal, unsigned chunk) {
+
+  if (chunkSize_ == 0) {
+    return EvaluateLogLikelihood(signal);
+  }
+
+  unsigned begin = chunk * chunkSize_;
+  unsigned end = min<unsigned>(begin + chunkSize_, roiFitPix_.size());
+  return CalcLogLikelihoodVectorized(signal, begin, end);
+}
+
+/*****************************************************/
+// The signal LL of the vectorized kernel is sum n*log(c*s + b) - (c*s + b)
+// over the fit pixels, with c = CommonNorm; s and b do not depend on c.
+// The GPD excess is only available at the current CommonNorm.
+bool CalcBin::GetCommonNormFitTerms(vector<double> &counts,
+                                    vector<double> &excess,
+                                    vector<double> &background) {
+
+  if (GPD_ || !(imb_.BackgroundNorm() > 0)) {
+    return false;
+  }
+
+  CompileROI();
+  UpdateModelCounts();
+  if (!roiFitPix_.empty()) {
+    CalcExpectedExcess(roiFitPix_.front(), roiFitPix_.back() + 1, 1.);
+  }
+
+  const double bgNorm = imb_.BackgroundNorm();
+  for (unsigned v = 0; v < roiFitPix_.size(); ++v) {
+    const unsigned i = roiFitPix_[v];
+    counts.push_back(roiFitCounts_[v]);
+    excess.push_back(roiExcess_[i]);
+    background.push_back(roiFitBackground_[v] * bgNorm -
+                         GetPerPixelExpectedBackgroundCorrection(roiPixIds_[i]));
+  }
+  return true;
+}
 
-      log_trace("Data value: " << evtVal);
-      log_trace("BG value: " << bgVal);
-      log_trace("Expected excess: " << expExcess);
-      log_trace("Expected counts: " << expEvt);
+/*****************************************************/
+bool CalcBin::HasLogLikelihoodGradient() const {
+
+  return !GPD_;
+}
+
+/*****************************************************/
+// mu = CommonNorm * s + BackgroundNorm * b per fit pixel, so
+// dLL/dCommonNorm = sum (n/mu - 1) * s and dLL/dBackgroundNorm =
+// sum (n/mu - 1) * b; pixels with mu clamped to minOnCount_ are constant.
+// For BackgroundNorm <= 0, the BG of all pixels is <= 0 and the LL is a
+// constant penalty with vanishing derivatives; the fits keep the norms
+// positive (see InternalMinimize).
+double CalcBin::CalcLogLikelihoodGradient(double &dCommonNorm,
+                                          double &dBackgroundNorm) {
+
+  dCommonNorm = 0.;
+  dBackgroundNorm = 0.;
+  if (GPD_) {
+    log_fatal("No LL gradient with the GPD ROI.");
+  }
+  if (!(imb_.BackgroundNorm() > 0)) {
+    return EvaluateLogLikelihood(true);
+  }
+
+  if (!roiFitPix_.empty()) {
+    CalcExpectedExcess(roiFitPix_.front(), roiFitPix_.back() + 1, 1.);
+  }
+
+  const double norm = imb_.CommonNorm();
+  const double bgNorm = imb_.BackgroundNorm();
+  double logLike = 0.;
+  for (unsigned v = 0; v < roiFitPix_.size(); ++v) {
+    const unsigned i = roiFitPix_[v];
+    const double evtVal = roiFitCounts_[v];
+    const double signal = roiExcess_[i];
+    const double bgVal = roiFitBackground_[v];
+    double expEvt = norm * signal + bgNorm * bgVal -
+                    GetPerPixelExpectedBackgroundCorrection(roiPixIds_[i]);
+    if (expEvt < minOnCount_) {
+      expEvt = minOnCount_;
+      logLike += evtVal * log(expEvt) - expEvt;
+      continue;
     }
+    logLike += evtVal * log(expEvt) - expEvt;
+    const double w = evtVal / expEvt - 1.;
+    dCommonNorm += w * signal;
+    dBackgroundNorm += w * bgVal;
   }
+  logLike -= roiFitLogFactorialSum_;
+  logLike += -1.e30 * roiNegativeBG_;
 
-  log_trace("CalcBin " << binID_ << ": LL(Model+BG) = " << logLike);
+  log_trace("CalcBin " << binID_ << ": LL(Model+BG) = " << logLike
+            << ", dLL/dCommonNorm = " << dCommonNorm
+            << ", dLL/dBackgroundNorm = " << dBackgroundNorm);
   return logLike;
 }
 
 /*****************************************************/
-double CalcBin::CalcBackgroundLogLikelihood() {
+double CalcBin::CalcBackgroundLogLikelihoodGradient(double &dBackgroundNorm) {
+
+  dBackgroundNorm = 0.;
+  if (!(imb_.BackgroundNorm() > 0)) {
+    return EvaluateLogLikelihood(false);
+  }
+
+  const double bgNorm = imb_.BackgroundNorm();
+  double logLike = 0.;
+  for (unsigned v = 0; v < roiFitPix_.size(); ++v) {
+    const double evtVal = roiFitCounts_[v];
+    const double bgVal = roiFitBackground_[v] * bgNorm;
+    logLike += evtVal * log(bgVal) - bgVal;
+    dBackgroundNorm += (evtVal / bgVal - 1.) * roiFitBackground_[v];
+  }
+  logLike -= roiFitLogFactorialSum_;
+  logLike += -1.e30 * roiNegativeBG_;
+
+  log_trace("CalcBin " << binID_ << ": LL(BG) = " << logLike
+            << ", dLL/dBackgroundNorm = " << dBackgroundNorm);
+  return logLike;
+}
+
+/*****************************************************/
+double CalcBin::CalcLogLikelihoodScalar() {
 
   double logLike = 0;
+  const double bgNorm = imb_.BackgroundNorm();
+  const unsigned nPix = roiPixIds_.size();
 
   //Loop through ROI
-  for (unsigned k = 0; k < roiPix_.size(); ++k) {
-    for (int j = roiPix_.ivbegin(k); j < roiPix_.ivend(k); ++j) {
+  for (unsigned i = 0; i < nPix; ++i) {
 
-      double evtVal = (*eventMap_)[j];
+    int j = roiPixIds_[i];
 
-      //Check on On Value:
-      //it might be the healpix default "empty" value
-      if (evtVal < -1.e30) {
-        log_trace("Healpix undefined pixel value, changed to 0.");
-        evtVal = 0;
-      }
-        //or it might be negative in case of residual maps
-      else if (evtVal < 0) {
-        //log_warn("Negative on count " << evtVal << ", changed to 0.");
-        evtVal = 0;
-        //   log_fatal("On Count is < 0.");
-      }
+    double evtVal = roiCounts_[i];
 
-      double bgVal = imb_.BG(j);
+    //correct BG based on expected signal contribution in DI dec ring
+    double bgVal = roiBackground_[i] * bgNorm;
 
-      if (bgVal == 0) {
-        //ignore BG=0
-        log_trace("Bin " << binID_ << "; pixel " << j << " : OFF=" << bgVal
-                      << " , ignoring via LL+=0");
-      }
-      else if (bgVal < 0) {
-        log_trace("Bin " << binID_ << "; pixel " << j << " : OFF=" << bgVal
-                      << " is negative, set LL+=-1e30");
-        logLike += -1.e30;
-      }
-      else {
-        //The following is the logarithm of the factorial of N:
-        // log(N!) = lgamma(N+1)
-        double logCounts = lgamma(evtVal + 1);
-        logLike += evtVal * log(bgVal) - bgVal - logCounts;
+    //CommonNorm() is used inside the following method:
+
+    double expExcess = GetPerPixelExpectedExcess(j, roiPixCenters_[i]);
+
+    double corrBG = GetPerPixelExpectedBackgroundCorrection(j);
+
+    double expEvt = expExcess + bgVal - corrBG;
+
+    if (bgVal == 0) {
+      //ignore BG=0
+      log_trace("Bin " << binID_ << "; pixel " << j << " : OFF=" << bgVal
+                    << " , ignoring via LL+=0");
+    }
+    else if (bgVal < 0) {
+      log_trace("Bin " << binID_ << "; pixel " << j << " : OFF=" << bgVal
+                    << " is negative, set LL+=-1e30");
+      logLike += -1.e30;
+    }
+    else {
+      if (expEvt < minOnCount_) {
+        log_trace("Negative or zero expected On counts = " << expEvt
+                      << ", changed to minimum double value: " << minOnCount_);
+        expEvt = minOnCount_;
       }
+      logLike += evtVal * log(expEvt) - expEvt - roiLogFactorial_[i];
+    }
+
+    log_trace("Data value: " << evtVal);
+    log_trace("BG value: " << bgVal);
+    log_trace("Expected excess: " << expExcess);
+    log_trace("Expected counts: " << expEvt);
+  }
+
+  log_trace("CalcBin " << binID_ << ": LL(Model+BG) = " << logLike);
+  return logLike;
+}
 
-      log_trace("Data value: " << evtVal);
-      log_trace("BG value: " << bgVal);
+/*****************************************************/
+double CalcBin::CalcBackgroundLogLikelihoodScalar() {
+
+  double logLike = 0;
+  const double bgNorm = imb_.BackgroundNorm();
+  const unsigned nPix = roiPixIds_.size();
+
+  //Loop through ROI
+  for (unsigned i = 0; i < nPix; ++i) {
+
+    int j = roiPixIds_[i];
+
+    double evtVal = roiCounts_[i];
+
+    double bgVal = roiBackground_[i] * bgNorm;
+
+    if (bgVal == 0) {
+      //ignore BG=0
+      log_trace("Bin " << binID_ << "; pixel " << j << " : OFF=" << bgVal
+                    << " , ignoring via LL+=0");
     }
+    else if (bgVal < 0) {
+      log_trace("Bin " << binID_ << "; pixel " << j << " : OFF=" << bgVal
+                    << " is negative, set LL+=-1e30");
+      logLike += -1.e30;
+    }
+    else {
+      logLike += evtVal * log(bgVal) - bgVal - roiLogFactorial_[i];
+    }
+
+    log_trace("Data value: " << evtVal);
+    log_trace("BG value: " << bgVal);
   }
 
   log_trace("CalcBin " << binID_ << ": LL(BG) = " << logLike);
@@ -944,15 +1591,22 @@ void CalcBin::CalcTopHatWeights(double &sumExpWeighted,
 
 void CalcBin::MakeModelMap(bool add) {
   for (unsigned k = 0; k < roiPix_.size(); ++k) {
+    //consecutive pixels of an interval are in consecutive slots
+    const int slot = modelMap_->GetSlot(roiPix_.ivbegin(k));
+    if (slot < 0 || modelMap_->GetSlot(roiPix_.ivend(k) - 1) !=
+                    slot + roiPix_.ivlen(k) - 1) {
+      log_fatal("ROI of CalcBin " << binID_ << " outside the model map.");
+    }
     for (int j = roiPix_.ivbegin(k); j < roiPix_.ivend(k); ++j) {
+      const int s = slot + (j - roiPix_.ivbegin(k));
       if ((*backgroundMap_)[j] < 1e-30) {
-        modelMap_->SetPixel(j, 0.);
+        modelMap_->SetSlotValue(s, 0.);
       } else {
         if (add) {
-          modelMap_->AddToPixel(j, GetPerPixelExpectedExcess(j));
+          modelMap_->AddToSlot(s, GetPerPixelExpectedExcess(j));
         }
         else {
-          modelMap_->SetPixel(j, GetPerPixelExpectedExcess(j));
+          modelMap_->SetSlotValue(s, GetPerPixelExpectedExcess(j));
         };
       }
     }
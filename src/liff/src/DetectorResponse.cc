@@ -16,12 +16,88 @@
 #include <sstream>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
 
 #include <liff/BinList.h>
 #include <liff/DetectorResponse.h>
 
 using namespace std;
 
+namespace {
+
+  // Responses read by DetectorResponse::Open, by file name. The cache does
+  // not own them, so a file is released once the last user is destroyed.
+  struct CachedResponse {
+    time_t mtime;
+    off_t size;
+    boost::weak_ptr<const DetectorResponse> response;
+  };
+
+  map<string, CachedResponse> responseCache;
+  boost::mutex responseCacheMutex;
+
+  unsigned sourceRevision = 0;
+  boost::mutex sourceRevisionMutex;
+
+}
+
+unsigned NextSourceRevision() {
+  boost::mutex::scoped_lock lock(sourceRevisionMutex);
+  if (++sourceRevision == 0) {
+    ++sourceRevision;
+  }
+  return sourceRevision;
+}
+
+DetectorResponse DetectorResponse::Open(const string &filename) {
+
+  struct stat buf;
+  if (stat(filename.c_str(), &buf) != 0) {
+    log_fatal("DetectorResponse file " << filename << " does not exist!");
+  }
+
+  DetectorResponseConstPtr shared;
+  {
+    boost::mutex::scoped_lock lock(responseCacheMutex);
+    CachedResponse &cached = responseCache[filename];
+    shared = cached.response.lock();
+    if (shared && (cached.mtime == buf.st_mtime) &&
+        (cached.size == buf.st_size)) {
+      log_debug("Sharing DetectorResponse file " << filename);
+    }
+    else {
+      shared = DetectorResponseConstPtr(new DetectorResponse(filename));
+      cached.mtime = buf.st_mtime;
+      cached.size = buf.st_size;
+      cached.response = shared;
+    }
+  }
+
+  //copies share the (immutable) simulated histograms and functions
+  //through the pointers in the ResponseBins, but every copy needs its own
+  //ResponseBin objects for the reweighted energy state
+  DetectorResponse dr(*shared);
+  dr.shared_ = shared;
+  for (ResponseBinMap::iterator it = dr.responseBins_.begin();
+       it != dr.responseBins_.end(); ++it) {
+    it->second = ResponseBinPtr(new ResponseBin(*it->second));
+  }
+  if (dr.spectrum_) {
+    dr.spectrum_ = LogLogSpectrumPtr(new LogLogSpectrum(*dr.spectrum_));
+  }
+  return dr;
+}
+
+void DetectorResponse::Unshare() {
+
+  for (ResponseBinMap::iterator it = responseBins_.begin();
+       it != responseBins_.end(); ++it) {
+    it->second->CloneSimObjects();
+  }
+  shared_.reset();
+}
+
 void DetectorResponse::Read(string filename) {
 
   TFile infile(filename.c_str());
@@ -136,6 +212,7 @@ void DetectorResponse::Read(string filename) {
         (bin->logEnBins_).push_back(logen);
       }
       bin->sigExp_ = bin->simEnSigHist_->Integral(); //exp. signal events
+      bin->UpdateSimSignal();
 
       infile.GetObject((dir + "EnBg" + suffix).c_str(), histpointer);
       bin->simEnBgHist_ = TH1DPtr((TH1D *) histpointer->Clone());
@@ -156,6 +233,8 @@ void DetectorResponse::Read(string filename) {
       infile.GetObject((dir + "EnBg" + suffix + "_fit").c_str(), funcpointer);
       bin->simEnBgFunc_ = TF1Ptr((TF1 *) funcpointer->Clone());
       delete funcpointer;
+
+      bin->NameSimObjects();
     }
   }
 
@@ -502,6 +581,7 @@ void DetectorResponse::MakeAllHistFromSWEETS(const string sweetspath, const Func
       FillSignalHistFromSWEETS(events_in_bin, bin->simEnSigHist_,
                                "mc.logEnergy-3.",spectrumweight);
       bin->GetEnSigHist(true); //reset
+      bin->UpdateSimSignal();
       integ = bin->simEnSigHist_->Integral();
       bin->sigExp_ = integ;
       //Energy Background, in TeV instead of GeV
@@ -511,6 +591,8 @@ void DetectorResponse::MakeAllHistFromSWEETS(const string sweetspath, const Func
       bin->GetEnBgHist(true); //reset
       integ = bin->simEnBgHist_->Integral();
       bin->bgExp_ = integ;
+      //after the projections, which look the histograms up by name
+      bin->NameSimObjects();
       tempfile->Close();
     }
     sweets->Close();
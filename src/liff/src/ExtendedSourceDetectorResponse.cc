@@ -8,11 +8,14 @@
  
 #include <utility>
 
+#include <liff/BatchModelInterface.h>
 #include <liff/BinList.h>
 #include <liff/ExtendedSourceDetectorResponse.h>
 
 #include <hawcnest/HAWCUnits.h>
 
+#include <algorithm>
+
 using namespace std;
 using namespace threeML;
 using namespace HAWCUnits;
@@ -44,53 +47,381 @@ void ExtendedSourceDetectorResponse::SetModel
   numRegions_ = (int) decBinId_.size();
   log_debug("Number of dec bands: " << numRegions_);
 
+  modelRevision_ = NextSourceRevision();
+
   // re-convolute extended source with PSF, otherwise only re-scale the flux
   if (reconvolute) {
     convolutedExpectedSignalMap_.clear();
     prevCount_.clear();
+    convolutedComponents_.clear();
+    useComponents_ = false;
   } else if (convolutedExpectedSignalMap_.size() > 0) {
     RescaleCounts();
   }
 }
 
+bool ExtendedSourceDetectorResponse::UpdateModel(ModelInterface &mi) {
+
+  double minra, maxra, mindec, maxdec;
+  mi.getExtendedSourceBoundaries(sourceId_, &minra, &maxra, &mindec, &maxdec);
+
+  vector<double> fluxes;
+  vector<char> sampled;
+  SampleModelFluxes(mi, minra, maxra, mindec, maxdec, fluxes, sampled);
+
+  //before the first convolution positions_ is empty, and nothing is cached
+  const bool comparable =
+      (minra == minra_) && (maxra == maxra_) &&
+      (mindec == mindec_) && (maxdec == maxdec_) &&
+      (sampled == modelSampled_) && (fluxes.size() == modelFluxes_.size());
+  if (comparable && (fluxes == modelFluxes_)) {
+    log_debug("Model of extended source " << sourceId_ << " unchanged.");
+    return false;
+  }
+
+  //spectral-only change: only the weights of the convoluted components
+  //change, the per-bin maps are summed up again in ConvolutePSF
+  vector<double> scales;
+  const unsigned nEnergies = GetModelEnergies().size();
+  bool spectralOnly = false;
+  if (comparable && !fluxes.empty()) {
+    if (useComponents_ &&
+        GetSpectralScales(fluxes, componentFluxes_, nEnergies, scales)) {
+      log_debug("Spectral-only change of extended source " << sourceId_
+                << ", re-weighting the convoluted components.");
+      componentScales_ = scales;
+      convolutedExpectedSignalMap_.clear();
+      prevCount_.clear();
+      modelFluxes_ = fluxes;
+      modelRevision_ = NextSourceRevision();
+      return true;
+    }
+    //the components cost nEnergies + 1 convolutions; switch only once as
+    //many spectral-only changes in a row were paid with full convolutions,
+    //so that the morphology steps of a mixed fit do not discard them
+    spectralOnly = !useComponents_ &&
+        GetSpectralScales(fluxes, modelFluxes_, nEnergies, scales);
+    if (spectralOnly && (++spectralOnlyChanges_ > nEnergies)) {
+      log_debug("Spectral-only change of extended source " << sourceId_
+                << ", switching to per-energy-bin convolution.");
+      convolutedExpectedSignalMap_.clear();
+      convolutedComponents_.clear();
+      prevCount_.clear();
+      useComponents_ = true;
+      componentFluxes_ = fluxes;
+      componentScales_.assign(nEnergies, 1.);
+      modelFluxes_ = fluxes;
+      modelRevision_ = NextSourceRevision();
+      return true;
+    }
+  }
+
+  if (!spectralOnly) {
+    spectralOnlyChanges_ = 0;
+  }
+  SetModel(mi, true);
+  modelFluxes_ = fluxes;
+  modelSampled_ = sampled;
+  return true;
+}
+
+vector<double> ExtendedSourceDetectorResponse::GetModelEnergies() {
+  //same energies as used for the reweighting in GetExpectedSignal
+  const AnalysisBinMap &nhbmap = dr_.GetAnalysisBinMap();
+  vector<double> energies =
+      dr_.GetBin(decBinId_[0], nhbmap.begin()->first)->GetLogEnBins();
+  for (vector<double>::iterator i = energies.begin();
+       i != energies.end(); ++i) {
+    *i = pow(10., *i + 6.); //Changing from TeV to MeV
+  }
+  return energies;
+}
+
+void ExtendedSourceDetectorResponse::SampleModelFluxes(
+    ModelInterface &mi, const double minra, const double maxra,
+    const double mindec, const double maxdec,
+    vector<double> &fluxes, vector<char> &sampled) {
+
+  const vector<double> energies = GetModelEnergies();
+  const unsigned nEnergies = energies.size();
+  fluxes.assign(positions_.size() * nEnergies, 0.);
+  sampled.assign(positions_.size(), 0);
+
+  //same selection of positions as in ConvolutePSF
+  const bool fft = !healpixIds_.size();
+  vector<double> ra, dec;
+  vector<unsigned> index;
+  for (unsigned q = 0; q < positions_.size(); ++q) {
+    const double r = positions_[q].first;
+    const double d = positions_[q].second;
+    bool inside = (minra <= maxra && r >= minra && r <= maxra) ||
+                  (minra > maxra && (r >= minra || r <= maxra));
+    if (fft) {
+      inside = inside && d >= mindec && d <= maxdec;
+    }
+    if (inside) {
+      ra.push_back(r);
+      dec.push_back(d);
+      index.push_back(q);
+    }
+  }
+  if (fft) {
+    vector<char> isInside;
+    BatchModelInterface::IsInsideAnyExtendedSource(mi, ra, dec, isInside);
+    unsigned n = 0;
+    for (unsigned i = 0; i < index.size(); ++i) {
+      if (isInside[i]) {
+        ra[n] = ra[i];
+        dec[n] = dec[i];
+        index[n] = index[i];
+        ++n;
+      }
+    }
+    ra.resize(n);
+    dec.resize(n);
+    index.resize(n);
+  }
+  if (index.empty()) {
+    return;
+  }
+
+  vector<double> f;
+  BatchModelInterface::GetExtendedSourceFluxes(mi, sourceId_, ra, dec,
+                                               energies, f);
+  for (unsigned i = 0; i < index.size(); ++i) {
+    copy(f.begin() + i * nEnergies, f.begin() + (i + 1) * nEnergies,
+         fluxes.begin() + index[i] * nEnergies);
+    sampled[index[i]] = 1;
+  }
+}
+
+bool ExtendedSourceDetectorResponse::GetSpectralScales(
+    const vector<double> &fluxes, const vector<double> &reference,
+    const unsigned nEnergies, vector<double> &scales) {
+
+  //relative precision of fluxes computed as morphology times spectrum
+  static const double tolerance = 1e-12;
+
+  if ((nEnergies == 0) || (fluxes.size() != reference.size())) {
+    return false;
+  }
+  const unsigned nPositions = reference.size() / nEnergies;
+  scales.assign(nEnergies, 0.);
+  for (unsigned e = 0; e < nEnergies; ++e) {
+    double maxReference = 0.;
+    double scale = 0.;
+    for (unsigned q = 0; q < nPositions; ++q) {
+      const unsigned k = q * nEnergies + e;
+      if (fabs(reference[k]) > maxReference) {
+        maxReference = fabs(reference[k]);
+        scale = fluxes[k] / reference[k];
+      }
+    }
+    for (unsigned q = 0; q < nPositions; ++q) {
+      const unsigned k = q * nEnergies + e;
+      const double expected = scale * reference[k];
+      if (fabs(fluxes[k] - expected) >
+          tolerance * max(fabs(fluxes[k]), fabs(expected))) {
+        return false;
+      }
+    }
+    scales[e] = scale;
+  }
+  return true;
+}
+
 void ExtendedSourceDetectorResponse::ConvolutePSF(const BinName& nhbin,
                                                   rangeset<int> &roiPix) {
 
   if (prevCount_.find(nhbin) != prevCount_.end()) prevCount_.erase(nhbin);
 
+  if (positions_.empty()) GetPositions(nside_);
+
+  if (useComponents_) {
+    if (componentFluxes_.size() ==
+        positions_.size() * componentScales_.size()) {
+      ConvoluteComponents(nhbin, roiPix);
+      return;
+    }
+    //the grid changed since the components were defined
+    log_debug("Grid of extended source " << sourceId_ << " changed, "
+              << "dropping the per-energy-bin convolution.");
+    useComponents_ = false;
+    convolutedComponents_.clear();
+  }
+
   arr<double> tempArr(nside_ * nside_ * 12);
   tempArr.fill(0.);
   Healpix_Map<double> tempMap(tempArr, RING);
-  //healpix pixel size in RA on the equator
-  //nside_ only gets changed after ResetSources, so it is safe to assume it is a constant.
-  double dGrid = 90. / nside_;
-  if (nside_>1000) dGrid = 90. / 512;
 
-  if (positions_.empty()) GetPositions(nside_);
+  //the model fluxes at all positions, as sampled by UpdateModel; only if
+  //the grid was built after that, query the model for all positions at
+  //once here. Then compute the signal (in the order of the former
+  //per-position loops, so that prevCount_ is set from the same position)
+  if (modelSampled_.size() != positions_.size()) {
+    SampleModelFluxes(mi_, minra_, maxra_, mindec_, maxdec_, modelFluxes_,
+                      modelSampled_);
+  }
+  const vector<double> &fluxes = modelFluxes_;
+  const vector<char> &sampled = modelSampled_;
+  const unsigned nEnergies =
+      positions_.empty() ? 0 : fluxes.size() / positions_.size();
+  vector<double> scaled(nEnergies);
+  vector<int> pixelIds;
+  for (unsigned k = 0; k < healpixIds_.size(); ++k) {
+    for (int j = healpixIds_.ivbegin(k); j < healpixIds_.ivend(k); ++j) {
+      pixelIds.push_back(j);
+    }
+  }
 
-  if (!healpixIds_.size()) {
-    for (int idDec = 0; idDec < gridDec_; ++idDec) {
-      double itDec = positions_[idDec * gridRA_].second;
-      for (int idRA = 0; idRA < gridRA_; ++idRA) {
-        double itRA = (positions_[idDec * gridRA_ + idRA]).first;
-        //no need to get expected signal outside the extended source
-        if (itDec >= mindec_ && itDec <= maxdec_ && ((minra_ <= maxra_ && itRA >= minra_ && itRA <= maxra_) ||
-            (minra_ > maxra_ && (itRA >= minra_ || itRA <= maxra_))) &&
-            mi_.isInsideAnyExtendedSource(itRA, itDec)) {
-          double tempCount = GetExpectedSignal(nhbin, itRA, itDec);
-          fftwIn_[idRA * gridDec_ + idDec] = tempCount;
-
-          bool pixelFound = false;
-          if (!pixelFound && tempCount > 1e-30) { //to prevent fluctuation around 0 due to double precision
-            prevCount_[nhbin] = make_pair(SkyPos(itRA, itDec), tempCount);
-            pixelFound = true;
+  for (unsigned q = 0; q < positions_.size(); ++q) {
+    double tempCount = 0.;
+    if (sampled[q]) {
+      copy(fluxes.begin() + q * nEnergies,
+           fluxes.begin() + (q + 1) * nEnergies, scaled.begin());
+      tempCount = GetExpectedSignal(nhbin, positions_[q].second, scaled);
+      //to prevent fluctuation around 0 due to double precision
+      if (tempCount > 1e-30) {
+        prevCount_[nhbin] =
+            make_pair(SkyPos(positions_[q].first, positions_[q].second),
+                      tempCount);
+      }
+    }
+    if (!healpixIds_.size()) {
+      //positions_ run over RA fastest, the FFT input over Dec
+      const int idDec = q / gridRA_;
+      const int idRA = q % gridRA_;
+      fftwIn_[idRA * gridDec_ + idDec] = tempCount;
+    }
+    else if (sampled[q]) {
+      tempMap[pixelIds[q]] = tempCount;
+      log_debug("ExpSig: " << tempMap[pixelIds[q]]);
+    }
+  }
+
+  ConvoluteInput(nhbin, tempMap, roiPix);
+
+  convolutedExpectedSignalMap_.insert(
+    pair<BinName, SkyMap<double> >(nhbin, SkyMap<double>(tempMap, roiPix))
+  );
+}
+
+// The expected signal at a position is linear in the fluxes, see
+// ResponseBin::GetSignalWeights, and so is the convolution. With the
+// fluxes of the reference model F_b(p) at energy b, the convoluted signal
+// is the sum of the convolutions of w_b(dec) * F_b(p) (one component per
+// energy) plus the convolution of the flux-independent constant. A model
+// with fluxes s_b * F_b(p) is then the same sum with the components scaled
+// by s_b, so spectral-only changes need no new convolution.
+void ExtendedSourceDetectorResponse::ConvoluteComponents(
+    const BinName& nhbin, rangeset<int> &roiPix) {
+
+  const unsigned nEnergies = componentScales_.size();
+  vector<SkyMap<double> > &components = convolutedComponents_[nhbin];
+  if (!components.empty() &&
+      !components[0].GetPixelRange().contains(roiPix)) {
+    components.clear();
+  }
+
+  if (components.empty()) {
+    log_debug("Convoluting " << nEnergies + 1 << " components of extended "
+              << "source " << sourceId_ << " in bin " << nhbin);
+    const double pixelArea = HAWCUnits::pi / (3 * nside_ * nside_);
+    //signal weights of the response bins, per dec bin
+    map<int, pair<vector<double>, double> > weights;
+    //HEALPix pixel of each position in the spherical-harmonics case
+    vector<int> pixelIds;
+    for (unsigned k = 0; k < healpixIds_.size(); ++k) {
+      for (int j = healpixIds_.ivbegin(k); j < healpixIds_.ivend(k); ++j) {
+        pixelIds.push_back(j);
+      }
+    }
+    components.resize(nEnergies + 1);
+    for (unsigned c = 0; c <= nEnergies; ++c) {
+      arr<double> tempArr(nside_ * nside_ * 12);
+      tempArr.fill(0.);
+      Healpix_Map<double> tempMap(tempArr, RING);
+      if (!healpixIds_.size()) {
+        for (int n = 0; n < gridRA_ * gridDec_; ++n) {
+          fftwIn_[n] = 0.;
+        }
+      }
+
+      bool nonZero = false;
+      for (unsigned q = 0; q < positions_.size(); ++q) {
+        if (!modelSampled_[q]) {
+          continue;
+        }
+        int decb1, decb2;
+        double w1, w2;
+        if (!GetDecInterpolation(positions_[q].second, decb1, decb2,
+                                 w1, w2)) {
+          continue;
+        }
+        int decb[2] = {decb1, decb2};
+        for (unsigned d = 0; d < 2; ++d) {
+          if (weights.find(decb[d]) == weights.end()) {
+            dr_.GetBin(decb[d], nhbin)->GetSignalWeights(
+                weights[decb[d]].first, weights[decb[d]].second);
           }
-        } else {
-          fftwIn_[idRA * gridDec_ + idDec] = 0.;
+        }
+        const pair<vector<double>, double> &sw1 = weights[decb1];
+        const pair<vector<double>, double> &sw2 = weights[decb2];
+        double value;
+        if (c < nEnergies) {
+          const double flux =
+              componentFluxes_[q * nEnergies + c] * pixelArea * 1e6;
+          value = w1 * sw1.first[c] * flux + w2 * sw2.first[c] * flux;
+        }
+        else {
+          value = w1 * sw1.second + w2 * sw2.second;
+        }
+        if (value == 0.) {
+          continue;
+        }
+        nonZero = true;
+        if (!healpixIds_.size()) {
+          const int idDec = q / gridRA_;
+          const int idRA = q % gridRA_;
+          fftwIn_[idRA * gridDec_ + idDec] = value;
+        }
+        else {
+          tempMap[pixelIds[q]] = value;
         }
       }
+
+      if (nonZero) {
+        ConvoluteInput(nhbin, tempMap, roiPix);
+        components[c] = SkyMap<double>(tempMap, roiPix);
+      }
+      else {
+        components[c] = SkyMap<double>(roiPix, nside_, RING);
+      }
     }
+  }
 
+  rangeset<int> pixels = components[0].GetPixelRange();
+  SkyMap<double> sum(pixels, nside_, RING);
+  for (unsigned c = 0; c <= nEnergies; ++c) {
+    sum.Add(components[c], (c < nEnergies) ? componentScales_[c] : 1.);
+  }
+  convolutedExpectedSignalMap_.insert(
+    pair<BinName, SkyMap<double> >(nhbin, sum)
+  );
+}
+
+// PSF convolution of the model values in fftwIn_ (FFT grid) or tempMap
+// (spherical harmonics), the result is stored in tempMap
+void ExtendedSourceDetectorResponse::ConvoluteInput(
+    const BinName& nhbin, Healpix_Map<double> &tempMap,
+    rangeset<int> &roiPix) {
+
+  //healpix pixel size in RA on the equator
+  //nside_ only gets changed after ResetSources, so it is safe to assume it is a constant.
+  double dGrid = 90. / nside_;
+  if (nside_>1000) dGrid = 90. / 512;
+
+  if (!healpixIds_.size()) {
     fftw_execute(fftwFP_);
 
     int nGrid = gridRA_ * gridDec_;
@@ -176,27 +507,12 @@ void ExtendedSourceDetectorResponse::ConvolutePSF(const BinName& nhbin,
       }
     }
   } else {
+    //positions_ holds the pixel centers of healpixIds_
     double minDec = 90.;
     double maxDec = -90.;
-
-    for (unsigned k = 0; k < healpixIds_.size(); ++k) {
-      for (int j = healpixIds_.ivbegin(k); j < healpixIds_.ivend(k); ++j) {
-        SkyPos point(tempMap.pix2ang(j));
-        minDec = min(minDec, point.Dec());
-        maxDec = max(maxDec, point.Dec());
-        if (((minra_ <= maxra_ && point.RA() >= minra_ && point.RA() <= maxra_) ||
-            (minra_ > maxra_ && (point.RA() >= minra_ || point.RA() <= maxra_)))) {
-          double tempCount = GetExpectedSignal(nhbin, point.RA(), point.Dec());
-          tempMap[j] = tempCount;
-          log_debug("ExpSig: " << tempMap[j]);
-
-          bool pixelFound = false;
-          if (!pixelFound && tempCount > 1e-30) { //to prevent fluctuation around 0 due to double precision
-            prevCount_[nhbin] = make_pair(SkyPos(point.RA(), point.Dec()), tempCount);
-            pixelFound = true;
-          }
-        }
-      }
+    for (unsigned q = 0; q < positions_.size(); ++q) {
+      minDec = min(minDec, positions_[q].second);
+      maxDec = max(maxDec, positions_[q].second);
     }
 
     double centerDec = (minDec + maxDec) / 2.;
@@ -237,10 +553,6 @@ void ExtendedSourceDetectorResponse::ConvolutePSF(const BinName& nhbin,
     alm.Add(alm2);
     alm2map(alm, tempMap);
   }
-
-  convolutedExpectedSignalMap_.insert(
-    pair<BinName, SkyMap<double> >(nhbin, SkyMap<double>(tempMap, roiPix))
-  );
 }
 
 void ExtendedSourceDetectorResponse::RescaleCounts() {
@@ -277,22 +589,48 @@ double ExtendedSourceDetectorResponse::GetExtendedSourceConvolutedSignal(
   const BinName& nhbin, const int nside, rangeset<int> &roiPix,
   const int healpixId) {
 
-  nside_ = nside;
-
-  if (convolutedExpectedSignalMap_.find(nhbin) == convolutedExpectedSignalMap_.end()) {
-    ConvolutePSF(nhbin, roiPix);
+  MapMap::const_iterator it = convolutedExpectedSignalMap_.find(nhbin);
+  if (it == convolutedExpectedSignalMap_.end()) {
+    PrepareConvolutedSignal(nhbin, nside, roiPix);
+    it = convolutedExpectedSignalMap_.find(nhbin);
   }
 
-  if (convolutedExpectedSignalMap_[nhbin].Nside() == nside) {
-    return convolutedExpectedSignalMap_[nhbin][healpixId];
+  //read-only access from here on
+  const SkyMap<double> &convoluted = it->second;
+
+  if (convoluted.Nside() == nside) {
+    return convoluted[healpixId];
   } else {
     log_warn("We should not get here, but if happening,");
     log_warn("it means the nside used in PSF convolution ("<<nside_<<")");
     log_warn("is different from the one in data ("<<nside<<").");
     log_warn("The code will be very slow.");
     Healpix_Map<double> tempMap(nside, RING, SET_NSIDE);
-    int tempPixel = (convolutedExpectedSignalMap_[nhbin]).ang2pix(tempMap.pix2ang(healpixId));
-    return convolutedExpectedSignalMap_[nhbin][tempPixel];
+    int tempPixel = convoluted.ang2pix(tempMap.pix2ang(healpixId));
+    return convoluted[tempPixel];
+  }
+}
+
+void ExtendedSourceDetectorResponse::PrepareConvolutedSignal(
+  const BinName& nhbin, const int nside, rangeset<int> &roiPix) {
+
+  //only write if needed, so that concurrent callers only read
+  if (nside_ != nside) {
+    nside_ = nside;
+  }
+
+  MapMap::iterator it = convolutedExpectedSignalMap_.find(nhbin);
+  if ((it != convolutedExpectedSignalMap_.end()) &&
+      !it->second.GetPixelRange().contains(roiPix)) {
+    //the ROI grew since the convolution, e.g. after a point source moved
+    log_debug("ROI changed, re-convoluting extended source " << sourceId_
+              << " in bin " << nhbin);
+    convolutedExpectedSignalMap_.erase(it);
+    it = convolutedExpectedSignalMap_.end();
+  }
+
+  if (it == convolutedExpectedSignalMap_.end()) {
+    ConvolutePSF(nhbin, roiPix);
   }
 }
 
@@ -328,47 +666,16 @@ TF1Ptr ExtendedSourceDetectorResponse::GetPsfFunction(
 //Next function
 double ExtendedSourceDetectorResponse::GetExpectedSignal(
     const BinName& nhbin, const double ra, const double dec) {
-  int decb1 = 0;
-  int decb2 = 0;
-  double dec1 = 0.0; //for declination centers
-  double dec2 = 0.0;
-
-  ResponseBinPtr rb1;
-  ResponseBinPtr rb2;
-  log_trace("Pos: " << ra << "," << dec);
-  for (int i = decBinId_[0]; i <= decBinId_[numRegions_ - 1]; ++i) {
-    if ((dec < decUpperEdge_[i - decBinId_[0]]) && (dec >= decLowerEdge_[i - decBinId_[0]])) {
-      rb1 = dr_.GetBin(i, nhbin);
-      rb2 = rb1;
-      decb1 = i;
-      decb2 = i;
-      dec1 = dr_.GetDecBinMap()[i].simDec_;
-      if (dec < dec1 && decb1 > 0) {
-        decb2 = decb1 - 1;
-        rb2 = dr_.GetBin(decb2, nhbin);
-      }
-      if (dec > dec1 && decb1 < int(dr_.GetDecBinMap().size()) - 1) {
-        decb2 = decb1 + 1;
-        rb2 = dr_.GetBin(decb2, nhbin);
-      }
-      dec2 = dr_.GetDecBinMap()[decb2].simDec_;
-      break;
-    }
-  }
+  int decb1, decb2;
   double w1, w2; // weights for the interpolation
-  if (dec1 == dec2) {
-    w1 = 1.;
-    w2 = 0.;
-  } else {
-    w1 = (dec - dec2) / (dec1 - dec2);
-    w2 = (dec - dec1) / (dec2 - dec1);
-  }
-
-  if (!rb1) {
+  log_trace("Pos: " << ra << "," << dec);
+  if (!GetDecInterpolation(dec, decb1, decb2, w1, w2)) {
     log_trace("Query for signal expectation at declination outside of "
                   << " boundaries of extended source " << sourceId_);
     return 0.;
   }
+  ResponseBinPtr rb1 = dr_.GetBin(decb1, nhbin);
+
   //always reweight for each coordinate if it is an extended source
   //Dec 1
   vector<double> energies = rb1->GetLogEnBins();
@@ -377,9 +684,22 @@ double ExtendedSourceDetectorResponse::GetExpectedSignal(
     *i = pow(10., *i + 6.); //Changing from TeV to MeV
   }
 
-  double pixelArea = HAWCUnits::pi / (3 * nside_ * nside_);
   vector<double> fluxes =
       mi_.getExtendedSourceFluxes(sourceId_, ra, dec, energies); // In (MeV s cm2 sr)^-1
+  return GetExpectedSignal(nhbin, dec, fluxes);
+}
+
+double ExtendedSourceDetectorResponse::GetExpectedSignal(
+    const BinName& nhbin, const double dec, vector<double> &fluxes) {
+  int decb1, decb2;
+  double w1, w2; // weights for the interpolation
+  if (!GetDecInterpolation(dec, decb1, decb2, w1, w2)) {
+    return 0.;
+  }
+  ResponseBinPtr rb1 = dr_.GetBin(decb1, nhbin);
+  ResponseBinPtr rb2 = dr_.GetBin(decb2, nhbin);
+
+  double pixelArea = HAWCUnits::pi / (3 * nside_ * nside_);
   transform(fluxes.begin(), fluxes.end(), fluxes.begin(),
             bind1st(multiplies<double>(), pixelArea));// In (MeV s cm2)^-1
   //convert to TeV^-1 cm^-1 s^-1
@@ -387,13 +707,39 @@ double ExtendedSourceDetectorResponse::GetExpectedSignal(
        i != fluxes.end(); ++i) {
     (*i) *= 1e6;
   }
-  rb1->ReweightEnergies(fluxes);
-  rb2->ReweightEnergies(fluxes);
   //log_debug("Weights: "<<w1<<" "<<w2);
-  return w1 * rb1->GetExpectedSignal() + w2 * rb2->GetExpectedSignal();
+  return w1 * rb1->GetExpectedSignal(fluxes) +
+         w2 * rb2->GetExpectedSignal(fluxes);
 }
 
 
+bool ExtendedSourceDetectorResponse::GetDecInterpolation(
+    const double dec, int &decb1, int &decb2, double &w1, double &w2) {
+  for (int i = decBinId_[0]; i <= decBinId_[numRegions_ - 1]; ++i) {
+    if ((dec < decUpperEdge_[i - decBinId_[0]]) && (dec >= decLowerEdge_[i - decBinId_[0]])) {
+      decb1 = i;
+      decb2 = i;
+      double dec1 = dr_.GetDecBinMap()[i].simDec_; //for declination centers
+      if (dec < dec1 && decb1 > 0) {
+        decb2 = decb1 - 1;
+      }
+      if (dec > dec1 && decb1 < int(dr_.GetDecBinMap().size()) - 1) {
+        decb2 = decb1 + 1;
+      }
+      double dec2 = dr_.GetDecBinMap()[decb2].simDec_;
+      if (dec1 == dec2) {
+        w1 = 1.;
+        w2 = 0.;
+      } else {
+        w1 = (dec - dec2) / (dec1 - dec2);
+        w2 = (dec - dec1) / (dec2 - dec1);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
 void ExtendedSourceDetectorResponse::checkRegionId(int regionId) const {
   if ((regionId < 0) || (regionId >= numRegions_)) {
     log_fatal("Source region ID " << regionId << " not defined!");
@@ -469,6 +815,9 @@ vector<pair<double, double> > ExtendedSourceDetectorResponse::GetPositions(int n
   if (!positions_.empty()) return positions_;
 
   healpixIds_.clear();
+  //sampled at the old positions
+  modelFluxes_.clear();
+  modelSampled_.clear();
   log_debug(minra_<<" "<<maxra_<<" "<<mindec_<<" "<<maxdec_);
 
   double maxaDec = min(fabs(mindec_), fabs(maxdec_));
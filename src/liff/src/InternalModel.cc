@@ -15,7 +15,11 @@ InternalModel::InternalModel(bool CNfit, bool BGfit)
       isCommonNormFree_(CNfit),
       isBackgroundNormFree_(BGfit),
       detResFree_(false),
-      verbosity_(-1) { }
+      verbosity_(-1),
+      llKernel_(LL_KERNEL_VECTORIZED),
+      llTolerance_(1e-9),
+      analyticCNFit_(true),
+      analyticGradient_(true) { }
 
 /*****************************************************/
 
@@ -26,7 +30,11 @@ InternalModel::InternalModel(
       commonNormError_(1),
       isCommonNormFree_(CNfit),
       isBackgroundNormFree_(BGfit),
-      verbosity_(-1) {
+      verbosity_(-1),
+      llKernel_(LL_KERNEL_VECTORIZED),
+      llTolerance_(1e-9),
+      analyticCNFit_(true),
+      analyticGradient_(true) {
 
   SetBackgroundModel(BGModel, FreeBGParIDs);
 
@@ -14,6 +14,7 @@ using namespace HAWCUnits;
 InternalModelBin::InternalModelBin()
     : bgMap_(0),
       pixelArea_(-1),
+      bgRevision_(0),
       backgroundNorm_(1),
       backgroundNormError_(0) {
 }
@@ -29,6 +30,7 @@ InternalModelBin::InternalModelBin(const BinName& binID,
       intModel_(Internal),
       bgMap_(BGMap),
       roiSkyPos_(ROI),
+      bgRevision_(0),
       backgroundNorm_(1),
       backgroundNormError_(0) {
 
@@ -59,6 +61,7 @@ void InternalModelBin::FitBackgroundModelToMap(SkyMap<double> *BGMap) {
   if (!bgModelBin_) log_fatal("No BackgroundModel defined in CalcBin "
                                   << binID_ << "!");
   bgHash_.clear();
+  ++bgRevision_;
   log_debug("CalcBin " << binID_ << ": Fitting BGModel to BG-Map, "
                 << "all parameters free...")
 
@@ -156,23 +159,21 @@ void InternalModelBin::SetBackgroundFromMap(SkyMap<double> *BGMap) {
   bgModelBin_.reset();
   freeBGParList_.clear();
   bgHash_.clear();
+  ++bgRevision_;
   log_debug("Use BG map from data as background in CalcBin " << binID_ << " .");
 }
 
 /*****************************************************/
 
-double InternalModelBin::BG(int hp) {
+double InternalModelBin::UnscaledBG(int hp) {
 
-  if (bgHash_.count(hp) > 0) {
-    return bgHash_[hp] * BackgroundNorm();
-  }
-  else if (!bgMap_) {
+  if (!bgMap_) {
     log_fatal("No BGMap from data defined for CalcBin " << binID_ << "!");
     return 0.; //to get rid of compiler warning
   }
   else if (!bgModelBin_) {
+    //SkyMap lookups are O(1), no need to cache map values
     double bgval = (*bgMap_)[hp];
-    //cache without variable BackgroundNorm
     /*
     if (bgval==0.) {
       //90%-Poisson confidence limit for 0 counts in integration duration:
@@ -196,8 +197,11 @@ double InternalModelBin::BG(int hp) {
         <<" , assuming "<<duration<<" hour direct-integration duration");
     }
     */
-    bgHash_[hp] = bgval;
-    return bgval * BackgroundNorm();
+    return bgval;
+  }
+  std::map<int, double>::const_iterator cached = bgHash_.find(hp);
+  if (cached != bgHash_.end()) {
+    return cached->second;
   }
   else {
     SkyPos center(bgMap_->pix2ang(hp));
@@ -205,7 +209,7 @@ double InternalModelBin::BG(int hp) {
     double bgval = bgModelBin_->Eval(center.RA(), center.Dec()) * pixelArea_;
     //cache without variable BackgroundNorm
     bgHash_[hp] = bgval;
-    return bgval * BackgroundNorm();
+    return bgval;
   }
 }
 
@@ -213,6 +217,7 @@ double InternalModelBin::BG(int hp) {
 
 void InternalModelBin::AddFreeBackgroundParameter(int ParId) {
   bgHash_.clear();
+  ++bgRevision_;
   FreeParameter FP;
   FP.FuncPointer = GetBackgroundModel();
   FP.ParId = ParId;
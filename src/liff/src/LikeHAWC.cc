@@ -10,7 +10,11 @@
 #include <liff/BinList.h>
 #include <liff/LikeHAWC.h>
 #include <liff/Minimize.h>
+#include <liff/ThreadPool.h>
 #include <vector>
+
+#include <boost/bind.hpp>
+
 //#include <liff/ROI.h>
 #include <hawcnest/HAWCUnits.h>
 #include <data-structures/geometry/R3Transform.h>
@@ -68,23 +72,17 @@ LikeHAWC::LikeHAWC()
     : data_(0),
       mi_(NullModelInterface),
       detRes_(""),
-      fixedROI_(false) {
+      fixedROI_(false),
+      pixelChunkSize_(DefaultPixelChunkSize) {
 
   //default Internal Model:
   internal_ = InternalModelPtr(new InternalModel());
   log_debug("Using default InternalModel with only BG norm fit.");
-
-  gLikeHAWC = this;
 }
 
 LikeHAWC::~LikeHAWC()
 {
   log_info("Destructing LikeHAWC instance.")
-
-  // This avoid having a global pointer pointing to something that has been destructed
-
-  gLikeHAWC = NULL;
-
 }
 
 LikeHAWC::LikeHAWC(SkyMapCollection *Data, const string& DetRes,
@@ -92,7 +90,8 @@ LikeHAWC::LikeHAWC(SkyMapCollection *Data, const string& DetRes,
     : data_(Data),
       mi_(NullModelInterface),
       detRes_(DetRes),
-      fixedROI_(true) {
+      fixedROI_(true),
+      pixelChunkSize_(DefaultPixelChunkSize) {
 
   //default Internal Model:
   internal_ = InternalModelPtr(new InternalModel());
@@ -103,12 +102,6 @@ LikeHAWC::LikeHAWC(SkyMapCollection *Data, const string& DetRes,
   roi_.push_back(SkyPos(360., 0.));
 
   SetupCalcBins(binList);
-
-  if (gLikeHAWC) {
-    log_warn("Global pointer 'gLikeHAWC' is already defined,"
-                 << " changing it to new instance of 'LikeHAWC'.");
-  }
-  gLikeHAWC = this;
 }
 
 LikeHAWC::LikeHAWC(
@@ -123,7 +116,8 @@ LikeHAWC::LikeHAWC(
     : data_(Data),
       mi_(model),
       detRes_(DetRes),
-      fixedROI_(roiFixed) {
+      fixedROI_(roiFixed),
+      pixelChunkSize_(DefaultPixelChunkSize) {
       //fixedROI_(false) {
 
   //default Internal Model:
@@ -132,12 +126,6 @@ LikeHAWC::LikeHAWC(
   SetROI(roiRA, roiDec, roiRadius, roiFixed);
   //SetROI(roiRA, roiDec, roiRadius, roiFixed=false);
   SetupCalcBins(binList);
-
-  if (gLikeHAWC) {
-    log_warn("Global pointer 'gLikeHAWC' is already defined,"
-                 << " changing it to new instance of 'LikeHAWC'.");
-  }
-  gLikeHAWC = this;
 }
 
 
@@ -150,7 +138,8 @@ LikeHAWC::LikeHAWC(
     : data_(Data),
       mi_(model),
       detRes_(DetRes),
-      fixedROI_(false) {
+      fixedROI_(false),
+      pixelChunkSize_(DefaultPixelChunkSize) {
 
   //default Internal Model:
   internal_ = InternalModelPtr(new InternalModel());
@@ -159,12 +148,6 @@ LikeHAWC::LikeHAWC(
 
   ResetSources(model);
   SetupCalcBins(binList); //error here
-
-  if (gLikeHAWC) {
-    log_warn("Global pointer 'gLikeHAWC' is already defined,"
-                 << " changing it to new instance of 'LikeHAWC'.");
-  }
-  gLikeHAWC = this;
 }
 
 //mi_(LikeHAWC::NullModelInterface)
@@ -178,19 +161,14 @@ LikeHAWC::LikeHAWC(
       mi_(NullModelInterface),
       detRes_(DetRes),
       internal_(internal),
-      fixedROI_(false) {
+      fixedROI_(false),
+      pixelChunkSize_(DefaultPixelChunkSize) {
 
   //default ROI all-sky:
   roi_.push_back(SkyPos(180., 0.));
   roi_.push_back(SkyPos(360., 0.));
 
   SetupCalcBins(binList);
-
-  if (gLikeHAWC) {
-    log_warn("Global pointer 'gLikeHAWC' is already defined,"
-                 << " changing it to new instance of 'LikeHAWC'.");
-  }
-  gLikeHAWC = this;
 }
 
 LikeHAWC::LikeHAWC(
@@ -203,16 +181,11 @@ LikeHAWC::LikeHAWC(
       mi_(model),
       detRes_(DetRes),
       internal_(internal),
-      fixedROI_(false) {
+      fixedROI_(false),
+      pixelChunkSize_(DefaultPixelChunkSize) {
 
   ResetSources(model);
   SetupCalcBins(binList);
-
-  if (gLikeHAWC) {
-    log_warn("Global pointer 'gLikeHAWC' is already defined,"
-                 << " changing it to new instance of 'LikeHAWC'.");
-  }
-  gLikeHAWC = this;
 }
 
 LikeHAWC::LikeHAWC(
@@ -224,7 +197,8 @@ LikeHAWC::LikeHAWC(
     : data_(0),
       mi_(model),
       detRes_(DetRes),
-      fixedROI_(false) {
+      fixedROI_(false),
+      pixelChunkSize_(DefaultPixelChunkSize) {
 
   //default Internal Model:
   internal_ = InternalModelPtr(new InternalModel());
@@ -249,12 +223,6 @@ LikeHAWC::LikeHAWC(
   SetData(mapTreeFile, roi, binList);
 
   SetupCalcBins(binList);
-
-  if (gLikeHAWC) {
-    log_warn("Global pointer 'gLikeHAWC' is already defined,"
-                 << " changing it to new instance of 'LikeHAWC'.");
-  }
-  gLikeHAWC = this;
 }
 
 LikeHAWC::LikeHAWC(
@@ -266,7 +234,8 @@ LikeHAWC::LikeHAWC(
     bool loadAllSky)
     : mi_(model),
       detRes_(DetRes),
-      fixedROI_(false) {
+      fixedROI_(false),
+      pixelChunkSize_(DefaultPixelChunkSize) {
 
   log_debug("Trying again...");
   log_info(mi_.getNumberOfPointSources());
@@ -295,12 +264,6 @@ LikeHAWC::LikeHAWC(
   SetData(mapTreeFile, nTransits, roi, binList);
 
   SetupCalcBins(binList);
-
-  if (gLikeHAWC) {
-    log_warn("Global pointer 'gLikeHAWC' is already defined,"
-                 << " changing it to new instance of 'LikeHAWC'.");
-  }
-  gLikeHAWC = this;
 }
 
 //ROI.cc ver.
@@ -351,12 +314,6 @@ LikeHAWC::LikeHAWC(
 //  SetData(mapTreeFile, nTransits, roi, binList);
 //
 //  SetupCalcBins(binList);
-//
-//  if (gLikeHAWC) {
-//    log_warn("Global pointer 'gLikeHAWC' is already defined,"
-//                 << " changing it to new instance of 'LikeHAWC'.");
-//  }
-//  gLikeHAWC = this;
 //}
 
 LikeHAWC::LikeHAWC(
@@ -365,7 +322,8 @@ LikeHAWC::LikeHAWC(
     const BinList& binList)
     : mi_(NullModelInterface),
       detRes_(DetRes),
-      fixedROI_(false) {
+      fixedROI_(false),
+      pixelChunkSize_(DefaultPixelChunkSize) {
 
   //default Internal Model:
   internal_ = InternalModelPtr(new InternalModel());
@@ -380,12 +338,6 @@ LikeHAWC::LikeHAWC(
   SetData(mapTreeFile, roi_, binList);
 
   SetupCalcBins(binList);
-
-  if (gLikeHAWC) {
-    log_warn("Global pointer 'gLikeHAWC' is already defined,"
-                 << " changing it to new instance of 'LikeHAWC'.");
-  }
-  gLikeHAWC = this;
 }
 
 
@@ -396,7 +348,8 @@ LikeHAWC::LikeHAWC(
     const BinList& binList)
     : mi_(NullModelInterface),
       detRes_(DetRes),
-      fixedROI_(false) {
+      fixedROI_(false),
+      pixelChunkSize_(DefaultPixelChunkSize) {
 
   //default Internal Model:
   internal_ = InternalModelPtr(new InternalModel());
@@ -411,12 +364,6 @@ LikeHAWC::LikeHAWC(
   SetData(mapTreeFile, nTransits, roi_, binList);
 
   SetupCalcBins(binList);
-
-  if (gLikeHAWC) {
-    log_warn("Global pointer 'gLikeHAWC' is already defined,"
-                 << " changing it to new instance of 'LikeHAWC'.");
-  }
-  gLikeHAWC = this;
 }
 
 
@@ -609,13 +556,17 @@ void LikeHAWC::UpdateSources() {
       moved += pointSources_[n]->SetModel(mi_, detResFree);
     }
     log_debug("Updated " << nps << " point source(s).");
-    //then, extended sources:
+    //then, extended sources, only re-convoluted if their model changed:
+    int changed = 0;
     for (int n = 0; n < nex; n++) {
-      extendedSources_[n]->SetModel(mi_, true);
+      if (extendedSources_[n]->UpdateModel(mi_)) {
+        ++changed;
+      }
     }
-    log_debug("Updated " << nex << " extended source(s).");
+    log_debug("Updated " << changed << " of " << nex
+              << " extended source(s).");
 
-    if (!fixedROI_ && ((moved > 0) || (nex > 0))) {
+    if (!fixedROI_ && ((moved > 0) || (changed > 0))) {
       //setting new roi, includes clearing the cached expected signal
       SetROI(MatchROI(padding_));
     }
@@ -917,17 +868,159 @@ LikeHAWC::GetExtendedSourceDetectorResponse(int sID) {
 
 /*****************************************************/
 
+void LikeHAWC::SetNumberOfThreads(unsigned nThreads, unsigned pixelChunkSize) {
+  pixelChunkSize_ = pixelChunkSize;
+  if (nThreads == 1) {
+    threadPool_.reset();
+    log_info("Evaluating the likelihood in a single thread.");
+    return;
+  }
+  threadPool_ = ThreadPoolPtr(new ThreadPool(nThreads));
+  log_info("Evaluating the likelihood with "
+           << threadPool_->GetNumberOfThreads() << " threads.");
+}
+
+/*****************************************************/
+
+unsigned LikeHAWC::GetNumberOfThreads() const {
+  return threadPool_ ? threadPool_->GetNumberOfThreads() : 1;
+}
+
+/*****************************************************/
+
+// Tasks are (CalcBin, pixel chunk) pairs. Everything shared between tasks is
+// built serially by CalcBin::PrepareLogLikelihood, and the partial sums are
+// added up in a fixed order, so the result does not depend on the number of
+// threads or on the scheduling. Without a thread pool the same tasks are
+// run in the calling thread.
+double LikeHAWC::SumLogLikelihood(bool signal) {
+
+  double LL = 0;
+
+  vector<unsigned> taskBin;
+  vector<unsigned> taskChunk;
+  for (unsigned k = 0; k < calcBins_.size(); ++k) {
+    unsigned nChunks =
+        calcBins_[k]->PrepareLogLikelihood(signal, pixelChunkSize_);
+    for (unsigned c = 0; c < nChunks; ++c) {
+      taskBin.push_back(k);
+      taskChunk.push_back(c);
+    }
+  }
+
+  vector<double> taskLL(taskBin.size(), 0.);
+  if (threadPool_) {
+    threadPool_->Run(taskBin.size(),
+                     boost::bind(&LikeHAWC::EvaluateLogLikelihoodTask, this,
+                                 signal, boost::cref(taskBin),
+                                 boost::cref(taskChunk), boost::ref(taskLL),
+                                 _1));
+  }
+  else {
+    for (unsigned t = 0; t < taskBin.size(); ++t) {
+      EvaluateLogLikelihoodTask(signal, taskBin, taskChunk, taskLL, t);
+    }
+  }
+
+  for (unsigned t = 0; t < taskLL.size(); ++t) {
+    LL += taskLL[t];
+  }
+  return LL;
+}
+
+/*****************************************************/
+
+void LikeHAWC::EvaluateLogLikelihoodTask(bool signal,
+                                         const vector<unsigned> &taskBin,
+                                         const vector<unsigned> &taskChunk,
+                                         vector<double> &taskLL,
+                                         unsigned t) {
+  taskLL[t] =
+      calcBins_[taskBin[t]]->CalcLogLikelihoodChunk(signal, taskChunk[t]);
+}
+
+/*****************************************************/
+
+// One task per CalcBin, with the caches built serially before as in
+// SumLogLikelihood; the bins are added up in a fixed order.
+double LikeHAWC::SumLogLikelihoodGradient(bool signal,
+                                          vector<double> &dCommonNorms,
+                                          vector<double> &dBackgroundNorms) {
+
+  for (unsigned k = 0; k < calcBins_.size(); ++k) {
+    calcBins_[k]->PrepareLogLikelihood(signal, 0);
+  }
+
+  vector<double> binLL(calcBins_.size(), 0.);
+  dCommonNorms.assign(calcBins_.size(), 0.);
+  dBackgroundNorms.assign(calcBins_.size(), 0.);
+  if (threadPool_) {
+    threadPool_->Run(calcBins_.size(),
+                     boost::bind(&LikeHAWC::EvaluateLogLikelihoodGradientTask,
+                                 this, signal, boost::ref(binLL),
+                                 boost::ref(dCommonNorms),
+                                 boost::ref(dBackgroundNorms), _1));
+  }
+  else {
+    for (unsigned k = 0; k < calcBins_.size(); ++k) {
+      EvaluateLogLikelihoodGradientTask(signal, binLL, dCommonNorms,
+                                        dBackgroundNorms, k);
+    }
+  }
+
+  double LL = 0;
+  for (unsigned k = 0; k < binLL.size(); ++k) {
+    LL += binLL[k];
+  }
+  return LL;
+}
+
+/*****************************************************/
+
+void LikeHAWC::EvaluateLogLikelihoodGradientTask(
+    bool signal, vector<double> &binLL, vector<double> &dCommonNorms,
+    vector<double> &dBackgroundNorms, unsigned k) {
+  if (signal) {
+    binLL[k] = calcBins_[k]->CalcLogLikelihoodGradient(dCommonNorms[k],
+                                                       dBackgroundNorms[k]);
+  }
+  else {
+    binLL[k] =
+        calcBins_[k]->CalcBackgroundLogLikelihoodGradient(dBackgroundNorms[k]);
+  }
+}
+
+/*****************************************************/
+
+double LikeHAWC::CalcLogLikelihoodGradient(double &dCommonNorm,
+                                           vector<double> &dBackgroundNorms) {
+  vector<double> dCommonNorms;
+  double LL = SumLogLikelihoodGradient(true, dCommonNorms, dBackgroundNorms);
+  dCommonNorm = 0.;
+  for (unsigned k = 0; k < dCommonNorms.size(); ++k) {
+    dCommonNorm += dCommonNorms[k];
+  }
+  return LL;
+}
+
+/*****************************************************/
+
+double LikeHAWC::CalcBackgroundLogLikelihoodGradient(
+    vector<double> &dBackgroundNorms) {
+  vector<double> dCommonNorms;
+  return SumLogLikelihoodGradient(false, dCommonNorms, dBackgroundNorms);
+}
+
+/*****************************************************/
+
 double LikeHAWC::CalcBackgroundLogLikelihood(bool doIntFit) {
   if (doIntFit) {
-    if (InternalBGMinimize() != 0) {
+    if (InternalBGMinimize(*this) != 0) {
       log_warn("BG-only fit failed, returning LL(BG)=2");
       return 2;
     }
   }
-  double LL = 0;
-  for (unsigned k = 0; k < calcBins_.size(); ++k) {
-    LL += calcBins_[k]->CalcBackgroundLogLikelihood();
-  }
+  double LL = SumLogLikelihood(false);
   log_debug("LL(Bg) =       " << LL)
   return LL;
   return LL;
@@ -937,15 +1030,12 @@ double LikeHAWC::CalcBackgroundLogLikelihood(bool doIntFit) {
 
 double LikeHAWC::CalcLogLikelihood(bool doIntFit) {
   if (doIntFit) {
-    if (InternalMinimize() != 0) {
+    if (InternalMinimize(*this) != 0) {
       log_warn("Source fit failed, returning LL(Model)=2");
       return 2;
     }
   }
-  double LL = 0;
-  for (unsigned k = 0; k < calcBins_.size(); ++k) {
-    LL += calcBins_[k]->CalcLogLikelihood();
-  }
+  double LL = SumLogLikelihood(true);
   log_debug("LL(Bg+Model) = " << LL)
   return LL;
 }
@@ -955,15 +1045,12 @@ double LikeHAWC::CalcLogLikelihood(bool doIntFit) {
 double LikeHAWC::CalcLogLikelihoodUpdateSources(bool doIntFit) {
   UpdateSources();
   if (doIntFit) {
-    if (InternalMinimize() != 0) {
+    if (InternalMinimize(*this) != 0) {
       log_warn("Source fit failed, returning LL(Model)=2");
       return 2;
     }
   }
-  double LL = 0;
-  for (unsigned k = 0; k < calcBins_.size(); ++k) {
-    LL += calcBins_[k]->CalcLogLikelihood();
-  }
+  double LL = SumLogLikelihood(true);
   log_debug("LL(Bg+Model) = " << LL)
   return LL;
 }
@@ -974,15 +1061,12 @@ double LikeHAWC::CalcLogLikelihood(
     ModelInterface &model, bool doIntFit) {
   ResetSources(model);
   if (doIntFit) {
-    if (InternalMinimize() != 0) {
+    if (InternalMinimize(*this) != 0) {
       log_warn("Source fit failed, returning LL(Model)=2");
       return 2;
     }
   }
-  double LL = 0;
-  for (unsigned k = 0; k < calcBins_.size(); ++k) {
-    LL += calcBins_[k]->CalcLogLikelihood();
-  }
+  double LL = SumLogLikelihood(true);
   log_debug("LL(Bg+Model) = " << LL)
   return LL;
 }
@@ -1081,7 +1165,7 @@ double LikeHAWC::CalcTopHatBackgroundLogLikelihood(
   topHatCenter = center;
   topHatRadius = radius;
   if (doIntFit) {
-    if (InternalTopHatBGMinimize() != 0) {
+    if (InternalTopHatBGMinimize(*this) != 0) {
       log_warn("BG-only fit failed, returning LL(BG)=2");
       return 2;
     }
@@ -1105,7 +1189,7 @@ double LikeHAWC::CalcTopHatLogLikelihood(
   topHatCenter = center;
   topHatRadius = radius;
   if (doIntFit) {
-    if (InternalTopHatMinimize() != 0) {
+    if (InternalTopHatMinimize(*this) != 0) {
       log_warn("Source fit failed, returning LL(Model)=2");
       return 2;
     }
@@ -1130,7 +1214,7 @@ double LikeHAWC::CalcTopHatLogLikelihoodUpdateSources(
   topHatRadius = radius;
   UpdateSources();
   if (doIntFit) {
-    if (InternalTopHatMinimize() != 0) {
+    if (InternalTopHatMinimize(*this) != 0) {
       log_warn("Source fit failed, returning LL(Model)=2");
       return 2;
     }
@@ -1156,7 +1240,7 @@ double LikeHAWC::CalcTopHatLogLikelihood(
   topHatRadius = radius;
   ResetSources(model);
   if (doIntFit) {
-    if (InternalTopHatMinimize() != 0) {
+    if (InternalTopHatMinimize(*this) != 0) {
       log_warn("Source fit failed, returning LL(Model)=2");
       return 2;
     }
@@ -1397,7 +1481,7 @@ vector<double> LikeHAWC::GetEnergies(bool reset) {
       log_fatal("Detector response file is not defined. Cannot get energy list.")
     }
 
-    DetectorResponse dr = DetectorResponse(detRes_);
+    DetectorResponse dr = DetectorResponse::Open(detRes_);
     AnalysisBinMap nhbmap = dr.GetAnalysisBinMap();
     AnalysisBinMap::iterator nh = nhbmap.begin();
     ResponseBinPtr rb = dr.GetBin(0, nh->first);
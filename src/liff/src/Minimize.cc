@@ -3,21 +3,56 @@
 #include <liff/LikeHAWC.h>
 
 #include <liff/Minimize.h>
+#include <liff/PoissonLikelihood.h>
+
+#include <algorithm>
 
 using namespace std;
 
-LikeHAWC *gLikeHAWC;
+namespace {
+
+  // Limits of the BackgroundNorms in fits with the analytic gradient. The
+  // LL is a constant penalty for norms <= 0, so neither its value nor its
+  // gradient could lead MIGRAD back from there.
+  const double minGradientBackgroundNorm = 1e-3;
+  const double maxGradientBackgroundNorm = 1e3;
+
+  // TMinuit calling back into the fit function with the LikeHAWC instance it
+  // was set up for, instead of going through a global pointer. Each fit owns
+  // its InternalMinuit, so fits of different LikeHAWC objects are independent.
+  class InternalMinuit : public TMinuit {
+
+    public:
+
+      InternalMinuit(int nPar, LikeHAWC &like, InternalFitFunction fitFunc)
+          : TMinuit(nPar), like_(like), fitFunc_(fitFunc) { }
+
+      virtual Int_t Eval(Int_t npar, Double_t *grad, Double_t &fval,
+                         Double_t *par, Int_t flag) {
+        int n = npar;
+        fitFunc_(like_, n, grad, fval, par, flag);
+        return 0;
+      }
+
+    private:
+
+      LikeHAWC &like_;
+      InternalFitFunction fitFunc_;
+
+  };
+
+}
 
 /*****************************************************/
 
-int InternalMinimize() {
+int InternalMinimize(LikeHAWC &like) {
 
   int nFree = 0;
   FreeParameterList freeParList;
 
   //free BG shape parameters
 
-  CalcBinVector &calcBinVector = gLikeHAWC->GetCalcBins();
+  CalcBinVector &calcBinVector = like.GetCalcBins();
 
   for (unsigned k = 0; k < calcBinVector.size(); ++k) {
 
@@ -32,7 +67,7 @@ int InternalMinimize() {
 
   //Other free parameters:
   FreeParameterList ofp =
-      gLikeHAWC->GetInternalModel()->GetFreeParameterList();
+      like.GetInternalModel()->GetFreeParameterList();
   nFree += ofp.size();
   freeParList.insert(freeParList.end(), ofp.begin(), ofp.end());
   bool updateSources = false;
@@ -47,7 +82,7 @@ int InternalMinimize() {
   //BGNorm fit
   vector<double> bn_values;
   vector<double> bn_errors;
-  bool bnFit = gLikeHAWC->GetInternalModel()->IsBackgroundNormFree();
+  bool bnFit = like.GetInternalModel()->IsBackgroundNormFree();
   if (bnFit) {
     for (unsigned k = 0; k < calcBinVector.size(); ++k) {
       InternalModelBin &imb = calcBinVector[k]->GetInternalModelBin();
@@ -61,7 +96,7 @@ int InternalMinimize() {
   }
 
   //Common Norm fit
-  bool cnFit = gLikeHAWC->GetInternalModel()->IsCommonNormFree();
+  bool cnFit = like.GetInternalModel()->IsCommonNormFree();
   if (cnFit) {
     nFree += 1;
     log_debug("Fitting CommonNorm.");
@@ -72,16 +107,34 @@ int InternalMinimize() {
     return 0;
   }
 
+  //CommonNorm alone: the LL is concave in it, no need for MINUIT
+  if (cnFit && (nFree == 1) &&
+      like.GetInternalModel()->IsAnalyticCommonNormFit() &&
+      (InternalCommonNormMinimize(like) == 0)) {
+    return 0;
+  }
+
   log_debug("Minimizing with " << nFree << " free parameters...");
 
+  //The expectation is linear in CommonNorm and the BackgroundNorms: if
+  //nothing else is free, MIGRAD gets the gradient instead of estimating it
+  //by finite differences
+  bool analyticGradient = freeParList.empty() &&
+      like.GetInternalModel()->IsAnalyticGradient();
+  for (unsigned k = 0; k < calcBinVector.size(); ++k) {
+    analyticGradient = analyticGradient &&
+                       calcBinVector[k]->HasLogLikelihoodGradient();
+  }
+
   //Setup Minimizer
-  TMinuit *theMinuit = new TMinuit(nFree);
+  InternalFitFunction fitFunc =
+      analyticGradient ? InternalFitFuncGradient :
+      updateSources ? InternalFitFuncUpdateSources : InternalFitFunc;
+  TMinuit *theMinuit = new InternalMinuit(nFree, like, fitFunc);
 
   // minuit verbosity, -1 = no printing, 0 = A little printing
-  int Verbosity = gLikeHAWC->GetInternalModel()->GetInternalFitVerbosity();
+  int Verbosity = like.GetInternalModel()->GetInternalFitVerbosity();
   theMinuit->SetPrintLevel(Verbosity);
-  if (updateSources) theMinuit->SetFCN(InternalFitFuncUpdateSources);
-  else theMinuit->SetFCN(InternalFitFunc);
 
   double arglist[2];  // arguments to pass to the Minuit interpreter
   int flag = 0;
@@ -94,6 +147,13 @@ int InternalMinimize() {
     log_warn("Minuit SET ERR failed, flag=" << flag);
     return -1;
   }
+  if (analyticGradient) {
+    arglist[0] = 1;   //use the gradient without checking it numerically
+    theMinuit->mnexcm("SET GRAD", arglist, 1, flag);
+    if (flag) {
+      log_warn("Minuit SET GRAD failed, flag=" << flag);
+    }
+  }
   //Setup Free Parameters
   //
   int np = 0;
@@ -112,16 +172,24 @@ int InternalMinimize() {
     for (unsigned b = 0; b < bn_values.size(); b++) {
       double BNValue = bn_values[b];
       double BNError = bn_errors[b];
+      double BNMin = 0;
+      double BNMax = 0;
+      if (analyticGradient) {
+        BNMin = minGradientBackgroundNorm;
+        BNMax = maxGradientBackgroundNorm;
+        BNValue = min(max(BNValue, BNMin), BNMax);
+      }
       if (BNError == 0) BNError = 0.1 * BNValue;
       string BNName = Form("BackgroundNorm_bin%d", b);
-      theMinuit->mnparm(np, BNName.c_str(), BNValue, BNError, 0, 0, flag);
+      theMinuit->mnparm(np, BNName.c_str(), BNValue, BNError, BNMin, BNMax,
+                        flag);
       np++;
     }
   }
   //and CommonNorm...
   if (cnFit) {
-    double CNValue = gLikeHAWC->GetInternalModel()->CommonNorm();
-    double CNError = gLikeHAWC->GetInternalModel()->CommonNormError();
+    double CNValue = like.GetInternalModel()->CommonNorm();
+    double CNError = like.GetInternalModel()->CommonNormError();
     if (CNError == 0) CNError = CNValue;
     string CNName = "CommonNorm";
     theMinuit->mnparm(np, CNName.c_str(), CNValue, CNError, 0, 0, flag);
@@ -167,8 +235,8 @@ int InternalMinimize() {
     double CNValue;
     double CNError;
     theMinuit->GetParameter(np, CNValue, CNError);
-    gLikeHAWC->GetInternalModel()->CommonNorm() = CNValue;
-    gLikeHAWC->GetInternalModel()->CommonNormError() = CNError;
+    like.GetInternalModel()->CommonNorm() = CNValue;
+    like.GetInternalModel()->CommonNormError() = CNError;
     np++;
   }
 
@@ -179,7 +247,41 @@ int InternalMinimize() {
 
 /*****************************************************/
 
-void InternalFitFunc(int &npar, double *gin, double &LL,
+int InternalCommonNormMinimize(LikeHAWC &like) {
+
+  vector<double> counts;
+  vector<double> excess;
+  vector<double> background;
+  CalcBinVector &calcBinVector = like.GetCalcBins();
+  for (unsigned k = 0; k < calcBinVector.size(); ++k) {
+    if (!calcBinVector[k]->GetCommonNormFitTerms(counts, excess,
+                                                 background)) {
+      log_debug("No analytic CommonNorm fit for bin "
+                << calcBinVector[k]->GetBinID() << ", using MINUIT.");
+      return 1;
+    }
+  }
+
+  double CNValue = like.GetInternalModel()->CommonNorm();
+  double CNError = 0;
+  if (counts.empty() ||
+      !PoissonMaximizeNorm(&counts[0], &excess[0], &background[0],
+                           counts.size(), CNValue, CNError)) {
+    log_debug("No maximum of the LL in CommonNorm found, using MINUIT.");
+    return 1;
+  }
+
+  like.GetInternalModel()->CommonNorm() = CNValue;
+  like.GetInternalModel()->CommonNormError() = CNError;
+  log_debug("CommonNorm = " << CNValue << " +- " << CNError
+            << " (Newton's method)");
+  return 0;
+}
+
+/*****************************************************/
+
+void InternalFitFunc(LikeHAWC &like,
+                     int &npar, double *gin, double &LL,
                      double *par, int iflag) {
 
   //npar:  Number of parameters
@@ -204,7 +306,7 @@ void InternalFitFunc(int &npar, double *gin, double &LL,
 
   //Assign Parameters
   int n = 0;
-  CalcBinVector &calcBinVector = gLikeHAWC->GetCalcBins();
+  CalcBinVector &calcBinVector = like.GetCalcBins();
 
   //BG fit: free parameters in each CalcBin:
   for (unsigned k = 0; k < calcBinVector.size(); k++) {
@@ -221,7 +323,7 @@ void InternalFitFunc(int &npar, double *gin, double &LL,
   /*
   //Other free parameters:
   FreeParameterList ofp =
-    gLikeHAWC->GetInternalModel()->GetFreeParameterList();
+    like.GetInternalModel()->GetFreeParameterList();
   for (unsigned j=0; j<ofp.size(); j++) {
     int ParId = ofp[j].ParId;
     ofp[j].FuncPointer->SetParameter(ParId, par[n]);
@@ -229,7 +331,7 @@ void InternalFitFunc(int &npar, double *gin, double &LL,
   }
   */
   //Background Norm fit
-  bool bnFit = gLikeHAWC->GetInternalModel()->IsBackgroundNormFree();
+  bool bnFit = like.GetInternalModel()->IsBackgroundNormFree();
   if (bnFit) {
     for (unsigned k = 0; k < calcBinVector.size(); k++) {
       InternalModelBin &imb = calcBinVector[k]->GetInternalModelBin();
@@ -238,19 +340,20 @@ void InternalFitFunc(int &npar, double *gin, double &LL,
     }
   }
   //Common Norm fit
-  bool cnFit = gLikeHAWC->GetInternalModel()->IsCommonNormFree();
+  bool cnFit = like.GetInternalModel()->IsCommonNormFree();
   if (cnFit) {
-    gLikeHAWC->GetInternalModel()->CommonNorm() = par[n];
+    like.GetInternalModel()->CommonNorm() = par[n];
     //n++;
   }
 
-  LL = -gLikeHAWC->CalcLogLikelihood(false);
+  LL = -like.CalcLogLikelihood(false);
 
 }
 
 /*****************************************************/
 
-void InternalFitFuncUpdateSources(int &npar, double *gin, double &LL,
+void InternalFitFuncUpdateSources(LikeHAWC &like,
+                                  int &npar, double *gin, double &LL,
                                   double *par, int iflag) {
 
   //npar:  Number of parameters
@@ -276,7 +379,7 @@ void InternalFitFuncUpdateSources(int &npar, double *gin, double &LL,
   //Assign Parameters
   int n = 0;
 
-  CalcBinVector &calcBinVector = gLikeHAWC->GetCalcBins();
+  CalcBinVector &calcBinVector = like.GetCalcBins();
 
   //BG fit: free parameters in each CalcBin:
   for (unsigned k = 0; k < calcBinVector.size(); k++) {
@@ -290,14 +393,14 @@ void InternalFitFuncUpdateSources(int &npar, double *gin, double &LL,
   }
   //Other free parameters:
   FreeParameterList ofp =
-      gLikeHAWC->GetInternalModel()->GetFreeParameterList();
+      like.GetInternalModel()->GetFreeParameterList();
   for (unsigned j = 0; j < ofp.size(); j++) {
     int ParId = ofp[j].ParId;
     ofp[j].FuncPointer->SetParameter(ParId, par[n]);
     n++;
   }
   //Background Norm fit
-  bool bnFit = gLikeHAWC->GetInternalModel()->IsBackgroundNormFree();
+  bool bnFit = like.GetInternalModel()->IsBackgroundNormFree();
   if (bnFit) {
     for (unsigned k = 0; k < calcBinVector.size(); k++) {
       InternalModelBin &imb = calcBinVector[k]->GetInternalModelBin();
@@ -306,24 +409,67 @@ void InternalFitFuncUpdateSources(int &npar, double *gin, double &LL,
     }
   }
   //Common Norm fit
-  bool cnFit = gLikeHAWC->GetInternalModel()->IsCommonNormFree();
+  bool cnFit = like.GetInternalModel()->IsCommonNormFree();
   if (cnFit) {
-    gLikeHAWC->GetInternalModel()->CommonNorm() = par[n];
+    like.GetInternalModel()->CommonNorm() = par[n];
     n++;
   }
 
-  LL = -gLikeHAWC->CalcLogLikelihoodUpdateSources(false);
+  LL = -like.CalcLogLikelihoodUpdateSources(false);
 }
 
 
 /*****************************************************/
 
-int InternalBGMinimize() {
+void InternalFitFuncGradient(LikeHAWC &like,
+                             int &npar, double *gin, double &LL,
+                             double *par, int iflag) {
+
+  //Same parameter order as InternalFitFunc, but only BackgroundNorms and
+  //CommonNorm can be free. The gradient costs no extra pass over the
+  //pixels, so it is always filled.
+  int n = 0;
+  CalcBinVector &calcBinVector = like.GetCalcBins();
+
+  //Background Norm fit
+  bool bnFit = like.GetInternalModel()->IsBackgroundNormFree();
+  if (bnFit) {
+    for (unsigned k = 0; k < calcBinVector.size(); k++) {
+      InternalModelBin &imb = calcBinVector[k]->GetInternalModelBin();
+      imb.BackgroundNorm() = par[n];
+      n++;
+    }
+  }
+  //Common Norm fit
+  bool cnFit = like.GetInternalModel()->IsCommonNormFree();
+  if (cnFit) {
+    like.GetInternalModel()->CommonNorm() = par[n];
+  }
+
+  double dCommonNorm = 0.;
+  vector<double> dBackgroundNorms;
+  double logLike = like.CalcLogLikelihoodGradient(dCommonNorm,
+                                                  dBackgroundNorms);
+  if (bnFit && gin) {
+    for (unsigned k = 0; k < calcBinVector.size(); k++) {
+      gin[k] = -dBackgroundNorms[k];
+    }
+  }
+  if (cnFit && gin) {
+    gin[n] = -dCommonNorm;
+  }
+
+  LL = -logLike;
+}
+
+/*****************************************************/
+
+int InternalBGMinimize(LikeHAWC &like) {
 
   int nFree = 0;
   FreeParameterList freeParList;
 
-  CalcBinVector &calcBinVector = gLikeHAWC->GetCalcBins();
+  CalcBinVector &calcBinVector = like.GetCalcBins();
 
   //BG fit
   //free parameters in each CalcBin:
@@ -336,7 +482,7 @@ int InternalBGMinimize() {
   //BGNorm fit
   vector<double> bn_values;
   vector<double> bn_errors;
-  bool bnFit = gLikeHAWC->GetInternalModel()->IsBackgroundNormFree();
+  bool bnFit = like.GetInternalModel()->IsBackgroundNormFree();
   if (bnFit) {
     for (unsigned k = 0; k < calcBinVector.size(); ++k) {
       InternalModelBin &imb = calcBinVector[k]->GetInternalModelBin();
@@ -357,13 +503,18 @@ int InternalBGMinimize() {
 
   log_debug("Minimizing with " << nFree << " free parameters...");
 
+  //BackgroundNorms only: MIGRAD gets the gradient (see InternalMinimize)
+  bool analyticGradient = freeParList.empty() &&
+      like.GetInternalModel()->IsAnalyticGradient();
+
   //Setup Minimizer
-  TMinuit *theMinuit = new TMinuit(nFree);
+  TMinuit *theMinuit = new InternalMinuit(
+      nFree, like,
+      analyticGradient ? InternalBGFitFuncGradient : InternalBGFitFunc);
 
   // minuit verbosity, -1 = no printing, 0 = A little printing
-  int Verbosity = gLikeHAWC->GetInternalModel()->GetInternalFitVerbosity();
+  int Verbosity = like.GetInternalModel()->GetInternalFitVerbosity();
   theMinuit->SetPrintLevel(Verbosity);
-  theMinuit->SetFCN(InternalBGFitFunc);
 
   double arglist[2];  // arguments to pass to the Minuit interpreter
   int flag = 0;
@@ -376,6 +527,13 @@ int InternalBGMinimize() {
     log_warn("Minuit SET ERR failed, flag=" << flag);
     return -1;
   }
+  if (analyticGradient) {
+    arglist[0] = 1;   //use the gradient without checking it numerically
+    theMinuit->mnexcm("SET GRAD", arglist, 1, flag);
+    if (flag) {
+      log_warn("Minuit SET GRAD failed, flag=" << flag);
+    }
+  }
 
 
   //Setup Free Parameters
@@ -394,9 +552,17 @@ int InternalBGMinimize() {
     for (unsigned b = 0; b < bn_values.size(); b++) {
       double BNValue = bn_values[b];
       double BNError = bn_errors[b];
+      double BNMin = 0;
+      double BNMax = 0;
+      if (analyticGradient) {
+        BNMin = minGradientBackgroundNorm;
+        BNMax = maxGradientBackgroundNorm;
+        BNValue = min(max(BNValue, BNMin), BNMax);
+      }
       if (BNError == 0) BNError = 0.1 * BNValue;
       string BNName = Form("BackgroundNorm_bin%d", b);
-      theMinuit->mnparm(np, BNName.c_str(), BNValue, BNError, 0, 0, flag);
+      theMinuit->mnparm(np, BNName.c_str(), BNValue, BNError, BNMin, BNMax,
+                        flag);
       np++;
     }
   }
@@ -443,7 +609,8 @@ int InternalBGMinimize() {
 
 /*****************************************************/
 
-void InternalBGFitFunc(int &npar, double *gin, double &LL,
+void InternalBGFitFunc(LikeHAWC &like,
+                       int &npar, double *gin, double &LL,
                        double *par, int iflag) {
 
   //npar:  Number of parameters
@@ -469,7 +636,7 @@ void InternalBGFitFunc(int &npar, double *gin, double &LL,
   //Assign Parameters
   int n = 0;
 
-  CalcBinVector &calcBinVector = gLikeHAWC->GetCalcBins();
+  CalcBinVector &calcBinVector = like.GetCalcBins();
 
   //BG fit: free parameters in each CalcBin:
   for (unsigned k = 0; k < calcBinVector.size(); k++) {
@@ -482,7 +649,7 @@ void InternalBGFitFunc(int &npar, double *gin, double &LL,
     }
   }
   //Background Norm fit
-  bool bnFit = gLikeHAWC->GetInternalModel()->IsBackgroundNormFree();
+  bool bnFit = like.GetInternalModel()->IsBackgroundNormFree();
   if (bnFit) {
     for (unsigned k = 0; k < calcBinVector.size(); k++) {
       InternalModelBin &imb = calcBinVector[k]->GetInternalModelBin();
@@ -491,18 +658,41 @@ void InternalBGFitFunc(int &npar, double *gin, double &LL,
     }
   }
 
-  LL = -gLikeHAWC->CalcBackgroundLogLikelihood(false);
+  LL = -like.CalcBackgroundLogLikelihood(false);
+}
+
+/*****************************************************/
+
+void InternalBGFitFuncGradient(LikeHAWC &like,
+                               int &npar, double *gin, double &LL,
+                               double *par, int iflag) {
+
+  //Only the BackgroundNorms are free, one per CalcBin
+  CalcBinVector &calcBinVector = like.GetCalcBins();
+  for (unsigned k = 0; k < calcBinVector.size(); k++) {
+    calcBinVector[k]->GetInternalModelBin().BackgroundNorm() = par[k];
+  }
+
+  vector<double> dBackgroundNorms;
+  double logLike = like.CalcBackgroundLogLikelihoodGradient(dBackgroundNorms);
+  if (gin) {
+    for (unsigned k = 0; k < calcBinVector.size(); k++) {
+      gin[k] = -dBackgroundNorms[k];
+    }
+  }
+
+  LL = -logLike;
 }
 
 
 /*****************************************************/
 
-int InternalTopHatMinimize() {
+int InternalTopHatMinimize(LikeHAWC &like) {
 
   int nFree = 0;
   FreeParameterList freeParList;
 
-  CalcBinVector &calcBinVector = gLikeHAWC->GetCalcBins();
+  CalcBinVector &calcBinVector = like.GetCalcBins();
 
   //free BG shape parameters
   for (unsigned k = 0; k < calcBinVector.size(); ++k) {
@@ -517,7 +707,7 @@ int InternalTopHatMinimize() {
 
   //Other free parameters:
   FreeParameterList ofp =
-      gLikeHAWC->GetInternalModel()->GetFreeParameterList();
+      like.GetInternalModel()->GetFreeParameterList();
   nFree += ofp.size();
   freeParList.insert(freeParList.end(), ofp.begin(), ofp.end());
   bool updateSources = false;
@@ -532,7 +722,7 @@ int InternalTopHatMinimize() {
   //BGNorm fit
   vector<double> bn_values;
   vector<double> bn_errors;
-  bool bnFit = gLikeHAWC->GetInternalModel()->IsBackgroundNormFree();
+  bool bnFit = like.GetInternalModel()->IsBackgroundNormFree();
   if (bnFit) {
     for (unsigned k = 0; k < calcBinVector.size(); ++k) {
       InternalModelBin &imb = calcBinVector[k]->GetInternalModelBin();
@@ -545,7 +735,7 @@ int InternalTopHatMinimize() {
   }
 
   //Common Norm fit
-  bool cnFit = gLikeHAWC->GetInternalModel()->IsCommonNormFree();
+  bool cnFit = like.GetInternalModel()->IsCommonNormFree();
   if (cnFit) {
     nFree += 1;
     log_debug("Fitting CommonNorm.");
@@ -559,13 +749,13 @@ int InternalTopHatMinimize() {
   log_debug("Minimizing with " << nFree << " free parameters...");
 
   //Setup Minimizer
-  TMinuit *theMinuit = new TMinuit(nFree);
+  InternalFitFunction fitFunc = updateSources ?
+      InternalTopHatFitFuncUpdateSources : InternalTopHatFitFunc;
+  TMinuit *theMinuit = new InternalMinuit(nFree, like, fitFunc);
 
   // minuit verbosity, -1 = no printing, 0 = A little printing
-  int Verbosity = gLikeHAWC->GetInternalModel()->GetInternalFitVerbosity();
+  int Verbosity = like.GetInternalModel()->GetInternalFitVerbosity();
   theMinuit->SetPrintLevel(Verbosity);
-  if (updateSources) theMinuit->SetFCN(InternalTopHatFitFuncUpdateSources);
-  else theMinuit->SetFCN(InternalTopHatFitFunc);
 
   double arglist[2];  // arguments to pass to the Minuit interpreter
   int flag = 0;
@@ -604,8 +794,8 @@ int InternalTopHatMinimize() {
   }
   //and CommonNorm...
   if (cnFit) {
-    double CNValue = gLikeHAWC->GetInternalModel()->CommonNorm();
-    double CNError = gLikeHAWC->GetInternalModel()->CommonNormError();
+    double CNValue = like.GetInternalModel()->CommonNorm();
+    double CNError = like.GetInternalModel()->CommonNormError();
     if (CNError == 0) CNError = CNValue;
     string CNName = "CommonNorm";
     theMinuit->mnparm(np, CNName.c_str(), CNValue, CNError, 0, 0, flag);
@@ -651,8 +841,8 @@ int InternalTopHatMinimize() {
     double CNValue;
     double CNError;
     theMinuit->GetParameter(np, CNValue, CNError);
-    gLikeHAWC->GetInternalModel()->CommonNorm() = CNValue;
-    gLikeHAWC->GetInternalModel()->CommonNormError() = CNError;
+    like.GetInternalModel()->CommonNorm() = CNValue;
+    like.GetInternalModel()->CommonNormError() = CNError;
     np++;
   }
 
@@ -663,7 +853,8 @@ int InternalTopHatMinimize() {
 
 /*****************************************************/
 
-void InternalTopHatFitFunc(int &npar, double *gin, double &LL,
+void InternalTopHatFitFunc(LikeHAWC &like,
+                           int &npar, double *gin, double &LL,
                            double *par, int iflag) {
 
   //npar:  Number of parameters
@@ -689,7 +880,7 @@ void InternalTopHatFitFunc(int &npar, double *gin, double &LL,
   //Assign Parameters
   int n = 0;
 
-  CalcBinVector &calcBinVector = gLikeHAWC->GetCalcBins();
+  CalcBinVector &calcBinVector = like.GetCalcBins();
 
   //BG fit: free parameters in each CalcBin:
   for (unsigned k = 0; k < calcBinVector.size(); k++) {
@@ -706,7 +897,7 @@ void InternalTopHatFitFunc(int &npar, double *gin, double &LL,
   /*
   //Other free parameters:
   FreeParameterList ofp =
-    gLikeHAWC->GetInternalModel()->GetFreeParameterList();
+    like.GetInternalModel()->GetFreeParameterList();
   for (unsigned j=0; j<ofp.size(); j++) {
     int ParId = ofp[j].ParId;
     ofp[j].FuncPointer->SetParameter(ParId, par[n]);
@@ -714,7 +905,7 @@ void InternalTopHatFitFunc(int &npar, double *gin, double &LL,
   }
   */
   //Background Norm fit
-  bool bnFit = gLikeHAWC->GetInternalModel()->IsBackgroundNormFree();
+  bool bnFit = like.GetInternalModel()->IsBackgroundNormFree();
   if (bnFit) {
     for (unsigned k = 0; k < calcBinVector.size(); k++) {
       InternalModelBin &imb = calcBinVector[k]->GetInternalModelBin();
@@ -723,19 +914,20 @@ void InternalTopHatFitFunc(int &npar, double *gin, double &LL,
     }
   }
   //Common Norm fit
-  bool cnFit = gLikeHAWC->GetInternalModel()->IsCommonNormFree();
+  bool cnFit = like.GetInternalModel()->IsCommonNormFree();
   if (cnFit) {
-    gLikeHAWC->GetInternalModel()->CommonNorm() = par[n];
+    like.GetInternalModel()->CommonNorm() = par[n];
     n++;
   }
 
-  LL = -gLikeHAWC->CalcTopHatLogLikelihood(gLikeHAWC->topHatCenter,
-                                           gLikeHAWC->topHatRadius, false);
+  LL = -like.CalcTopHatLogLikelihood(like.topHatCenter,
+                                           like.topHatRadius, false);
 }
 
 /*****************************************************/
 
-void InternalTopHatFitFuncUpdateSources(int &npar, double *gin, double &LL,
+void InternalTopHatFitFuncUpdateSources(LikeHAWC &like,
+                                        int &npar, double *gin, double &LL,
                                         double *par, int iflag) {
 
   //npar:  Number of parameters
@@ -761,7 +953,7 @@ void InternalTopHatFitFuncUpdateSources(int &npar, double *gin, double &LL,
   //Assign Parameters
   int n = 0;
 
-  CalcBinVector &calcBinVector = gLikeHAWC->GetCalcBins();
+  CalcBinVector &calcBinVector = like.GetCalcBins();
 
   //BG fit: free parameters in each CalcBin:
   for (unsigned k = 0; k < calcBinVector.size(); k++) {
@@ -775,14 +967,14 @@ void InternalTopHatFitFuncUpdateSources(int &npar, double *gin, double &LL,
   }
   //Other free parameters:
   FreeParameterList ofp =
-      gLikeHAWC->GetInternalModel()->GetFreeParameterList();
+      like.GetInternalModel()->GetFreeParameterList();
   for (unsigned j = 0; j < ofp.size(); j++) {
     int ParId = ofp[j].ParId;
     ofp[j].FuncPointer->SetParameter(ParId, par[n]);
     n++;
   }
   //Background Norm fit
-  bool bnFit = gLikeHAWC->GetInternalModel()->IsBackgroundNormFree();
+  bool bnFit = like.GetInternalModel()->IsBackgroundNormFree();
   if (bnFit) {
     for (unsigned k = 0; k < calcBinVector.size(); k++) {
       InternalModelBin &imb = calcBinVector[k]->GetInternalModelBin();
@@ -791,25 +983,25 @@ void InternalTopHatFitFuncUpdateSources(int &npar, double *gin, double &LL,
     }
   }
   //Common Norm fit
-  bool cnFit = gLikeHAWC->GetInternalModel()->IsCommonNormFree();
+  bool cnFit = like.GetInternalModel()->IsCommonNormFree();
   if (cnFit) {
-    gLikeHAWC->GetInternalModel()->CommonNorm() = par[n];
+    like.GetInternalModel()->CommonNorm() = par[n];
     n++;
   }
 
-  LL = -gLikeHAWC->CalcTopHatLogLikelihoodUpdateSources(
-      gLikeHAWC->topHatCenter, gLikeHAWC->topHatRadius, false);
+  LL = -like.CalcTopHatLogLikelihoodUpdateSources(
+      like.topHatCenter, like.topHatRadius, false);
 }
 
 
 /*****************************************************/
 
-int InternalTopHatBGMinimize() {
+int InternalTopHatBGMinimize(LikeHAWC &like) {
 
   int nFree = 0;
   FreeParameterList freeParList;
 
-  CalcBinVector &calcBinVector = gLikeHAWC->GetCalcBins();
+  CalcBinVector &calcBinVector = like.GetCalcBins();
 
   //BG fit
   //free parameters in each CalcBin:
@@ -822,7 +1014,7 @@ int InternalTopHatBGMinimize() {
   //BGNorm fit
   vector<double> bn_values;
   vector<double> bn_errors;
-  bool bnFit = gLikeHAWC->GetInternalModel()->IsBackgroundNormFree();
+  bool bnFit = like.GetInternalModel()->IsBackgroundNormFree();
   if (bnFit) {
     for (unsigned k = 0; k < calcBinVector.size(); ++k) {
       InternalModelBin &imb = calcBinVector[k]->GetInternalModelBin();
@@ -844,12 +1036,12 @@ int InternalTopHatBGMinimize() {
   log_debug("Minimizing with " << nFree << " free parameters...");
 
   //Setup Minimizer
-  TMinuit *theMinuit = new TMinuit(nFree);
+  TMinuit *theMinuit =
+      new InternalMinuit(nFree, like, InternalTopHatBGFitFunc);
 
   // minuit verbosity, -1 = no printing, 0 = A little printing
-  int Verbosity = gLikeHAWC->GetInternalModel()->GetInternalFitVerbosity();
+  int Verbosity = like.GetInternalModel()->GetInternalFitVerbosity();
   theMinuit->SetPrintLevel(Verbosity);
-  theMinuit->SetFCN(InternalTopHatBGFitFunc);
 
   double arglist[2];  // arguments to pass to the Minuit interpreter
   int flag = 0;
@@ -929,7 +1121,8 @@ int InternalTopHatBGMinimize() {
 
 /*****************************************************/
 
-void InternalTopHatBGFitFunc(int &npar, double *gin, double &LL,
+void InternalTopHatBGFitFunc(LikeHAWC &like,
+                             int &npar, double *gin, double &LL,
                              double *par, int iflag) {
 
   //npar:  Number of parameters
@@ -955,7 +1148,7 @@ void InternalTopHatBGFitFunc(int &npar, double *gin, double &LL,
   //Assign Parameters
   int n = 0;
 
-  CalcBinVector &calcBinVector = gLikeHAWC->GetCalcBins();
+  CalcBinVector &calcBinVector = like.GetCalcBins();
 
   //BG fit: free parameters in each CalcBin:
   for (unsigned k = 0; k < calcBinVector.size(); k++) {
@@ -968,7 +1161,7 @@ void InternalTopHatBGFitFunc(int &npar, double *gin, double &LL,
     }
   }
   //Background Norm fit
-  bool bnFit = gLikeHAWC->GetInternalModel()->IsBackgroundNormFree();
+  bool bnFit = like.GetInternalModel()->IsBackgroundNormFree();
   if (bnFit) {
     for (unsigned k = 0; k < calcBinVector.size(); k++) {
       InternalModelBin &imb = calcBinVector[k]->GetInternalModelBin();
@@ -977,8 +1170,8 @@ void InternalTopHatBGFitFunc(int &npar, double *gin, double &LL,
     }
   }
 
-  LL = -gLikeHAWC->CalcTopHatBackgroundLogLikelihood
-      (gLikeHAWC->topHatCenter, gLikeHAWC->topHatRadius, false);
+  LL = -like.CalcTopHatBackgroundLogLikelihood
+      (like.topHatCenter, like.topHatRadius, false);
 } 
 
 
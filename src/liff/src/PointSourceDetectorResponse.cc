@@ -31,15 +31,25 @@ int PointSourceDetectorResponse::SetModel
     log_debug("Setting position");
     SetSkyPos(skypos_);
   }
-  //unlike before, now always ReweightEnergies, in case spectrum changed
-  log_debug("Call ReweightEnergies");
-  ReweightEnergies();
+  //reweight energies if the source moved (even if SetSkyPos did, as before)
+  //or the spectrum changed; unchanged sources keep their expected signal
+  vector<double> fluxes = QueryFluxes();
+  if (moved || detResFree || (fluxes != fluxes_)) {
+    log_debug("Call ReweightEnergies");
+    ReweightEnergies(fluxes);
+  }
+  else {
+    log_debug("Spectrum and position of source ID " << sourceId_
+              << " unchanged.");
+  }
 
   // reset PSF cache if DetectorResponse has free parameters
   if (detResFree) {
     log_debug("Clearing pixelated-PSF cache due to free DetRes parameters.");
     pixelatedPsf_.clear();
     deltaFunctionPSF_.clear();
+    psfRevision_ = NextSourceRevision();
+    pixelatedPsfRevision_ = NextSourceRevision();
   }
 
   return moved;
@@ -48,6 +58,8 @@ int PointSourceDetectorResponse::SetModel
 void PointSourceDetectorResponse::SetSkyPos(SkyPos pos) {
   ra_ = pos.RA();
   dec_ = pos.Dec();
+  psfRevision_ = NextSourceRevision();
+  modelRevision_ = NextSourceRevision();
   log_debug("Changing position of source ID " << sourceId_
                 << " to RA=" << ra_ << " , Dec=" << dec_);
   int newdbid1 = dr_.GetDecBinIndex(dec_);
@@ -96,13 +108,14 @@ void PointSourceDetectorResponse::SetSkyPos(SkyPos pos) {
 }
 
 void PointSourceDetectorResponse::ReweightEnergies() {
-  //reweight energies for all nHit bins if point source
-  log_debug("Reweighting energies for source ID " << sourceId_);
-  AnalysisBinMap nhbmap = dr_.GetAnalysisBinMap();
-  AnalysisBinMap::iterator nh = nhbmap.begin();
+  ReweightEnergies(QueryFluxes());
+}
+
+vector<double> PointSourceDetectorResponse::QueryFluxes() {
   //get log-energy histogram binning from first analysis bin and use
   //it to query the MI for fuxes
-  ResponseBinPtr rb = dr_.GetBin(decBinId1_, nh->first);
+  const AnalysisBinMap &nhbmap = dr_.GetAnalysisBinMap();
+  ResponseBinPtr rb = dr_.GetBin(decBinId1_, nhbmap.begin()->first);
   vector<double> energies = rb->GetLogEnBins();
   //convert to MeV
   for (vector<double>::iterator i = energies.begin();
@@ -117,10 +130,19 @@ void PointSourceDetectorResponse::ReweightEnergies() {
     (*i) *= 1e6;
     log_trace("fluxes [TeV^-1 cm^-2 s^-1]: " << *i)
   }
-  for (nh = nhbmap.begin(); nh != nhbmap.end(); ++nh) {
+  return fluxes;
+}
+
+void PointSourceDetectorResponse::ReweightEnergies(
+    const vector<double> &fluxes) {
+  //reweight energies for all nHit bins if point source
+  log_debug("Reweighting energies for source ID " << sourceId_);
+  const AnalysisBinMap &nhbmap = dr_.GetAnalysisBinMap();
+  for (AnalysisBinMap::const_iterator nh = nhbmap.begin();
+       nh != nhbmap.end(); ++nh) {
     log_trace("Source ID " << sourceId_ << " reweighting ResponseBin(d="
                   << decBinId1_ << ",n=" << nh->first << ")");
-    rb = dr_.GetBin(decBinId1_, nh->first);
+    ResponseBinPtr rb = dr_.GetBin(decBinId1_, nh->first);
     log_trace("Call ReweightEnergies");
     rb->ReweightEnergies(fluxes);
     log_trace("Source ID " << sourceId_ << " reweighting ResponseBin(d="
@@ -129,6 +151,8 @@ void PointSourceDetectorResponse::ReweightEnergies() {
     log_trace("Call ReweightEnergies");
     rb->ReweightEnergies(fluxes);
   }
+  fluxes_ = fluxes;
+  modelRevision_ = NextSourceRevision();
 }
 
 TF1Ptr PointSourceDetectorResponse::GetPsfFunction(const BinName& nhbin) {
@@ -142,21 +166,54 @@ double PointSourceDetectorResponse::GetExpectedSignal(const BinName& nhbin) {
   return w1_ * rb1->GetExpectedSignal() + w2_ * rb2->GetExpectedSignal();
 }
 
-double PointSourceDetectorResponse::GetSmearedSignal(
-    const double distance, const double pixelArea, const BinName& nhbin) {
+void PointSourceDetectorResponse::PreparePixelatedPsf(
+    const double pixelArea, const BinName& nhbin) {
   const BinPair bin(nhbin, decBinId1_);
   if (pixelatedPsf_.find(bin) == pixelatedPsf_.end()) {
     pixelatedPsf_[bin] = CalculatePixelatedPsf(pixelArea, nhbin);
   }
+}
+
+double PointSourceDetectorResponse::GetSmearedSignal(
+    const double distance, const double pixelArea, const BinName& nhbin) {
+  if (distance > PSF_LIM) {
+
+    return 0.;
+
+  }
+  return GetPixelatedPsfDensity(distance, pixelArea, nhbin) *
+         GetExpectedSignal(nhbin);
+}
+
+double PointSourceDetectorResponse::GetPixelatedPsfDensity(
+    const double distance, const double pixelArea, const BinName& nhbin) {
+  const BinPair bin(nhbin, decBinId1_);
+  map<BinPair, TH1D>::const_iterator psf = pixelatedPsf_.find(bin);
+  if (psf == pixelatedPsf_.end()) {
+    PreparePixelatedPsf(pixelArea, nhbin);
+    psf = pixelatedPsf_.find(bin);
+  }
   if (distance > PSF_LIM) {
 
     return 0.;
 
   }
-  double relativeDensity = (pixelatedPsf_[bin]).GetBinContent(
-      (pixelatedPsf_[bin]).FindBin(distance));
-  return relativeDensity * GetExpectedSignal(nhbin);
+  //read-only access (FindFixBin), safe once the PSF is prepared
+  return psf->second.GetBinContent(
+      psf->second.GetXaxis()->FindFixBin(distance));
+}
 
+double PointSourceDetectorResponse::GetPixelatedPsfRadius(
+    const double pixelArea, const BinName& nhbin) {
+  PreparePixelatedPsf(pixelArea, nhbin);
+  const TH1D &psf = pixelatedPsf_.find(BinPair(nhbin, decBinId1_))->second;
+  //upper edge of the last non-zero radial bin
+  for (int k = psf.GetNbinsX(); k > 0; --k) {
+    if (psf.GetBinContent(k) != 0.) {
+      return psf.GetXaxis()->GetBinUpEdge(k);
+    }
+  }
+  return 0.;
 }
 
 TH1D PointSourceDetectorResponse::CalculatePixelatedPsf(
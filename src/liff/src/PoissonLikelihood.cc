@@ -0,0 +1,365 @@
+/*!
+ * @file PoissonLikelihood.cc
+ * @author agent
+ * @date 16 Oct 2026
+ * @brief Vectorized kernel for the model-dependent part of the binned
+ *        Poisson log-likelihood.
+ * @version $Id$
+ */
+
+#include <liff/PoissonLikelihood.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+// The SIMD kernels are compiled with per-function target attributes and
+// selected at run time, so they are available in regular (non -march=native)
+// builds. Other compilers/architectures only get the scalar loop.
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define LIFF_POISSON_X86 1
+#include <immintrin.h>
+#if defined(__clang__) || (__GNUC__ >= 5)
+#define LIFF_POISSON_AVX512 1
+#endif
+#endif
+
+using namespace std;
+
+namespace {
+
+  // log(1+x) = x - x^2/2 + x^3 P(x)/Q(x) on [sqrt(1/2)-1, sqrt(2)-1],
+  // coefficients from the Cephes library
+  const double P0 = 1.01875663804580931796E-4;
+  const double P1 = 4.97494994976747001425E-1;
+  const double P2 = 4.70579119878881725854E0;
+  const double P3 = 1.44989225341610930846E1;
+  const double P4 = 1.79368678507819816313E1;
+  const double P5 = 7.70838733755885391666E0;
+
+  const double Q0 = 1.12873587189167450590E1;
+  const double Q1 = 4.52279145837532221105E1;
+  const double Q2 = 8.29875266912776603211E1;
+  const double Q3 = 7.11544750618563894466E1;
+  const double Q4 = 2.31251620126765340583E1;
+
+  const double SQRTH = 0.70710678118654752440;
+  // log(2) split into an exactly representable part and a correction
+  const double LN2_HI = 0.693359375;
+  const double LN2_LO = -2.121944400546905827679E-4;
+
+  // Sum of n*log(mu) - mu over [begin, end) using the scalar fast log; used
+  // for the remainders of the SIMD loops
+  double FastLogTail(const double *counts, const double *excess,
+                     const double *bg, double bgNorm, double minMu,
+                     unsigned begin, unsigned end) {
+    double sum = 0.;
+    for (unsigned i = begin; i < end; ++i) {
+      double mu = bg[i] * bgNorm;
+      if (excess)
+        mu = excess[i] + mu;
+      if (mu < minMu)
+        mu = minMu;
+      sum += counts[i] * PoissonFastLog(mu) - mu;
+    }
+    return sum;
+  }
+
+#ifdef LIFF_POISSON_X86
+
+  __attribute__((target("avx2")))
+  inline __m256d Log4(__m256d x) {
+    const __m256d one = _mm256_set1_pd(1.);
+    const __m256d two52 = _mm256_set1_pd(4503599627370496.);
+
+    // frexp: x = m * 2^e with m in [0.5, 1)
+    __m256i bits = _mm256_castpd_si256(x);
+    __m256i biased = _mm256_srli_epi64(bits, 52);
+    __m256d e = _mm256_sub_pd(
+        _mm256_castsi256_pd(_mm256_or_si256(biased, _mm256_castpd_si256(two52))),
+        two52);
+    e = _mm256_sub_pd(e, _mm256_set1_pd(1022.));
+    __m256d m = _mm256_castsi256_pd(_mm256_or_si256(
+        _mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)),
+        _mm256_set1_epi64x(0x3FE0000000000000LL)));
+
+    __m256d small = _mm256_cmp_pd(m, _mm256_set1_pd(SQRTH), _CMP_LT_OQ);
+    e = _mm256_sub_pd(e, _mm256_and_pd(small, one));
+    __m256d xx = _mm256_blendv_pd(_mm256_sub_pd(m, one),
+                                  _mm256_sub_pd(_mm256_add_pd(m, m), one),
+                                  small);
+
+    __m256d z = _mm256_mul_pd(xx, xx);
+    __m256d p = _mm256_set1_pd(P0);
+    p = _mm256_add_pd(_mm256_mul_pd(p, xx), _mm256_set1_pd(P1));
+    p = _mm256_add_pd(_mm256_mul_pd(p, xx), _mm256_set1_pd(P2));
+    p = _mm256_add_pd(_mm256_mul_pd(p, xx), _mm256_set1_pd(P3));
+    p = _mm256_add_pd(_mm256_mul_pd(p, xx), _mm256_set1_pd(P4));
+    p = _mm256_add_pd(_mm256_mul_pd(p, xx), _mm256_set1_pd(P5));
+    __m256d q = _mm256_add_pd(xx, _mm256_set1_pd(Q0));
+    q = _mm256_add_pd(_mm256_mul_pd(q, xx), _mm256_set1_pd(Q1));
+    q = _mm256_add_pd(_mm256_mul_pd(q, xx), _mm256_set1_pd(Q2));
+    q = _mm256_add_pd(_mm256_mul_pd(q, xx), _mm256_set1_pd(Q3));
+    q = _mm256_add_pd(_mm256_mul_pd(q, xx), _mm256_set1_pd(Q4));
+
+    __m256d y = _mm256_mul_pd(xx, _mm256_div_pd(_mm256_mul_pd(z, p), q));
+    y = _mm256_add_pd(y, _mm256_mul_pd(e, _mm256_set1_pd(LN2_LO)));
+    y = _mm256_sub_pd(y, _mm256_mul_pd(_mm256_set1_pd(0.5), z));
+    z = _mm256_add_pd(xx, y);
+    return _mm256_add_pd(z, _mm256_mul_pd(e, _mm256_set1_pd(LN2_HI)));
+  }
+
+  __attribute__((target("avx2")))
+  double SumAVX2(const double *counts, const double *excess, const double *bg,
+                 double bgNorm, double minMu, unsigned n) {
+    const __m256d vNorm = _mm256_set1_pd(bgNorm);
+    const __m256d vMin = _mm256_set1_pd(minMu);
+    __m256d acc = _mm256_setzero_pd();
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4) {
+      __m256d mu = _mm256_mul_pd(_mm256_loadu_pd(bg + i), vNorm);
+      if (excess)
+        mu = _mm256_add_pd(_mm256_loadu_pd(excess + i), mu);
+      // operand order keeps NaN, like the scalar comparison
+      mu = _mm256_max_pd(vMin, mu);
+      __m256d term = _mm256_mul_pd(_mm256_loadu_pd(counts + i), Log4(mu));
+      acc = _mm256_add_pd(acc, _mm256_sub_pd(term, mu));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    return sum + FastLogTail(counts, excess, bg, bgNorm, minMu, i, n);
+  }
+
+#ifdef LIFF_POISSON_AVX512
+
+  __attribute__((target("avx512f")))
+  inline __m512d Log8(__m512d x) {
+    const __m512d one = _mm512_set1_pd(1.);
+    const __m512d two52 = _mm512_set1_pd(4503599627370496.);
+
+    __m512i bits = _mm512_castpd_si512(x);
+    __m512i biased = _mm512_srli_epi64(bits, 52);
+    __m512d e = _mm512_sub_pd(
+        _mm512_castsi512_pd(_mm512_or_si512(biased, _mm512_castpd_si512(two52))),
+        two52);
+    e = _mm512_sub_pd(e, _mm512_set1_pd(1022.));
+    __m512d m = _mm512_castsi512_pd(_mm512_or_si512(
+        _mm512_and_si512(bits, _mm512_set1_epi64(0x000FFFFFFFFFFFFFLL)),
+        _mm512_set1_epi64(0x3FE0000000000000LL)));
+
+    __mmask8 small = _mm512_cmp_pd_mask(m, _mm512_set1_pd(SQRTH), _CMP_LT_OQ);
+    e = _mm512_mask_sub_pd(e, small, e, one);
+    __m512d xx = _mm512_mask_blend_pd(small, _mm512_sub_pd(m, one),
+                                      _mm512_sub_pd(_mm512_add_pd(m, m), one));
+
+    __m512d z = _mm512_mul_pd(xx, xx);
+    __m512d p = _mm512_set1_pd(P0);
+    p = _mm512_add_pd(_mm512_mul_pd(p, xx), _mm512_set1_pd(P1));
+    p = _mm512_add_pd(_mm512_mul_pd(p, xx), _mm512_set1_pd(P2));
+    p = _mm512_add_pd(_mm512_mul_pd(p, xx), _mm512_set1_pd(P3));
+    p = _mm512_add_pd(_mm512_mul_pd(p, xx), _mm512_set1_pd(P4));
+    p = _mm512_add_pd(_mm512_mul_pd(p, xx), _mm512_set1_pd(P5));
+    __m512d q = _mm512_add_pd(xx, _mm512_set1_pd(Q0));
+    q = _mm512_add_pd(_mm512_mul_pd(q, xx), _mm512_set1_pd(Q1));
+    q = _mm512_add_pd(_mm512_mul_pd(q, xx), _mm512_set1_pd(Q2));
+    q = _mm512_add_pd(_mm512_mul_pd(q, xx), _mm512_set1_pd(Q3));
+    q = _mm512_add_pd(_mm512_mul_pd(q, xx), _mm512_set1_pd(Q4));
+
+    __m512d y = _mm512_mul_pd(xx, _mm512_div_pd(_mm512_mul_pd(z, p), q));
+    y = _mm512_add_pd(y, _mm512_mul_pd(e, _mm512_set1_pd(LN2_LO)));
+    y = _mm512_sub_pd(y, _mm512_mul_pd(_mm512_set1_pd(0.5), z));
+    z = _mm512_add_pd(xx, y);
+    return _mm512_add_pd(z, _mm512_mul_pd(e, _mm512_set1_pd(LN2_HI)));
+  }
+
+  __attribute__((target("avx512f")))
+  double SumAVX512(const double *counts, const double *excess, const double *bg,
+                   double bgNorm, double minMu, unsigned n) {
+    const __m512d vNorm = _mm512_set1_pd(bgNorm);
+    const __m512d vMin = _mm512_set1_pd(minMu);
+    __m512d acc = _mm512_setzero_pd();
+    unsigned i = 0;
+    for (; i + 8 <= n; i += 8) {
+      __m512d mu = _mm512_mul_pd(_mm512_loadu_pd(bg + i), vNorm);
+      if (excess)
+        mu = _mm512_add_pd(_mm512_loadu_pd(excess + i), mu);
+      mu = _mm512_max_pd(vMin, mu);
+      __m512d term = _mm512_mul_pd(_mm512_loadu_pd(counts + i), Log8(mu));
+      acc = _mm512_add_pd(acc, _mm512_sub_pd(term, mu));
+    }
+    double lanes[8];
+    _mm512_storeu_pd(lanes, acc);
+    double sum = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+                 ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    return sum + FastLogTail(counts, excess, bg, bgNorm, minMu, i, n);
+  }
+
+#endif // LIFF_POISSON_AVX512
+
+#endif // LIFF_POISSON_X86
+
+  enum InstructionSet { IS_SCALAR, IS_AVX2, IS_AVX512 };
+
+  InstructionSet DetectInstructionSet() {
+#ifdef LIFF_POISSON_X86
+    __builtin_cpu_init();
+#ifdef LIFF_POISSON_AVX512
+    if (__builtin_cpu_supports("avx512f"))
+      return IS_AVX512;
+#endif
+    if (__builtin_cpu_supports("avx2"))
+      return IS_AVX2;
+#endif
+    return IS_SCALAR;
+  }
+
+  InstructionSet GetInstructionSet() {
+    static const InstructionSet is = DetectInstructionSet();
+    return is;
+  }
+
+}
+
+/*****************************************************/
+double PoissonFastLog(double x) {
+  int e;
+  x = frexp(x, &e);
+  if (x < SQRTH) {
+    e -= 1;
+    x = x + x - 1.;
+  }
+  else {
+    x = x - 1.;
+  }
+  double z = x * x;
+  double p = ((((P0 * x + P1) * x + P2) * x + P3) * x + P4) * x + P5;
+  double q = ((((x + Q0) * x + Q1) * x + Q2) * x + Q3) * x + Q4;
+  double y = x * (z * p / q);
+  y = y + e * LN2_LO;
+  y = y - 0.5 * z;
+  z = x + y;
+  return z + e * LN2_HI;
+}
+
+/*****************************************************/
+double PoissonLogLikelihoodSumScalar(const double *counts,
+                                     const double *excess,
+                                     const double *bg,
+                                     double bgNorm,
+                                     double minMu,
+                                     unsigned n) {
+  double sum = 0.;
+  for (unsigned i = 0; i < n; ++i) {
+    double mu = bg[i] * bgNorm;
+    if (excess)
+      mu = excess[i] + mu;
+    if (mu < minMu)
+      mu = minMu;
+    sum += counts[i] * log(mu) - mu;
+  }
+  return sum;
+}
+
+/*****************************************************/
+double PoissonLogLikelihoodSum(const double *counts,
+                               const double *excess,
+                               const double *bg,
+                               double bgNorm,
+                               double minMu,
+                               unsigned n) {
+  switch (GetInstructionSet()) {
+#ifdef LIFF_POISSON_X86
+#ifdef LIFF_POISSON_AVX512
+    case IS_AVX512:
+      return SumAVX512(counts, excess, bg, bgNorm, minMu, n);
+#endif
+    case IS_AVX2:
+      return SumAVX2(counts, excess, bg, bgNorm, minMu, n);
+#endif
+    default:
+      return PoissonLogLikelihoodSumScalar(counts, excess, bg, bgNorm, minMu,
+                                           n);
+  }
+}
+
+/*****************************************************/
+// The LL is concave in norm, and its derivative is convex (decreasing) in
+// the usual case of non-negative excesses, so Newton steps from below the
+// maximum never overshoot it. Steps leaving the bracket of the maximum
+// (the domain mu_i > 0, narrowed by the sign of the derivative) are
+// replaced by bisection.
+bool PoissonMaximizeNorm(const double *counts,
+                         const double *excess,
+                         const double *bg,
+                         unsigned n,
+                         double &norm,
+                         double &error) {
+
+  double lo = -HUGE_VAL;
+  double hi = HUGE_VAL;
+  bool curved = false;
+  for (unsigned i = 0; i < n; ++i) {
+    if (excess[i] > 0) {
+      lo = max(lo, -bg[i] / excess[i]);
+    }
+    else if (excess[i] < 0) {
+      hi = min(hi, -bg[i] / excess[i]);
+    }
+    if (excess[i] != 0 && counts[i] > 0) {
+      curved = true;
+    }
+  }
+  if (!curved || !(lo < hi)) {
+    return false;
+  }
+
+  //norm = 0 is inside the domain for positive BG
+  double x = (norm > lo && norm < hi) ? norm : 0.;
+  double d1 = 0.;
+  double d2 = 0.;
+  bool converged = false;
+  for (int iter = 0; iter < 100 && !converged; ++iter) {
+    d1 = 0.;
+    d2 = 0.;
+    for (unsigned i = 0; i < n; ++i) {
+      const double r = excess[i] / (x * excess[i] + bg[i]);
+      d1 += counts[i] * r - excess[i];
+      d2 -= counts[i] * r * r;
+    }
+    if (d1 > 0) {
+      lo = x;
+    }
+    else {
+      hi = x;
+    }
+    double next = x - d1 / d2;
+    if (!(next > lo && next < hi)) {
+      next = 0.5 * (x + (next <= lo ? lo : hi));
+    }
+    converged = fabs(next - x) <= 1e-12 * max(1., fabs(x));
+    x = next;
+  }
+
+  //a maximum at the edge of the domain (mu_i -> 0 in a pixel without
+  //counts) is not a zero of the derivative
+  if (!converged || !(fabs(d1) <= 1e-6 * sqrt(-d2))) {
+    return false;
+  }
+  norm = x;
+  error = 1. / sqrt(-d2);
+  return true;
+}
+
+/*****************************************************/
+const char *GetPoissonKernelInstructionSet() {
+  switch (GetInstructionSet()) {
+    case IS_AVX512:
+      return "AVX-512";
+    case IS_AVX2:
+      return "AVX2";
+    default:
+      return "scalar";
+  }
+}
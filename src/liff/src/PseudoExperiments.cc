@@ -0,0 +1,178 @@
+/*!
+ * @file PseudoExperiments.cc
+ * @author agent
+ * @date 16 Oct 2026
+ * @brief Reproducible Poisson pseudo-experiments for a LikeHAWC setup.
+ * @version $Id$
+ */
+
+#include <liff/PseudoExperiments.h>
+
+#include <hawcnest/Logging.h>
+
+#include <boost/bind.hpp>
+
+#include <fstream>
+#include <iomanip>
+
+using namespace std;
+
+namespace {
+
+  // FNV-1a hash, so that the stream of a bin does not depend on which
+  // other bins are used
+  boost::uint64_t HashBinName(const BinName &name) {
+    boost::uint64_t hash = 0xCBF29CE484222325ULL;
+    for (unsigned i = 0; i < name.size(); ++i) {
+      hash ^= (unsigned char) name[i];
+      hash *= 0x100000001B3ULL;
+    }
+    return hash;
+  }
+
+  // Stream number of a bin in a trial: the FNV-1a hash of the bin name,
+  // continued with the bytes of the trial number
+  boost::uint64_t StreamNumber(boost::uint64_t binKey,
+                               boost::uint64_t trial) {
+    boost::uint64_t hash = binKey;
+    for (unsigned i = 0; i < sizeof(trial); ++i) {
+      hash ^= (trial >> (8 * i)) & 0xFF;
+      hash *= 0x100000001B3ULL;
+    }
+    return hash;
+  }
+
+}
+
+/*****************************************************/
+PseudoExperiments::PseudoExperiments(LikeHAWC &like, boost::uint64_t seed,
+                                     unsigned nThreads)
+    : like_(like),
+      seed_(seed),
+      pool_(nThreads),
+      generated_(false) {
+
+  CalcBinVector &calcBins = like_.GetCalcBins();
+  if (calcBins.empty()) {
+    log_fatal("No CalcBins defined for pseudo-experiments.");
+  }
+  for (unsigned k = 0; k < calcBins.size(); ++k) {
+    binKeys_.push_back(HashBinName(calcBins[k]->GetBinID()));
+    original_.push_back(*calcBins[k]->eventMap_);
+  }
+
+  commonNorm_ = like_.CommonNorm();
+  for (unsigned k = 0; k < calcBins.size(); ++k) {
+    backgroundNorms_.push_back(
+        calcBins[k]->GetInternalModelBin().BackgroundNorm());
+  }
+  const FreeParameterList &pars = like_.GetFreeParameterList();
+  for (unsigned i = 0; i < pars.size(); ++i) {
+    freeParameters_.push_back(pars[i].FuncPointer->GetParameter(pars[i].ParId));
+  }
+
+  SetExpectation(false);
+}
+
+/*****************************************************/
+PseudoExperiments::~PseudoExperiments() {
+  Restore();
+}
+
+/*****************************************************/
+void PseudoExperiments::SetExpectation(bool withModel) {
+
+  CalcBinVector &calcBins = like_.GetCalcBins();
+  if (withModel) {
+    like_.MakeModelMap();
+  }
+  expectation_.clear();
+  for (unsigned k = 0; k < calcBins.size(); ++k) {
+    expectation_.push_back(*calcBins[k]->backgroundMap_);
+    if (withModel) {
+      expectation_[k].Add(*calcBins[k]->modelMap_);
+    }
+  }
+}
+
+/*****************************************************/
+void PseudoExperiments::Generate(boost::uint64_t trial) {
+
+  pool_.Run(expectation_.size(),
+            boost::bind(&PseudoExperiments::GenerateBin, this, trial, _1));
+  generated_ = true;
+  like_.GetData()->MapsChanged();
+}
+
+/*****************************************************/
+void PseudoExperiments::GenerateBin(boost::uint64_t trial, unsigned k) {
+
+  SkyMap<double> &eventMap = *like_.GetCalcBins()[k]->eventMap_;
+  eventMap = expectation_[k];
+  eventMap.PoissonFluctuate(seed_, StreamNumber(binKeys_[k], trial));
+}
+
+/*****************************************************/
+vector<double> PseudoExperiments::CalcTestStatistics(boost::uint64_t first,
+                                                     unsigned n,
+                                                     bool doIntFit) {
+  vector<double> ts(n);
+  for (unsigned i = 0; i < n; ++i) {
+    Generate(first + i);
+    ResetFitParameters();
+    ts[i] = like_.CalcTestStatistic(doIntFit);
+    log_debug("Pseudo-experiment " << first + i << ": TS = " << ts[i]);
+  }
+  ResetFitParameters();
+  return ts;
+}
+
+/*****************************************************/
+void PseudoExperiments::WriteTestStatistics(const string &filename,
+                                            boost::uint64_t first,
+                                            const vector<double> &ts) {
+  ofstream out(filename.c_str());
+  if (!out) {
+    log_fatal("Could not create file \"" << filename << "\".");
+  }
+  out << "# trial TS" << endl;
+  out << setprecision(10);
+  for (unsigned i = 0; i < ts.size(); ++i) {
+    out << first + i << " " << ts[i] << endl;
+  }
+  if (!out) {
+    log_fatal("Error writing file \"" << filename << "\".");
+  }
+}
+
+/*****************************************************/
+void PseudoExperiments::Restore() {
+
+  if (!generated_) {
+    return;
+  }
+  CalcBinVector &calcBins = like_.GetCalcBins();
+  for (unsigned k = 0; k < calcBins.size(); ++k) {
+    *calcBins[k]->eventMap_ = original_[k];
+  }
+  like_.GetData()->MapsChanged();
+  ResetFitParameters();
+  generated_ = false;
+}
+
+/*****************************************************/
+void PseudoExperiments::ResetFitParameters() {
+
+  like_.CommonNorm() = commonNorm_;
+  CalcBinVector &calcBins = like_.GetCalcBins();
+  for (unsigned k = 0; k < calcBins.size(); ++k) {
+    calcBins[k]->GetInternalModelBin().BackgroundNorm() = backgroundNorms_[k];
+  }
+  const FreeParameterList &pars = like_.GetFreeParameterList();
+  for (unsigned i = 0; i < pars.size() && i < freeParameters_.size(); ++i) {
+    pars[i].FuncPointer->SetParameter(pars[i].ParId, freeParameters_[i]);
+  }
+  if (!pars.empty()) {
+    like_.UpdateSources();
+  }
+}
@@ -15,13 +15,19 @@
 #include <hawcnest/HAWCUnits.h>
 #include <liff/BinList.h>
 #include <liff/SkyMapCollection.h>
+#include <liff/ThreadPool.h>
 
 #include <boost/make_shared.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
 #include <dirent.h>
 
+#include <RVersion.h>
 #include <TObjArray.h>
+#include <TROOT.h>
 #include <TTree.h>
 
 using namespace std;
@@ -231,11 +237,12 @@ vector<string> SkyMapCollection::FindSiderealDayMaps(UTCDate start, UTCDate stop
 }
 
 vector<string> SkyMapCollection::LoadSiderealDayMaps(UTCDate start,UTCDate stop,
-                                                  string prefix) {
+                                                  string prefix,
+                                                  unsigned nThreads) {
   transits_ = 0;
 
   vector<string> maptrees = FindSiderealDayMaps(start, stop,prefix);
-  LoadMapList(maptrees);
+  LoadMapList(maptrees, nThreads);
 
   transits_ = (double) maptrees.size();
   log_info("Assuming one full transit per sidereal day, setting total "
@@ -245,7 +252,7 @@ vector<string> SkyMapCollection::LoadSiderealDayMaps(UTCDate start,UTCDate stop,
   return maptrees;
 }
 
-void SkyMapCollection::LoadMapList(vector<string> maptrees) {
+void SkyMapCollection::LoadMapList(vector<string> maptrees, unsigned nThreads) {
 
   if (maptrees.size() == 0) {
     log_warn("No maptrees listed for loading...")
@@ -257,59 +264,114 @@ void SkyMapCollection::LoadMapList(vector<string> maptrees) {
   binInfoMap_.clear();
   transits_ = 0;
 
-  MapTree mt;
-  vector<string>::iterator it = maptrees.begin();
-
-  bool firstSD = true;
   map<BinName, double> avgDuration;
 
+  // Load first file, includes SetBins
+  MapTree mt;
+  vector<string>::iterator it = maptrees.begin();
   for (; it != maptrees.end(); it++) {
     if (!mt.OpenFile(*it)) {
       log_warn("cannot open MapTree root file " << *it << " , skipping.")
     }
-    else if (firstSD) {
-      //mt.CloseFile(); //Open-cmd inside LoadMaps
-      // Load first file, includes SetBins
-      //log_info("  Loading "<<*it);
+    else {
+      mt.CloseFile(); //Open-cmd inside LoadMaps
       LoadMaps(*it);
-      firstSD = false;
       for (BinInfoMap::iterator b = binInfoMap_.begin();
            b != binInfoMap_.end(); ++b) {
         avgDuration[b->first] = b->second.duration;
       }
+      it++;
+      break;
     }
-    else {
-      //all other SDs:
-      log_info("  Loading " << *it);
-      for (AnalysisBinMap::iterator nb = analysisBins_.begin();
-           nb != analysisBins_.end(); ++nb) {
-        const BinName& n     = nb->first;
-        const string nHitDir = "nHit" + PadBinName(n) + "/";
-        
-        if (!mt.OpenTree((nHitDir + "data").c_str())) {
-          if (!mt.OpenTree((nHitDir + "gh00_data").c_str())) {
-            log_fatal("Does this MapTree follow the tree naming convention nHitXX/data ?");
-          }
-          log_info("Found maptree via old naming scheme (gh00).");
-        }
-        eventMaps_[n].AddMapTree(mt);
+  }
 
-        if (!mt.OpenTree((nHitDir + "bkg").c_str())) {
-          if (!mt.OpenTree((nHitDir + "gh00_bkg").c_str())) {
-            log_fatal("Does this MapTree follow the tree naming convention nHitXX/bkg?");
-          }
-          log_info("Found maptree via old naming scheme (gh00).");
-        }
-        backgroundMaps_[n].AddMapTree(mt);
+  //all other SDs:
+  const vector<string> files(it, maptrees.end());
+  if (nThreads == 0) {
+    nThreads = boost::thread::hardware_concurrency();
+  }
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,6,0)
+  if (nThreads > 1) {
+    ROOT::EnableThreadSafety();
+  }
+#else
+  if (nThreads > 1) {
+    log_warn("Reading MapTree files in parallel needs ROOT >= 6.06, using 1 thread.");
+    nThreads = 1;
+  }
+#endif
+  const unsigned nWorkers = max(1u, min<unsigned>(nThreads, files.size()));
+
+  // Worker 0 adds directly to the loaded maps; the others to empty copies,
+  // which are added in worker order below. With one worker, this is the
+  // same summation order as loading the files one after another.
+  vector<MapMap> partialEvent(nWorkers - 1, eventMaps_);
+  vector<MapMap> partialBackground(nWorkers - 1, backgroundMaps_);
+  vector<MapMap*> eventSums(1, &eventMaps_);
+  vector<MapMap*> backgroundSums(1, &backgroundMaps_);
+  for (unsigned w = 0; w + 1 < nWorkers; ++w) {
+    for (MapMap::iterator m = partialEvent[w].begin();
+         m != partialEvent[w].end(); ++m) {
+      m->second.Empty();
+    }
+    for (MapMap::iterator m = partialBackground[w].begin();
+         m != partialBackground[w].end(); ++m) {
+      m->second.Empty();
+    }
+    eventSums.push_back(&partialEvent[w]);
+    backgroundSums.push_back(&partialBackground[w]);
+  }
+
+  vector<BinInfoMap> fileBinInfo(files.size());
+  vector<int> fileLoaded(files.size(), 0);
+  if (nWorkers == 1) {
+    StackMapFiles(files, 1, eventSums, backgroundSums, fileBinInfo,
+                  fileLoaded, 0);
+  }
+  else {
+    log_info("Stacking " << files.size() << " map files with " << nWorkers
+                 << " reader threads.");
+    ThreadPool pool(nWorkers);
+    pool.Run(nWorkers, boost::bind(&SkyMapCollection::StackMapFiles, this,
+                                   boost::cref(files), nWorkers,
+                                   boost::cref(eventSums),
+                                   boost::cref(backgroundSums),
+                                   boost::ref(fileBinInfo),
+                                   boost::ref(fileLoaded), _1));
+  }
+
+  for (unsigned w = 0; w + 1 < nWorkers; ++w) {
+    for (MapMap::iterator m = partialEvent[w].begin();
+         m != partialEvent[w].end(); ++m) {
+      eventMaps_[m->first].Add(m->second);
+    }
+    partialEvent[w].clear();
+    for (MapMap::iterator m = partialBackground[w].begin();
+         m != partialBackground[w].end(); ++m) {
+      backgroundMaps_[m->first].Add(m->second);
+    }
+    partialBackground[w].clear();
+  }
+  ++revision_;
+
+  // add BinInfo information, in file order
+  for (unsigned i = 0; i < files.size(); ++i) {
+    if (!fileLoaded[i]) {
+      continue;
+    }
+    for (BinInfoMap::iterator b = fileBinInfo[i].begin();
+         b != fileBinInfo[i].end(); ++b) {
+      if (binInfoMap_.find(b->first) == binInfoMap_.end()) {
+        binInfoMap_[b->first] = b->second;
       }
-      mt.CloseFile();
-      // add BinInfo information
-      LoadBinInfo(*it, false);
-      for (BinInfoMap::iterator b = binInfoMap_.begin();
-           b != binInfoMap_.end(); b++) {
-        avgDuration[b->first] += b->second.duration;
+      else {
+        binInfoMap_[b->first] += b->second;
       }
     }
+    for (BinInfoMap::iterator b = binInfoMap_.begin();
+         b != binInfoMap_.end(); b++) {
+      avgDuration[b->first] += b->second.duration;
+    }
   }
   for (BinInfoMap::iterator b = binInfoMap_.begin();
        b != binInfoMap_.end(); ++b) {
@@ -321,16 +383,82 @@ void SkyMapCollection::LoadMapList(vector<string> maptrees) {
                << " BinInfo entries 'totalDuration' in days: " << transits_);
 }
 
+void SkyMapCollection::StackMapFiles(const vector<string>& files,
+                                     unsigned nWorkers,
+                                     const vector<MapMap*>& eventSums,
+                                     const vector<MapMap*>& backgroundSums,
+                                     vector<BinInfoMap>& fileBinInfo,
+                                     vector<int>& fileLoaded,
+                                     unsigned worker) const {
+  MapMap& eventSum = *eventSums[worker];
+  MapMap& backgroundSum = *backgroundSums[worker];
+  MapTree mt;
+
+  for (unsigned i = worker; i < files.size(); i += nWorkers) {
+    if (!mt.OpenFile(files[i])) {
+      log_warn("cannot open MapTree root file " << files[i] << " , skipping.")
+      continue;
+    }
+    log_info("  Loading " << files[i]);
+    for (AnalysisBinMap::const_iterator nb = analysisBins_.begin();
+         nb != analysisBins_.end(); ++nb) {
+      const BinName& n     = nb->first;
+      const string nHitDir = "nHit" + PadBinName(n) + "/";
+      
+      if (!mt.OpenTree((nHitDir + "data").c_str())) {
+        if (!mt.OpenTree((nHitDir + "gh00_data").c_str())) {
+          log_fatal("Does this MapTree follow the tree naming convention nHitXX/data ?");
+        }
+        log_info("Found maptree via old naming scheme (gh00).");
+      }
+      eventSum[n].AddMapTree(mt);
+
+      if (!mt.OpenTree((nHitDir + "bkg").c_str())) {
+        if (!mt.OpenTree((nHitDir + "gh00_bkg").c_str())) {
+          log_fatal("Does this MapTree follow the tree naming convention nHitXX/bkg?");
+        }
+        log_info("Found maptree via old naming scheme (gh00).");
+      }
+      backgroundSum[n].AddMapTree(mt);
+    }
+    mt.CloseFile();
+    LoadBinInfo(files[i], false, fileBinInfo[i]);
+    fileLoaded[i] = 1;
+  }
+}
+
 void SkyMapCollection::LoadMaps(const string& file, const BinList& binList,
                                 const double transits) {
 
   eventMaps_.clear();
   modelMaps_.clear();
   backgroundMaps_.clear();
+  ++revision_;
   log_info("Loading maps from file " << file);
 
   SetBins(binList);
 
+  if (MapColumnFile::IsMapColumnFile(file)) {
+    LoadMapColumnFile(file);
+  }
+  else {
+    LoadMapTreeFile(file);
+  }
+
+  double totDur = binInfoMap_.begin()->second.totalDuration;
+  log_info("Reading transit signal fraction from bin "
+               << binInfoMap_.begin()->first
+               << " BinInfo entry 'totalDuration': " << totDur / 24. << " transits.");
+  transits_ = totDur / 24.;
+  
+  // Override transit signal fraction read from bin info if provided.
+  if (transits != dontSetTransits_)
+    SetTransits(transits);
+  
+}
+
+void SkyMapCollection::LoadMapTreeFile(const string& file) {
+
   MapTree mt;
   if (!mt.OpenFile(file)) {
     log_fatal("Cannot open MapTree root file " << file)
@@ -340,8 +468,6 @@ void SkyMapCollection::LoadMaps(const string& file, const BinList& binList,
     const BinName& n = nb->first;
     log_debug("Loading bin " << n);
 
-    // Define the list of pixels
-    rangeset<int> pixset;
     const string nHitDir = "nHit" + PadBinName(n) + "/";
     if (!mt.OpenTree((nHitDir + "data").c_str())) {
       if (!mt.OpenTree((nHitDir + "gh00_data").c_str())) {
@@ -349,31 +475,9 @@ void SkyMapCollection::LoadMaps(const string& file, const BinList& binList,
       }
       log_info("Found maptree via old naming scheme (gh00).");
     }
-    if (radius_ > 0.) {
-      // Disc case
-      log_debug("Loading from disk, center (" << center_.RA() << ", "
-                << center_.Dec() << "), radius " << radius_/degree);
-      mt.GetMap<double>().query_disc(center_.GetPointing(), radius_, pixset);
-    }
-    else if (!polygon_.empty()) {
-      // Polygon case
-      log_debug("Loading from polygon");
-      mt.GetMap<double>().query_polygon(polygon_, pixset);
-    }
-    else if (minDec_ == minDec_ && maxDec_ == maxDec_) {
-      // Declination band case
-      double theta1 = HAWCUnits::halfpi - minDec_;
-      double theta2 = HAWCUnits::halfpi - maxDec_;
-      double thetaMin = min(theta1, theta2);
-      double thetaMax = max(theta1, theta2);
-      log_debug("Preparing pixel list to load data between declination "
-                    << minDec_ / degree << " and " << maxDec_ / degree);
-      mt.GetMap<double>().query_strip(thetaMin, thetaMax, true, pixset);
-    }
-    else {
-      log_fatal("No sky region information given, " <<
-          "use SetDisc, SetPolygon or SetDecBand first.")
-    }
+    // Define the list of pixels
+    rangeset<int> pixset =
+      QueryRegion(Healpix_Base(mt.Nside(), mt.Scheme(), SET_NSIDE));
 
     // Load the data for the list of pixels
     eventMaps_[n] = SkyMap<double>(mt, pixset);
@@ -392,16 +496,61 @@ void SkyMapCollection::LoadMaps(const string& file, const BinList& binList,
 
   // load BinInfo information
   LoadBinInfo(file);
-  double totDur = binInfoMap_.begin()->second.totalDuration;
-  log_info("Reading transit signal fraction from bin "
-               << binInfoMap_.begin()->first
-               << " BinInfo entry 'totalDuration': " << totDur / 24. << " transits.");
-  transits_ = totDur / 24.;
-  
-  // Override transit signal fraction read from bin info if provided.
-  if (transits != dontSetTransits_)
-    SetTransits(transits);
-  
+}
+
+void SkyMapCollection::LoadMapColumnFile(const string& file) {
+
+  const MapColumnFile mc(file);
+
+  for (AnalysisBinMap::iterator nb = analysisBins_.begin(); nb != analysisBins_.end(); ++nb) {
+    const BinName& n = nb->first;
+    log_debug("Loading bin " << n);
+
+    if (!mc.HasBin(n)) {
+      log_fatal("Could not find bin " << n << " in map column file.");
+    }
+    const int nside = mc.Nside(n);
+    const Healpix_Ordering_Scheme scheme = mc.Scheme(n);
+    rangeset<int> pixset = QueryRegion(Healpix_Base(nside, scheme, SET_NSIDE));
+
+    // Only the pages holding these pixels are read from disk
+    eventMaps_[n] = SkyMap<double>(mc, n, MapColumnFile::DATA, pixset);
+    modelMaps_[n] = SkyMap<double>(pixset, nside, scheme);
+    backgroundMaps_[n] =
+      SkyMap<double>(mc, n, MapColumnFile::BACKGROUND, pixset);
+  }
+
+  LoadBinInfo(file);
+}
+
+rangeset<int> SkyMapCollection::QueryRegion(const Healpix_Base& base) const {
+  rangeset<int> pixset;
+  if (radius_ > 0.) {
+    // Disc case
+    log_debug("Loading from disk, center (" << center_.RA() << ", "
+              << center_.Dec() << "), radius " << radius_/degree);
+    base.query_disc(center_.GetPointing(), radius_, pixset);
+  }
+  else if (!polygon_.empty()) {
+    // Polygon case
+    log_debug("Loading from polygon");
+    base.query_polygon(polygon_, pixset);
+  }
+  else if (minDec_ == minDec_ && maxDec_ == maxDec_) {
+    // Declination band case
+    double theta1 = HAWCUnits::halfpi - minDec_;
+    double theta2 = HAWCUnits::halfpi - maxDec_;
+    double thetaMin = min(theta1, theta2);
+    double thetaMax = max(theta1, theta2);
+    log_debug("Preparing pixel list to load data between declination "
+                  << minDec_ / degree << " and " << maxDec_ / degree);
+    base.query_strip(thetaMin, thetaMax, true, pixset);
+  }
+  else {
+    log_fatal("No sky region information given, " <<
+        "use SetDisc, SetPolygon or SetDecBand first.")
+  }
+  return pixset;
 }
 
 void SkyMapCollection::InitializeMaps(const BinList& binList, const int nside) {
@@ -409,6 +558,7 @@ void SkyMapCollection::InitializeMaps(const BinList& binList, const int nside) {
   modelMaps_.clear();
   backgroundMaps_.clear();
   binInfoMap_.clear();
+  ++revision_;
   SetBins(binList);
   transits_ = 1;
   Healpix_Ordering_Scheme scheme = RING;
@@ -562,6 +712,34 @@ void SkyMapCollection::WriteMapTree(const string& filename, WriteType writeType,
   log_info("Wrote MapTree file '" << filename << "'.");
 }
 
+void SkyMapCollection::WriteMapColumns(const string& filename,
+                                       bool singlePrecision) {
+  MapColumnWriter mc(filename, singlePrecision);
+
+  for (AnalysisBinMap::iterator nb = analysisBins_.begin();
+       nb != analysisBins_.end(); ++nb) {
+    const BinName& n = nb->first;
+    const SkyMap<double>& data = *GetEventMap(n);
+    const SkyMap<double>& bkg = *GetBackgroundMap(n);
+
+    const BinInfo& bi = binInfoMap_[n];
+    MapColumnFile::BinInfo mcbi;
+    mcbi.startMJD = bi.startMJD;
+    mcbi.stopMJD = bi.stopMJD;
+    mcbi.nEvents = bi.nEvents;
+    mcbi.totalDuration = bi.totalDuration;
+    mcbi.duration = bi.duration;
+    mcbi.maptype = bi.maptype;
+    mcbi.maxDur = bi.maxDur;
+    mcbi.minDur = bi.minDur;
+    mcbi.epoch = bi.epoch;
+
+    mc.AddBin(n, data.Nside(), data.Scheme(), data.GetPixelRange(),
+              data.GetPixelValues(), bkg.GetPixelValues(), mcbi);
+  }
+  mc.Close();
+}
+
 void SkyMapCollection::UpdateWithModel(WriteType writeType,
                                        bool poisson) {
 
@@ -663,7 +841,39 @@ SkyMapCollection::GetBackgroundMap(const BinName& nhbin) {
 }
 
 void SkyMapCollection::LoadBinInfo(const string& mtFile, const bool reset) {
+  LoadBinInfo(mtFile, reset, binInfoMap_);
+}
+
+void SkyMapCollection::LoadBinInfo(const string& mtFile, const bool reset,
+                                   BinInfoMap& binInfoMap) const {
   log_debug("Loading duration information from MapTree file.");
+  if (MapColumnFile::IsMapColumnFile(mtFile)) {
+    const MapColumnFile mc(mtFile);
+    if (reset) {
+      binInfoMap.clear();
+    }
+    const vector<string>& names = mc.GetBinNames();
+    for (unsigned i = 0; i < names.size(); ++i) {
+      const MapColumnFile::BinInfo& mcbi = mc.GetBinInfo(names[i]);
+      BinInfo bi;
+      bi.startMJD = mcbi.startMJD;
+      bi.stopMJD = mcbi.stopMJD;
+      bi.nEvents = mcbi.nEvents;
+      bi.totalDuration = mcbi.totalDuration;
+      bi.duration = mcbi.duration;
+      bi.maptype = mcbi.maptype;
+      bi.maxDur = mcbi.maxDur;
+      bi.minDur = mcbi.minDur;
+      bi.epoch = mcbi.epoch;
+      if (reset || (binInfoMap.find(names[i]) == binInfoMap.end())) {
+        binInfoMap[names[i]] = bi;
+      }
+      else {
+        binInfoMap[names[i]] += bi;
+      }
+    }
+    return;
+  }
   const boost::shared_ptr<TFile> infile =
     boost::make_shared<TFile>(mtFile.c_str());
   //test if BinInfo tree is there
@@ -672,7 +882,7 @@ void SkyMapCollection::LoadBinInfo(const string& mtFile, const bool reset) {
     if (reset) {
       log_warn(" Assuming 2h average integration duration for all bins.");
       log_warn(" Assuming 1 transit duration.");
-      binInfoMap_.clear();
+      binInfoMap.clear();
       BinInfo bi;
       bi.startMJD = 0;
       bi.stopMJD = 0;
@@ -683,8 +893,8 @@ void SkyMapCollection::LoadBinInfo(const string& mtFile, const bool reset) {
       bi.maxDur = -1;
       bi.minDur = -1;
       bi.epoch = "unknown";
-      for (AnalysisBinMap::iterator nb = analysisBins_.begin(); nb != analysisBins_.end(); ++nb) {
-        binInfoMap_[nb->first] = bi;
+      for (AnalysisBinMap::const_iterator nb = analysisBins_.begin(); nb != analysisBins_.end(); ++nb) {
+        binInfoMap[nb->first] = bi;
       }
     }
     else {
@@ -799,11 +1009,11 @@ void SkyMapCollection::LoadBinInfo(const string& mtFile, const bool reset) {
       if (!hasName)
         nhname = BinIndexToName(nhid);
       
-      if (reset || (binInfoMap_.find(nhname) == binInfoMap_.end())) {
-        binInfoMap_[nhname] = bi;
+      if (reset || (binInfoMap.find(nhname) == binInfoMap.end())) {
+        binInfoMap[nhname] = bi;
       }
       else {
-        binInfoMap_[nhname] += bi;
+        binInfoMap[nhname] += bi;
       }
     }
 
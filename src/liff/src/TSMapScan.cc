@@ -0,0 +1,454 @@
+/*!
+ * @file TSMapScan.cc
+ * @author agent
+ * @date 16 Oct 2026
+ * @brief Multi-threaded point source TS scan over a set of HEALPix pixels.
+ * @version $Id$
+ */
+
+#include <liff/TSMapScan.h>
+
+#include <hawcnest/HAWCUnits.h>
+#include <hawcnest/Logging.h>
+
+#include <healpix_map.h>
+#include <healpix_map_fitsio.h>
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+
+#include <RVersion.h>
+#include <TROOT.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+using namespace std;
+using namespace threeML;
+using namespace HAWCUnits;
+
+namespace {
+
+  // Pixels fitted by one task; consecutive pixels of a RING map lie on the
+  // same ring, so a workspace moves by small steps in declination
+  const unsigned chunkSize = 16;
+
+  unsigned CheckThreads(unsigned nThreads) {
+    if (nThreads == 0) {
+      nThreads = boost::thread::hardware_concurrency();
+    }
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,6,0)
+    if (nThreads > 1) {
+      ROOT::EnableThreadSafety();
+    }
+#else
+    if (nThreads > 1) {
+      log_warn("Parallel fits need ROOT >= 6.06, using 1 thread.");
+      nThreads = 1;
+    }
+#endif
+    return max(1u, nThreads);
+  }
+
+}
+
+/*****************************************************/
+TSMapScan::TSMapScan(SkyMapCollection &data, const string &detRes,
+                     const BinList &binList, const string &spectrum,
+                     double pivot, double roiRadius, unsigned nThreads)
+    : data_(data),
+      detRes_(detRes),
+      binList_(binList),
+      spectrum_(spectrum),
+      pivot_(pivot),
+      roiRadius_(roiRadius),
+      pool_(CheckThreads(nThreads)),
+      backgroundNormFree_(false),
+      indexFree_(false),
+      blockSize_(1024),
+      startNorm_(0.),
+      startNormError_(0.),
+      startIndex_(0.),
+      startIndexError_(0.),
+      nside_(0) {
+}
+
+/*****************************************************/
+TSMapScan::TSMapScan(const string &mapTreeFile, double nTransits,
+                     const string &detRes, const BinList &binList,
+                     const string &spectrum, double pivot, double roiRadius,
+                     int nside, const vector<int> &pixels, unsigned nThreads)
+    : ownedData_(boost::make_shared<SkyMapCollection>()),
+      data_(*ownedData_),
+      detRes_(detRes),
+      binList_(binList),
+      spectrum_(spectrum),
+      pivot_(pivot),
+      roiRadius_(roiRadius),
+      pool_(CheckThreads(nThreads)),
+      backgroundNormFree_(false),
+      indexFree_(false),
+      blockSize_(1024),
+      startNorm_(0.),
+      startNormError_(0.),
+      startIndex_(0.),
+      startIndexError_(0.),
+      nside_(0) {
+
+  SetDataRegion(data_, nside, pixels, roiRadius + 1.);
+  data_.LoadMaps(mapTreeFile, binList_);
+  if (nTransits >= 0) {
+    data_.SetTransits(nTransits);
+  }
+}
+
+/*****************************************************/
+void TSMapScan::SetDataRegion(SkyMapCollection &data, int nside,
+                              const vector<int> &pixels, double radius) {
+
+  if (pixels.empty()) {
+    log_fatal("No pixels given to define the data region.");
+  }
+  Healpix_Base base(nside, RING, SET_NSIDE);
+  double minDec = 90.;
+  double maxDec = -90.;
+  for (unsigned i = 0; i < pixels.size(); ++i) {
+    const double dec = 90. - base.pix2ang(pixels[i]).theta / degree;
+    minDec = min(minDec, dec);
+    maxDec = max(maxDec, dec);
+  }
+  minDec = max(-90., minDec - radius);
+  maxDec = min(90., maxDec + radius);
+  log_info("Loading data map for dec range " << minDec << " to " << maxDec);
+  data.SetDecBand(minDec * degree, maxDec * degree);
+}
+
+/*****************************************************/
+void TSMapScan::SetBackgroundNormFree(bool free) {
+
+  backgroundNormFree_ = free;
+  for (unsigned i = 0; i < workspaces_.size(); ++i) {
+    SetupFit(workspaces_[i]);
+  }
+}
+
+/*****************************************************/
+void TSMapScan::SetIndexFree(bool free) {
+
+  indexFree_ = free;
+  for (unsigned i = 0; i < workspaces_.size(); ++i) {
+    SetupFit(workspaces_[i]);
+  }
+}
+
+/*****************************************************/
+void TSMapScan::SetCheckpointFile(const string &filename,
+                                  unsigned blockSize) {
+  checkpointFile_ = filename;
+  blockSize_ = max(1u, blockSize);
+}
+
+/*****************************************************/
+void TSMapScan::CreateWorkspaces(int pixel) {
+
+  // ROOT objects are created here, in one thread
+  const SkyPos position(Healpix_Base(nside_, RING, SET_NSIDE).pix2ang(pixel));
+  workspaces_.resize(pool_.GetNumberOfThreads());
+  for (unsigned i = 0; i < workspaces_.size(); ++i) {
+    Workspace &ws = workspaces_[i];
+    ostringstream name;
+    name << "TSMapScanSpectrum" << i;
+    ws.spectrum = MakeSpectrum(name.str(), spectrum_,
+                               numeric_limits<double>::quiet_NaN(),
+                               numeric_limits<double>::quiet_NaN(),
+                               pivot_);
+    ws.source.reset(new TF1PointSource("TestSource", position.RA(),
+                                       position.Dec(), ws.spectrum));
+    ws.like.reset(new LikeHAWC(&data_, detRes_, *ws.source, position.RA(),
+                               position.Dec(), roiRadius_, true, binList_));
+    //the PSF functions are evaluated in the fit, which runs in parallel
+    ws.like->GetPointSourceDetectorResponse(0)->GetDetectorResponse()
+        ->Unshare();
+    SetupFit(ws);
+    idle_.push_back(&ws);
+  }
+
+  //MINUIT takes its start steps from the errors, so they are reset as well
+  startNorm_ = workspaces_[0].spectrum->GetParameter(0);
+  startNormError_ = workspaces_[0].spectrum->GetParameterError(0);
+  startIndex_ = workspaces_[0].spectrum->GetParameter(1);
+  startIndexError_ = workspaces_[0].spectrum->GetParameterError(1);
+  CalcBinVector &calcBins = workspaces_[0].like->GetCalcBins();
+  backgroundNorms_.clear();
+  backgroundNormErrors_.clear();
+  for (unsigned k = 0; k < calcBins.size(); ++k) {
+    InternalModelBin &imb = calcBins[k]->GetInternalModelBin();
+    backgroundNorms_.push_back(imb.BackgroundNorm());
+    backgroundNormErrors_.push_back(imb.BackgroundNormError());
+  }
+  log_info("Created fit workspaces for " << workspaces_.size()
+           << " threads.");
+}
+
+/*****************************************************/
+void TSMapScan::SetupFit(Workspace &ws) {
+
+  ws.like->ClearFreeParameterList();
+  ws.like->SetCommonNormFree(true);
+  ws.like->SetBackgroundNormFree(backgroundNormFree_);
+  if (indexFree_) {
+    ws.like->AddFreeParameter(ws.spectrum, 1);
+  }
+}
+
+/*****************************************************/
+TSMapScan::Workspace *TSMapScan::CheckOut() {
+
+  boost::mutex::scoped_lock lock(idleMutex_);
+  if (idle_.empty()) {
+    log_fatal("No idle fit workspace left.");
+  }
+  Workspace *ws = idle_.back();
+  idle_.pop_back();
+  return ws;
+}
+
+/*****************************************************/
+void TSMapScan::CheckIn(Workspace *ws) {
+
+  boost::mutex::scoped_lock lock(idleMutex_);
+  idle_.push_back(ws);
+}
+
+/*****************************************************/
+void TSMapScan::Scan(int nside, const vector<int> &pixels) {
+
+  if (nside_ == 0) {
+    nside_ = nside;
+  }
+  else if (nside != nside_) {
+    log_fatal("Scan with nside " << nside << " after scans with nside "
+              << nside_ << ".");
+  }
+  if (!checkpointFile_.empty()) {
+    ReadCheckpoint();
+  }
+
+  vector<int> todo;
+  for (unsigned i = 0; i < pixels.size(); ++i) {
+    if (results_.find(pixels[i]) == results_.end()) {
+      todo.push_back(pixels[i]);
+    }
+  }
+  log_info("Scanning " << todo.size() << " of " << pixels.size()
+           << " pixels in " << pool_.GetNumberOfThreads() << " threads.");
+  if (todo.empty()) {
+    return;
+  }
+  if (workspaces_.empty()) {
+    CreateWorkspaces(todo[0]);
+  }
+
+  for (unsigned first = 0; first < todo.size(); first += blockSize_) {
+    const unsigned n = min<unsigned>(blockSize_, todo.size() - first);
+    vector<Result> block(n);
+    pool_.Run((n + chunkSize - 1) / chunkSize,
+              boost::bind(&TSMapScan::FitChunk, this, &todo, first, n,
+                          &block, _1));
+    for (unsigned i = 0; i < n; ++i) {
+      results_[block[i].pixel] = block[i];
+    }
+    if (!checkpointFile_.empty()) {
+      WriteCheckpoint(block);
+    }
+    log_info(first + n << " of " << todo.size() << " pixels done.");
+  }
+}
+
+/*****************************************************/
+void TSMapScan::FitChunk(const vector<int> *todo, unsigned first, unsigned n,
+                         vector<Result> *results, unsigned chunk) {
+
+  Workspace *ws = CheckOut();
+  try {
+    const unsigned stop = min(n, (chunk + 1) * chunkSize);
+    for (unsigned i = chunk * chunkSize; i < stop; ++i) {
+      (*results)[i] = Fit(*ws, (*todo)[first + i]);
+    }
+  }
+  catch (...) {
+    CheckIn(ws);
+    throw;
+  }
+  CheckIn(ws);
+}
+
+/*****************************************************/
+TSMapScan::Result TSMapScan::Fit(Workspace &ws, int pixel) {
+
+  LikeHAWC &like = *ws.like;
+
+  //same start values and steps for every pixel, whichever workspace fits it
+  ws.spectrum->SetParameter(0, startNorm_);
+  ws.spectrum->SetParameterError(0, startNormError_);
+  ws.spectrum->SetParameter(1, startIndex_);
+  ws.spectrum->SetParameterError(1, startIndexError_);
+  like.CommonNorm() = 1.;
+  like.CommonNormError() = 1.;
+  CalcBinVector &calcBins = like.GetCalcBins();
+  for (unsigned k = 0; k < calcBins.size(); ++k) {
+    InternalModelBin &imb = calcBins[k]->GetInternalModelBin();
+    imb.BackgroundNorm() = backgroundNorms_[k];
+    imb.BackgroundNormError() = backgroundNormErrors_[k];
+  }
+
+  const SkyPos position(Healpix_Base(nside_, RING, SET_NSIDE).pix2ang(pixel));
+  ws.source->setPointSourcePosition(0, position.RA(), position.Dec());
+  like.UpdateSources();
+  like.SetROI(position.RA(), position.Dec(), roiRadius_, true);
+
+  Result result;
+  result.pixel = pixel;
+  result.ts = like.CalcTestStatistic();
+  if (result.ts < 0) {
+    //rounding difference between model and BG LL maximization
+    log_debug("TS=" << result.ts << " at pixel " << pixel << ", set to 0.");
+    result.ts = 0.;
+    like.CommonNorm() = 0.;
+    like.CommonNormError() = 1.;
+  }
+  result.significance = sqrt(result.ts);
+  if (isnan(like.CommonNorm())) {
+    log_warn("CommonNorm from LL is nan at pixel " << pixel << ".");
+    like.CommonNorm() = 1.;
+    like.CommonNormError() = 1.;
+  }
+  else if (like.CommonNorm() < 0) {
+    result.significance = -result.significance;
+  }
+
+  const double norm = ws.spectrum->GetParameter(0);
+  result.flux = like.CommonNorm() * norm;
+  result.fluxError = like.CommonNormError() * norm;
+  result.index = -ws.spectrum->GetParameter(1);
+  result.indexError = indexFree_ ? ws.spectrum->GetParameterError(1) : 0.;
+  return result;
+}
+
+/*****************************************************/
+vector<TSMapScan::Result> TSMapScan::GetResults() const {
+
+  vector<Result> results;
+  results.reserve(results_.size());
+  for (map<int, Result>::const_iterator it = results_.begin();
+       it != results_.end(); ++it) {
+    results.push_back(it->second);
+  }
+  return results;
+}
+
+/*****************************************************/
+void TSMapScan::ReadCheckpoint() {
+
+  ifstream in(checkpointFile_.c_str());
+  if (!in) {
+    return;
+  }
+  unsigned nRead = 0;
+  string line;
+  while (getline(in, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    istringstream fields(line);
+    if (line[0] == '#') {
+      string hash, key;
+      int nside;
+      if ((fields >> hash >> key >> nside) && key == "nside" &&
+          nside != nside_) {
+        log_fatal("Checkpoint file \"" << checkpointFile_ << "\" has nside "
+                  << nside << ", scan has nside " << nside_ << ".");
+      }
+      continue;
+    }
+    Result r;
+    if (!(fields >> r.pixel >> r.ts >> r.significance >> r.flux
+                 >> r.fluxError >> r.index >> r.indexError)) {
+      //last line of an interrupted write
+      log_warn("Skipping incomplete line in checkpoint file \""
+               << checkpointFile_ << "\".");
+      continue;
+    }
+    results_[r.pixel] = r;
+    ++nRead;
+  }
+  log_info("Read " << nRead << " pixels from checkpoint file \""
+           << checkpointFile_ << "\".");
+}
+
+/*****************************************************/
+void TSMapScan::WriteCheckpoint(const vector<Result> &results) const {
+
+  const bool exists = ifstream(checkpointFile_.c_str()).good();
+  ofstream out(checkpointFile_.c_str(), ios::app);
+  if (!out) {
+    log_fatal("Could not open file \"" << checkpointFile_ << "\".");
+  }
+  if (!exists) {
+    out << "# nside " << nside_ << endl;
+    out << "# pixel TS significance flux fluxError index indexError" << endl;
+  }
+  out << setprecision(10);
+  for (unsigned i = 0; i < results.size(); ++i) {
+    const Result &r = results[i];
+    out << r.pixel << " " << r.ts << " " << r.significance << " " << r.flux
+        << " " << r.fluxError << " " << r.index << " " << r.indexError
+        << "\n";
+  }
+  out.flush();
+  if (!out) {
+    log_fatal("Error writing file \"" << checkpointFile_ << "\".");
+  }
+}
+
+/*****************************************************/
+void TSMapScan::WriteFits(const string &filename) const {
+
+  if (nside_ == 0) {
+    log_fatal("No pixels scanned, cannot write \"" << filename << "\".");
+  }
+  vector<Healpix_Map<double> > maps(5);
+  for (unsigned i = 0; i < maps.size(); ++i) {
+    maps[i].SetNside(nside_, RING);
+    maps[i].fill(-5.);
+  }
+  for (map<int, Result>::const_iterator it = results_.begin();
+       it != results_.end(); ++it) {
+    const Result &r = it->second;
+    maps[0][r.pixel] = r.significance;
+    maps[1][r.pixel] = r.flux;
+    maps[2][r.pixel] = r.fluxError;
+    maps[3][r.pixel] = r.index;
+    maps[4][r.pixel] = r.indexError;
+  }
+
+  fitshandle out;
+  arr<string> colname(5);
+  colname[0] = "significance";
+  colname[1] = "flux";
+  colname[2] = "flux error";
+  colname[3] = "index";
+  colname[4] = "index error";
+  out.create(filename);
+  prepare_Healpix_fitsmap(out, maps[0], PLANCK_FLOAT64, colname);
+  for (unsigned i = 0; i < maps.size(); ++i) {
+    out.write_column(i + 1, maps[i].Map());
+  }
+  out.set_key("TRANSITS", data_.GetTransits(), "Number of transits");
+  out.close();
+  log_info("Created new fits output file: " << filename);
+}
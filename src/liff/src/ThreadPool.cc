@@ -0,0 +1,138 @@
+/*!
+ * @file ThreadPool.cc
+ * @author agent
+ * @date 16 Oct 2026
+ * @brief Minimal fixed-size pool of worker threads for indexed tasks.
+ * @version $Id$
+ */
+
+#include <liff/ThreadPool.h>
+
+#include <hawcnest/Logging.h>
+
+#include <boost/bind.hpp>
+
+#include <exception>
+
+using namespace std;
+
+/*****************************************************/
+ThreadPool::ThreadPool(unsigned nThreads)
+    : task_(0),
+      nTasks_(0),
+      next_(0),
+      pending_(0),
+      generation_(0),
+      stop_(false) {
+
+  if (nThreads == 0) {
+    nThreads = boost::thread::hardware_concurrency();
+  }
+  if (nThreads == 0) {
+    nThreads = 1;
+  }
+  for (unsigned i = 1; i < nThreads; ++i) {
+    workers_.push_back(
+        new boost::thread(boost::bind(&ThreadPool::WorkerLoop, this)));
+  }
+  log_debug("Started thread pool with " << nThreads << " thread(s).");
+}
+
+/*****************************************************/
+ThreadPool::~ThreadPool() {
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    stop_ = true;
+  }
+  start_.notify_all();
+  for (unsigned i = 0; i < workers_.size(); ++i) {
+    workers_[i]->join();
+    delete workers_[i];
+  }
+}
+
+/*****************************************************/
+void ThreadPool::Run(unsigned n, const Task &task) {
+
+  if (n == 0) {
+    return;
+  }
+
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    task_ = &task;
+    nTasks_ = n;
+    next_ = 0;
+    pending_ = n;
+    error_.clear();
+    ++generation_;
+  }
+  start_.notify_all();
+
+  RunTasks();
+
+  string error;
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    while (pending_ > 0) {
+      done_.wait(lock);
+    }
+    task_ = 0;
+    error = error_;
+  }
+
+  if (!error.empty()) {
+    log_fatal("Task in thread pool failed: " << error);
+  }
+}
+
+/*****************************************************/
+void ThreadPool::WorkerLoop() {
+  unsigned seen = 0;
+  for (;;) {
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      while (!stop_ && (generation_ == seen)) {
+        start_.wait(lock);
+      }
+      if (stop_) {
+        return;
+      }
+      seen = generation_;
+    }
+    RunTasks();
+  }
+}
+
+/*****************************************************/
+void ThreadPool::RunTasks() {
+  for (;;) {
+    const Task *task = 0;
+    unsigned i = 0;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      if (next_ >= nTasks_) {
+        return;
+      }
+      task = task_;
+      i = next_++;
+    }
+
+    string error;
+    try {
+      (*task)(i);
+    } catch (const exception &e) {
+      error = e.what();
+    } catch (...) {
+      error = "unknown exception";
+    }
+
+    boost::mutex::scoped_lock lock(mutex_);
+    if (!error.empty() && error_.empty()) {
+      error_ = error;
+    }
+    if (--pending_ == 0) {
+      done_.notify_all();
+    }
+  }
+}
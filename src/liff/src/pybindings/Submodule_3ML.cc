@@ -15,6 +15,7 @@ using namespace boost::python;
 using namespace std;
 
 void pybind_liff_LikeHAWC_3ML();
+void pybind_liff_TSMapScan();
 
 BOOST_PYTHON_MODULE (liff_3ML) {
   // Shower user-defined and python docstrings; suppress C++ signatures
@@ -23,5 +24,6 @@ BOOST_PYTHON_MODULE (liff_3ML) {
   load_project("liff", false);
 
   pybind_liff_LikeHAWC_3ML();
+  pybind_liff_TSMapScan();
 }
 
@@ -0,0 +1,115 @@
+#include <string>
+#include <vector>
+
+#include <boost/python.hpp>
+#include <boost/python/stl_iterator.hpp>
+
+#include <liff/BinList.h>
+#include <liff/TSMapScan.h>
+
+using namespace std;
+using namespace boost::python;
+
+// Wrappers converting python lists for the TSMapScan interface.
+namespace {
+
+vector<int> ToPixels(const boost::python::list pixels) {
+  return vector<int>(stl_input_iterator<int>(pixels),
+                     stl_input_iterator<int>());
+}
+
+boost::shared_ptr<TSMapScan> TSMapScan_from_files(
+  const string mapTreeFile, const double nTransits, const string detRes,
+  const boost::python::list binList, const string spectrum,
+  const double pivot, const double roiRadius, const int nside,
+  const boost::python::list pixels, const unsigned nThreads) {
+
+  return boost::shared_ptr<TSMapScan>(
+    new TSMapScan(
+      mapTreeFile, nTransits, detRes,
+      BinList(
+        vector<string>(stl_input_iterator<string>(binList),
+                       stl_input_iterator<string>())
+      ), spectrum, pivot, roiRadius, nside, ToPixels(pixels), nThreads
+    )
+  );
+}
+
+void Scan_wrapper(TSMapScan &self, const int nside,
+                  const boost::python::list pixels) {
+  self.Scan(nside, ToPixels(pixels));
+}
+
+// List of (pixel, TS, significance, flux, flux error, index, index error)
+boost::python::list GetResults_wrapper(const TSMapScan &self) {
+  boost::python::list result;
+  const vector<TSMapScan::Result> results = self.GetResults();
+  for (unsigned i = 0; i < results.size(); ++i) {
+    const TSMapScan::Result &r = results[i];
+    result.append(boost::python::make_tuple(r.pixel, r.ts, r.significance,
+                                            r.flux, r.fluxError,
+                                            r.index, r.indexError));
+  }
+  return result;
+}
+
+}
+
+void
+pybind_liff_TSMapScan() {
+
+  class_<TSMapScan, boost::noncopyable>(
+      "TSMapScan",
+      "Multi-threaded point source TS scan over HEALPix pixels.",
+      no_init)
+
+      .def("__init__",
+           make_constructor(&TSMapScan_from_files),
+           "Load the maps needed to scan the pixels\nArgs:\n"
+               "     mtfile: map tree file name\n"
+               "     ntrans: number of transits, < 0 to use the map tree\n"
+               "     detres: detector response file name\n"
+               "    binlist: list of bin names\n"
+               "   spectrum: e.g. 'SimplePowerLaw,3.5e-11,2.63'\n"
+               "      pivot: pivot energy [TeV]\n"
+               "  roiRadius: ROI radius [degree]\n"
+               "      nside: nside of the RING map of the pixels\n"
+               "     pixels: list of pixels to be scanned\n"
+               "   nthreads: number of threads, 0 = one per core\n")
+
+      .def("SetBackgroundNormFree",
+           &TSMapScan::SetBackgroundNormFree,
+           args("free"),
+           "Fit the background norms of all bins, too.")
+
+      .def("SetIndexFree",
+           &TSMapScan::SetIndexFree,
+           args("free"),
+           "Fit the spectral index, too.")
+
+      .def("SetCheckpointFile",
+           &TSMapScan::SetCheckpointFile,
+           args("filename", "blockSize"),
+           "Append results to a text file after every blockSize pixels; "
+               "pixels found in the file are skipped.")
+
+      .def("Scan",
+           &Scan_wrapper,
+           args("nside", "pixels"),
+           "Fit a point source at the centers of the given pixels.")
+
+      .def("GetResults",
+           &GetResults_wrapper,
+           "List of (pixel, TS, significance, flux, flux error, index, "
+               "index error) tuples, ordered by pixel.")
+
+      .def("WriteFits",
+           &TSMapScan::WriteFits,
+           args("filename"),
+           "Write significance, flux and index maps to a FITS file.")
+
+      .def("GetNumberOfThreads",
+           &TSMapScan::GetNumberOfThreads,
+           "Number of threads fitting pixels.")
+      ;
+}
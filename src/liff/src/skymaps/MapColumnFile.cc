@@ -0,0 +1,380 @@
+/*!
+ * @file MapColumnFile.cc
+ * @author agent
+ * @date 16 Oct 2026
+ * @brief Columnar, memory-mapped storage of the data and background maps
+ *        of a set of analysis bins.
+ * @version $Id$
+ */
+
+#include <liff/skymaps/MapColumnFile.h>
+
+#include <healpix_map.h>
+
+#include <hawcnest/Logging.h>
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+  const char magic[8] = {'L', 'I', 'F', 'F', 'M', 'C', 'O', 'L'};
+  const boost::uint32_t formatVersion = 1;
+  const boost::uint32_t byteOrderMark = 0x01020304;
+  const unsigned headerSize = 32;
+
+  // Header after the magic: version, byte order, value size, number of bins
+  // (4 x uint32) and the directory offset (uint64)
+  struct Header {
+    boost::uint32_t version;
+    boost::uint32_t byteOrder;
+    boost::uint32_t valueSize;
+    boost::uint32_t nBins;
+    boost::uint64_t directory;
+  };
+
+  template<typename T>
+  void Append(string &buf, const T &val) {
+    buf.append(reinterpret_cast<const char *>(&val), sizeof(T));
+  }
+
+  void AppendString(string &buf, const string &str) {
+    Append(buf, (boost::uint32_t) str.size());
+    buf.append(str);
+  }
+
+  // Bounds-checked reading of the directory
+  class Cursor {
+    public:
+      Cursor(const char *data, size_t size, size_t pos, const string &fname)
+          : data_(data), size_(size), pos_(pos), fname_(fname) { }
+
+      template<typename T>
+      T Get() {
+        Check(sizeof(T));
+        T val;
+        memcpy(&val, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return val;
+      }
+
+      string GetString() {
+        boost::uint32_t len = Get<boost::uint32_t>();
+        Check(len);
+        string str(data_ + pos_, len);
+        pos_ += len;
+        return str;
+      }
+
+    private:
+      void Check(size_t n) {
+        if ((pos_ > size_) || (n > size_ - pos_)) {
+          log_fatal("Map column file " << fname_ << " is truncated.");
+        }
+      }
+
+      const char *data_;
+      size_t size_;
+      size_t pos_;
+      const string &fname_;
+  };
+
+}
+
+/*****************************************************/
+MapColumnFile::MapColumnFile(const string &filename)
+    : fname_(filename),
+      valueSize_(0) {
+
+  if (!IsMapColumnFile(filename)) {
+    log_fatal("\"" << filename << "\" is not a map column file.");
+  }
+  try {
+    file_.open(filename);
+  } catch (const exception &e) {
+    log_fatal("Could not map file \"" << filename << "\": " << e.what());
+  }
+  const char *data = file_.data();
+  const size_t size = file_.size();
+  if (size < headerSize) {
+    log_fatal("Map column file " << filename << " is truncated.");
+  }
+
+  Header header;
+  memcpy(&header, data + sizeof(magic), sizeof(Header));
+  if (header.byteOrder != byteOrderMark) {
+    log_fatal("Map column file " << filename << " was written on a machine "
+              "with different byte order.");
+  }
+  if (header.version != formatVersion) {
+    log_fatal("Map column file " << filename << " has unknown version "
+              << header.version << ".");
+  }
+  if ((header.valueSize != sizeof(float)) &&
+      (header.valueSize != sizeof(double))) {
+    log_fatal("Map column file " << filename << " has invalid value size "
+              << header.valueSize << ".");
+  }
+  valueSize_ = header.valueSize;
+
+  Cursor cursor(data, size, header.directory, fname_);
+  for (unsigned b = 0; b < header.nBins; ++b) {
+    string name = cursor.GetString();
+    Bin &bin = bins_[name];
+    names_.push_back(name);
+    bin.nside = cursor.Get<boost::int32_t>();
+    bin.scheme = cursor.Get<boost::int32_t>();
+    bin.info.startMJD = cursor.Get<double>();
+    bin.info.stopMJD = cursor.Get<double>();
+    bin.info.nEvents = cursor.Get<double>();
+    bin.info.totalDuration = cursor.Get<double>();
+    bin.info.duration = cursor.Get<double>();
+    bin.info.maptype = cursor.GetString();
+    bin.info.maxDur = cursor.Get<double>();
+    bin.info.minDur = cursor.Get<double>();
+    bin.info.epoch = cursor.GetString();
+    bin.offset[DATA] = cursor.Get<boost::uint64_t>();
+    bin.offset[BACKGROUND] = cursor.Get<boost::uint64_t>();
+    boost::uint32_t nRanges = cursor.Get<boost::uint32_t>();
+    bin.ranges.resize(nRanges);
+    boost::uint64_t nValues = 0;
+    for (unsigned r = 0; r < nRanges; ++r) {
+      PixelRange &range = bin.ranges[r];
+      range.begin = cursor.Get<boost::int32_t>();
+      range.end = cursor.Get<boost::int32_t>();
+      range.first = cursor.Get<boost::uint64_t>();
+      if ((range.end <= range.begin) || (range.first != nValues) ||
+          ((r > 0) && (range.begin < bin.ranges[r - 1].end))) {
+        log_fatal("Map column file " << filename << " has an invalid pixel "
+                  "range index for bin " << name << ".");
+      }
+      nValues += range.end - range.begin;
+    }
+    for (unsigned c = 0; c < 2; ++c) {
+      if ((bin.offset[c] > size) ||
+          (nValues > (size - bin.offset[c]) / valueSize_) ||
+          (bin.offset[c] % valueSize_ != 0)) {
+        log_fatal("Map column file " << filename << " is truncated.");
+      }
+    }
+  }
+  if (bins_.size() != names_.size()) {
+    log_fatal("Map column file " << filename << " has duplicate bins.");
+  }
+  log_debug("Mapped map column file " << filename << " with " << names_.size()
+            << " bins, " << 8 * valueSize_ << "-bit values.");
+}
+
+/*****************************************************/
+bool MapColumnFile::IsMapColumnFile(const string &filename) {
+  struct stat buf;
+  if (stat(filename.c_str(), &buf) != 0) {
+    return false;
+  }
+  ifstream in(filename.c_str(), ios::binary);
+  char head[sizeof(magic)];
+  if (!in.read(head, sizeof(magic))) {
+    return false;
+  }
+  return memcmp(head, magic, sizeof(magic)) == 0;
+}
+
+/*****************************************************/
+rangeset<int> MapColumnFile::GetStoredPixels(const string &bin) const {
+  const Bin &b = GetBin(bin);
+  rangeset<int> pixels;
+  for (unsigned r = 0; r < b.ranges.size(); ++r) {
+    pixels.append(b.ranges[r].begin, b.ranges[r].end);
+  }
+  return pixels;
+}
+
+/*****************************************************/
+void MapColumnFile::ReadRange(const string &bin, Column column,
+                              int begin, int end, double *out) const {
+
+  const Bin &b = GetBin(bin);
+  const char *base = file_.data() + b.offset[column];
+
+  // first stored range ending after begin
+  unsigned r = 0;
+  unsigned hi = b.ranges.size();
+  while (r < hi) {
+    unsigned mid = (r + hi) / 2;
+    if (b.ranges[mid].end <= begin) {
+      r = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  int p = begin;
+  for (; (p < end) && (r < b.ranges.size()); ++r) {
+    const PixelRange &range = b.ranges[r];
+    for (; (p < end) && (p < range.begin); ++p) {
+      *out++ = Healpix_undef;
+    }
+    int stop = min(end, range.end);
+    if (p >= stop) {
+      continue;
+    }
+    size_t first = range.first + (p - range.begin);
+    size_t n = stop - p;
+    if (valueSize_ == sizeof(double)) {
+      memcpy(out, base + first * sizeof(double), n * sizeof(double));
+    } else {
+      const float *values =
+          reinterpret_cast<const float *>(base) + first;
+      for (size_t i = 0; i < n; ++i) {
+        out[i] = values[i];
+      }
+    }
+    out += n;
+    p = stop;
+  }
+  for (; p < end; ++p) {
+    *out++ = Healpix_undef;
+  }
+}
+
+/*****************************************************/
+const MapColumnFile::Bin &MapColumnFile::GetBin(const string &bin) const {
+  map<string, Bin>::const_iterator it = bins_.find(bin);
+  if (it == bins_.end()) {
+    log_fatal("Bin " << bin << " not found in map column file " << fname_);
+  }
+  return it->second;
+}
+
+/*****************************************************/
+MapColumnWriter::MapColumnWriter(const string &filename, bool singlePrecision)
+    : fname_(filename),
+      out_(filename.c_str(), ios::binary | ios::trunc),
+      valueSize_(singlePrecision ? sizeof(float) : sizeof(double)),
+      nBins_(0) {
+  if (!out_) {
+    log_fatal("Could not create file \"" << filename << "\".");
+  }
+  // placeholder, the header is written in Close()
+  string header(headerSize, '\0');
+  out_.write(header.data(), header.size());
+}
+
+/*****************************************************/
+MapColumnWriter::~MapColumnWriter() {
+  if (!out_.is_open()) {
+    return;
+  }
+  // Close() was not called, e.g. because AddBin failed. Only Close() writes
+  // the header, so the magic stays zero and the incomplete file is rejected
+  // by IsMapColumnFile.
+  out_.close();
+  if (out_.fail()) {
+    log_fatal_nothrow("Error closing map column file " << fname_);
+  }
+  log_warn("Map column file " << fname_ << " was not closed, leaving it "
+           "incomplete.");
+}
+
+/*****************************************************/
+void MapColumnWriter::AddBin(const string &bin, int nside,
+                             Healpix_Ordering_Scheme scheme,
+                             const rangeset<int> &pixels,
+                             const vector<double> &data,
+                             const vector<double> &bkg,
+                             const MapColumnFile::BinInfo &info) {
+
+  if (!out_.is_open()) {
+    log_fatal("Map column file " << fname_ << " is already closed.");
+  }
+  if ((data.size() != (size_t) pixels.nval()) ||
+      (bkg.size() != (size_t) pixels.nval())) {
+    log_fatal("Bin " << bin << ": number of values does not match the "
+              "number of pixels.");
+  }
+
+  boost::uint64_t offset[2];
+  offset[MapColumnFile::DATA] = out_.tellp();
+  WriteValues(data);
+  offset[MapColumnFile::BACKGROUND] = out_.tellp();
+  WriteValues(bkg);
+
+  AppendString(directory_, bin);
+  Append(directory_, (boost::int32_t) nside);
+  Append(directory_, (boost::int32_t) scheme);
+  Append(directory_, info.startMJD);
+  Append(directory_, info.stopMJD);
+  Append(directory_, info.nEvents);
+  Append(directory_, info.totalDuration);
+  Append(directory_, info.duration);
+  AppendString(directory_, info.maptype);
+  Append(directory_, info.maxDur);
+  Append(directory_, info.minDur);
+  AppendString(directory_, info.epoch);
+  Append(directory_, offset[MapColumnFile::DATA]);
+  Append(directory_, offset[MapColumnFile::BACKGROUND]);
+  Append(directory_, (boost::uint32_t) pixels.size());
+  boost::uint64_t first = 0;
+  for (tsize r = 0; r < pixels.size(); ++r) {
+    Append(directory_, (boost::int32_t) pixels.ivbegin(r));
+    Append(directory_, (boost::int32_t) pixels.ivend(r));
+    Append(directory_, first);
+    first += pixels.ivlen(r);
+  }
+  ++nBins_;
+
+  if (!out_) {
+    log_fatal("Error writing map column file " << fname_);
+  }
+}
+
+/*****************************************************/
+void MapColumnWriter::Close() {
+
+  if (!out_.is_open()) {
+    return;
+  }
+
+  Header header;
+  header.version = formatVersion;
+  header.byteOrder = byteOrderMark;
+  header.valueSize = valueSize_;
+  header.nBins = nBins_;
+  header.directory = out_.tellp();
+
+  out_.write(directory_.data(), directory_.size());
+  out_.seekp(0);
+  out_.write(magic, sizeof(magic));
+  out_.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+  out_.close();
+
+  if (out_.fail()) {
+    log_fatal("Error writing map column file " << fname_);
+  }
+  log_info("Wrote map column file '" << fname_ << "' with " << nBins_
+           << " bins.");
+}
+
+/*****************************************************/
+void MapColumnWriter::WriteValues(const vector<double> &values) {
+  if (values.empty()) {
+    return;
+  }
+  if (valueSize_ == sizeof(double)) {
+    out_.write(reinterpret_cast<const char *>(&values[0]),
+               values.size() * sizeof(double));
+  } else {
+    vector<float> buf(values.begin(), values.end());
+    out_.write(reinterpret_cast<const char *>(&buf[0]),
+               buf.size() * sizeof(float));
+  }
+  // keep the next array aligned
+  size_t pad = (8 - (size_t) out_.tellp() % 8) % 8;
+  if (pad > 0) {
+    out_.write("\0\0\0\0\0\0\0", pad);
+  }
+}
@@ -6,17 +6,17 @@
  * @version $Id: SkyMap.cc 35073 2016-10-07 22:33:07Z criviere $
  */
 
-#include <boost/random.hpp>
-#include <boost/random/poisson_distribution.hpp>
-#include <boost/random/variate_generator.hpp>
 #include <boost/random/random_device.hpp>
 
+#include <algorithm>
 #include <typeinfo>
 
 #include <liff/skymaps/SkyMap.h>
 
 #include <hawcnest/Logging.h>
 
+#include <rng-service/RNGStream.h>
+
 using namespace std;
 
 template<typename T>
@@ -24,40 +24,31 @@ void SkyMap<T>::SetPixelRange
     (rangeset<int> &pixset, int nside, Healpix_Ordering_Scheme scheme) {
   SetNside(nside, scheme);
   pixels_ = pixset;
-  tsize ranges = pixels_.size();
-  for (unsigned i = 0; i < ranges; i++) {
-    int length = pixels_.ivlen(i);
-    arr<T> mappart(length, 0);
-    maps_.push_back(mappart);
-  }
+  BuildIndex();
+  values_.assign(pixels_.nval(), T(0));
 }
 
 template<typename T>
 void SkyMap<T>::SetFromMap(Healpix_Map<T> &map, rangeset<int> &pixset) {
   SetNside(map.Nside(), map.Scheme());
   pixels_ = pixset;
-  tsize ranges = pixels_.size();
-  for (unsigned i = 0; i < ranges; i++) {
-    int length = pixels_.ivlen(i);
-    arr<T> mappart(length);
-    for (int p = 0; p < length; p++) {
+  BuildIndex();
+  values_.resize(pixels_.nval());
+  for (unsigned i = 0; i < pixels_.size(); i++) {
+    T *mappart = &values_[offsets_[i]];
+    for (int p = 0; p < pixels_.ivlen(i); p++) {
       mappart[p] = map[pixels_.ivbegin(i) + p];
     }
-    maps_.push_back(mappart);
   }
 }
 
 template<typename T>
 void SkyMap<T>::Empty() {
-  for (unsigned i = 0; i < pixels_.size(); i++) {
-    for (int p = 0; p < pixels_.ivlen(i); p++) {
-      maps_[i][p] = 0;
-    }
-  }
+  std::fill(values_.begin(), values_.end(), T(0));
 }
 
 template<typename T>
-void SkyMap<T>::Add(const SkyMap map) {
+void SkyMap<T>::Add(const SkyMap &map, T scale) {
 #if HEALPIX_VERSION < 330
   if (!(this->GetPixelRange().equals(map.GetPixelRange()))) {
 #else
@@ -71,25 +62,37 @@ void SkyMap<T>::Add(const SkyMap map) {
     log_warn("Adding SkyMaps with different outside values, keeping the "
              "first one");
   }
-  for (unsigned i = 0; i < pixels_.size(); i++) {
-    for (int p = 0; p < pixels_.ivlen(i); p++) {
-      maps_[i][p] += map[pixels_.ivbegin(i) + p];
-    }
+  // same rangeset, so the slots match one to one
+  for (unsigned s = 0; s < values_.size(); s++) {
+    values_[s] += scale * map.values_[s];
   }
 }
 
+namespace {
+
+  // Seed for the non-reproducible Poisson fluctuations, drawn once per call
+  boost::uint64_t RandomSeed() {
+    boost::random::random_device device;
+    return ((boost::uint64_t) device() << 32) ^ device();
+  }
+
+}
+
 template<typename T>
 void SkyMap<T>::PoissonFluctuate() {
-  boost::mt19937 rndGen;
-  typedef boost::variate_generator<boost::mt19937,
-                                   boost::poisson_distribution<> > RndPoissonType;
-  RndPoissonType rndPoisson(rndGen, boost::poisson_distribution<>(1.));
+  PoissonFluctuate(RandomSeed(), 0);
+}
+
+template<typename T>
+void SkyMap<T>::PoissonFluctuate(boost::uint64_t seed,
+                                 boost::uint64_t stream) {
+  const RNGStream rng(seed, stream);
   for (unsigned i = 0; i < pixels_.size(); i++) {
+    T *mappart = &values_[offsets_[i]];
     for (int p = 0; p < pixels_.ivlen(i); p++) {
-      // Re-use the random generator from AddHealpixMap(). Use aerie's instead?
-      rndPoisson = RndPoissonType(rndGen, boost::poisson_distribution<>(maps_[i][p]));
-      rndPoisson.engine().seed(boost::random::random_device()());
-      maps_[i][p] = rndPoisson();
+      if (mappart[p] > 0) {
+        mappart[p] = rng.Poisson(mappart[p]);
+      }
     }
   }
 }
@@ -101,27 +104,26 @@ void SkyMap<T>::AddHealpixMap(Healpix_Map<T> &map, bool poisson) {
         " does not match Nside " << nside_ << " of SkyMap.")
   }
   if (poisson) {
-    boost::mt19937 rndGen;
-    typedef boost::variate_generator<boost::mt19937,
-                                     boost::poisson_distribution<> > RndPoissonType;
-    RndPoissonType rndPoisson(rndGen, boost::poisson_distribution<>(1.));
+    const RNGStream rng(RandomSeed());
     if (scheme_ != map.Scheme()) {
       swapfunc swapper = (scheme_ == RING) ?
                          &Healpix_Base::ring2nest : &Healpix_Base::nest2ring;
       for (unsigned i = 0; i < pixels_.size(); i++) {
+        T *mappart = &values_[offsets_[i]];
         for (int p = 0; p < pixels_.ivlen(i); p++) {
-          rndPoisson = RndPoissonType(rndGen, boost::poisson_distribution<>((T) map[(this->*swapper)(pixels_.ivbegin(i) + p)]));
-          rndPoisson.engine().seed(boost::random::random_device()());
-          maps_[i][p] += rndPoisson();
+          const int hp = pixels_.ivbegin(i) + p;
+          const T mean = (T) map[(this->*swapper)(hp)];
+          if (mean > 0) mappart[p] += rng.Poisson(mean);
         }
       }
     }
     else {
       for (unsigned i = 0; i < pixels_.size(); i++) {
+        T *mappart = &values_[offsets_[i]];
         for (int p = 0; p < pixels_.ivlen(i); p++) {
-          rndPoisson = RndPoissonType(rndGen, boost::poisson_distribution<>(map[pixels_.ivbegin(i) + p]));
-          rndPoisson.engine().seed(boost::random::random_device()());
-          maps_[i][p] += rndPoisson();
+          const int hp = pixels_.ivbegin(i) + p;
+          const T mean = map[hp];
+          if (mean > 0) mappart[p] += rng.Poisson(mean);
         }
       }
     }
@@ -131,15 +133,17 @@ void SkyMap<T>::AddHealpixMap(Healpix_Map<T> &map, bool poisson) {
       swapfunc swapper = (scheme_ == RING) ?
                          &Healpix_Base::ring2nest : &Healpix_Base::nest2ring;
       for (unsigned i = 0; i < pixels_.size(); i++) {
+        T *mappart = &values_[offsets_[i]];
         for (int p = 0; p < pixels_.ivlen(i); p++) {
-          maps_[i][p] += (T) map[(this->*swapper)(pixels_.ivbegin(i) + p)];
+          mappart[p] += (T) map[(this->*swapper)(pixels_.ivbegin(i) + p)];
         }
       }
     }
     else {
       for (unsigned i = 0; i < pixels_.size(); i++) {
+        T *mappart = &values_[offsets_[i]];
         for (int p = 0; p < pixels_.ivlen(i); p++) {
-          maps_[i][p] += map[pixels_.ivbegin(i) + p];
+          mappart[p] += map[pixels_.ivbegin(i) + p];
         }
       }
     }
@@ -156,15 +160,17 @@ void SkyMap<T>::SubHealpixMap(Healpix_Map<T> &map) {
     swapfunc swapper = (scheme_ == RING) ?
                        &Healpix_Base::ring2nest : &Healpix_Base::nest2ring;
     for (unsigned i = 0; i < pixels_.size(); i++) {
+      T *mappart = &values_[offsets_[i]];
       for (int p = 0; p < pixels_.ivlen(i); p++) {
-        maps_[i][p] -= (T) map[(this->*swapper)(pixels_.ivbegin(i) + p)];
+        mappart[p] -= (T) map[(this->*swapper)(pixels_.ivbegin(i) + p)];
       }
     }
   }
   else {
     for (unsigned i = 0; i < pixels_.size(); i++) {
+      T *mappart = &values_[offsets_[i]];
       for (int p = 0; p < pixels_.ivlen(i); p++) {
-        maps_[i][p] -= map[pixels_.ivbegin(i) + p];
+        mappart[p] -= map[pixels_.ivbegin(i) + p];
       }
     }
   }
@@ -174,14 +180,30 @@ template<typename T>
 void SkyMap<T>::SetFromTree(MapTree &tree, rangeset<int> &pixset) {
   SetNside(tree.Nside(), tree.Scheme());
   pixels_ = pixset;
-  tsize ranges = pixels_.size();
-  for (unsigned i = 0; i < ranges; i++) {
+  BuildIndex();
+  values_.resize(pixels_.nval());
+  for (unsigned i = 0; i < pixels_.size(); i++) {
+    tree.ReadRange(pixels_.ivbegin(i), pixels_.ivend(i), &values_[offsets_[i]]);
+  }
+}
+
+template<typename T>
+void SkyMap<T>::SetFromColumn(const MapColumnFile &file, const string &bin,
+                              MapColumnFile::Column column,
+                              rangeset<int> &pixset) {
+  SetNside(file.Nside(bin), file.Scheme(bin));
+  pixels_ = pixset;
+  BuildIndex();
+  values_.resize(pixels_.nval());
+  vector<double> buf;
+  for (unsigned i = 0; i < pixels_.size(); i++) {
     int length = pixels_.ivlen(i);
-    arr<T> mappart(length);
+    buf.resize(length);
+    file.ReadRange(bin, column, pixels_.ivbegin(i), pixels_.ivend(i), &buf[0]);
+    T *mappart = &values_[offsets_[i]];
     for (int p = 0; p < length; p++) {
-      mappart[p] = (T) tree.GetPixel(pixels_.ivbegin(i) + p);
+      mappart[p] = (T) buf[p];
     }
-    maps_.push_back(mappart);
   }
 }
 
@@ -195,15 +217,20 @@ void SkyMap<T>::AddMapTree(MapTree &tree) {
     swapfunc swapper = (scheme_ == RING) ?
                        &Healpix_Base::ring2nest : &Healpix_Base::nest2ring;
     for (unsigned i = 0; i < pixels_.size(); i++) {
+      T *mappart = &values_[offsets_[i]];
       for (int p = 0; p < pixels_.ivlen(i); p++) {
-        maps_[i][p] += (T) tree.GetPixel((this->*swapper)(pixels_.ivbegin(i) + p));
+        mappart[p] += (T) tree.GetPixel((this->*swapper)(pixels_.ivbegin(i) + p));
       }
     }
   }
   else {
+    vector<double> buf;
     for (unsigned i = 0; i < pixels_.size(); i++) {
+      T *mappart = &values_[offsets_[i]];
+      buf.resize(pixels_.ivlen(i));
+      tree.ReadRange(pixels_.ivbegin(i), pixels_.ivend(i), &buf[0]);
       for (int p = 0; p < pixels_.ivlen(i); p++) {
-        maps_[i][p] += (T) tree.GetPixel(pixels_.ivbegin(i) + p);
+        mappart[p] += (T) buf[p];
       }
     }
   }
@@ -219,15 +246,20 @@ void SkyMap<T>::SubMapTree(MapTree &tree) {
     swapfunc swapper = (scheme_ == RING) ?
                        &Healpix_Base::ring2nest : &Healpix_Base::nest2ring;
     for (unsigned i = 0; i < pixels_.size(); i++) {
+      T *mappart = &values_[offsets_[i]];
       for (int p = 0; p < pixels_.ivlen(i); p++) {
-        maps_[i][p] -= (T) tree.GetPixel((this->*swapper)(pixels_.ivbegin(i) + p));
+        mappart[p] -= (T) tree.GetPixel((this->*swapper)(pixels_.ivbegin(i) + p));
       }
     }
   }
   else {
+    vector<double> buf;
     for (unsigned i = 0; i < pixels_.size(); i++) {
+      T *mappart = &values_[offsets_[i]];
+      buf.resize(pixels_.ivlen(i));
+      tree.ReadRange(pixels_.ivbegin(i), pixels_.ivend(i), &buf[0]);
       for (int p = 0; p < pixels_.ivlen(i); p++) {
-        maps_[i][p] -= (T) tree.GetPixel(pixels_.ivbegin(i) + p);
+        mappart[p] -= (T) buf[p];
       }
     }
   }
@@ -235,41 +267,35 @@ void SkyMap<T>::SubMapTree(MapTree &tree) {
 
 template<typename T>
 void SkyMap<T>::Scale(T val) {
-  for (unsigned i = 0; i < pixels_.size(); i++) {
-    for (int p = 0; p < pixels_.ivlen(i); p++) {
-      maps_[i][p] *= val;
-    }
+  for (unsigned s = 0; s < values_.size(); s++) {
+    values_[s] *= val;
   }
 }
 
 template<typename T>
 void SkyMap<T>::SetInsideValue(T val) {
-  for (unsigned i = 0; i < pixels_.size(); i++) {
-    for (int p = 0; p < pixels_.ivlen(i); p++) {
-      maps_[i][p] = val;
-    }
-  }
+  std::fill(values_.begin(), values_.end(), val);
 }
 
 template<typename T>
 const T &SkyMap<T>::operator[](int pix) const {
   // const: pixel values can not be changed directly
-  tdiff i = pixels_.findInterval(pix);
-  return (i != -1) ? maps_[i][pix - pixels_.ivbegin(i)] : outside_;
+  const int slot = GetSlot(pix);
+  return (slot != -1) ? values_[slot] : outside_;
 }
 
 template<typename T>
 void SkyMap<T>::SetPixel(int pix, T value) {
-  tdiff i = pixels_.findInterval(pix);
-  if (i == -1) log_fatal("Pixel ID outside SkyMap range.")
-  maps_[i][pix - pixels_.ivbegin(i)] = value;
+  const int slot = GetSlot(pix);
+  if (slot == -1) log_fatal("Pixel ID outside SkyMap range.")
+  values_[slot] = value;
 }
 
 template<typename T>
 void SkyMap<T>::AddToPixel(int pix, T value) {
-  tdiff i = pixels_.findInterval(pix);
-  if (i == -1) log_fatal("Pixel ID outside SkyMap range.")
-  maps_[i][pix - pixels_.ivbegin(i)] += value;
+  const int slot = GetSlot(pix);
+  if (slot == -1) log_fatal("Pixel ID outside SkyMap range.")
+  values_[slot] += value;
 }
 
 template<typename T>
@@ -278,27 +304,23 @@ const int SkyMap<T>::FillHealpixMap(Healpix_Map<T> &fullmap, bool poisson) const
   fullmap.fill(T(Healpix_undef));
   int n = 0;
   if (poisson) {
-    boost::mt19937 rndGen;
-    typedef boost::variate_generator<boost::mt19937,
-                                     boost::poisson_distribution<> > RndPoissonType;
-    RndPoissonType rndPoisson(rndGen, boost::poisson_distribution<>(1.));
+    const RNGStream rng(RandomSeed());
     for (unsigned i = 0; i < pixels_.size(); i++) {
+      const T *mappart = &values_[offsets_[i]];
       for (int p = 0; p < pixels_.ivlen(i); p++) {
-        if (maps_[i][p] > 0.) {
-          rndPoisson = RndPoissonType(rndGen,
-                                      boost::poisson_distribution<>(maps_[i][p]));
-          rndPoisson.engine().seed(boost::random::random_device()());
-          fullmap[pixels_.ivbegin(i) + p] = rndPoisson();
+        if (mappart[p] > 0.) {
+          fullmap[pixels_.ivbegin(i) + p] = rng.Poisson(mappart[p]);
         } else {
-          fullmap[pixels_.ivbegin(i) + p] = maps_[i][p];
+          fullmap[pixels_.ivbegin(i) + p] = mappart[p];
         }
         n++;
       }
     }
   } else {
     for (unsigned i = 0; i < pixels_.size(); i++) {
+      const T *mappart = &values_[offsets_[i]];
       for (int p = 0; p < pixels_.ivlen(i); p++) {
-        fullmap[pixels_.ivbegin(i) + p] = maps_[i][p];
+        fullmap[pixels_.ivbegin(i) + p] = mappart[p];
         n++;
       }
     }
@@ -317,11 +339,18 @@ const int SkyMap<T>::WriteTreeFile
   return n;
 }
 
+template<typename T>
+vector<T> SkyMap<T>::GetPixelValues() const {
+  // the slots are in increasing pixel order
+  return values_;
+}
+
 template<typename T>
 void SkyMap<T>::Info() const {
   log_info("Printing info of SkyMap of type "<<typeid(T).name()<<":");
   log_info(" - outside_: "<<outside_);
-  log_info(" - maps_.size(): "<<maps_.size());
+  log_info(" - values_.size(): "<<values_.size());
+  log_info(" - index_.size(): "<<index_.size());
   log_info(" - pixels_: "<<pixels_);
   log_info(" - sum: "<<this->GetSum());
   return;
@@ -330,14 +359,61 @@ void SkyMap<T>::Info() const {
 template<typename T>
 T SkyMap<T>::GetSum() const {
   T sum = 0;
-  for (unsigned i = 0; i < pixels_.size(); i++) {
-    for (int p = 0; p < pixels_.ivlen(i); p++) {
-      sum += maps_[i][p];
-    }
+  for (unsigned s = 0; s < values_.size(); s++) {
+    sum += values_[s];
   }
   return sum;
 }
 
+template<typename T>
+int SkyMap<T>::GetSlotPixel(int slot) const {
+  if (slot < 0 || slot >= GetNumberOfSlots()) {
+    log_fatal("Slot " << slot << " outside SkyMap range.")
+  }
+  // last interval starting at or before the slot
+  const tsize i =
+      upper_bound(offsets_.begin(), offsets_.end(), slot) - offsets_.begin() - 1;
+  return pixels_.ivbegin(i) + (slot - offsets_[i]);
+}
+
+template<typename T>
+void SkyMap<T>::BuildIndex() {
+  const tsize ranges = pixels_.size();
+  offsets_.resize(ranges);
+  int nval = 0;
+  for (tsize i = 0; i < ranges; i++) {
+    offsets_[i] = nval;
+    nval += pixels_.ivlen(i);
+  }
+
+  index_.clear();
+  indexShift_ = 0;
+  if (ranges == 0) {
+    firstPix_ = endPix_ = 0;
+    return;
+  }
+  firstPix_ = pixels_.ivbegin(0);
+  endPix_ = pixels_.ivend(ranges - 1);
+
+  // Blocks of 2^indexShift_ pixels, with at most about nval/4 table entries.
+  // The intervals overlapping block b are index_[b], ..., index_[b + 1], so a
+  // lookup searches only these, also where short intervals cluster in a few
+  // blocks of a fragmented map.
+  const int span = endPix_ - firstPix_;
+  while ((span >> indexShift_) > nval / 4 && indexShift_ < 30) {
+    ++indexShift_;
+  }
+  const int nBlocks = ((span - 1) >> indexShift_) + 1;
+  index_.resize(nBlocks + 1);
+  tsize i = 0;
+  for (int b = 0; b < nBlocks; b++) {
+    const int start = firstPix_ + (b << indexShift_);
+    while (pixels_.ivend(i) <= start) ++i;
+    index_[b] = i;
+  }
+  index_[nBlocks] = ranges - 1;
+}
+
 template
 class SkyMap<int>;
 template
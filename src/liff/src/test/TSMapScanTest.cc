@@ -0,0 +1,84 @@
+/*!
+ * @file TSMapScanTest.cc
+ * @brief Unit test for the multi-threaded TS map scan
+ * @author agent
+ * @date 16 Oct 2026
+ * @ingroup integration_test
+ * @version $Id$
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <hawcnest/HAWCUnits.h>
+
+#include <liff/BinList.h>
+#include <liff/SkyMapCollection.h>
+#include <liff/TSMapScan.h>
+
+#include <healpix_base.h>
+
+#include <cstdlib>
+#include <vector>
+
+using namespace HAWCUnits;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(TSMapScanThreads)
+
+  // The fits with free index have to give the same results with 1 and with
+  // several threads, i.e. whichever workspace fits a pixel after whichever
+  // other pixel
+  BOOST_AUTO_TEST_CASE(IndexFree)
+  {
+    const char* HAWC_SRC = getenv("HAWC_SRC");
+    BOOST_REQUIRE(HAWC_SRC != NULL);
+
+    string LIKE_CONF = string(HAWC_SRC) + string("/liff/config/");
+    string mapfile = LIKE_CONF +
+      "SubSkyMaps/Crab/maptree_20150519_v4_100days_CrabDisc5deg.root";
+    string detfile = LIKE_CONF +
+      "DetResponse/DetRes_aerie-svn-25030_HAWC250_20150519_v4_SensiPSF.root";
+
+    const SkyPos crab(83.63, 22.01);
+    const BinList binList(0, 9);
+
+    SkyMapCollection data;
+    data.SetDisc(crab, 5. * degree);
+    data.LoadMaps(mapfile, binList);
+
+    // More pixels than one chunk of a scan, so that they are spread over
+    // the workspaces
+    const int nside = 256;
+    Healpix_Base base(nside, RING, SET_NSIDE);
+    rangeset<int> pixset;
+    base.query_disc(crab.GetPointing(), 1. * degree, pixset);
+    vector<int> pixels;
+    pixset.toVector(pixels);
+    BOOST_REQUIRE(pixels.size() > 32);
+
+    vector<vector<TSMapScan::Result> > results;
+    const unsigned nThreads[] = {1, 4};
+    for (unsigned t = 0; t < 2; ++t) {
+      TSMapScan scan(data, detfile, binList, "SimplePowerLaw,3.5e-11,2.63",
+                     1., 2., nThreads[t]);
+      scan.SetIndexFree(true);
+      scan.Scan(nside, pixels);
+      results.push_back(scan.GetResults());
+    }
+
+    BOOST_REQUIRE_EQUAL(results[0].size(), pixels.size());
+    BOOST_REQUIRE_EQUAL(results[1].size(), pixels.size());
+    for (unsigned i = 0; i < pixels.size(); ++i) {
+      const TSMapScan::Result &r1 = results[0][i];
+      const TSMapScan::Result &rN = results[1][i];
+      BOOST_CHECK_EQUAL(r1.pixel, rN.pixel);
+      BOOST_CHECK_EQUAL(r1.ts, rN.ts);
+      BOOST_CHECK_EQUAL(r1.flux, rN.flux);
+      BOOST_CHECK_EQUAL(r1.fluxError, rN.fluxError);
+      BOOST_CHECK_EQUAL(r1.index, rN.index);
+      BOOST_CHECK_EQUAL(r1.indexError, rN.indexError);
+    }
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,117 @@
+/*!
+ * @file PhiloxEngine.h
+ * @brief Counter-based Philox4x32-10 random number engine.
+ * @author agent
+ * @date 16 Oct 2026
+ * @version $Id$
+ */
+
+#ifndef RNGSERVICE_PHILOXENGINE_H_INCLUDED
+#define RNGSERVICE_PHILOXENGINE_H_INCLUDED
+
+#include <boost/cstdint.hpp>
+
+/*!
+ * @class PhiloxEngine
+ * @author agent
+ * @date 16 Oct 2026
+ * @ingroup rndm_gen
+ * @brief Philox4x32-10 generator of J. Salmon et al., SC11 (2011).
+ *
+ * Block @a i of stream @a s is a keyed bijection of the counter (i, s), so
+ * the engine needs no state besides its position and any block can be
+ * computed without generating the ones before it.  Streams with different
+ * numbers never overlap.  The class models a @c boost::random uniform random
+ * number generator with 32-bit output.
+ */
+class PhiloxEngine {
+
+  public:
+
+    typedef boost::uint32_t result_type;
+
+    PhiloxEngine(const boost::uint64_t key = 0,
+                 const boost::uint64_t stream = 0) :
+      key_(key), stream_(stream), block_(0), pos_(4)
+    { }
+
+    static result_type min() { return 0; }
+    static result_type max() { return 0xFFFFFFFFu; }
+
+    result_type operator()() {
+      if (pos_ == 4) {
+        Block(block_++, buffer_);
+        pos_ = 0;
+      }
+      return buffer_[pos_++];
+    }
+
+    /// Uniform number in [0, 1) with 53 random bits
+    double Uniform() {
+      const boost::uint32_t hi = (*this)();
+      const boost::uint32_t lo = (*this)();
+      return ToDouble(hi, lo);
+    }
+
+    /// Fills out[0..n-1] with the next n numbers of Uniform()
+    void Uniform(double* out, unsigned n) {
+      // Finish the buffered block, then convert whole blocks in a loop
+      // without data dependencies between iterations
+      while (n > 0 && pos_ != 4) {
+        *out++ = Uniform();
+        --n;
+      }
+      const unsigned nBlocks = n / 2;
+      boost::uint32_t w[4];
+      for (unsigned i = 0; i < nBlocks; ++i) {
+        Block(block_ + i, w);
+        out[2*i] = ToDouble(w[0], w[1]);
+        out[2*i+1] = ToDouble(w[2], w[3]);
+      }
+      block_ += nBlocks;
+      if (n % 2)
+        out[n-1] = Uniform();
+    }
+
+    /// Computes the four words of block number @a block of this stream
+    void Block(const boost::uint64_t block, boost::uint32_t out[4]) const {
+      boost::uint32_t c0 = boost::uint32_t(block);
+      boost::uint32_t c1 = boost::uint32_t(block >> 32);
+      boost::uint32_t c2 = boost::uint32_t(stream_);
+      boost::uint32_t c3 = boost::uint32_t(stream_ >> 32);
+      boost::uint32_t k0 = boost::uint32_t(key_);
+      boost::uint32_t k1 = boost::uint32_t(key_ >> 32);
+      for (int r = 0; r < 10; ++r) {
+        const boost::uint64_t p0 = boost::uint64_t(0xD2511F53u) * c0;
+        const boost::uint64_t p1 = boost::uint64_t(0xCD9E8D57u) * c2;
+        const boost::uint32_t n0 = boost::uint32_t(p1 >> 32) ^ c1 ^ k0;
+        const boost::uint32_t n2 = boost::uint32_t(p0 >> 32) ^ c3 ^ k1;
+        c1 = boost::uint32_t(p1);
+        c3 = boost::uint32_t(p0);
+        c0 = n0;
+        c2 = n2;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+      }
+      out[0] = c0;
+      out[1] = c1;
+      out[2] = c2;
+      out[3] = c3;
+    }
+
+  private:
+
+    static double ToDouble(const boost::uint32_t hi, const boost::uint32_t lo) {
+      const boost::uint64_t x = ((boost::uint64_t(hi) << 32) | lo) >> 11;
+      return x * (1. / 9007199254740992.);
+    }
+
+    boost::uint64_t key_;
+    boost::uint64_t stream_;
+    boost::uint64_t block_;        ///< Next block to generate
+    boost::uint32_t buffer_[4];    ///< Current block
+    unsigned pos_;                 ///< Next word of buffer_ (4: exhausted)
+
+};
+
+#endif // RNGSERVICE_PHILOXENGINE_H_INCLUDED
@@ -9,6 +9,8 @@
 #ifndef RNGSERVICE_RNGSERVICE_H_INCLUDED
 #define RNGSERVICE_RNGSERVICE_H_INCLUDED
 
+#include <vector>
+
 /*!
  * @class RNGService
  * @author Segev BenZvi
@@ -16,6 +18,10 @@
  * @ingroup rndm_gen
  * @brief Abstract interface for services which generate random numbers from a
  *        few commonly used distributions.
+ *
+ * The bulk versions fill a vector with many draws.  By default they call the
+ * scalar functions in a loop; implementations override them with faster
+ * kernels that return the same sequence as the scalar calls.
  */
 class RNGService {
 
@@ -124,6 +130,44 @@ class RNGService {
     virtual double CutoffPowerLaw(const double n, const double lambda,
                                   const double a, const double b) const = 0;
 
+    /// Fill @a out with @a count uniform numbers between @a a and @a b
+    virtual void Uniform(const unsigned count, std::vector<double>& out,
+                         const double a=0, const double b=1) const
+    {
+      out.resize(count);
+      for (unsigned i = 0; i < count; ++i)
+        out[i] = Uniform(a, b);
+    }
+
+    /// Fill @a out with one Poisson number for each mean in @a mu
+    virtual void Poisson(const std::vector<double>& mu, std::vector<int>& out)
+      const
+    {
+      out.resize(mu.size());
+      for (unsigned i = 0; i < mu.size(); ++i)
+        out[i] = Poisson(mu[i]);
+    }
+
+    /// Fill @a out with @a count draws from a power law x^n on [a, b]
+    virtual void PowerLaw(const double n, const double a, const double b,
+                          const unsigned count, std::vector<double>& out) const
+    {
+      out.resize(count);
+      for (unsigned i = 0; i < count; ++i)
+        out[i] = PowerLaw(n, a, b);
+    }
+
+    /// Fill @a out with @a count draws from x^n e^{-lambda x} on [a, b]
+    virtual void CutoffPowerLaw(const double n, const double lambda,
+                                const double a, const double b,
+                                const unsigned count, std::vector<double>& out)
+      const
+    {
+      out.resize(count);
+      for (unsigned i = 0; i < count; ++i)
+        out[i] = CutoffPowerLaw(n, lambda, a, b);
+    }
+
 };
 
 #endif // RNGSERVICE_RNGSERVICE_H_INCLUDED
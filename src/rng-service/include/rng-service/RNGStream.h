@@ -0,0 +1,87 @@
+/*!
+ * @file RNGStream.h
+ * @brief Independent random number stream for one task.
+ * @author agent
+ * @date 16 Oct 2026
+ * @version $Id$
+ */
+
+#ifndef RNGSERVICE_RNGSTREAM_H_INCLUDED
+#define RNGSERVICE_RNGSTREAM_H_INCLUDED
+
+#include <rng-service/RNGService.h>
+#include <rng-service/PhiloxEngine.h>
+
+/*!
+ * @class RNGStream
+ * @author agent
+ * @date 16 Oct 2026
+ * @ingroup rndm_gen
+ * @brief Random numbers from one stream of a counter-based generator.
+ *
+ * A stream is identified by a seed and a stream number; it is usually
+ * obtained from StdRNGService::GetStream.  Streams are cheap to create and
+ * statistically independent, and the numbers of a stream do not depend on
+ * anything else, so parallel code stays reproducible: give every unit of
+ * work (not every thread) its own stream number, and the results do not
+ * change with the number of threads.
+ *
+ * A single RNGStream must not be used from several threads at once.
+ */
+class RNGStream : public RNGService {
+
+  public:
+
+    RNGStream(const boost::uint64_t seed=0, const boost::uint64_t stream=0);
+
+    using RNGService::Uniform;
+    using RNGService::Poisson;
+    using RNGService::PowerLaw;
+    using RNGService::CutoffPowerLaw;
+
+    int Poisson(const double mu=1) const;
+
+    int Binomial(const int n=10, const double p=0.5) const;
+
+    double Gaussian(const double mu=0, const double sigma=1) const;
+
+    double LogNormal(const double mu=0, const double sigma=1) const;
+
+    double Rician(const double nu=0, const double sigma=1) const;
+
+    double Uniform(const double a=0, const double b=1) const;
+
+    double Exponential(const double lambda=1) const;
+
+    double PowerLaw(const double n,
+                    const double a, const double b) const;
+
+    double CutoffPowerLaw(const double n, const double lambda,
+                          const double a, const double b) const;
+
+    void Uniform(const unsigned count, std::vector<double>& out,
+                 const double a=0, const double b=1) const;
+
+    void Poisson(const std::vector<double>& mu, std::vector<int>& out) const;
+
+    void PowerLaw(const double n, const double a, const double b,
+                  const unsigned count, std::vector<double>& out) const;
+
+    void CutoffPowerLaw(const double n, const double lambda,
+                        const double a, const double b,
+                        const unsigned count, std::vector<double>& out) const;
+
+  private:
+
+    /// Adapts the engine to the functor interface of RNGAlgorithms
+    struct UniformSource {
+      UniformSource(PhiloxEngine& engine) : engine_(engine) { }
+      double operator()() { return engine_.Uniform(); }
+      PhiloxEngine& engine_;
+    };
+
+    mutable PhiloxEngine engine_;
+
+};
+
+#endif // RNGSERVICE_RNGSTREAM_H_INCLUDED
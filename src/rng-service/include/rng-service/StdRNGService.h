@@ -10,6 +10,7 @@
 #define RNGSERVICE_STDRNGSERVICE_H_INCLUDED
 
 #include <rng-service/RNGService.h>
+#include <rng-service/RNGStream.h>
 
 #include <hawcnest/Service.h>
 
@@ -31,12 +32,12 @@
  * hidden by the StdRNGService interface, so user code will not be coupled to
  * boost.
  *
- * Note that the service is probably not thread-safe, in the sense that
- * multiple copies of the RNG engine may be created in different threads.
- * If these copies have the same seed, then the different threads will generate
- * identical sequences of numbers.  Therefore, use with caution in a
- * multithreaded environment.  (As of October 2013 AERIE does not support
- * multithreading.)
+ * The functions of the service share one engine and must not be called from
+ * several threads at once.  Parallel code should instead draw from streams
+ * created with GetStream(), which is thread-safe.  The streams are derived
+ * deterministically from the seed of the service; numbering them by unit of
+ * work (event, pixel, trial, ...) rather than by thread makes the results
+ * independent of the number of threads.
  *
  * Also note that users are expected to run the RNG in an intelligent way when
  * submitting many jobs in parallel.  Each job should get a unique random seed,
@@ -59,6 +60,21 @@ class StdRNGService : public RNGService {
 
     void Finish() { }
 
+    /*!
+     * @brief Independent random number stream number @a stream.
+     *
+     * The stream is a function of the seed of the service and @a stream only,
+     * so the same seed and stream number always give the same numbers.  Safe
+     * to call from several threads after the service is initialized.
+     */
+    RNGStream GetStream(const boost::uint64_t stream) const
+    { return RNGStream(seed_, stream); }
+
+    using RNGService::Uniform;
+    using RNGService::Poisson;
+    using RNGService::PowerLaw;
+    using RNGService::CutoffPowerLaw;
+
     /*!
      * @brief Draw an integer from a Poisson distribution with mean @a mu.
      * 
@@ -160,6 +176,18 @@ class StdRNGService : public RNGService {
     double CutoffPowerLaw(const double n, const double lambda,
                           const double a, const double b) const;
 
+    void Uniform(const unsigned count, std::vector<double>& out,
+                 const double a=0, const double b=1) const;
+
+    void Poisson(const std::vector<double>& mu, std::vector<int>& out) const;
+
+    void PowerLaw(const double n, const double a, const double b,
+                  const unsigned count, std::vector<double>& out) const;
+
+    void CutoffPowerLaw(const double n, const double lambda,
+                        const double a, const double b,
+                        const unsigned count, std::vector<double>& out) const;
+
   private:
 
     typedef boost::mt19937 RNGEngine;
@@ -178,14 +206,7 @@ class StdRNGService : public RNGService {
     mutable NGenerator normalRNG_;        ///< Normal number generator
     mutable EGenerator expRNG_;           ///< Exponential number generator
 
-    /// Binomial variate generator using an inversion algorithm
-    int BinomialInversion(const int n, const double p) const;
-
-    /// Binomial variate generator using a transformation/rejection algorithm
-    int BinomialRejection(const int n, const double p) const;
-
-    /// Corrections to Stirling's approximation for log(k!)
-    int StirlingCorrection(int k) const;
+    unsigned seed_;                       ///< Seed of the engine and streams
 
 };
 
@@ -0,0 +1,145 @@
+/*!
+ * @file RNGStream.cc
+ * @brief Independent random number stream for one task.
+ * @author agent
+ * @date 16 Oct 2026
+ * @version $Id$
+ */
+
+#include <rng-service/RNGStream.h>
+#include <rng-service/RNGAlgorithms.h>
+
+#include <hawcnest/HAWCUnits.h>
+
+#include <boost/random/normal_distribution.hpp>
+
+#include <cmath>
+
+using namespace std;
+using namespace HAWCUnits;
+
+RNGStream::RNGStream(const boost::uint64_t seed, const boost::uint64_t stream) :
+  engine_(seed, stream)
+{
+}
+
+int
+RNGStream::Poisson(const double mu)
+  const
+{
+  UniformSource u(engine_);
+  return RNGAlgorithms::Poisson(u, mu);
+}
+
+int
+RNGStream::Binomial(const int n, const double p)
+  const
+{
+  UniformSource u(engine_);
+  return RNGAlgorithms::Binomial(u, n, p);
+}
+
+double
+RNGStream::Gaussian(const double mu, const double sigma)
+  const
+{
+  return boost::random::normal_distribution<double>(mu, sigma)(engine_);
+}
+
+double
+RNGStream::LogNormal(const double mu, const double sigma)
+  const
+{
+  return exp(Gaussian(mu, sigma));
+}
+
+double
+RNGStream::Rician(const double nu, const double sigma)
+  const
+{
+  double theta = Uniform(0., 360*degree);
+  double x = Gaussian(nu*cos(theta), sigma);
+  double y = Gaussian(nu*sin(theta), sigma);
+  return sqrt(x*x + y*y);
+}
+
+double
+RNGStream::Uniform(const double a, const double b)
+  const
+{
+  return a + (b-a)*engine_.Uniform();
+}
+
+double
+RNGStream::Exponential(const double lambda)
+  const
+{
+  return -log(1. - engine_.Uniform()) / lambda;
+}
+
+double
+RNGStream::PowerLaw(const double n, const double a, const double b)
+  const
+{
+  return RNGAlgorithms::PowerLawSampler(n, a, b)(engine_.Uniform());
+}
+
+double
+RNGStream::CutoffPowerLaw(const double n, const double lambda,
+                          const double a, const double b)
+  const
+{
+  UniformSource u(engine_);
+  return RNGAlgorithms::CutoffPowerLaw(u,
+                                       RNGAlgorithms::PowerLawSampler(n, a, b),
+                                       lambda);
+}
+
+void
+RNGStream::Uniform(const unsigned count, vector<double>& out,
+                   const double a, const double b)
+  const
+{
+  out.resize(count);
+  if (count == 0)
+    return;
+  engine_.Uniform(&out[0], count);
+  if (a != 0. || b != 1.) {
+    for (unsigned i = 0; i < count; ++i)
+      out[i] = a + (b-a)*out[i];
+  }
+}
+
+void
+RNGStream::Poisson(const vector<double>& mu, vector<int>& out)
+  const
+{
+  UniformSource u(engine_);
+  out.resize(mu.size());
+  for (unsigned i = 0; i < mu.size(); ++i)
+    out[i] = RNGAlgorithms::Poisson(u, mu[i]);
+}
+
+void
+RNGStream::PowerLaw(const double n, const double a, const double b,
+                    const unsigned count, vector<double>& out)
+  const
+{
+  Uniform(count, out);
+  const RNGAlgorithms::PowerLawSampler powerLaw(n, a, b);
+  for (unsigned i = 0; i < count; ++i)
+    out[i] = powerLaw(out[i]);
+}
+
+void
+RNGStream::CutoffPowerLaw(const double n, const double lambda,
+                          const double a, const double b,
+                          const unsigned count, vector<double>& out)
+  const
+{
+  UniformSource u(engine_);
+  const RNGAlgorithms::PowerLawSampler powerLaw(n, a, b);
+  out.resize(count);
+  for (unsigned i = 0; i < count; ++i)
+    out[i] = RNGAlgorithms::CutoffPowerLaw(u, powerLaw, lambda);
+}
@@ -3,6 +3,7 @@
 
 #include <rng-service/RNGService.h>
 #include <rng-service/StdRNGService.h>
+#include <rng-service/RNGStream.h>
 
 using namespace boost::python;
 
@@ -49,11 +50,21 @@ class RNGServiceWrap : public RNGService, public wrapper<RNGService> {
 void
 pybind_rng_service_RNGService()
 {
+  // Scalar overloads; the bulk versions fill C++ vectors and are not exposed
+  int (RNGService::*poisson)(const double) const = &RNGService::Poisson;
+  double (RNGService::*uniform)(const double, const double) const =
+    &RNGService::Uniform;
+  double (RNGService::*powerLaw)(const double, const double, const double)
+    const = &RNGService::PowerLaw;
+  double (RNGService::*cutoffPowerLaw)(const double, const double,
+                                       const double, const double) const =
+    &RNGService::CutoffPowerLaw;
+
   class_<RNGServiceWrap, boost::noncopyable>
     ("RNGService",
      "Abstract interface for random number generators",
      no_init)
-     .def("Poisson", pure_virtual(&RNGService::Poisson),
+     .def("Poisson", pure_virtual(poisson),
           (arg("mu")=1.),
           "Generate Poisson random integers with mean mu.")
      .def("Binomial", pure_virtual(&RNGService::Binomial),
@@ -68,15 +79,15 @@ pybind_rng_service_RNGService()
      .def("Rician", pure_virtual(&RNGService::Rician),
           (arg("mu")=0., arg("sigma")=1.),
           "Generate rician random numbers with mean mu and width sigma.")
-     .def("Uniform", pure_virtual(&RNGService::Uniform),
+     .def("Uniform", pure_virtual(uniform),
           (arg("a")=0., arg("b")=1.),
           "Generate uniform random numbers in the range [a, b].")
      .def("Exponential", pure_virtual(&RNGService::Exponential),
           (arg("lambda")=1.),
           "Generate exponential random numbers with decay length lambda.")
-     .def("PowerLaw", pure_virtual(&RNGService::PowerLaw),
+     .def("PowerLaw", pure_virtual(powerLaw),
           "Generate power law random numbers x^n on [a, b].")
-     .def("CutoffPowerLaw", pure_virtual(&RNGService::CutoffPowerLaw),
+     .def("CutoffPowerLaw", pure_virtual(cutoffPowerLaw),
           "Generate random numbers x^n * exp(-lambda*x) on [a, b].")
     ;
 }
@@ -88,6 +99,19 @@ pybind_rng_service_StdRNGService()
   class_<StdRNGService, bases<RNGService> >
     ("StdRNGService",
      "Default service for generating random numbers")
+    .def("GetStream", &StdRNGService::GetStream,
+         "Independent random number stream derived from the service seed.")
+    ;
+}
+
+/// Define python bindings for the RNGStream
+void
+pybind_rng_service_RNGStream()
+{
+  class_<RNGStream, bases<RNGService> >
+    ("RNGStream",
+     "Random numbers from one stream of a counter-based generator",
+     init<boost::uint64_t, boost::uint64_t>((arg("seed")=0, arg("stream")=0)))
     ;
 }
 
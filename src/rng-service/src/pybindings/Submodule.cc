@@ -12,6 +12,7 @@ using namespace std;
 
 void pybind_rng_service_RNGService();
 void pybind_rng_service_StdRNGService();
+void pybind_rng_service_RNGStream();
 
 BOOST_PYTHON_FUNCTION_OVERLOADS(GS_RNGService_Overloads,
   GetService<RNGService>, 1, 2);
@@ -25,6 +26,7 @@ BOOST_PYTHON_MODULE(rng_service)
 
   pybind_rng_service_RNGService();
   pybind_rng_service_StdRNGService();
+  pybind_rng_service_RNGStream();
 
   def("GetService", GetService<RNGService>,
     GS_RNGService_Overloads()[return_value_policy<reference_existing_object>()]);
@@ -16,6 +16,10 @@
 #include <hawcnest/test/OutputConfig.h>
 
 #include <rng-service/StdRNGService.h>
+#include <rng-service/PhiloxEngine.h>
+#include <rng-service/RNGStream.h>
+
+#include <vector>
 
 using namespace std;
 
@@ -209,5 +213,100 @@ BOOST_AUTO_TEST_SUITE(RNGDistributions)
     BOOST_CHECK_SMALL(M2/(n-1) - ((b-a)*(b-a))/12, 1e-2);
   }
 
+  //____________________________________________________________________________
+  // Bulk draws reproduce the sequence of scalar draws
+  BOOST_AUTO_TEST_CASE(Bulk)
+  {
+    HAWCNest nest;
+    nest.Service("StdRNGService", "rng1")
+      ("seed", 12345);
+    nest.Service("StdRNGService", "rng2")
+      ("seed", 12345);
+    nest.Configure();
+
+    const RNGService& rng1 = GetService<RNGService>("rng1");
+    const RNGService& rng2 = GetService<RNGService>("rng2");
+
+    vector<double> u;
+    rng1.Uniform(1001, u, 2., 11.);
+    for (unsigned i = 0; i < u.size(); ++i)
+      BOOST_CHECK_EQUAL(u[i], rng2.Uniform(2., 11.));
+
+    vector<double> mu(1000, 5.75);
+    mu.resize(2000, 123.4);
+    vector<int> k;
+    rng1.Poisson(mu, k);
+    for (unsigned i = 0; i < k.size(); ++i)
+      BOOST_CHECK_EQUAL(k[i], rng2.Poisson(mu[i]));
+
+    rng1.PowerLaw(-2.7, 1., 100., 1000, u);
+    for (unsigned i = 0; i < u.size(); ++i)
+      BOOST_CHECK_EQUAL(u[i], rng2.PowerLaw(-2.7, 1., 100.));
+
+    rng1.CutoffPowerLaw(-2., 0.1, 1., 100., 1000, u);
+    for (unsigned i = 0; i < u.size(); ++i)
+      BOOST_CHECK_EQUAL(u[i], rng2.CutoffPowerLaw(-2., 0.1, 1., 100.));
+  }
+
+  //____________________________________________________________________________
+  // Streams only depend on the seed and stream number
+  BOOST_AUTO_TEST_CASE(Streams)
+  {
+    HAWCNest nest;
+    nest.Service("StdRNGService", "rng")
+      ("seed", 12345);
+    nest.Configure();
+
+    const StdRNGService& rng =
+      dynamic_cast<const StdRNGService&>(GetService<RNGService>("rng"));
+
+    RNGStream s1 = rng.GetStream(7);
+    RNGStream s2 = rng.GetStream(7);
+    RNGStream s3 = rng.GetStream(8);
+    RNGStream s4(12345, 7);
+
+    // Bulk and scalar draws of a stream agree, also in the middle of a
+    // block: Poisson(3.) consumes one Uniform, i.e. two 32-bit words
+    s1.Poisson(3.);
+    s2.Poisson(3.);
+    vector<double> u;
+    s1.Uniform(1001, u);
+    int nSame = 0;
+    for (unsigned i = 0; i < u.size(); ++i) {
+      BOOST_CHECK_EQUAL(u[i], s2.Uniform());
+      s4.Uniform();
+      nSame += (u[i] == s3.Uniform());
+    }
+    BOOST_CHECK_EQUAL(nSame, 0);
+    BOOST_CHECK_EQUAL(s1.Gaussian(), s2.Gaussian());
+
+    // ... and after an odd number of 32-bit words, which only the engine
+    // itself (e.g. through boost distributions) consumes
+    PhiloxEngine e1(12345, 7);
+    PhiloxEngine e2(12345, 7);
+    e1();
+    e2();
+    e1.Uniform(&u[0], u.size());
+    for (unsigned i = 0; i < u.size(); ++i)
+      BOOST_CHECK_EQUAL(u[i], e2.Uniform());
+
+    // Moments of a bulk Poisson draw from a stream
+    vector<double> mu(100000, 5.75);
+    vector<int> k;
+    s4.Poisson(mu, k);
+    int n = 0;
+    double mean = 0;
+    double M2 = 0;
+    double du = 0;
+    for (unsigned i = 0; i < k.size(); ++i) {
+      n = i + 1;
+      du = k[i] - mean;
+      mean += du/n;
+      M2 += du*(k[i] - mean);
+    }
+    BOOST_CHECK_SMALL(mean - 5.75, 2e-2);
+    BOOST_CHECK_SMALL(M2/(n-1) - 5.75, 5e-2);
+  }
+
 BOOST_AUTO_TEST_SUITE_END()
 